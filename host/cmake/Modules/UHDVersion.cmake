@@ -19,7 +19,7 @@ find_package(Git QUIET)
 ########################################################################
 set(UHD_VERSION_MAJOR 4)
 set(UHD_VERSION_API   0)
-set(UHD_VERSION_ABI   0)
+set(UHD_VERSION_ABI   1)
 set(UHD_VERSION_PATCH 0)
 set(UHD_VERSION_DEVEL FALSE)
 
@@ -5,18 +5,21 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
+#include <uhd/convert.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/types/tune_request.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/utils/rx_recorder.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/utils/thread.hpp>
+#include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 #include <chrono>
 #include <complex>
 #include <csignal>
-#include <fstream>
+#include <future>
 #include <iostream>
 #include <thread>
 
@@ -28,35 +31,25 @@ void sig_int_handler(int)
     stop_signal_called = true;
 }
 
-template <typename samp_type>
 void recv_to_file(uhd::usrp::multi_usrp::sptr usrp,
-    const std::string& cpu_format,
     const std::string& wire_format,
     const size_t& channel,
-    const std::string& file,
-    size_t samps_per_buff,
+    const uhd::rx_recorder::config_t& config,
     unsigned long long num_requested_samples,
-    double time_requested       = 0.0,
-    bool bw_summary             = false,
-    bool stats                  = false,
-    bool null                   = false,
-    bool enable_size_map        = false,
-    bool continue_on_bad_packet = false)
+    double time_requested = 0.0,
+    bool bw_summary       = false,
+    bool stats            = false)
 {
-    unsigned long long num_total_samps = 0;
     // create a receive streamer
-    uhd::stream_args_t stream_args(cpu_format, wire_format);
+    uhd::stream_args_t stream_args(config.cpu_format, wire_format);
     std::vector<size_t> channel_nums;
     channel_nums.push_back(channel);
     stream_args.channels             = channel_nums;
     uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(stream_args);
 
-    uhd::rx_metadata_t md;
-    std::vector<samp_type> buff(samps_per_buff);
-    std::ofstream outfile;
-    if (not null)
-        outfile.open(file.c_str(), std::ofstream::binary);
-    bool overflow_message = true;
+    // The recorder receives into a pool of buffers and writes them from
+    // separate threads, so a slow write doesn't immediately cause an overflow.
+    auto recorder = uhd::rx_recorder::make(rx_stream, config);
 
     // setup streaming
     uhd::stream_cmd_t stream_cmd((num_requested_samples == 0)
@@ -67,8 +60,6 @@ void recv_to_file(uhd::usrp::multi_usrp::sptr usrp,
     stream_cmd.time_spec  = uhd::time_spec_t();
     rx_stream->issue_stream_cmd(stream_cmd);
 
-    typedef std::map<size_t, size_t> SizeMap;
-    SizeMap mapSizes;
     const auto start_time = std::chrono::steady_clock::now();
     const auto stop_time =
         start_time + std::chrono::milliseconds(int64_t(1000 * time_requested));
@@ -76,81 +67,59 @@ void recv_to_file(uhd::usrp::multi_usrp::sptr usrp,
     auto last_update                     = start_time;
     unsigned long long last_update_samps = 0;
 
+    auto record_result =
+        std::async(std::launch::async, [recorder, num_requested_samples]() {
+            return recorder->record(num_requested_samples);
+        });
+
     // Run this loop until either time expired (if a duration was given), until
     // the requested number of samples were collected (if such a number was
     // given), or until Ctrl-C was pressed.
-    while (not stop_signal_called
-           and (num_requested_samples != num_total_samps or num_requested_samples == 0)
-           and (time_requested == 0.0 or std::chrono::steady_clock::now() <= stop_time)) {
+    while (record_result.wait_for(std::chrono::milliseconds(100))
+           != std::future_status::ready) {
         const auto now = std::chrono::steady_clock::now();
-
-        size_t num_rx_samps =
-            rx_stream->recv(&buff.front(), buff.size(), md, 3.0, enable_size_map);
-
-        if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
-            std::cout << boost::format("Timeout while streaming") << std::endl;
-            break;
-        }
-        if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
-            if (overflow_message) {
-                overflow_message = false;
-                std::cerr
-                    << boost::format(
-                           "Got an overflow indication. Please consider the following:\n"
-                           "  Your write medium must sustain a rate of %fMB/s.\n"
-                           "  Dropped samples will not be written to the file.\n"
-                           "  Please modify this example for your purposes.\n"
-                           "  This message will not appear again.\n")
-                           % (usrp->get_rx_rate(channel) * sizeof(samp_type) / 1e6);
-            }
-            continue;
-        }
-        if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) {
-            std::string error = str(boost::format("Receiver error: %s") % md.strerror());
-            if (continue_on_bad_packet) {
-                std::cerr << error << std::endl;
-                continue;
-            } else
-                throw std::runtime_error(error);
-        }
-
-        if (enable_size_map) {
-            SizeMap::iterator it = mapSizes.find(num_rx_samps);
-            if (it == mapSizes.end())
-                mapSizes[num_rx_samps] = 0;
-            mapSizes[num_rx_samps] += 1;
-        }
-
-        num_total_samps += num_rx_samps;
-
-        if (outfile.is_open()) {
-            outfile.write((const char*)&buff.front(), num_rx_samps * sizeof(samp_type));
+        if (stop_signal_called or (time_requested != 0.0 and now > stop_time)) {
+            recorder->stop();
         }
 
         if (bw_summary) {
-            last_update_samps += num_rx_samps;
             const auto time_since_last_update = now - last_update;
             if (time_since_last_update > std::chrono::seconds(1)) {
+                const auto current = recorder->get_stats();
                 const double time_since_last_update_s =
                     std::chrono::duration<double>(time_since_last_update).count();
-                const double rate = double(last_update_samps) / time_since_last_update_s;
-                std::cout << "\t" << (rate / 1e6) << " Msps" << std::endl;
-                last_update_samps = 0;
+                const double rate = double(current.num_samps - last_update_samps)
+                                    / time_since_last_update_s;
+                std::cout << "\t" << (rate / 1e6) << " Msps (" << current.num_queued
+                          << " buffers queued)" << std::endl;
+                last_update_samps = current.num_samps;
                 last_update       = now;
             }
         }
     }
     const auto actual_stop_time = std::chrono::steady_clock::now();
+    const auto num_total_samps  = record_result.get();
 
     stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS;
     rx_stream->issue_stream_cmd(stream_cmd);
 
-    if (outfile.is_open()) {
-        outfile.close();
+    recorder->close();
+    const auto recorder_stats = recorder->get_stats();
+
+    if (recorder_stats.num_overflows) {
+        std::cerr << boost::format(
+                         "Got %d overflow indication(s). Please consider the following:\n"
+                         "  Your write medium must sustain a rate of %fMB/s.\n"
+                         "  Dropped samples will not be written to the file.\n"
+                         "  Increase --buffers to ride out longer write stalls.\n")
+                         % recorder_stats.num_overflows
+                         % (usrp->get_rx_rate(channel)
+                             * uhd::convert::get_bytes_per_item(config.cpu_format) / 1e6);
     }
 
     if (stats) {
         std::cout << std::endl;
+
         const double actual_duration_seconds =
             std::chrono::duration<float>(actual_stop_time - start_time).count();
 
@@ -159,12 +128,18 @@ void recv_to_file(uhd::usrp::multi_usrp::sptr usrp,
                   << std::endl;
         const double rate = (double)num_total_samps / actual_duration_seconds;
         std::cout << (rate / 1e6) << " Msps" << std::endl;
+        std::cout << boost::format("Write stalls: %d (%f seconds), max. buffers queued: "
+                                   "%d, longest write: %f ms")
+                         % recorder_stats.num_stalls % recorder_stats.stall_time
+                         % recorder_stats.max_queued
+                         % (recorder_stats.max_write_time * 1e3)
+                  << std::endl;
 
-        if (enable_size_map) {
+        if (config.one_packet) {
             std::cout << std::endl;
             std::cout << "Packet size map (bytes: count)" << std::endl;
-            for (SizeMap::iterator it = mapSizes.begin(); it != mapSizes.end(); it++)
-                std::cout << it->first << ":\t" << it->second << std::endl;
+            for (const auto& size : recorder_stats.recv_sizes)
+                std::cout << size.first << ":\t" << size.second << std::endl;
         }
     }
 }
@@ -216,8 +191,8 @@ bool check_locked_sensor(std::vector<std::string> sensor_names,
 int UHD_SAFE_MAIN(int argc, char* argv[])
 {
     // variables to be set by po
-    std::string args, file, type, ant, subdev, ref, wirefmt;
-    size_t channel, total_num_samps, spb;
+    std::string args, file, type, ant, subdev, ref, wirefmt, stripe_dirs;
+    size_t channel, total_num_samps, spb, num_buffers, buffer_size;
     double rate, freq, gain, bw, total_time, setup_time, lo_offset;
 
     // setup the program options
@@ -230,7 +205,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("type", po::value<std::string>(&type)->default_value("short"), "sample type: double, float, or short")
         ("nsamps", po::value<size_t>(&total_num_samps)->default_value(0), "total number of samples to receive")
         ("duration", po::value<double>(&total_time)->default_value(0), "total number of seconds to receive")
-        ("spb", po::value<size_t>(&spb)->default_value(10000), "samples per buffer")
+        ("spb", po::value<size_t>(&spb), "samples per buffer (overrides --buffer-size)")
         ("rate", po::value<double>(&rate)->default_value(1e6), "rate of incoming samples")
         ("freq", po::value<double>(&freq)->default_value(0.0), "RF center frequency in Hz")
         ("lo-offset", po::value<double>(&lo_offset)->default_value(0.0),
@@ -248,6 +223,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("sizemap", "track packet size and display breakdown on exit")
         ("null", "run without writing to file")
         ("continue", "don't abort on a bad packet")
+        ("buffers", po::value<size_t>(&num_buffers)->default_value(16), "number of buffers between receiving and writing to disk")
+        ("buffer-size", po::value<size_t>(&buffer_size)->default_value(4 * 1024 * 1024), "size of a single buffer in bytes")
+        ("stripe-dirs", po::value<std::string>(&stripe_dirs)->default_value(""), "comma-separated list of directories to stripe the file across (e.g., one per disk)")
+        ("no-direct", "write through the page cache instead of using direct I/O")
         ("skip-lo", "skip checking LO lock status")
         ("int-n", "tune USRP with integer-N tuning")
     ;
@@ -379,41 +358,44 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         std::cout << "Press Ctrl + C to stop streaming..." << std::endl;
     }
 
-#define recv_to_file_args(format) \
-    (usrp,                        \
-        format,                   \
-        wirefmt,                  \
-        channel,                  \
-        file,                     \
-        spb,                      \
-        total_num_samps,          \
-        total_time,               \
-        bw_summary,               \
-        stats,                    \
-        null,                     \
-        enable_size_map,          \
-        continue_on_bad_packet)
-    // recv to file
+    std::string cpu_format;
+    if (type == "double")
+        cpu_format = "fc64";
+    else if (type == "float")
+        cpu_format = "fc32";
+    else if (type == "short")
+        cpu_format = "sc16";
+    else
+        throw std::runtime_error("Unknown type " + type);
     if (wirefmt == "s16") {
-        if (type == "double")
-            recv_to_file<double> recv_to_file_args("f64");
-        else if (type == "float")
-            recv_to_file<float> recv_to_file_args("f32");
-        else if (type == "short")
-            recv_to_file<short> recv_to_file_args("s16");
-        else
-            throw std::runtime_error("Unknown type " + type);
-    } else {
-        if (type == "double")
-            recv_to_file<std::complex<double>> recv_to_file_args("fc64");
-        else if (type == "float")
-            recv_to_file<std::complex<float>> recv_to_file_args("fc32");
-        else if (type == "short")
-            recv_to_file<std::complex<short>> recv_to_file_args("sc16");
-        else
-            throw std::runtime_error("Unknown type " + type);
+        // Real samples: drop the leading 'c' (e.g., "fc32" -> "f32")
+        cpu_format.erase(1, 1);
     }
 
+    uhd::rx_recorder::config_t recorder_config;
+    recorder_config.filename               = null ? "" : file;
+    recorder_config.cpu_format             = cpu_format;
+    recorder_config.num_buffers            = num_buffers;
+    recorder_config.buffer_size            = vm.count("spb")
+                                      ? spb * uhd::convert::get_bytes_per_item(cpu_format)
+                                      : buffer_size;
+    recorder_config.direct_io              = vm.count("no-direct") == 0;
+    recorder_config.one_packet             = enable_size_map;
+    recorder_config.continue_on_bad_packet = continue_on_bad_packet;
+    if (not stripe_dirs.empty()) {
+        boost::split(recorder_config.stripe_dirs, stripe_dirs, boost::is_any_of(","));
+    }
+
+    // recv to file
+    recv_to_file(usrp,
+        wirefmt,
+        channel,
+        recorder_config,
+        total_num_samps,
+        total_time,
+        bw_summary,
+        stats);
+
     // finished
     std::cout << std::endl << "Done!" << std::endl << std::endl;
 
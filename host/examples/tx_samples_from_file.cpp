@@ -9,12 +9,13 @@
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/utils/thread.hpp>
+#include <uhd/utils/tx_file_source.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
 #include <chrono>
 #include <complex>
 #include <csignal>
-#include <fstream>
+#include <future>
 #include <iostream>
 #include <thread>
 
@@ -26,42 +27,26 @@ void sig_int_handler(int)
     stop_signal_called = true;
 }
 
-template <typename samp_type>
-void send_from_file(
-    uhd::tx_streamer::sptr tx_stream, const std::string& file, size_t samps_per_buff)
+//! Send one burst from the file, and return once it was sent or Ctrl+C was pressed
+void send_from_file(uhd::tx_file_source::sptr source, const double timeout)
 {
-    uhd::tx_metadata_t md;
-    md.start_of_burst = false;
-    md.end_of_burst   = false;
-    std::vector<samp_type> buff(samps_per_buff);
-    std::ifstream infile(file.c_str(), std::ifstream::binary);
-
-    // loop until the entire file has been read
-
-    while (not md.end_of_burst and not stop_signal_called) {
-        infile.read((char*)&buff.front(), buff.size() * sizeof(samp_type));
-        size_t num_tx_samps = size_t(infile.gcount() / sizeof(samp_type));
-
-        md.end_of_burst = infile.eof();
-
-        const size_t samples_sent = tx_stream->send(&buff.front(), num_tx_samps, md);
-        if (samples_sent != num_tx_samps) {
-            UHD_LOG_ERROR("TX-STREAM",
-                "The tx_stream timed out sending " << num_tx_samps << " samples ("
-                                                   << samples_sent << " sent).");
-            return;
+    auto play_result = std::async(
+        std::launch::async, [source, timeout]() { return source->play(0, timeout); });
+    while (play_result.wait_for(std::chrono::milliseconds(100))
+           != std::future_status::ready) {
+        if (stop_signal_called) {
+            source->stop();
         }
     }
-
-    infile.close();
+    play_result.get();
 }
 
 int UHD_SAFE_MAIN(int argc, char* argv[])
 {
     // variables to be set by po
     std::string args, file, type, ant, subdev, ref, wirefmt, channel;
-    size_t spb;
-    double rate, freq, gain, bw, delay, lo_offset;
+    size_t spb, prefetch;
+    double rate, freq, gain, bw, delay, lo_offset, start_time;
 
     // setup the program options
     po::options_description desc("Allowed options");
@@ -72,6 +57,8 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("file", po::value<std::string>(&file)->default_value("usrp_samples.dat"), "name of the file to read binary samples from")
         ("type", po::value<std::string>(&type)->default_value("short"), "sample type: double, float, or short")
         ("spb", po::value<size_t>(&spb)->default_value(10000), "samples per buffer")
+        ("prefetch", po::value<size_t>(&prefetch)->default_value(64), "MiB of the file to read ahead of transmission")
+        ("start-time", po::value<double>(&start_time), "start transmission this many seconds after the device time was read (optional)")
         ("rate", po::value<double>(&rate), "rate of outgoing samples")
         ("freq", po::value<double>(&freq), "RF center frequency in Hz")
         ("lo-offset", po::value<double>(&lo_offset)->default_value(0.0),
@@ -82,7 +69,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         ("bw", po::value<double>(&bw), "analog frontend filter bandwidth in Hz")
         ("ref", po::value<std::string>(&ref)->default_value("internal"), "reference source (internal, external, mimo)")
         ("wirefmt", po::value<std::string>(&wirefmt)->default_value("sc16"), "wire format (sc8 or sc16)")
-        ("delay", po::value<double>(&delay)->default_value(0.0), "specify a delay between repeated transmission of file (in seconds)")
+        ("delay", po::value<double>(&delay)->default_value(0.0), "specify a delay between repeated transmission of file (in seconds). Without a delay, the file is repeated seamlessly.")
         ("channel", po::value<std::string>(&channel)->default_value("0"), "which channel to use")
         ("repeat", "repeatedly transmit file")
         ("int-n", "tune USRP with integer-n tuning")
@@ -215,27 +202,45 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
         cpu_format = "fc32";
     else if (type == "short")
         cpu_format = "sc16";
+    else
+        throw std::runtime_error("Unknown type " + type);
     uhd::stream_args_t stream_args(cpu_format, wirefmt);
     channel_nums.push_back(boost::lexical_cast<size_t>(channel));
     stream_args.channels             = channel_nums;
     uhd::tx_streamer::sptr tx_stream = usrp->get_tx_stream(stream_args);
 
+    // The file is memory-mapped and read ahead by a helper thread, so
+    // waveforms that don't fit in memory can be sent at full rate
+    uhd::tx_file_source::config_t source_config;
+    source_config.filenames      = {file};
+    source_config.cpu_format     = cpu_format;
+    source_config.samps_per_send = spb;
+    source_config.prefetch_size  = prefetch * 1024 * 1024;
+    source_config.loop           = repeat and delay == 0.0;
+
+    auto source    = uhd::tx_file_source::make(tx_stream, source_config);
+    double timeout = 1.0;
+    if (vm.count("start-time")) {
+        source->set_start_time(usrp->get_time_now() + uhd::time_spec_t(start_time));
+        timeout += start_time;
+    }
+
     // send from file
     do {
-        if (type == "double")
-            send_from_file<std::complex<double>>(tx_stream, file, spb);
-        else if (type == "float")
-            send_from_file<std::complex<float>>(tx_stream, file, spb);
-        else if (type == "short")
-            send_from_file<std::complex<short>>(tx_stream, file, spb);
-        else
-            throw std::runtime_error("Unknown type " + type);
+        send_from_file(source, timeout);
 
         if (repeat and delay > 0.0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(int64_t(delay * 1000)));
         }
+        source->seek(0);
     } while (repeat and not stop_signal_called);
 
+    const auto source_stats = source->get_stats();
+    std::cout << boost::format("Sent %d samples, %d send() calls were ahead of the "
+                               "read-ahead")
+                     % source_stats.num_samps % source_stats.num_prefetch_misses
+              << std::endl;
+
     // finished
     std::cout << std::endl << "Done!" << std::endl << std::endl;
 
@@ -13,12 +13,26 @@
 #include <uhd/utils/noncopyable.hpp>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace uhd {
 
 class UHD_API image_loader : uhd::noncopyable
 {
 public:
+    //! Signature of a progress callback
+    /*!
+     * The argument is the fraction of the image that has been transferred to
+     * the device, between 0.0 and 1.0.
+     */
+    typedef std::function<void(const double)> progress_fcn_t;
+
+    //! Signature of a message callback
+    /*!
+     * The argument is one line of status output, without the line break.
+     */
+    typedef std::function<void(const std::string&)> message_fcn_t;
+
     typedef struct
     {
         uhd::device_addr_t args;
@@ -31,8 +45,21 @@ public:
         std::string id;
         std::vector<uint8_t> component;
         uhd::dict<std::string, std::string> metadata;
+        //! If set, loaders report their progress here instead of printing it
+        progress_fcn_t progress;
+        //! If set, loaders pass their status output here instead of printing it
+        message_fcn_t message;
     } image_loader_args_t;
 
+    //! Outcome of loading images onto one of several devices
+    typedef struct
+    {
+        //! True if an applicable device was found and loaded
+        bool success;
+        //! The error message, if the loader threw an exception
+        std::string error;
+    } load_result_t;
+
     //! Signature of an image loading function
     /*!
      * This is the function signature for an image loading function.
@@ -67,6 +94,21 @@ public:
      */
     static bool load(const image_loader_args_t& image_loader_args);
 
+    //! Load firmware and/or FPGA onto several devices at once
+    /*!
+     * Every entry of \p image_loader_args is passed to load() from its own
+     * thread, so the (mostly device-bound) transfers to all devices overlap. A
+     * failure on one device does not stop the others.
+     *
+     * \param image_loader_args arguments for each device
+     * \param max_concurrent maximum number of devices loaded at the same time,
+     *                       or 0 to load all of them at once
+     * \return the outcome for each entry of \p image_loader_args, in order
+     */
+    static std::vector<load_result_t> load(
+        const std::vector<image_loader_args_t>& image_loader_args,
+        const size_t max_concurrent = 0);
+
     //! Get the instructions on how to recovery a particular device
     /*!
      * These instructions should be queried if the user interrupts an image loading
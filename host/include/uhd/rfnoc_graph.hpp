@@ -17,6 +17,7 @@
 #include <uhd/utils/noncopyable.hpp>
 #include <boost/units/detail/utility.hpp> // for demangle
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace uhd { namespace rfnoc {
@@ -283,6 +284,48 @@ public:
     virtual std::vector<uhd::transport::adapter_id_t> enumerate_adapters_to_dst(
         const block_id_t& dst_blk, size_t dst_port) = 0;
 
+    //! Host-side placement of a streamer channel, see get_stream_placements()
+    struct stream_placement_t
+    {
+        //! The ID of the streamer
+        std::string streamer_id;
+        //! The streamer port (channel)
+        size_t port;
+        //! graph_edge_t::RX_STREAM or graph_edge_t::TX_STREAM
+        graph_edge_t::edge_t direction;
+        //! The host transport adapter carrying the data of this channel
+        uhd::transport::adapter_id_t adapter_id;
+        //! The sample rate at the time the channel was connected, 0 if unknown
+        double samp_rate;
+        //! The estimated load on the adapter in bytes per second, including
+        // the CHDR packet overhead. 0 if the sample rate was unknown.
+        double load;
+    };
+
+    /*! Return the host transport adapters of all connected streamer channels
+     *
+     * Unless an adapter ID is passed to connect(), a streamer channel is placed
+     * on the adapter that carries the least load in its direction. The load of
+     * a channel is estimated from the sample rate on the connected block port,
+     * the sample size of the over-the-wire format, and the packet overhead
+     * given the MTU of the link. If the streamer uses polling offload threads
+     * (see \ref page_transport), those are balanced by load in the same way.
+     *
+     * The sample rate is read when connect() is called, and a placement is
+     * not revisited when the rate changes later. Before the first commit(),
+     * the rate on a block port is often not known yet. Channels connected
+     * while the rate is unknown don't add load, and are spread out by number
+     * of channels instead. For placement by load, set the rates and call
+     * commit() before connecting the streamers, e.g. by connecting the blocks
+     * and committing first.
+     *
+     * This allows verifying that high-rate channels ended up on different
+     * adapters.
+     *
+     * \return The placement of every connected streamer channel
+     */
+    virtual std::vector<stream_placement_t> get_stream_placements() const = 0;
+
     /*! Enumerate all the possible static connections in the graph
      *
      * \return A vector containing all the static edges in the graph.
@@ -9,6 +9,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/time_ticks.hpp>
 #include <stdint.h>
 #include <string>
 
@@ -32,6 +33,7 @@ struct UHD_API rx_metadata_t
     {
         has_time_spec       = false;
         time_spec           = time_spec_t(0.0);
+        time_ticks          = time_ticks_t();
         more_fragments      = false;
         fragment_offset     = 0;
         start_of_burst      = false;
@@ -49,6 +51,13 @@ struct UHD_API rx_metadata_t
     //! Time of the first sample.
     time_spec_t time_spec;
 
+    /*!
+     * Time of the first sample, as the exact tick count reported by the device.
+     * Valid whenever has_time_spec is true. time_spec is derived from this
+     * value; use time_ticks.to_time_spec() to convert it again if needed.
+     */
+    time_ticks_t time_ticks;
+
     /*!
      * Fragmentation flag:
      * Similar to IPv4 fragmentation:
@@ -171,6 +180,23 @@ struct UHD_API tx_metadata_t
     //! When to send the first sample.
     time_spec_t time_spec;
 
+    /*!
+     * When to send the first sample, as an exact tick count.
+     * Only used if has_time_ticks is set. If its tick rate matches the tick
+     * rate of the device, it is used without conversion.
+     */
+    time_ticks_t time_ticks;
+
+    /*!
+     * Use time_ticks instead of time_spec?
+     * - Set false to send at the time specified by time spec.
+     * - Set true (together with has_time_spec) to send at time_ticks, which
+     *   must be valid then.
+     * The streamer doesn't clear this flag. When reusing the metadata with a
+     * new time_spec, clear it again.
+     */
+    bool has_time_ticks;
+
     //! Set start of burst to true for the first packet in the chain.
     bool start_of_burst;
 
@@ -0,0 +1,139 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <stdint.h>
+#include <cmath>
+
+namespace uhd {
+
+/*!
+ * A time_ticks_t holds an exact timestamp as an integer number of clock ticks,
+ * together with the rate of the clock it refers to.
+ *
+ * This is the representation used by the devices themselves. Unlike
+ * time_spec_t, which stores fractional seconds as double precision floating
+ * point, it does not lose precision over long captures at tick rates that
+ * aren't a power of two, and carrying it through the streamers costs no
+ * floating point math. Conversion to seconds only happens when to_time_spec()
+ * is called.
+ *
+ * A default-constructed time_ticks_t is invalid (its tick rate is zero).
+ */
+class time_ticks_t
+{
+public:
+    //! Create an invalid timestamp
+    time_ticks_t(void) = default;
+
+    /*!
+     * Create a timestamp from a tick count.
+     * \param ticks the number of ticks since time zero
+     * \param tick_rate the number of ticks per second
+     */
+    time_ticks_t(const uint64_t ticks, const double tick_rate)
+        : _ticks(ticks), _tick_rate(tick_rate)
+    {
+    }
+
+    /*!
+     * Create a timestamp from a time_spec_t.
+     * \param time_spec the time to convert
+     * \param tick_rate the number of ticks per second
+     */
+    static time_ticks_t from_time_spec(
+        const time_spec_t& time_spec, const double tick_rate)
+    {
+        return time_ticks_t(uint64_t(time_spec.to_ticks(tick_rate)), tick_rate);
+    }
+
+    //! True if this timestamp was set
+    bool is_valid(void) const
+    {
+        return _tick_rate > 0.0;
+    }
+
+    //! Return the tick count
+    uint64_t get_ticks(void) const
+    {
+        return _ticks;
+    }
+
+    //! Return the tick rate the tick count refers to
+    double get_tick_rate(void) const
+    {
+        return _tick_rate;
+    }
+
+    /*!
+     * Return the tick count in a given clock domain.
+     * No conversion happens if \p tick_rate matches the tick rate of this
+     * timestamp.
+     */
+    uint64_t to_ticks(const double tick_rate) const
+    {
+        if (tick_rate == _tick_rate) {
+            return _ticks;
+        }
+        return uint64_t(to_time_spec().to_ticks(tick_rate));
+    }
+
+    /*!
+     * Convert the timestamp to seconds.
+     * For integer tick rates (the common case), the full seconds are computed
+     * exactly, and the fractional seconds carry only the rounding error of a
+     * single division.
+     */
+    time_spec_t to_time_spec(void) const
+    {
+        const uint64_t rate_i = uint64_t(_tick_rate);
+        if (rate_i > 0 && double(rate_i) == _tick_rate) {
+            return time_spec_t(
+                int64_t(_ticks / rate_i), double(_ticks % rate_i) / _tick_rate);
+        }
+        return time_spec_t::from_ticks((long long)_ticks, _tick_rate);
+    }
+
+    /*!
+     * Advance the timestamp by a number of samples.
+     * The result is exact if the tick rate is an integer multiple of the
+     * sample rate, and rounded to the nearest tick otherwise.
+     * \param num_samps the number of samples to advance by
+     * \param samp_rate the sample rate, in samples per second
+     */
+    time_ticks_t& advance(const uint64_t num_samps, const double samp_rate)
+    {
+        const double ticks_per_samp     = _tick_rate / samp_rate;
+        const uint64_t ticks_per_samp_i = uint64_t(ticks_per_samp);
+        if (double(ticks_per_samp_i) == ticks_per_samp) {
+            _ticks += num_samps * ticks_per_samp_i;
+        } else {
+            _ticks += uint64_t(std::llround(num_samps * ticks_per_samp));
+        }
+        return *this;
+    }
+
+private:
+    uint64_t _ticks   = 0;
+    double _tick_rate = 0.0;
+};
+
+//! Timestamps are equal if they refer to the same tick rate and tick count
+UHD_INLINE bool operator==(const time_ticks_t& lhs, const time_ticks_t& rhs)
+{
+    return lhs.get_ticks() == rhs.get_ticks()
+           && lhs.get_tick_rate() == rhs.get_tick_rate();
+}
+
+UHD_INLINE bool operator!=(const time_ticks_t& lhs, const time_ticks_t& rhs)
+{
+    return !(lhs == rhs);
+}
+
+} // namespace uhd
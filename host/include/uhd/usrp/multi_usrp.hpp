@@ -650,6 +650,14 @@ public:
      */
     virtual void set_rx_rate(double rate, size_t chan = ALL_CHANS) = 0;
 
+    /*!
+     * Set the RX sample rate on several channels.
+     * See set_rx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param rate the rate in Sps
+     * \param chans the channel indexes
+     */
+    virtual void set_rx_rate(double rate, const std::vector<size_t>& chans);
+
     /*! Set the number of samples sent per packet (spp) for RX streaming
      *
      * On RFNoC devices, this will set the spp value on the radio itself. For
@@ -684,6 +692,35 @@ public:
     virtual tune_result_t set_rx_freq(
         const tune_request_t& tune_request, size_t chan = 0) = 0;
 
+    /*!
+     * Set the RX center frequency on several channels.
+     *
+     * This is equivalent to calling set_rx_freq() for every channel, but lets
+     * the device apply the settings in one go. On RFNoC devices, the channels
+     * are configured one radio at a time, so the register writes for a radio
+     * go out back to back. Each setting is fully resolved before the next
+     * channel is configured, so the returned values are final.
+     *
+     * The other multi-channel setters of this class work the same way. Where
+     * a single-channel setter accepts ALL_CHANS, that is equivalent to passing
+     * all channels to its multi-channel version.
+     *
+     * \param tune_request tune request instructions, used for all channels
+     * \param chans the channel indexes
+     * \return the tune results, in the order of chans
+     * \throws uhd::lookup_error if any of the channels is invalid. In this
+     *         case, no channel is tuned.
+     *
+     * \note The multi-channel setters were added in UHD 4.0.1. They are new
+     *       virtual methods of multi_usrp, which changes its ABI (see
+     *       \ref page_semver): applications, and classes derived from
+     *       multi_usrp, need to be rebuilt. Derived classes that don't override
+     *       them get a default that calls the single-channel setter for one
+     *       channel after the other.
+     */
+    virtual std::vector<tune_result_t> set_rx_freq(
+        const tune_request_t& tune_request, const std::vector<size_t>& chans);
+
     /*!
      * Get the RX center frequency.
      * \param chan the channel index 0 to N-1
@@ -973,6 +1010,16 @@ public:
      */
     virtual void set_rx_gain(double gain, const std::string& name, size_t chan = 0) = 0;
 
+    /*!
+     * Set the RX gain value for the specified gain element on several channels.
+     * See set_rx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param gain the gain in dB
+     * \param name the name of the gain element
+     * \param chans the channel indexes
+     */
+    virtual void set_rx_gain(
+        double gain, const std::string& name, const std::vector<size_t>& chans);
+
     /*! Get a list of possible RX gain profile options
      *
      * Example: On the TwinRX, this will return "low-noise", "low-distortion" or
@@ -1114,6 +1161,14 @@ public:
      */
     virtual void set_rx_bandwidth(double bandwidth, size_t chan = 0) = 0;
 
+    /*!
+     * Set the RX bandwidth on the frontend of several channels.
+     * See set_rx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param bandwidth the bandwidth in Hz
+     * \param chans the channel indexes
+     */
+    virtual void set_rx_bandwidth(double bandwidth, const std::vector<size_t>& chans);
+
     /*!
      * Get the RX bandwidth on the frontend.
      * \param chan the channel index 0 to N-1
@@ -1306,6 +1361,14 @@ public:
      */
     virtual void set_tx_rate(double rate, size_t chan = ALL_CHANS) = 0;
 
+    /*!
+     * Set the TX sample rate on several channels.
+     * See set_tx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param rate the rate in Sps
+     * \param chans the channel indexes
+     */
+    virtual void set_tx_rate(double rate, const std::vector<size_t>& chans);
+
     /*!
      * Gets the TX sample rate.
      * \param chan the channel index 0 to N-1
@@ -1329,6 +1392,31 @@ public:
     virtual tune_result_t set_tx_freq(
         const tune_request_t& tune_request, size_t chan = 0) = 0;
 
+    /*!
+     * Set the TX center frequency on several channels.
+     *
+     * This is equivalent to calling set_tx_freq() for every channel, but lets
+     * the device apply the settings in one go. On RFNoC devices, the channels
+     * are configured one radio at a time, so the register writes for a radio
+     * go out back to back. Each setting is fully resolved before the next
+     * channel is configured, so the returned values are final.
+     *
+     * The other multi-channel setters of this class work the same way. Where
+     * a single-channel setter accepts ALL_CHANS, that is equivalent to passing
+     * all channels to its multi-channel version.
+     *
+     * \param tune_request tune request instructions, used for all channels
+     * \param chans the channel indexes
+     * \return the tune results, in the order of chans
+     * \throws uhd::lookup_error if any of the channels is invalid. In this
+     *         case, no channel is tuned.
+     *
+     * \note See set_rx_freq(const tune_request_t&, const std::vector<size_t>&)
+     *       about the ABI of the multi-channel setters.
+     */
+    virtual std::vector<tune_result_t> set_tx_freq(
+        const tune_request_t& tune_request, const std::vector<size_t>& chans);
+
     /*!
      * Get the TX center frequency.
      * \param chan the channel index 0 to N-1
@@ -1363,6 +1451,16 @@ public:
      */
     virtual void set_tx_gain(double gain, const std::string& name, size_t chan = 0) = 0;
 
+    /*!
+     * Set the TX gain value for the specified gain element on several channels.
+     * See set_tx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param gain the gain in dB
+     * \param name the name of the gain element
+     * \param chans the channel indexes
+     */
+    virtual void set_tx_gain(
+        double gain, const std::string& name, const std::vector<size_t>& chans);
+
     /*! Get a list of possible TX gain profile options
      *
      * Example: On the N310, this will return "manual" or "default".
@@ -1551,6 +1649,14 @@ public:
      */
     virtual void set_tx_bandwidth(double bandwidth, size_t chan = 0) = 0;
 
+    /*!
+     * Set the TX bandwidth on the frontend of several channels.
+     * See set_tx_freq(const tune_request_t&, const std::vector<size_t>&).
+     * \param bandwidth the bandwidth in Hz
+     * \param chans the channel indexes
+     */
+    virtual void set_tx_bandwidth(double bandwidth, const std::vector<size_t>& chans);
+
     /*!
      * Get the TX bandwidth on the frontend.
      * \param chan the channel index 0 to N-1
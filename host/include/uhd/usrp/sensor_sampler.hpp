@@ -0,0 +1,138 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/utils/noncopyable.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uhd { namespace usrp {
+
+/*! Periodically read sensors in the background, and cache their values
+ *
+ * Reading a sensor through multi_usrp::get_mboard_sensor() and friends is a
+ * synchronous operation: depending on the device, it is an RPC call, a
+ * register read, or an I2C transaction. Applications that monitor sensors in
+ * a tight loop thus compete with control operations for the device.
+ *
+ * A sensor sampler owns one thread that reads a fixed set of sensors, each at
+ * its own period, and stores the most recent value of every sensor. get()
+ * returns that value without touching the device, together with its age, so
+ * it can be called as often as needed from any thread. It never waits for a
+ * sensor read in progress.
+ *
+ * Example:
+ * \code{.cpp}
+ * auto sampler = uhd::usrp::sensor_sampler::make({
+ *     sensor_sampler::mboard_sensor(usrp, "ref_locked", 1.0),
+ *     sensor_sampler::mboard_sensor(usrp, "temp", 10.0),
+ *     sensor_sampler::rx_sensor(usrp, "lo_locked", 0.5, 0)});
+ * const auto ref_locked = sampler->get("mboard0/ref_locked");
+ * if (ref_locked.valid and ref_locked.age < 2.0) {
+ *     std::cout << ref_locked.value.to_pp_string() << std::endl;
+ * }
+ * \endcode
+ *
+ * The sampler keeps the device alive; it must be destroyed before the device
+ * can be released.
+ */
+class UHD_API sensor_sampler : uhd::noncopyable
+{
+public:
+    typedef std::shared_ptr<sensor_sampler> sptr;
+    typedef std::function<sensor_value_t(void)> read_fn_t;
+
+    //! A sensor to be sampled
+    struct sensor_t
+    {
+        //! Name by which the value can be retrieved through get()
+        std::string key;
+        //! Function that reads the sensor. May throw.
+        read_fn_t read;
+        //! Time between two reads, in seconds
+        double period = 1.0;
+    };
+
+    //! The most recent value of a sensor
+    struct cached_value_t
+    {
+        //! The value returned by the last successful read
+        sensor_value_t value = sensor_value_t("", false, "", "");
+        //! False if the sensor was never read successfully
+        bool valid = false;
+        //! Time since the last successful read, in seconds. Only meaningful if
+        // valid is true.
+        double age = 0.0;
+        //! Error message of the last read, if it failed. Empty otherwise.
+        std::string error;
+    };
+
+    virtual ~sensor_sampler(void) = 0;
+
+    /*! Create a sampler and start its thread
+     *
+     * All sensors are read once, in order, right after the thread has
+     * started, and then every sensor_t::period seconds.
+     *
+     * \param sensors The sensors to sample
+     * \throws uhd::value_error if a key is duplicated or a period is not
+     *         positive
+     */
+    static sptr make(const std::vector<sensor_t>& sensors);
+
+    /*! Describe a motherboard sensor of a multi_usrp
+     *
+     * The key is "mboard<mboard>/<name>", e.g. "mboard0/ref_locked".
+     */
+    static sensor_t mboard_sensor(multi_usrp::sptr usrp,
+        const std::string& name,
+        const double period,
+        const size_t mboard = 0);
+
+    /*! Describe an RX frontend sensor of a multi_usrp
+     *
+     * The key is "rx<chan>/<name>", e.g. "rx0/lo_locked".
+     */
+    static sensor_t rx_sensor(multi_usrp::sptr usrp,
+        const std::string& name,
+        const double period,
+        const size_t chan = 0);
+
+    /*! Describe a TX frontend sensor of a multi_usrp
+     *
+     * The key is "tx<chan>/<name>", e.g. "tx0/lo_locked".
+     */
+    static sensor_t tx_sensor(multi_usrp::sptr usrp,
+        const std::string& name,
+        const double period,
+        const size_t chan = 0);
+
+    /*! Return the most recent value of a sensor
+     *
+     * This does not access the device and may be called from any thread.
+     *
+     * \throws uhd::key_error if there is no sensor with this key
+     */
+    virtual cached_value_t get(const std::string& key) const = 0;
+
+    //! Return the keys of all sampled sensors
+    virtual std::vector<std::string> get_keys(void) const = 0;
+
+    /*! Stop the sampler thread
+     *
+     * Waits for a sensor read in progress to finish. The cached values remain
+     * available through get(). Called by the destructor.
+     */
+    virtual void stop(void) = 0;
+};
+
+}} // namespace uhd::usrp
@@ -0,0 +1,167 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/rfnoc_types.hpp>
+#include <uhd/types/endianness.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uhd { namespace utils { namespace chdr {
+
+//! Options for analyze_pcap()
+struct pcap_analyzer_config_t
+{
+    //! The CHDR width of the captured link
+    uhd::rfnoc::chdr_w_t chdr_w = uhd::rfnoc::CHDR_W_64;
+    //! The endianness of the captured link
+    uhd::endianness_t endianness = uhd::ENDIANNESS_LITTLE;
+    //! Only decode UDP datagrams from or to this port. 0 means all ports.
+    uint16_t udp_port = 0;
+    //! Number of decoder threads. 0 means one per CPU.
+    size_t num_threads = 0;
+    //! Approximate number of capture bytes decoded as one unit of work
+    size_t chunk_size = 16 * 1024 * 1024;
+    //! Nominal tick rate of the device. Used for the timestamp drift, 0 to skip.
+    double tick_rate = 0.0;
+};
+
+//! The kind of packets a CHDR stream is made of
+enum pcap_stream_type_t {
+    PCAP_STREAM_DATA, //!< Data packets, with or without timestamp
+    PCAP_STREAM_CTRL, //!< Control transactions
+    PCAP_STREAM_STRS, //!< Stream status (flow control responses)
+    PCAP_STREAM_STRC, //!< Stream commands
+    PCAP_STREAM_MGMT //!< Management transactions
+};
+
+/*! Statistics of a single CHDR stream
+ *
+ * A stream is made up of all packets of one type that were sent to the same
+ * destination endpoint. All times are capture times, in seconds since the
+ * epoch.
+ */
+struct pcap_stream_stats_t
+{
+    //! The destination endpoint ID
+    uint16_t dst_epid = 0;
+    //! The type of the packets in this stream
+    pcap_stream_type_t type = PCAP_STREAM_DATA;
+    //! Number of packets
+    uint64_t num_packets = 0;
+    //! Number of bytes, as given by the CHDR length field
+    uint64_t num_bytes = 0;
+    //! Number of payload bytes (i.e., without header, timestamp and metadata)
+    uint64_t num_payload_bytes = 0;
+    //! Capture time of the first packet
+    double first_time = 0.0;
+    //! Capture time of the last packet
+    double last_time = 0.0;
+    //! Average throughput over the lifetime of the stream, in bits per second
+    double throughput = 0.0;
+
+    //! Number of discontinuities in the sequence numbers (data streams only)
+    uint64_t num_seq_gaps = 0;
+    //! Number of packets missing according to the sequence numbers
+    uint64_t num_lost_packets = 0;
+    //! Number of packets with the EOB flag set
+    uint64_t num_eob = 0;
+
+    //! Number of packets that carried a timestamp
+    uint64_t num_timestamps = 0;
+    //! The first timestamp, in ticks
+    uint64_t first_timestamp = 0;
+    //! The last timestamp, in ticks
+    uint64_t last_timestamp = 0;
+    //! Tick rate estimated from the timestamps and the capture times
+    double tick_rate = 0.0;
+    /*! Difference between the device clock (timestamps at the nominal tick
+     * rate) and the capture clock, in parts per million. Only meaningful for
+     * continuous streams, and 0 if the nominal tick rate is unknown.
+     */
+    double drift_ppm = 0.0;
+
+    //! Number of stream status packets that reported an error
+    uint64_t num_strs_errors = 0;
+    //! Shortest time between two stream status packets, in seconds
+    double min_strs_interval = 0.0;
+    //! Average time between two stream status packets, in seconds
+    double mean_strs_interval = 0.0;
+    //! Longest time between two stream status packets, in seconds
+    double max_strs_interval = 0.0;
+};
+
+//! Results of analyze_pcap()
+struct pcap_stats_t
+{
+    //! Number of bytes in the capture
+    uint64_t num_bytes = 0;
+    //! Number of records in the capture
+    uint64_t num_records = 0;
+    //! Number of CHDR packets decoded
+    uint64_t num_chdr_packets = 0;
+    //! Number of records that weren't UDP datagrams on the selected port
+    uint64_t num_ignored = 0;
+    //! Number of records that were truncated or had inconsistent lengths
+    uint64_t num_malformed = 0;
+    //! Capture time of the first record
+    double first_time = 0.0;
+    //! Capture time of the last record
+    double last_time = 0.0;
+    //! Time it took to decode the capture, in seconds
+    double decode_time = 0.0;
+    //! All streams, ordered by destination endpoint and type
+    std::vector<pcap_stream_stats_t> streams;
+
+    //! Return the decode rate, in bits of capture per second
+    double get_decode_rate() const
+    {
+        return decode_time > 0.0 ? num_bytes * 8 / decode_time : 0.0;
+    }
+};
+
+/*! Decode the CHDR packets of a packet capture held in memory
+ *
+ * The capture must be in the classic pcap format (with microsecond or
+ * nanosecond timestamps, in either byte order), and its link type must be
+ * Ethernet, Linux cooked capture, or raw IPv4. Every UDP datagram is expected
+ * to carry exactly one CHDR packet.
+ *
+ * The capture is split into chunks, which are decoded in parallel by
+ * config.num_threads threads. Packets are decoded in place, so the time per
+ * packet does not depend on any memory allocation. The results of the chunks
+ * are merged in capture order, so a sequence gap or a stream status interval
+ * that spans two chunks is accounted for like any other.
+ *
+ * \param data The start of the capture
+ * \param num_bytes The size of the capture, in bytes
+ * \param config Decoding options
+ * \return The capture statistics
+ * \throws uhd::value_error if the data is not a supported pcap capture
+ */
+UHD_API pcap_stats_t analyze_pcap(const void* data,
+    const size_t num_bytes,
+    const pcap_analyzer_config_t& config = pcap_analyzer_config_t());
+
+/*! Decode the CHDR packets of a packet capture file
+ *
+ * The file is memory-mapped and passed to analyze_pcap(), so it is never
+ * read into an intermediate buffer.
+ *
+ * \param filename The capture file
+ * \param config Decoding options
+ * \return The capture statistics
+ * \throws uhd::io_error if the file can't be opened
+ * \throws uhd::value_error if the file is not a supported pcap capture
+ */
+UHD_API pcap_stats_t analyze_pcap_file(const std::string& filename,
+    const pcap_analyzer_config_t& config = pcap_analyzer_config_t());
+
+}}} // namespace uhd::utils::chdr
@@ -0,0 +1,151 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/rfnoc/replay_block_control.hpp>
+#include <uhd/rfnoc_graph.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uhd { namespace rfnoc {
+
+/*! Upload a memory region into the on-board memory of a Replay block
+ *
+ * The data is split into contiguous, word-aligned sections, one per Replay
+ * block input port in \p ports. Every section gets its own TX streamer and
+ * its own thread, and is recorded into its own region of memory, so the
+ * transfer uses as many parallel streams as there are ports. The record
+ * offset and size of each port are managed by this function. If \p num_bytes
+ * is not a multiple of the memory word size, the last word is padded with
+ * zeros.
+ *
+ * The streamers are connected to the Replay block and the graph is committed
+ * by this function. The streamers are released (and thus disconnected) before
+ * it returns. The selected input ports must therefore not be connected to any
+ * other block.
+ *
+ * \param graph The rfnoc_graph the Replay block belongs to
+ * \param replay The Replay block to upload into
+ * \param data Pointer to the data to upload
+ * \param num_bytes Number of bytes to upload
+ * \param mem_offset Byte offset into the Replay block memory. Must be aligned
+ *                   to the memory word size.
+ * \param ports The input ports to use. An empty list means all input ports.
+ * \param stream_args Additional streamer arguments (e.g., "spp")
+ * \return The number of bytes occupied in memory (i.e., \p num_bytes rounded
+ *         up to a multiple of the memory word size)
+ * \throws uhd::value_error if the region does not fit into memory
+ * \throws uhd::io_error if the data could not be sent or recorded, or if stale
+ *         data keeps arriving on one of the input ports
+ */
+UHD_API uint64_t replay_upload(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset             = 0,
+    const std::vector<size_t>& ports      = std::vector<size_t>(),
+    const uhd::device_addr_t& stream_args = uhd::device_addr_t());
+
+/*! Upload the contents of a file into the on-board memory of a Replay block
+ *
+ * The file is memory-mapped and passed to replay_upload(), so it is never
+ * copied into an intermediate buffer.
+ *
+ * \param filename The file to upload
+ * \returns The number of bytes occupied in memory
+ * \throws uhd::io_error if the file can't be opened
+ *
+ * See replay_upload() for a description of the remaining arguments.
+ */
+UHD_API uint64_t replay_upload_file(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const std::string& filename,
+    const uint64_t mem_offset             = 0,
+    const std::vector<size_t>& ports      = std::vector<size_t>(),
+    const uhd::device_addr_t& stream_args = uhd::device_addr_t());
+
+/*! Download a region of the on-board memory of a Replay block
+ *
+ * This is the counterpart to replay_upload(). The region is split into
+ * contiguous, word-aligned sections, one per Replay block output port in
+ * \p ports, and every section is played back into its own RX streamer on its
+ * own thread.
+ *
+ * \param graph The rfnoc_graph the Replay block belongs to
+ * \param replay The Replay block to download from
+ * \param data Pointer to the destination buffer, at least \p num_bytes long
+ * \param num_bytes Number of bytes to download
+ * \param mem_offset Byte offset into the Replay block memory. Must be aligned
+ *                   to the memory word size.
+ * \param ports The output ports to use. An empty list means all output ports.
+ * \param stream_args Additional streamer arguments
+ * \throws uhd::value_error if the region does not fit into memory
+ * \throws uhd::io_error if the data could not be received
+ */
+UHD_API void replay_download(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset             = 0,
+    const std::vector<size_t>& ports      = std::vector<size_t>(),
+    const uhd::device_addr_t& stream_args = uhd::device_addr_t());
+
+/*! Download a region of the on-board memory of a Replay block into a file
+ *
+ * The file is created (or truncated) to \p num_bytes, memory-mapped, and
+ * filled directly by replay_download().
+ *
+ * \param filename The file to write
+ * \throws uhd::io_error if the file can't be created
+ *
+ * See replay_download() for a description of the remaining arguments.
+ */
+UHD_API void replay_download_file(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const std::string& filename,
+    const size_t num_bytes,
+    const uint64_t mem_offset             = 0,
+    const std::vector<size_t>& ports      = std::vector<size_t>(),
+    const uhd::device_addr_t& stream_args = uhd::device_addr_t());
+
+/*! Calculate the checksum of a buffer
+ *
+ * This is a 64-bit FNV-1a hash computed over little-endian 64-bit words
+ * (trailing bytes are hashed individually). It is fast enough to check
+ * multi-gigabyte waveforms, and yields the same value on any host.
+ *
+ * \param data Pointer to the data
+ * \param num_bytes Number of bytes to hash
+ * \return The checksum
+ */
+UHD_API uint64_t replay_checksum(const void* data, const size_t num_bytes);
+
+/*! Verify the contents of the on-board memory of a Replay block by reading it back
+ *
+ * The Replay block can't compute a checksum itself, so this check is done on
+ * the host: \p num_bytes are downloaded from \p mem_offset into a scratch
+ * buffer with replay_download(), and the checksum of that buffer is compared to
+ * the one of \p data. This takes as long as the download, and needs a scratch
+ * buffer of \p num_bytes.
+ *
+ * \return true if the memory contents match \p data
+ *
+ * See replay_download() for a description of the arguments.
+ */
+UHD_API bool replay_verify_readback(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset             = 0,
+    const std::vector<size_t>& ports      = std::vector<size_t>(),
+    const uhd::device_addr_t& stream_args = uhd::device_addr_t());
+
+}} // namespace uhd::rfnoc
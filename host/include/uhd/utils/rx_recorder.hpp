@@ -0,0 +1,157 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/utils/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uhd {
+
+/*! Record the output of an RX streamer to disk at a sustained rate
+ *
+ * The recorder decouples the thread calling recv() from storage. Samples are
+ * received directly into a pool of page-aligned buffers. Full buffers are
+ * handed to writer threads, which put them on disk while the receive thread
+ * keeps filling the next buffer. A storage stall therefore only turns into an
+ * overflow once every buffer of the pool is waiting to be written, and the
+ * statistics show how close a recording came to that point.
+ *
+ * Every channel is written to its own file. When multiple stripe directories
+ * are given (e.g., one per disk), consecutive buffers are distributed
+ * round-robin across them, and each stripe gets its own writer thread. To
+ * reassemble a striped channel, concatenate chunks of config_t::buffer_size
+ * bytes, taking one chunk from each stripe file in turn.
+ *
+ * File names are derived from config_t::filename. For a recording with
+ * multiple channels, "_ch<N>" is inserted before the extension, and for
+ * multiple stripes, "_s<N>" follows (e.g., "rx_ch1_s0.dat"). Striped files are
+ * put into their stripe directory, all others next to config_t::filename.
+ *
+ * Unless disabled, a sidecar index is written next to config_t::filename with
+ * an ".idx" suffix. It lists the recording parameters as comment lines,
+ * followed by one line per index entry:
+ *
+ *     <sample index>,<full secs>,<frac secs>,<event>
+ *
+ * Where the event is one of "start" (first sample), "buffer" (first sample of
+ * a buffer, for seeking), "sob" (start of burst), or "overflow" (first sample
+ * after a gap caused by an overflow).
+ *
+ * The recorder does not issue stream commands; streaming is controlled by the
+ * application.
+ */
+class UHD_API rx_recorder : uhd::noncopyable
+{
+public:
+    typedef std::shared_ptr<rx_recorder> sptr;
+
+    //! Recorder configuration
+    struct config_t
+    {
+        //! Base file name (see class description for the naming scheme)
+        std::string filename;
+        //! The CPU format of the streamer (determines the sample size)
+        std::string cpu_format = "sc16";
+        //! Directories to stripe the files across. If empty, files are not striped.
+        std::vector<std::string> stripe_dirs;
+        //! Number of buffers in the pool
+        size_t num_buffers = 16;
+        //! Size of a buffer, per channel, in bytes. Rounded up to a multiple of
+        // the page size and the sample size.
+        size_t buffer_size = 4 * 1024 * 1024;
+        //! Bypass the page cache (O_DIRECT) where supported
+        bool direct_io = true;
+        //! Write the sidecar index
+        bool write_index = true;
+        //! Receive one packet per recv() call
+        bool one_packet = false;
+        //! Do not throw on receive errors other than overflows and timeouts
+        bool continue_on_bad_packet = false;
+    };
+
+    //! Throughput and backpressure statistics
+    struct stats_t
+    {
+        //! Number of samples received, per channel
+        uint64_t num_samps = 0;
+        //! Number of bytes written to storage, over all files
+        uint64_t bytes_written = 0;
+        //! Number of overflows reported by the streamer
+        size_t num_overflows = 0;
+        //! Number of times the receive thread had to wait for a free buffer
+        size_t num_stalls = 0;
+        //! Total time the receive thread spent waiting for a free buffer, in seconds
+        double stall_time = 0.0;
+        //! Number of buffers currently waiting to be written
+        size_t num_queued = 0;
+        //! Highest number of buffers that were waiting to be written at once
+        size_t max_queued = 0;
+        //! Longest time it took to write a single buffer, in seconds
+        double max_write_time = 0.0;
+        //! Number of recv() calls by number of samples returned. Only filled in if
+        // config_t::one_packet is set.
+        std::map<size_t, size_t> recv_sizes;
+    };
+
+    virtual ~rx_recorder(void) = 0;
+
+    /*! Create a recorder and open its files
+     *
+     * \param rx_stream The streamer to record from
+     * \param config The recorder configuration. If config.filename is empty,
+     *               samples are received but not written (useful to check how
+     *               fast the receive side can run).
+     * \throws uhd::io_error if a file can't be created
+     * \throws uhd::value_error if the configuration is invalid
+     */
+    static sptr make(rx_streamer::sptr rx_stream, const config_t& config);
+
+    /*! Receive samples and queue them for writing
+     *
+     * Blocks until \p num_samps samples per channel were received, until stop()
+     * is called, or until recv() times out. May be called multiple times; the
+     * samples are appended to the same files.
+     *
+     * \param num_samps Number of samples per channel to record, 0 means
+     *                  until stopped
+     * \param timeout Timeout for every recv() call, in seconds
+     * \returns The number of samples per channel received by this call
+     * \throws uhd::io_error on receive errors, or if writing failed
+     */
+    virtual uint64_t record(const uint64_t num_samps = 0, const double timeout = 3.0) = 0;
+
+    /*! Make a running record() call return
+     *
+     * Any later record() call returns immediately. This may be called from any
+     * thread.
+     */
+    virtual void stop(void) = 0;
+
+    /*! Write all pending buffers, and close the files and the index
+     *
+     * Called by the destructor if not called explicitly. No more samples can
+     * be recorded afterwards.
+     *
+     * \throws uhd::io_error if writing failed
+     */
+    virtual void close(void) = 0;
+
+    //! Return the current statistics. May be called from any thread.
+    virtual stats_t get_stats(void) const = 0;
+
+    //! Return the names of all files written for a channel, in stripe order
+    virtual std::vector<std::string> get_filenames(const size_t chan) const = 0;
+};
+
+} // namespace uhd
@@ -16,7 +16,11 @@
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/tokenizer.hpp>
+#include <functional>
 #include <list>
+#include <memory>
+#include <utility>
+#include <vector>
 
 /*! \file soft_register.hpp
  * Utilities to access and index hardware registers.
@@ -294,6 +298,14 @@ public:
         return writable;
     }
 
+    /*!
+     * Was the soft-copy changed since it was last flushed or refreshed?
+     */
+    UHD_INLINE bool is_dirty()
+    {
+        return _soft_copy.is_dirty();
+    }
+
 private:
     wb_iface* _iface;
     const wb_iface::wb_addr_type _wr_addr;
@@ -369,6 +381,12 @@ public:
         return soft_register_t<reg_data_t, readable, writable>::read(field);
     }
 
+    UHD_INLINE bool is_dirty()
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        return soft_register_t<reg_data_t, readable, writable>::is_dirty();
+    }
+
 private:
     boost::mutex _mutex;
 };
@@ -451,6 +469,14 @@ public:
     virtual const std::string& get_name() const                       = 0;
 };
 
+//! Selects how a register map talks to its bus
+enum soft_regmap_mode_t {
+    //! Every register flush or refresh goes straight to the bus
+    DIRECT_REGMAP,
+    //! Writes are compared against a shadow of the hardware and coalesced
+    SHADOWED_REGMAP
+};
+
 /*!
  * A regmap is a collection of registers that share the same
  * bus (control iface). A regmap must have an identifier.
@@ -460,11 +486,40 @@ public:
  * Soft register object that holds offset, soft-copy and the control iface.
  * Methods give convenient field-level access to soft-copy and the ability
  * to do read-modify-write operations.
+ *
+ * In SHADOWED_REGMAP mode, the registers are bound to a host-side shadow of
+ * the bus instead of the bus itself. The shadow remembers the last value
+ * written to every address. Field updates are grouped by setting any number of
+ * fields, followed by a single flush() of the map: all registers are flushed
+ * into the shadow, writes to the same address are coalesced, and only the
+ * words that differ from what the hardware already holds are written to the
+ * bus, back-to-back under one lock. Flushing an individual register writes
+ * through immediately, but is also skipped if the value didn't change. Reads
+ * always go to the bus, after any pending writes were issued. Registers added
+ * with add_cacheable_to_map() are not read back by refresh() once their
+ * soft-copy is known to match the hardware. get_stats() reports how many bus accesses
+ * were saved.
  */
 class UHD_API soft_regmap_t : public soft_regmap_accessor_t, public uhd::noncopyable
 {
 public:
-    soft_regmap_t(const std::string& name) : _name(name) {}
+    //! Bus access statistics of a shadowed register map
+    struct stats_t
+    {
+        //! Number of register writes flushed into the shadow
+        size_t writes_requested = 0;
+        //! Number of writes that were issued on the bus
+        size_t writes_issued = 0;
+        //! Number of writes saved because the value didn't change or was coalesced
+        size_t writes_skipped = 0;
+        //! Number of register reads saved by refresh() on cacheable registers
+        size_t reads_skipped = 0;
+    };
+
+    soft_regmap_t(const std::string& name, const soft_regmap_mode_t mode = DIRECT_REGMAP)
+        : _name(name), _mode(mode)
+    {
+    }
     virtual ~soft_regmap_t(){};
 
     /*!
@@ -480,13 +535,24 @@ public:
      * Optionally synchronize the register with hardware.
      * The order of initialization is the same as the order in
      * which registers were added to the map.
+     * In shadowed mode, this also resets the shadow, so the next flush writes
+     * every register.
      */
     void initialize(wb_iface& iface, bool sync = false)
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
-        for (soft_register_base* reg : _reglist) {
-            reg->initialize(iface, sync);
+        if (_mode == SHADOWED_REGMAP) {
+            _shadow.reset(new shadow_iface_t(iface));
+            _reads_skipped = 0;
         }
+        wb_iface& reg_iface = _shadow ? *_shadow : iface;
+        _run_batched([&]() {
+            for (reg_entry_t& entry : _reglist) {
+                entry.synced = false;
+                entry.reg->initialize(reg_iface, sync);
+                entry.synced = sync;
+            }
+        });
     }
 
     /*!
@@ -497,24 +563,50 @@ public:
     void flush()
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
-        for (soft_register_base* reg : _reglist) {
-            reg->flush();
-        }
+        _run_batched([&]() {
+            for (reg_entry_t& entry : _reglist) {
+                entry.reg->flush();
+                entry.synced = true;
+            }
+        });
     }
 
     /*!
      * Refresh all register soft-copies from hardware.
      * The order of reading is the same as the order in
      * which registers were added to the map.
+     * In shadowed mode, cacheable registers are only read if they were not
+     * flushed or refreshed through this map before, or if their soft-copy was
+     * changed since.
      */
     void refresh()
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
-        for (soft_register_base* reg : _reglist) {
-            reg->refresh();
+        for (reg_entry_t& entry : _reglist) {
+            if (_shadow && entry.is_dirty && entry.synced && !entry.is_dirty()) {
+                _reads_skipped++;
+                continue;
+            }
+            entry.reg->refresh();
+            entry.synced = true;
         }
     }
 
+    /*!
+     * Return the bus access statistics. These are only tracked in
+     * shadowed mode, and are reset by initialize().
+     */
+    stats_t get_stats()
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        stats_t stats;
+        if (_shadow) {
+            _shadow->get_stats(stats);
+        }
+        stats.reads_skipped = _reads_skipped;
+        return stats;
+    }
+
     /*!
      * Lookup a register object by name.
      * If a register with "name" is not found, runtime_error is thrown
@@ -554,6 +646,153 @@ protected:
     UHD_INLINE void add_to_map(soft_register_base& reg,
         const std::string& name,
         const visibility_t visible = PRIVATE)
+    {
+        _add_to_map(reg, name, visible, nullptr);
+    }
+
+    /*!
+     * Add a cacheable register to this map with an identifier "name" and
+     * visibility. A register is cacheable if its hardware value only changes
+     * when it is written through this map (e.g., a configuration register, but
+     * not a status register). This only makes a difference in shadowed mode.
+     */
+    template <typename reg_t>
+    UHD_INLINE void add_cacheable_to_map(
+        reg_t& reg, const std::string& name, const visibility_t visible = PRIVATE)
+    {
+        _add_to_map(reg, name, visible, [&reg]() { return reg.is_dirty(); });
+    }
+
+private:
+    /*!
+     * Bus wrapper that the registers of a shadowed map are bound to.
+     * Outside of a batch, writes go through immediately unless they don't
+     * change the hardware value. Within a batch, they are queued until
+     * commit().
+     */
+    class shadow_iface_t : public wb_iface
+    {
+    public:
+        explicit shadow_iface_t(wb_iface& iface) : _iface(iface) {}
+
+        void poke32(const wb_addr_type addr, const uint32_t data)
+        {
+            _poke(addr, {data, false});
+        }
+
+        void poke64(const wb_addr_type addr, const uint64_t data)
+        {
+            _poke(addr, {data, true});
+        }
+
+        uint32_t peek32(const wb_addr_type addr)
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _commit();
+            return _iface.peek32(addr);
+        }
+
+        uint64_t peek64(const wb_addr_type addr)
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _commit();
+            return _iface.peek64(addr);
+        }
+
+        void begin_batch()
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _batch = true;
+        }
+
+        void commit()
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _batch = false;
+            _commit();
+        }
+
+        void get_stats(stats_t& stats)
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            stats.writes_requested = _writes_requested;
+            stats.writes_issued    = _writes_issued;
+            stats.writes_skipped   = _writes_requested - _writes_issued;
+        }
+
+    private:
+        struct word_t
+        {
+            uint64_t value;
+            bool is64;
+
+            bool operator==(const word_t& rhs) const
+            {
+                return value == rhs.value && is64 == rhs.is64;
+            }
+        };
+
+        void _poke(const wb_addr_type addr, const word_t& word)
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _writes_requested++;
+            // Later writes to the same address replace earlier ones, but keep
+            // their position in the queue
+            auto index = _pending_index.find(addr);
+            if (index != _pending_index.end()) {
+                _pending[index->second].second = word;
+            } else {
+                _pending_index[addr] = _pending.size();
+                _pending.emplace_back(addr, word);
+            }
+            if (not _batch) {
+                _commit();
+            }
+        }
+
+        void _commit()
+        {
+            std::vector<std::pair<wb_addr_type, word_t>> pending;
+            pending.swap(_pending);
+            _pending_index.clear();
+            for (const auto& write : pending) {
+                auto hw_word = _hw.find(write.first);
+                if (hw_word != _hw.end() && hw_word->second == write.second) {
+                    continue;
+                }
+                if (write.second.is64) {
+                    _iface.poke64(write.first, write.second.value);
+                } else {
+                    _iface.poke32(write.first, static_cast<uint32_t>(write.second.value));
+                }
+                _hw[write.first] = write.second;
+                _writes_issued++;
+            }
+        }
+
+        wb_iface& _iface;
+        boost::mutex _mutex;
+        bool _batch = false;
+        std::vector<std::pair<wb_addr_type, word_t>> _pending;
+        std::unordered_map<wb_addr_type, size_t> _pending_index;
+        std::unordered_map<wb_addr_type, word_t> _hw;
+        size_t _writes_requested = 0;
+        size_t _writes_issued    = 0;
+    };
+
+    struct reg_entry_t
+    {
+        soft_register_base* reg;
+        //! Reports if the soft-copy changed, only set for cacheable registers
+        std::function<bool()> is_dirty;
+        //! True if the soft-copy is known to match the hardware
+        bool synced;
+    };
+
+    void _add_to_map(soft_register_base& reg,
+        const std::string& name,
+        const visibility_t visible,
+        std::function<bool()> is_dirty)
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
         if (visible == PUBLIC) {
@@ -563,16 +802,40 @@ protected:
                     "cannot add two registers with the same name to regmap: " + name);
             }
         }
-        _reglist.push_back(&reg);
+        _reglist.push_back({&reg, std::move(is_dirty), false});
+    }
+
+    /*!
+     * Run func with the shadow (if any) in batch mode, and issue the writes it
+     * queued. Queued writes are also issued if func throws, because the
+     * registers they came from were already marked clean.
+     */
+    template <typename func_t>
+    void _run_batched(func_t&& func)
+    {
+        if (not _shadow) {
+            func();
+            return;
+        }
+        _shadow->begin_batch();
+        try {
+            func();
+        } catch (...) {
+            _shadow->commit();
+            throw;
+        }
+        _shadow->commit();
     }
 
-private:
     typedef std::unordered_map<std::string, soft_register_base*> regmap_t;
-    typedef std::list<soft_register_base*> reglist_t;
+    typedef std::list<reg_entry_t> reglist_t;
 
     const std::string _name;
+    const soft_regmap_mode_t _mode;
     regmap_t _regmap; // For lookups
     reglist_t _reglist; // To maintain order
+    std::unique_ptr<shadow_iface_t> _shadow;
+    size_t _reads_skipped = 0;
     boost::mutex _mutex;
 };
 
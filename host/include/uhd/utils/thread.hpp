@@ -8,9 +8,11 @@
 #pragma once
 
 #include <uhd/config.hpp>
+#include <uhd/utils/noncopyable.hpp>
 #include <boost/thread/thread.hpp>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace uhd {
 
@@ -63,4 +65,72 @@ UHD_API void set_thread_name(std::thread* thread, const std::string& name);
  */
 UHD_API void set_thread_affinity(const std::vector<size_t>& cpu_affinity_list);
 
+/*!
+ * Return the CPUs the current thread may run on.
+ * \return list of CPU numbers, or an empty list if the platform doesn't tell
+ */
+UHD_API std::vector<size_t> get_thread_affinity();
+
+/*!
+ * Parse a list of CPUs in the format used by Linux, e.g. "0-3,8,10-11".
+ * \param cpu_list comma separated list of CPU numbers and ranges
+ * \return sorted list of CPU numbers, without duplicates
+ * \throw uhd::value_error if the list is malformed
+ */
+UHD_API std::vector<size_t> parse_cpu_list(const std::string& cpu_list);
+
+/*!
+ * Return the CPUs that belong to a NUMA node.
+ *
+ * Together with set_thread_affinity(), this lets an application run the
+ * threads that call recv() or send() on the same socket as the network
+ * interface of a device.
+ *
+ * \param numa_node the number of the NUMA node
+ * \return list of CPU numbers, or an empty list if the node doesn't exist or
+ *         the platform doesn't tell
+ */
+UHD_API std::vector<size_t> get_numa_node_cpus(size_t numa_node);
+
+/*!
+ * Set the CPUs that threads created by UHD run on by default.
+ *
+ * This applies to threads created afterwards, such as the threads of
+ * uhd::task, or offload I/O threads that have no CPU assigned through
+ * stream args. It is initialized from the UHD_THREAD_AFFINITY environment
+ * variable, which is also the only way to place the logging threads, as they
+ * are started before any other call into UHD. An empty list means that
+ * threads may run on any CPU.
+ *
+ * \param cpu_affinity_list list of CPU numbers
+ */
+UHD_API void set_default_thread_affinity(const std::vector<size_t>& cpu_affinity_list);
+
+/*!
+ * Return the CPUs that threads created by UHD from the current thread run on.
+ *
+ * This is the list of the innermost thread_affinity_scope of the current
+ * thread if there is one, or the list set by set_default_thread_affinity()
+ * otherwise.
+ */
+UHD_API std::vector<size_t> get_default_thread_affinity();
+
+/*!
+ * Override the default thread affinity for the current thread.
+ *
+ * While an instance exists, threads created by UHD from the current thread
+ * run on the given CPUs. uhd::device::make() uses this to place the threads
+ * of a device according to its "cpu_affinity" or "numa_node" arguments.
+ */
+class UHD_API thread_affinity_scope : uhd::noncopyable
+{
+public:
+    thread_affinity_scope(const std::vector<size_t>& cpu_affinity_list);
+    ~thread_affinity_scope();
+
+private:
+    const bool _prev_active;
+    const std::vector<size_t> _prev_cpus;
+};
+
 } // namespace uhd
@@ -0,0 +1,133 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uhd {
+
+/*! Transmit waveforms from files through a TX streamer
+ *
+ * The files are memory-mapped, and send() is called with pointers right into
+ * the mapping, so samples go from the page cache to the converter without an
+ * intermediate copy, and without loading the whole waveform into memory. A
+ * helper thread faults in the pages ahead of the send cursor (up to
+ * config_t::prefetch_size bytes per file), so the thread calling play()
+ * doesn't stall on disk reads. For files that are larger than twice the
+ * prefetch size, pages behind the cursor are released again, which keeps the
+ * resident size bounded for multi-gigabyte waveforms.
+ *
+ * Every call to play() sends one burst: the first packet carries the start of
+ * burst flag and the start time, if one was set, and the last one carries the
+ * end of burst flag. When looping, the end of the file is followed by its
+ * beginning within the same burst, so there is no gap.
+ *
+ * On platforms without mmap(), the files are read into memory instead.
+ */
+class UHD_API tx_file_source : uhd::noncopyable
+{
+public:
+    typedef std::shared_ptr<tx_file_source> sptr;
+
+    //! Source configuration
+    struct config_t
+    {
+        //! Files to send, one per channel of the streamer. A single file is sent
+        // on all channels.
+        std::vector<std::string> filenames;
+        //! The CPU format of the streamer (determines the sample size)
+        std::string cpu_format = "sc16";
+        //! Number of samples per send() call. If zero, the maximum number of
+        // samples per packet of the streamer is used.
+        size_t samps_per_send = 0;
+        //! Number of bytes per file to read ahead of the send cursor
+        size_t prefetch_size = 64 * 1024 * 1024;
+        //! Continue at the beginning of the files when reaching their end
+        bool loop = false;
+    };
+
+    //! Throughput and prefetch statistics
+    struct stats_t
+    {
+        //! Number of samples sent, per channel
+        uint64_t num_samps = 0;
+        //! Number of times playback continued at the beginning of the files
+        uint64_t num_loops = 0;
+        //! Number of bytes read ahead by the prefetch thread, over all files
+        uint64_t bytes_prefetched = 0;
+        //! Number of send() calls that were passed samples which were not
+        // prefetched yet. If this grows, storage can't keep up.
+        uint64_t num_prefetch_misses = 0;
+    };
+
+    virtual ~tx_file_source(void) = 0;
+
+    /*! Create a source, map its files, and start prefetching
+     *
+     * \param tx_stream The streamer to send to
+     * \param config The source configuration
+     * \throws uhd::io_error if a file can't be opened or mapped
+     * \throws uhd::value_error if the configuration is invalid, or if the files
+     *         don't have the same number of samples
+     */
+    static sptr make(tx_streamer::sptr tx_stream, const config_t& config);
+
+    /*! Set the time at which the next burst starts
+     *
+     * Applies to the next call to play() only. Without a start time, a burst
+     * is sent as soon as possible.
+     */
+    virtual void set_start_time(const time_spec_t& time) = 0;
+
+    /*! Send one burst of samples
+     *
+     * Blocks until \p num_samps samples per channel were sent, until the end
+     * of the files is reached (unless looping), until stop() is called, or
+     * until send() times out. Playback continues where the previous call left
+     * off.
+     *
+     * \param num_samps Number of samples per channel to send, 0 means until the
+     *                  end of the files, or until stopped when looping
+     * \param timeout Timeout for every send() call, in seconds. For a burst
+     *                with a start time, the first call also waits until the
+     *                device can buffer the samples.
+     * \returns The number of samples per channel sent by this call
+     */
+    virtual uint64_t play(const uint64_t num_samps = 0, const double timeout = 1.0) = 0;
+
+    /*! Make a running play() call end its burst and return
+     *
+     * Any later play() call returns immediately. This may be called from any
+     * thread.
+     */
+    virtual void stop(void) = 0;
+
+    /*! Move the send cursor
+     *
+     * Must not be called while play() is running.
+     *
+     * \param samp The sample of the files to send next
+     * \throws uhd::index_error if samp is beyond the end of the files
+     */
+    virtual void seek(const uint64_t samp) = 0;
+
+    //! Return the number of samples in each file
+    virtual uint64_t get_num_samps(void) const = 0;
+
+    //! Return the current statistics. May be called from any thread.
+    virtual stats_t get_stats(void) const = 0;
+};
+
+} // namespace uhd
@@ -0,0 +1,323 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "convert_pack_sc12.hpp"
+#include <immintrin.h>
+
+/*
+ * AVX2 version of the 12-bit packer
+ *
+ * The shuffle orderings are identical to those of the SSSE3 packer (see
+ * ssse3_pack_sc12.cpp), but every 128-bit lane of a 256-bit register works on
+ * its own group of 4 samples, so 8 samples (2 x item32_sc12_3x) are packed per
+ * iteration. After packing, each lane holds three valid lines and one unused
+ * word:
+ *
+ *  ---------------------------------------
+ * | -- | B2 | B1 | B0 | -- | A2 | A1 | A0 |  Packed lanes
+ *  ---------------------------------------
+ * | -- | -- | B2 | B1 | B0 | A2 | A1 | A0 |  Permuted, 24 bytes are stored
+ *  ---------------------------------------
+ * | 255                                 0 |
+ *
+ * The store is masked, so unlike the SSSE3 version, no bytes beyond the end
+ * of the packed samples are ever written.
+ */
+#define SC12_SHIFT_MASK 0xfff0fff0, 0xfff0fff0, 0x0fff0fff, 0x0fff0fff
+#define SC12_PACK_SHUFFLE1 13, 12, 9, 8, 5, 4, 1, 0, 15, 14, 11, 10, 7, 6, 3, 2
+#define SC12_PACK_SHUFFLE2 9, 8, 0, 11, 10, 2, 13, 12, 4, 15, 14, 6, 0, 0, 0, 0
+#define SC12_PACK_SHUFFLE3 8, 1, 8, 8, 3, 8, 8, 5, 8, 8, 7, 8, 8, 8, 8, 8
+#define SC12_BYTESWAP 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+
+#define BROADCAST_EPI8(x) _mm256_broadcastsi128_si256(_mm_set_epi8(x))
+#define BROADCAST_EPI32(x) _mm256_broadcastsi128_si256(_mm_set_epi32(x))
+
+/*
+ * Pack two lanes of 4 scaled float samples each. m1 holds samples 0 and 1,
+ * m2 holds samples 2 and 3 of the respective lane.
+ */
+static inline __m256i pack_sc12_lanes(__m256 m1, __m256 m2)
+{
+    __m256 m0;
+    m0 = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 0, 2, 0));
+    m1 = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(3, 1, 3, 1));
+
+    __m256i m3, m4, m5, m6, m7;
+    m3 = BROADCAST_EPI32(SC12_SHIFT_MASK);
+    m4 = BROADCAST_EPI8(SC12_PACK_SHUFFLE2);
+    m5 = BROADCAST_EPI8(SC12_PACK_SHUFFLE3);
+
+    m6 = _mm256_cvtps_epi32(m0);
+    m7 = _mm256_cvtps_epi32(m1);
+    m6 = _mm256_slli_epi32(m6, 4);
+    m6 = _mm256_packs_epi32(m7, m6);
+    m6 = _mm256_and_si256(m6, m3);
+    m7 = _mm256_blend_epi32(_mm256_setzero_si256(), m6, 0x33);
+
+    m6 = _mm256_shuffle_epi8(m6, m4);
+    m7 = _mm256_shuffle_epi8(m7, m5);
+    m6 = _mm256_or_si256(m6, m7);
+
+    return _mm256_shuffle_epi32(m6, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template <bool swap>
+static inline void store_sc12_lanes(__m256i m0, item32_sc12_3x* output)
+{
+    if (swap) {
+        m0 = _mm256_shuffle_epi8(m0, BROADCAST_EPI8(SC12_BYTESWAP));
+    }
+    m0 = _mm256_permutevar8x32_epi32(m0, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_maskstore_epi32(reinterpret_cast<int*>(output),
+        _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0),
+        m0);
+}
+
+template <typename type, bool swap>
+inline void convert_star_8_to_sc12_item32_6(const std::complex<type>* in,
+    item32_sc12_3x* output,
+    const double scalar,
+    typename std::enable_if<std::is_same<type, float>::value>::type* = NULL)
+{
+    const __m256 m0 = _mm256_set1_ps(float(scalar));
+    __m256 m1       = _mm256_loadu_ps(reinterpret_cast<const float*>(&in[0]));
+    __m256 m2       = _mm256_loadu_ps(reinterpret_cast<const float*>(&in[4]));
+    m1              = _mm256_mul_ps(m1, m0);
+    m2              = _mm256_mul_ps(m2, m0);
+
+    // Samples 0-1 and 4-5 into m3, samples 2-3 and 6-7 into m4
+    const __m256 m3 = _mm256_permute2f128_ps(m1, m2, 0x20);
+    const __m256 m4 = _mm256_permute2f128_ps(m1, m2, 0x31);
+
+    store_sc12_lanes<swap>(pack_sc12_lanes(m3, m4), output);
+}
+
+template <typename type, bool swap>
+inline void convert_star_8_to_sc12_item32_6(const std::complex<type>* in,
+    item32_sc12_3x* output,
+    const double scalar,
+    typename std::enable_if<std::is_same<type, double>::value>::type* = NULL)
+{
+    const __m256d m0 = _mm256_set1_pd(scalar);
+    const __m128 f0 =
+        _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd((const double*)&in[0]), m0));
+    const __m128 f1 =
+        _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd((const double*)&in[2]), m0));
+    const __m128 f2 =
+        _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd((const double*)&in[4]), m0));
+    const __m128 f3 =
+        _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd((const double*)&in[6]), m0));
+
+    const __m256 m1 = _mm256_insertf128_ps(_mm256_castps128_ps256(f0), f2, 1);
+    const __m256 m2 = _mm256_insertf128_ps(_mm256_castps128_ps256(f1), f3, 1);
+
+    store_sc12_lanes<swap>(pack_sc12_lanes(m1, m2), output);
+}
+
+template <typename type, bool swap>
+inline void convert_star_8_to_sc12_item32_6(const std::complex<type>* in,
+    item32_sc12_3x* output,
+    const double,
+    typename std::enable_if<std::is_same<type, short>::value>::type* = NULL)
+{
+    __m256i m0, m1, m2, m3, m4, m5;
+    m0 = BROADCAST_EPI32(SC12_SHIFT_MASK);
+    m1 = BROADCAST_EPI8(SC12_PACK_SHUFFLE1);
+    m2 = BROADCAST_EPI8(SC12_PACK_SHUFFLE2);
+    m3 = BROADCAST_EPI8(SC12_PACK_SHUFFLE3);
+
+    m4 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    m4 = _mm256_shuffle_epi8(m4, m1);
+    m5 = _mm256_srli_epi16(m4, 4);
+    m4 = _mm256_shuffle_epi32(m4, _MM_SHUFFLE(0, 0, 3, 2));
+    m4 = _mm256_unpacklo_epi64(m5, m4);
+
+    m4 = _mm256_and_si256(m4, m0);
+    m5 = _mm256_blend_epi32(_mm256_setzero_si256(), m4, 0x33);
+    m4 = _mm256_shuffle_epi8(m4, m2);
+    m5 = _mm256_shuffle_epi8(m5, m3);
+    m3 = _mm256_or_si256(m4, m5);
+
+    m3 = _mm256_shuffle_epi32(m3, _MM_SHUFFLE(0, 1, 2, 3));
+    store_sc12_lanes<swap>(m3, output);
+}
+
+template <typename type, towire32_type towire, bool swap>
+struct convert_star_1_to_sc12_item32_3 : public converter
+{
+    convert_star_1_to_sc12_item32_3(void) : _scalar(0.0) {}
+
+    void set_scalar(const double scalar)
+    {
+        _scalar = scalar;
+    }
+
+    void operator()(
+        const input_type& inputs, const output_type& outputs, const size_t nsamps)
+    {
+        const std::complex<type>* input =
+            reinterpret_cast<const std::complex<type>*>(inputs[0]);
+
+        const size_t head_samps = size_t(outputs[0]) & 0x3;
+        int enable;
+        size_t rewind = 0;
+        switch (head_samps) {
+            case 0:
+                break;
+            case 1:
+                rewind = 9;
+                break;
+            case 2:
+                rewind = 6;
+                break;
+            case 3:
+                rewind = 3;
+                break;
+        }
+        item32_sc12_3x* output =
+            reinterpret_cast<item32_sc12_3x*>(size_t(outputs[0]) - rewind);
+
+        // helper variables
+        size_t i = 0, o = 0;
+
+        // handle the head case
+        switch (head_samps) {
+            case 0:
+                break; // no head
+            case 1:
+                enable = CONVERT12_LINE2;
+                convert_star_4_to_sc12_item32_3<type, towire>(
+                    0, 0, 0, input[0], enable, output[o++], _scalar);
+                break;
+            case 2:
+                enable = CONVERT12_LINE2 | CONVERT12_LINE1;
+                convert_star_4_to_sc12_item32_3<type, towire>(
+                    0, 0, input[0], input[1], enable, output[o++], _scalar);
+                break;
+            case 3:
+                enable = CONVERT12_LINE2 | CONVERT12_LINE1 | CONVERT12_LINE0;
+                convert_star_4_to_sc12_item32_3<type, towire>(
+                    0, input[0], input[1], input[2], enable, output[o++], _scalar);
+                break;
+        }
+        i += head_samps;
+
+        // convert the body, 8 samples at a time
+        while (i + 8 <= nsamps) {
+            convert_star_8_to_sc12_item32_6<type, swap>(&input[i], &output[o], _scalar);
+            o += 2;
+            i += 8;
+        }
+
+        // at most one full group of 4 samples is left
+        if (i + 4 <= nsamps) {
+            convert_star_4_to_sc12_item32_3<type, towire>(input[i + 0],
+                input[i + 1],
+                input[i + 2],
+                input[i + 3],
+                CONVERT12_LINE_ALL,
+                output[o++],
+                _scalar);
+            i += 4;
+        }
+
+        // handle the tail case
+        const size_t tail_samps = nsamps - i;
+        switch (tail_samps) {
+            case 0:
+                break; // no tail
+            case 1:
+                enable = CONVERT12_LINE0;
+                convert_star_4_to_sc12_item32_3<type, towire>(
+                    input[i + 0], 0, 0, 0, enable, output[o], _scalar);
+                break;
+            case 2:
+                enable = CONVERT12_LINE0 | CONVERT12_LINE1;
+                convert_star_4_to_sc12_item32_3<type, towire>(
+                    input[i + 0], input[i + 1], 0, 0, enable, output[o], _scalar);
+                break;
+            case 3:
+                enable = CONVERT12_LINE0 | CONVERT12_LINE1 | CONVERT12_LINE2;
+                convert_star_4_to_sc12_item32_3<type, towire>(input[i + 0],
+                    input[i + 1],
+                    input[i + 2],
+                    0,
+                    enable,
+                    output[o],
+                    _scalar);
+                break;
+        }
+    }
+
+    double _scalar;
+};
+
+static converter::sptr make_convert_fc64_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<double, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_fc64_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<double, uhd::ntohx, true>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<float, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<float, uhd::ntohx, true>());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<short, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(
+        new convert_star_1_to_sc12_item32_3<short, uhd::ntohx, true>());
+}
+
+UHD_STATIC_BLOCK(register_avx2_pack_sc12)
+{
+    uhd::convert::id_type id;
+    id.num_inputs  = 1;
+    id.num_outputs = 1;
+
+    id.input_format  = "fc64";
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc12_item32_le_1, PRIORITY_AVX2);
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc12_item32_be_1, PRIORITY_AVX2);
+
+    id.input_format  = "fc32";
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_fc32_1_to_sc12_item32_le_1, PRIORITY_AVX2);
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_fc32_1_to_sc12_item32_be_1, PRIORITY_AVX2);
+
+    id.input_format  = "sc16";
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc16_1_to_sc12_item32_le_1, PRIORITY_AVX2);
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc16_1_to_sc12_item32_be_1, PRIORITY_AVX2);
+}
@@ -0,0 +1,295 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "convert_unpack_sc12.hpp"
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+/*
+ * AVX2 version of the 12-bit unpacker
+ *
+ * The shuffle orderings are identical to those of the SSSE3 unpacker (see
+ * ssse3_unpack_sc12.cpp), but every 128-bit lane of a 256-bit register works
+ * on its own group of 4 samples, so 8 samples (2 x item32_sc12_3x) are
+ * unpacked per iteration. The 24 input bytes are loaded with a masked load
+ * and then spread across the two lanes:
+ *
+ *  ---------------------------------------
+ * | 0  | 0  | B2 | B1 | B0 | A2 | A1 | A0 |  Masked load
+ *  ---------------------------------------
+ * | 0  | B2 | B1 | B0 | 0  | A2 | A1 | A0 |  Permuted
+ *  ---------------------------------------
+ * | 255                                 0 |
+ *
+ * Unlike the SSSE3 version, no bytes beyond the end of the packed samples are
+ * ever read.
+ */
+#define SC12_SHIFT_MASK 0x0fff0fff, 0x0fff0fff, 0xfff0fff0, 0xfff0fff0
+#define SC12_PACK_SHUFFLE1 5, 4, 8, 7, 11, 10, 14, 13, 6, 5, 9, 8, 12, 11, 15, 14
+#define SC12_PACK_SHUFFLE2 15, 14, 7, 6, 13, 12, 5, 4, 11, 10, 3, 2, 9, 8, 1, 0
+#define SC12_BYTESWAP 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+
+#define BROADCAST_EPI8(x) _mm256_broadcastsi128_si256(_mm_set_epi8(x))
+#define BROADCAST_EPI32(x) _mm256_broadcastsi128_si256(_mm_set_epi32(x))
+
+/*
+ * Load two groups of packed samples and deinterleave them into 12-bit
+ * unpacked I/Q (Shuffle-1 of the SSSE3 unpacker), one group per lane.
+ */
+template <bool swap>
+static inline __m256i load_sc12_lanes(const item32_sc12_3x* input)
+{
+    __m256i m0 = _mm256_maskload_epi32(reinterpret_cast<const int*>(input),
+        _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0));
+    m0 = _mm256_permutevar8x32_epi32(m0, _mm256_setr_epi32(0, 1, 2, 7, 3, 4, 5, 7));
+    if (swap) {
+        m0 = _mm256_shuffle_epi8(m0, BROADCAST_EPI8(SC12_BYTESWAP));
+    }
+    m0 = _mm256_shuffle_epi32(m0, _MM_SHUFFLE(0, 1, 2, 3));
+    m0 = _mm256_shuffle_epi8(m0, BROADCAST_EPI8(SC12_PACK_SHUFFLE1));
+    return _mm256_and_si256(m0, BROADCAST_EPI32(SC12_SHIFT_MASK));
+}
+
+/*
+ * Widen the unpacked I/Q of both lanes to interleaved 32-bit integers. m3
+ * receives samples 0 and 1, m4 samples 2 and 3 of the respective lane.
+ */
+static inline void widen_sc12_lanes(const __m256i m0, __m256i& m3, __m256i& m4)
+{
+    __m256i m1, m2;
+    m4 = _mm256_setzero_si256();
+    m1 = _mm256_unpacklo_epi16(m4, m0);
+    m2 = _mm256_unpackhi_epi16(m4, m0);
+    m2 = _mm256_slli_epi32(m2, 4);
+    m3 = _mm256_unpacklo_epi32(m1, m2);
+    m4 = _mm256_unpackhi_epi32(m1, m2);
+}
+
+template <typename type, bool swap>
+inline void convert_sc12_item32_6_to_star_8(const item32_sc12_3x* input,
+    std::complex<type>* out,
+    const double scalar,
+    typename std::enable_if<std::is_same<type, float>::value>::type* = NULL)
+{
+    __m256i m3, m4;
+    widen_sc12_lanes(load_sc12_lanes<swap>(input), m3, m4);
+
+    __m256 m5, m6, m7;
+    m5 = _mm256_set1_ps(float(scalar / (1 << 16)));
+    m6 = _mm256_mul_ps(_mm256_cvtepi32_ps(m3), m5);
+    m7 = _mm256_mul_ps(_mm256_cvtepi32_ps(m4), m5);
+
+    _mm256_storeu_ps(
+        reinterpret_cast<float*>(&out[0]), _mm256_permute2f128_ps(m6, m7, 0x20));
+    _mm256_storeu_ps(
+        reinterpret_cast<float*>(&out[4]), _mm256_permute2f128_ps(m6, m7, 0x31));
+}
+
+template <typename type, bool swap>
+inline void convert_sc12_item32_6_to_star_8(const item32_sc12_3x* input,
+    std::complex<type>* out,
+    const double scalar,
+    typename std::enable_if<std::is_same<type, double>::value>::type* = NULL)
+{
+    __m256i m3, m4;
+    widen_sc12_lanes(load_sc12_lanes<swap>(input), m3, m4);
+
+    const __m256d m5 = _mm256_set1_pd(scalar / (1 << 16));
+    double* output   = reinterpret_cast<double*>(out);
+    _mm256_storeu_pd(output + 0,
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(m3)), m5));
+    _mm256_storeu_pd(output + 4,
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(m4)), m5));
+    _mm256_storeu_pd(output + 8,
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(m3, 1)), m5));
+    _mm256_storeu_pd(output + 12,
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(m4, 1)), m5));
+}
+
+template <typename type, bool swap>
+inline void convert_sc12_item32_6_to_star_8(const item32_sc12_3x* input,
+    std::complex<type>* out,
+    const double,
+    typename std::enable_if<std::is_same<type, short>::value>::type* = NULL)
+{
+    __m256i m0, m1, m3;
+    m3 = load_sc12_lanes<swap>(input);
+
+    m0 = _mm256_slli_epi16(m3, 4);
+    m1 = _mm256_shuffle_epi32(m3, _MM_SHUFFLE(1, 0, 0, 0));
+    m0 = _mm256_unpackhi_epi64(m1, m0);
+    m1 = _mm256_shuffle_epi8(m0, BROADCAST_EPI8(SC12_PACK_SHUFFLE2));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), m1);
+}
+
+template <typename type, tohost32_type tohost, bool swap>
+struct convert_sc12_item32_1_to_star_3 : public converter
+{
+    convert_sc12_item32_1_to_star_3(void) : _scalar(0.0)
+    {
+        // NOP
+    }
+
+    void set_scalar(const double scalar)
+    {
+        const int unpack_growth = 16;
+        _scalar                 = scalar / unpack_growth;
+    }
+
+    void operator()(
+        const input_type& inputs, const output_type& outputs, const size_t nsamps)
+    {
+        const size_t head_samps = size_t(inputs[0]) & 0x3;
+        size_t rewind           = 0;
+        switch (head_samps) {
+            case 0:
+                break;
+            case 1:
+                rewind = 9;
+                break;
+            case 2:
+                rewind = 6;
+                break;
+            case 3:
+                rewind = 3;
+                break;
+        }
+
+        const item32_sc12_3x* input =
+            reinterpret_cast<const item32_sc12_3x*>(size_t(inputs[0]) - rewind);
+        std::complex<type>* output = reinterpret_cast<std::complex<type>*>(outputs[0]);
+        std::complex<type> dummy;
+        size_t i = 0, o = 0;
+        switch (head_samps) {
+            case 0:
+                break; // no head
+            case 1:
+                convert_sc12_item32_3_to_star_4<type, tohost>(
+                    input[i++], dummy, dummy, dummy, output[0], _scalar);
+                break;
+            case 2:
+                convert_sc12_item32_3_to_star_4<type, tohost>(
+                    input[i++], dummy, dummy, output[0], output[1], _scalar);
+                break;
+            case 3:
+                convert_sc12_item32_3_to_star_4<type, tohost>(
+                    input[i++], dummy, output[0], output[1], output[2], _scalar);
+                break;
+        }
+        o += head_samps;
+
+        // convert the body, 8 samples at a time
+        while (o + 8 <= nsamps) {
+            convert_sc12_item32_6_to_star_8<type, swap>(&input[i], &output[o], _scalar);
+            i += 2;
+            o += 8;
+        }
+
+        // at most one full group of 4 samples is left
+        if (o + 4 <= nsamps) {
+            convert_sc12_item32_3_to_star_4<type, tohost>(input[i++],
+                output[o + 0],
+                output[o + 1],
+                output[o + 2],
+                output[o + 3],
+                _scalar);
+            o += 4;
+        }
+
+        const size_t tail_samps = nsamps - o;
+        switch (tail_samps) {
+            case 0:
+                break; // no tail
+            case 1:
+                convert_sc12_item32_3_to_star_4<type, tohost>(
+                    input[i], output[o + 0], dummy, dummy, dummy, _scalar);
+                break;
+            case 2:
+                convert_sc12_item32_3_to_star_4<type, tohost>(
+                    input[i], output[o + 0], output[o + 1], dummy, dummy, _scalar);
+                break;
+            case 3:
+                convert_sc12_item32_3_to_star_4<type, tohost>(input[i],
+                    output[o + 0],
+                    output[o + 1],
+                    output[o + 2],
+                    dummy,
+                    _scalar);
+                break;
+        }
+    }
+
+    double _scalar;
+};
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc64_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<double, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc64_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<double, uhd::ntohx, true>());
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<float, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<float, uhd::ntohx, true>());
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<short, uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1(void)
+{
+    return converter::sptr(
+        new convert_sc12_item32_1_to_star_3<short, uhd::ntohx, true>());
+}
+
+UHD_STATIC_BLOCK(register_avx2_unpack_sc12)
+{
+    uhd::convert::id_type id;
+    id.num_inputs  = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc64";
+    id.input_format  = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_le_1_to_fc64_1, PRIORITY_AVX2);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_be_1_to_fc64_1, PRIORITY_AVX2);
+
+    id.output_format = "fc32";
+    id.input_format  = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_le_1_to_fc32_1, PRIORITY_AVX2);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_be_1_to_fc32_1, PRIORITY_AVX2);
+
+    id.output_format = "sc16";
+    id.input_format  = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_le_1_to_sc16_1, PRIORITY_AVX2);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_be_1_to_sc16_1, PRIORITY_AVX2);
+}
@@ -76,6 +76,8 @@ static const int PRIORITY_TABLE =
 static const int PRIORITY_SIMD  = 3;
 static const int PRIORITY_TABLE = 1;
 #endif
+// AVX2 kernels are a build-time opt-in and supersede the SSE versions
+static const int PRIORITY_AVX2 = PRIORITY_SIMD + 1;
 
 /***********************************************************************
  * Typedefs
@@ -121,6 +121,16 @@ struct convert_star_1_to_sc12_item32_1 : public converter
     double _scalar;
 };
 
+static converter::sptr make_convert_fc64_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<double, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_fc64_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<double, uhd::ntohx>());
+}
+
 static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1(void)
 {
     return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx>());
@@ -149,6 +159,14 @@ UHD_STATIC_BLOCK(register_convert_pack_sc12)
     id.num_inputs  = 1;
     id.num_outputs = 1;
 
+    id.input_format  = "fc64";
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc12_item32_le_1, PRIORITY_GENERAL);
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc12_item32_be_1, PRIORITY_GENERAL);
+
     id.input_format  = "fc32";
     id.output_format = "sc12_item32_le";
     uhd::convert::register_converter(
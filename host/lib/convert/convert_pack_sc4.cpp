@@ -0,0 +1,178 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <algorithm>
+#include <type_traits>
+
+using namespace uhd::convert;
+
+typedef uint32_t (*towire32_type)(uint32_t);
+
+/*
+ * Packed 4-bit converter
+ *
+ * Every complex sample is reduced to a 4-bit I and a 4-bit Q value, and four
+ * samples share one 32-bit line. The first sample occupies the most
+ * significant byte, I is always in the upper nibble:
+ *  _ _ _ _ _ _ _ _
+ * |I|Q|I|Q|I|Q|I|Q|
+ * |_0_|_1_|_2_|_3_|
+ * 31              0
+ *
+ * Like with sc12, the position of the first sample within its line is derived
+ * from the output pointer: Buffers are always 32-bit aligned, and every sample
+ * advances the pointer by one byte.
+ */
+/*
+ * Scale a value and saturate it to the 4-bit range. Out-of-range values would
+ * otherwise wrap around, e.g., full scale (8) would turn into -8.
+ */
+UHD_INLINE item32_t scale_to_sc4(const double value, const double scalar)
+{
+    const double scaled = std::max(-8.0, std::min(7.0, value * scalar));
+    return item32_t(int32_t(scaled)) & 0xf;
+}
+
+template <typename type>
+item32_t convert_star_1_to_sc4_x1(const std::complex<type>& in,
+    const double scalar,
+    typename std::enable_if<std::is_floating_point<type>::value>::type* = NULL)
+{
+    return (scale_to_sc4(in.real(), scalar) << 4)
+           | (scale_to_sc4(in.imag(), scalar) << 0);
+}
+
+template <typename type>
+item32_t convert_star_1_to_sc4_x1(const std::complex<type>& in,
+    const double,
+    typename std::enable_if<std::is_same<type, short>::value>::type* = NULL)
+{
+    return (item32_t((in.real() >> 12) & 0xf) << 4)
+           | (item32_t((in.imag() >> 12) & 0xf) << 0);
+}
+
+template <typename type, towire32_type towire>
+struct convert_star_1_to_sc4_item32_1 : public converter
+{
+    convert_star_1_to_sc4_item32_1(void) : _scalar(0.0)
+    {
+        // NOP
+    }
+
+    void set_scalar(const double scalar)
+    {
+        _scalar = scalar;
+    }
+
+    void operator()(
+        const input_type& inputs, const output_type& outputs, const size_t nsamps)
+    {
+        const std::complex<type>* input =
+            reinterpret_cast<const std::complex<type>*>(inputs[0]);
+
+        const size_t head_pos = size_t(outputs[0]) & 0x3;
+        item32_t* output = reinterpret_cast<item32_t*>(size_t(outputs[0]) - head_pos);
+
+        size_t i = 0;
+
+        // handle the head case: the line is shared with previously packed
+        // samples, which must be preserved
+        if (head_pos != 0) {
+            item32_t line = towire(*output);
+            for (size_t pos = head_pos; pos < 4 && i < nsamps; pos++, i++) {
+                const size_t shift = 24 - 8 * pos;
+                line               = (line & ~(item32_t(0xff) << shift))
+                       | (convert_star_1_to_sc4_x1(input[i], _scalar) << shift);
+            }
+            *output++ = towire(line);
+        }
+
+        // convert the body
+        while (i + 4 <= nsamps) {
+            *output++ = towire((convert_star_1_to_sc4_x1(input[i + 0], _scalar) << 24)
+                               | (convert_star_1_to_sc4_x1(input[i + 1], _scalar) << 16)
+                               | (convert_star_1_to_sc4_x1(input[i + 2], _scalar) << 8)
+                               | (convert_star_1_to_sc4_x1(input[i + 3], _scalar) << 0));
+            i += 4;
+        }
+
+        // handle the tail case
+        if (i < nsamps) {
+            item32_t line = 0;
+            for (size_t shift = 24; i < nsamps; shift -= 8, i++) {
+                line |= convert_star_1_to_sc4_x1(input[i], _scalar) << shift;
+            }
+            *output = towire(line);
+        }
+    }
+
+    double _scalar;
+};
+
+static converter::sptr make_convert_fc64_1_to_sc4_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<double, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_fc64_1_to_sc4_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<double, uhd::ntohx>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc4_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<float, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc4_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<float, uhd::ntohx>());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc4_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<short, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc4_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc4_item32_1<short, uhd::ntohx>());
+}
+
+UHD_STATIC_BLOCK(register_convert_pack_sc4)
+{
+    // uhd::convert::register_bytes_per_item("sc4", 1/*byte*/); //registered in unpack
+
+    uhd::convert::id_type id;
+    id.num_inputs  = 1;
+    id.num_outputs = 1;
+
+    id.input_format  = "fc64";
+    id.output_format = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc4_item32_le_1, PRIORITY_GENERAL);
+    id.output_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_fc64_1_to_sc4_item32_be_1, PRIORITY_GENERAL);
+
+    id.input_format  = "fc32";
+    id.output_format = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_fc32_1_to_sc4_item32_le_1, PRIORITY_GENERAL);
+    id.output_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_fc32_1_to_sc4_item32_be_1, PRIORITY_GENERAL);
+
+    id.input_format  = "sc16";
+    id.output_format = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc16_1_to_sc4_item32_le_1, PRIORITY_GENERAL);
+    id.output_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc16_1_to_sc4_item32_be_1, PRIORITY_GENERAL);
+}
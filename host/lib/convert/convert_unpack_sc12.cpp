@@ -143,6 +143,16 @@ struct convert_sc12_item32_1_to_star_1 : public converter
     double _scalar;
 };
 
+static converter::sptr make_convert_sc12_item32_le_1_to_fc64_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<double, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc64_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<double, uhd::ntohx>());
+}
+
 static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1(void)
 {
     return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx>());
@@ -170,6 +180,14 @@ UHD_STATIC_BLOCK(register_convert_unpack_sc12)
     id.num_inputs  = 1;
     id.num_outputs = 1;
 
+    id.output_format = "fc64";
+    id.input_format  = "sc12_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_le_1_to_fc64_1, PRIORITY_GENERAL);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc12_item32_be_1_to_fc64_1, PRIORITY_GENERAL);
+
     id.output_format = "fc32";
     id.input_format  = "sc12_item32_le";
     uhd::convert::register_converter(
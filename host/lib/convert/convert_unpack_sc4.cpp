@@ -0,0 +1,133 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <type_traits>
+
+using namespace uhd::convert;
+
+typedef uint32_t (*tohost32_type)(uint32_t);
+
+/*
+ * Unpack one byte of a packed 4-bit line (see convert_pack_sc4.cpp for the
+ * layout). The nibbles are sign-extended before scaling.
+ */
+template <typename type>
+std::complex<type> convert_sc4_x1_to_star_1(const item32_t in,
+    const double scalar,
+    typename std::enable_if<std::is_floating_point<type>::value>::type* = NULL)
+{
+    return std::complex<type>(type((int8_t(in & 0xf0) >> 4) * scalar),
+        type((int8_t(in << 4) >> 4) * scalar));
+}
+
+template <typename type>
+std::complex<type> convert_sc4_x1_to_star_1(const item32_t in,
+    const double,
+    typename std::enable_if<std::is_same<type, short>::value>::type* = NULL)
+{
+    return std::complex<type>(type((in & 0xf0) << 8), type((in & 0x0f) << 12));
+}
+
+template <typename type, tohost32_type tohost>
+struct convert_sc4_item32_1_to_star_1 : public converter
+{
+    convert_sc4_item32_1_to_star_1(void) : _scalar(0.0)
+    {
+        // NOP
+    }
+
+    void set_scalar(const double scalar)
+    {
+        _scalar = scalar;
+    }
+
+    void operator()(
+        const input_type& inputs, const output_type& outputs, const size_t nsamps)
+    {
+        // The position of the first sample within its line is derived from the
+        // input pointer, the same way it is done for sc12.
+        size_t pos = size_t(inputs[0]) & 0x3;
+        const item32_t* input =
+            reinterpret_cast<const item32_t*>(size_t(inputs[0]) - pos);
+        std::complex<type>* output = reinterpret_cast<std::complex<type>*>(outputs[0]);
+
+        size_t o = 0;
+        while (o < nsamps) {
+            const item32_t line = tohost(*input++);
+            for (; pos < 4 && o < nsamps; pos++) {
+                output[o++] = convert_sc4_x1_to_star_1<type>(
+                    line >> (24 - 8 * pos), _scalar);
+            }
+            pos = 0;
+        }
+    }
+
+    double _scalar;
+};
+
+static converter::sptr make_convert_sc4_item32_le_1_to_fc64_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<double, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc4_item32_be_1_to_fc64_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<double, uhd::ntohx>());
+}
+
+static converter::sptr make_convert_sc4_item32_le_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<float, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc4_item32_be_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<float, uhd::ntohx>());
+}
+
+static converter::sptr make_convert_sc4_item32_le_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<short, uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc4_item32_be_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc4_item32_1_to_star_1<short, uhd::ntohx>());
+}
+
+UHD_STATIC_BLOCK(register_convert_unpack_sc4)
+{
+    uhd::convert::register_bytes_per_item("sc4", 1 /*byte*/);
+    uhd::convert::id_type id;
+    id.num_inputs  = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc64";
+    id.input_format  = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_le_1_to_fc64_1, PRIORITY_GENERAL);
+    id.input_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_be_1_to_fc64_1, PRIORITY_GENERAL);
+
+    id.output_format = "fc32";
+    id.input_format  = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_le_1_to_fc32_1, PRIORITY_GENERAL);
+    id.input_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_be_1_to_fc32_1, PRIORITY_GENERAL);
+
+    id.output_format = "sc16";
+    id.input_format  = "sc4_item32_le";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_le_1_to_sc16_1, PRIORITY_GENERAL);
+    id.input_format = "sc4_item32_be";
+    uhd::convert::register_converter(
+        id, &make_convert_sc4_item32_be_1_to_sc16_1, PRIORITY_GENERAL);
+}
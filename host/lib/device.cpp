@@ -11,7 +11,9 @@
 #include <uhd/utils/algorithm.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhd/utils/thread.hpp>
 #include <uhdlib/utils/prefs.hpp>
+#include <uhdlib/utils/thread_placement.hpp>
 #include <boost/format.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/thread/mutex.hpp>
@@ -165,7 +167,17 @@ device::sptr device::make(const device_addr_t& hint, device_filter_t filter, siz
         // Add keys from the config files (note: the user-defined keys will
         // always be applied, see also get_usrp_args()
         // Then, create and register a new device.
-        device::sptr dev         = maker(prefs::get_usrp_args(dev_addr));
+        const device_addr_t usrp_args = prefs::get_usrp_args(dev_addr);
+        // Threads the device creates run on the CPUs given in its args
+        std::vector<size_t> cpu_affinity_list = get_default_thread_affinity();
+        if (usrp_args.has_key("cpu_affinity") or usrp_args.has_key("numa_node")) {
+            cpu_affinity_list = read_cpu_placement(usrp_args);
+            UHD_LOG_INFO("UHD",
+                "Placing device threads on CPUs " << format_cpu_list(cpu_affinity_list));
+        }
+        thread_affinity_scope affinity_scope(cpu_affinity_list);
+        device::sptr dev = maker(usrp_args);
+
         hash_to_device[dev_hash] = dev;
         return dev;
     }
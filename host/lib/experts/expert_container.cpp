@@ -15,8 +15,14 @@
 #include <boost/graph/topological_sort.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef UHD_EXPERT_LOGGING
 #    define EX_LOG(depth, str) _log(depth, str)
@@ -44,6 +50,112 @@ typedef std::list<expert_graph_t::vertex_descriptor> node_queue_t;
 typedef boost::graph_traits<expert_graph_t>::edge_iterator edge_iter;
 typedef boost::graph_traits<expert_graph_t>::vertex_iterator vertex_iter;
 
+/*!
+ * A small pool of threads to resolve independent worker nodes concurrently.
+ *
+ * resolve() hands a batch of workers to the pool, takes part in resolving
+ * them, and returns when all of them are resolved. If any worker throws, the
+ * first exception is rethrown once the whole batch is done.
+ */
+class resolver_pool
+{
+public:
+    resolver_pool(const size_t num_threads)
+    {
+        for (size_t i = 0; i < num_threads; i++) {
+            _threads.emplace_back([this]() { _run(); });
+        }
+    }
+
+    ~resolver_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _work_cond.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    void resolve(const std::vector<dag_vertex_t*>& nodes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _nodes   = &nodes;
+            _next    = 0;
+            _pending = nodes.size();
+            _error   = nullptr;
+            _batch++;
+        }
+        _work_cond.notify_all();
+        _process();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done_cond.wait(lock, [this]() { return _pending == 0; });
+        _nodes = nullptr;
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+private:
+    void _run()
+    {
+        size_t last_batch = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _work_cond.wait(
+                    lock, [&]() { return _stop or _batch != last_batch; });
+                if (_stop) {
+                    return;
+                }
+                last_batch = _batch;
+            }
+            _process();
+        }
+    }
+
+    void _process()
+    {
+        while (true) {
+            dag_vertex_t* node = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_nodes == nullptr or _next >= _nodes->size()) {
+                    return;
+                }
+                node = (*_nodes)[_next++];
+            }
+            std::exception_ptr error;
+            try {
+                node->resolve();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (error and not _error) {
+                _error = error;
+            }
+            if (--_pending == 0) {
+                _done_cond.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _work_cond;
+    std::condition_variable _done_cond;
+    const std::vector<dag_vertex_t*>* _nodes = nullptr;
+    size_t _next                             = 0;
+    size_t _pending                          = 0;
+    size_t _batch                            = 0;
+    bool _stop                               = false;
+    std::exception_ptr _error;
+};
+
 class expert_container_impl : public expert_container
 {
 private: // Visitor class for cycle detection algorithm
@@ -65,7 +177,14 @@ private: // Visitor class for cycle detection algorithm
     };
 
 public:
-    expert_container_impl(const std::string& name) : _name(name) {}
+    expert_container_impl(const std::string& name, const size_t num_threads)
+        : _name(name)
+    {
+        // The calling thread takes part in resolving, so it counts as one
+        if (num_threads > 1) {
+            _pool = std::make_unique<resolver_pool>(num_threads - 1);
+        }
+    }
 
     ~expert_container_impl()
     {
@@ -83,27 +202,27 @@ public:
         boost::lock_guard<boost::mutex> lock(_mutex);
         EX_LOG(0, str(boost::format("resolve_all(%s)") % (force ? "force" : "")));
         // Do a full resolve of the graph
-        _resolve_helper("", "", force);
+        _resolve_helper(force);
     }
 
     void resolve_from(const std::string&)
     {
         boost::lock_guard<boost::recursive_mutex> resolve_lock(_resolve_mutex);
         boost::lock_guard<boost::mutex> lock(_mutex);
-        EX_LOG(0, "resolve_from (overridden to resolve_all)");
-        // Do a full resolve of the graph
-        // Not optimizing the traversal using node_name to reduce experts complexity
-        _resolve_helper("", "", false);
+        EX_LOG(0, "resolve_from (resolving all dirty nodes)");
+        // Resolve everything downstream of any dirty node. node_name is dirty
+        // itself if it changed, so there is no need to treat it differently.
+        _resolve_helper(false);
     }
 
     void resolve_to(const std::string&)
     {
         boost::lock_guard<boost::recursive_mutex> resolve_lock(_resolve_mutex);
         boost::lock_guard<boost::mutex> lock(_mutex);
-        EX_LOG(0, "resolve_to (overridden to resolve_all)");
-        // Do a full resolve of the graph
-        // Not optimizing the traversal using node_name to reduce experts complexity
-        _resolve_helper("", "", false);
+        EX_LOG(0, "resolve_to (resolving all dirty nodes)");
+        // Resolve everything downstream of any dirty node. If node_name does not
+        // depend on a dirty node, this returns without resolving anything.
+        _resolve_helper(false);
     }
 
     dag_vertex_t& retrieve(const std::string& name) const
@@ -302,6 +421,7 @@ protected:
 
         try {
             // Add a vertex in this graph for the data node
+            _invalidate_order();
             expert_graph_t::vertex_descriptor gr_node =
                 boost::add_vertex(data_node, _expert_dag);
             EX_LOG(1, str(boost::format("added vertex %s") % data_node->get_name()));
@@ -351,6 +471,7 @@ protected:
 
         try {
             // Add a vertex in this graph for the worker node
+            _invalidate_order();
             expert_graph_t::vertex_descriptor gr_node =
                 boost::add_vertex(worker, _expert_dag);
             EX_LOG(1, str(boost::format("added vertex %s") % worker->get_name()));
@@ -427,11 +548,19 @@ protected:
         // Release all nodes in the map
         _worker_map.clear();
         _datanode_map.clear();
+        _invalidate_order();
     }
 
 private:
-    void _resolve_helper(std::string start, std::string stop, bool force)
+    /*!
+     * Sort the graph, and cache everything the resolver needs to know about its
+     * structure. This only needs to happen again after nodes were added.
+     */
+    void _update_order()
     {
+        if (_order_valid) {
+            return;
+        }
         // Sort the graph topologically. This ensures that for all dependencies, the
         // dependant is always after all of its dependencies.
         node_queue_t sorted_nodes;
@@ -452,60 +581,156 @@ private:
                     + edges);
             }
         }
-        if (sorted_nodes.empty())
+
+        // The level of a node is the length of the longest path that leads to
+        // it. Nodes on the same level never depend on each other, so sorting
+        // by level keeps the order topological, and groups the nodes that can
+        // be resolved concurrently.
+        const size_t num_vertices = boost::num_vertices(_expert_dag);
+        std::vector<size_t> levels(num_vertices, 0);
+        _successors.assign(num_vertices, std::vector<size_t>());
+        _data_vertices.clear();
+        for (const expert_graph_t::vertex_descriptor vertex : sorted_nodes) {
+            for (auto ei = boost::out_edges(vertex, _expert_dag); ei.first != ei.second;
+                 ++ei.first) {
+                const size_t target = boost::target(*ei.first, _expert_dag);
+                levels[target]      = std::max(levels[target], levels[vertex] + 1);
+                _successors[vertex].push_back(target);
+            }
+            if (_get_vertex(vertex).get_class() != CLASS_WORKER) {
+                _data_vertices.push_back(vertex);
+            }
+        }
+        _order.assign(sorted_nodes.begin(), sorted_nodes.end());
+        std::stable_sort(_order.begin(), _order.end(), [&](size_t lhs, size_t rhs) {
+            return levels[lhs] < levels[rhs];
+        });
+        _order_pos.assign(num_vertices, 0);
+        _levels.assign(num_vertices, 0);
+        for (size_t pos = 0; pos < _order.size(); pos++) {
+            _order_pos[_order[pos]] = pos;
+            _levels[pos]            = levels[_order[pos]];
+        }
+        _visit_marks.assign(num_vertices, 0);
+        _visit_epoch = 0;
+        _order_valid = true;
+    }
+
+    void _invalidate_order()
+    {
+        _order_valid = false;
+    }
+
+    /*!
+     * Collect the positions (in the cached order) of all nodes that may need
+     * to be resolved, in ascending order. Unless all nodes are forced, these
+     * are the dirty data nodes and everything downstream of them. A worker
+     * outside of this set can't be dirty, because none of its inputs are.
+     */
+    void _find_affected(const bool force)
+    {
+        _affected.clear();
+        if (force) {
+            for (size_t pos = 0; pos < _order.size(); pos++) {
+                _affected.push_back(pos);
+            }
+            return;
+        }
+        if (++_visit_epoch == 0) {
+            std::fill(_visit_marks.begin(), _visit_marks.end(), 0);
+            _visit_epoch = 1;
+        }
+        for (const size_t vertex : _data_vertices) {
+            if (_get_vertex(vertex).is_dirty()) {
+                _visit_marks[vertex] = _visit_epoch;
+                _affected.push_back(vertex);
+            }
+        }
+        for (size_t i = 0; i < _affected.size(); i++) {
+            for (const size_t successor : _successors[_affected[i]]) {
+                if (_visit_marks[successor] != _visit_epoch) {
+                    _visit_marks[successor] = _visit_epoch;
+                    _affected.push_back(successor);
+                }
+            }
+        }
+        for (size_t& vertex : _affected) {
+            vertex = _order_pos[vertex];
+        }
+        std::sort(_affected.begin(), _affected.end());
+    }
+
+    void _resolve_node(dag_vertex_t& node, const bool force)
+    {
+        if (force or node.is_dirty()) {
+            node.resolve();
+            if (node.get_class() == CLASS_WORKER) {
+                _resolved_workers.push_back(&node);
+            }
+            EX_LOG(1,
+                str(boost::format("resolved node %s (%s) [%s]") % node.get_name()
+                    % (node.is_dirty() ? "dirty" : "clean") % node.to_string()));
+        } else {
+            EX_LOG(1,
+                str(boost::format("skipped node %s (%s) [%s]") % node.get_name()
+                    % (node.is_dirty() ? "dirty" : "clean") % node.to_string()));
+        }
+    }
+
+    void _resolve_helper(bool force)
+    {
+        _update_order();
+        _find_affected(force);
+        if (_affected.empty()) {
             return;
+        }
 
-        // Determine the start and stop node. If one is not explicitly specified then
-        // resolve everything
-        expert_graph_t::vertex_descriptor start_vertex = sorted_nodes.front();
-        expert_graph_t::vertex_descriptor stop_vertex  = sorted_nodes.back();
-        if (not start.empty())
-            start_vertex = _lookup_vertex(start);
-        if (not stop.empty())
-            stop_vertex = _lookup_vertex(stop);
-
-        // First Pass: Resolve all nodes if they are dirty, in a topological order
-        std::list<dag_vertex_t*> resolved_workers;
-        bool start_node_encountered = false;
-        for (node_queue_t::iterator node_iter = sorted_nodes.begin();
-             node_iter != sorted_nodes.end();
-             ++node_iter) {
-            // Determine if we are at or beyond the starting node
-            if (*node_iter == start_vertex)
-                start_node_encountered = true;
-
-            // Only resolve if the starting node has passed
-            if (start_node_encountered) {
-                dag_vertex_t& node = _get_vertex(*node_iter);
-                std::string node_val;
-                if (force or node.is_dirty()) {
-                    node.resolve();
-                    if (node.get_class() == CLASS_WORKER) {
-                        resolved_workers.push_back(&node);
+        // First Pass: Resolve all affected nodes if they are dirty, in a
+        // topological order. With a thread pool, the dirty workers of a level
+        // are resolved concurrently, and the next level starts once they are
+        // all done.
+        _resolved_workers.clear();
+        if (not _pool) {
+            for (const size_t pos : _affected) {
+                _resolve_node(_get_vertex(_order[pos]), force);
+            }
+        } else {
+            auto level_begin = _affected.begin();
+            while (level_begin != _affected.end()) {
+                const size_t level = _levels[*level_begin];
+                auto level_end     = std::find_if(level_begin,
+                    _affected.end(),
+                    [&](size_t pos) { return _levels[pos] != level; });
+                _level_workers.clear();
+                for (auto it = level_begin; it != level_end; ++it) {
+                    dag_vertex_t& node = _get_vertex(_order[*it]);
+                    if (node.get_class() == CLASS_WORKER and (force or node.is_dirty())) {
+                        _level_workers.push_back(&node);
+                    } else {
+                        _resolve_node(node, force);
                     }
+                }
+                if (_level_workers.size() == 1) {
+                    _resolve_node(*_level_workers.front(), true);
+                } else if (not _level_workers.empty()) {
+                    _pool->resolve(_level_workers);
+                    _resolved_workers.insert(_resolved_workers.end(),
+                        _level_workers.begin(),
+                        _level_workers.end());
                     EX_LOG(1,
-                        str(boost::format("resolved node %s (%s) [%s]") % node.get_name()
-                            % (node.is_dirty() ? "dirty" : "clean") % node.to_string()));
-                } else {
-                    EX_LOG(1,
-                        str(boost::format("skipped node %s (%s) [%s]") % node.get_name()
-                            % (node.is_dirty() ? "dirty" : "clean") % node.to_string()));
+                        str(boost::format("resolved %d workers on level %d")
+                            % _level_workers.size() % level));
                 }
+                level_begin = level_end;
             }
-
-            // Determine if we are beyond the stop node
-            if (*node_iter == stop_vertex)
-                break;
         }
 
         // Second Pass: Mark all the workers clean. The policy is that a worker will mark
         // all of its dependencies clean so after this step all data nodes that are not
         // consumed by a worker will remain dirty (as they should because no one has
         // consumed their value)
-        for (std::list<dag_vertex_t*>::iterator worker = resolved_workers.begin();
-             worker != resolved_workers.end();
-             ++worker) {
-            (*worker)->mark_clean();
+        for (dag_vertex_t* worker : _resolved_workers) {
+            worker->mark_clean();
         }
     }
 
@@ -555,11 +780,32 @@ private:
         _datanode_map; // A map from vertex name to vertex descriptor for data nodes
     boost::mutex _mutex;
     boost::recursive_mutex _resolve_mutex;
+
+    // Resolver state, derived from the graph structure by _update_order()
+    bool _order_valid = false;
+    // All vertices, sorted topologically and by level
+    std::vector<size_t> _order;
+    // The level of every position in _order
+    std::vector<size_t> _levels;
+    // The position of every vertex in _order
+    std::vector<size_t> _order_pos;
+    std::vector<std::vector<size_t>> _successors;
+    std::vector<size_t> _data_vertices;
+
+    // Scratch space for _resolve_helper(), kept to avoid allocations
+    std::vector<size_t> _visit_marks;
+    size_t _visit_epoch = 0;
+    std::vector<size_t> _affected;
+    std::vector<dag_vertex_t*> _level_workers;
+    std::vector<dag_vertex_t*> _resolved_workers;
+
+    std::unique_ptr<resolver_pool> _pool;
 };
 
-expert_container::sptr expert_container::make(const std::string& name)
+expert_container::sptr expert_container::make(
+    const std::string& name, const size_t num_threads)
 {
-    return std::make_shared<expert_container_impl>(name);
+    return std::make_shared<expert_container_impl>(name, num_threads);
 }
 
 }} // namespace uhd::experts
@@ -9,9 +9,10 @@
 
 namespace uhd { namespace experts {
 
-expert_container::sptr expert_factory::create_container(const std::string& name)
+expert_container::sptr expert_factory::create_container(
+    const std::string& name, const size_t num_threads)
 {
-    return expert_container::make(name);
+    return expert_container::make(name, num_threads);
 }
 
 }} // namespace uhd::experts
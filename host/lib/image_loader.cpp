@@ -11,8 +11,11 @@
 #include <uhd/utils/static.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <map>
+#include <thread>
 #include <utility>
 
 namespace fs = boost::filesystem;
@@ -67,6 +70,42 @@ bool uhd::image_loader::load(
     }
 }
 
+/*
+ * Loading onto several devices
+ */
+std::vector<uhd::image_loader::load_result_t> uhd::image_loader::load(
+    const std::vector<image_loader_args_t>& image_loader_args,
+    const size_t max_concurrent)
+{
+    std::vector<load_result_t> results(image_loader_args.size(), {false, ""});
+    std::atomic<size_t> next_index(0);
+    auto worker = [&]() {
+        for (size_t i = next_index++; i < image_loader_args.size(); i = next_index++) {
+            try {
+                results[i].success = load(image_loader_args[i]);
+            } catch (const std::exception& ex) {
+                results[i].error = ex.what();
+            }
+        }
+    };
+
+    const size_t num_threads =
+        (max_concurrent == 0) ? image_loader_args.size()
+                              : std::min(max_concurrent, image_loader_args.size());
+    UHD_LOG_DEBUG("IMAGE LOADER",
+        "Loading " << image_loader_args.size() << " devices from " << num_threads
+                   << " threads");
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
 /*
  * Get recovery instructions for particular device
  */
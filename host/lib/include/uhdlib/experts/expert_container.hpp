@@ -141,9 +141,16 @@ private:
      * Creates an empty instance of expert_container with the
      * specified name.
      *
+     * With more than one thread, workers that don't depend on each other are
+     * resolved concurrently. Only use this if all workers may run at the same
+     * time, i.e., they don't share any state other than their data nodes, and
+     * every data node is written by a single worker.
+     *
      * \param name Name of the container
+     * \param num_threads Number of threads that resolve workers, including the
+     *                    calling thread. 0 or 1 resolves all workers serially.
      */
-    static sptr make(const std::string& name);
+    static sptr make(const std::string& name, const size_t num_threads = 0);
 
     /*!
      * Returns a reference to the resolver mutex.
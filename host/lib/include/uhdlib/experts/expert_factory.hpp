@@ -36,8 +36,11 @@ public:
      * specified name.
      *
      * \param name Name of the container
+     * \param num_threads Number of threads that resolve independent workers
+     *                    concurrently. See expert_container::make().
      */
-    static expert_container::sptr create_container(const std::string& name);
+    static expert_container::sptr create_container(
+        const std::string& name, const size_t num_threads = 0);
 
     /*!
      * Add a data node to the expert graph.
@@ -268,6 +268,9 @@ typedef chdr_packet_writer_specific<mgmt_payload> chdr_mgmt_packet;
 class chdr_packet_factory
 {
 public:
+    //! A function that reads the destination EPID of a packet in a buffer
+    using dst_epid_fn_t = uint16_t (*)(const void* pkt_buff);
+
     //! A parametrized ctor that takes in all the info required to generate a CHDR packet
     //
     // \param chdr_w The CHDR width of the remote device
@@ -300,6 +303,12 @@ public:
     chdr_mgmt_packet::uptr make_mgmt(
         size_t mtu_bytes = std::numeric_limits<size_t>::max()) const;
 
+    //! Get a function that reads the destination EPID of a packet on this link
+    //
+    // The function only reads the header, so I/O services can use it to route
+    // received packets without creating a packet container.
+    dst_epid_fn_t get_dst_epid_fn() const;
+
     //! Get the CHDR width
     inline chdr_w_t get_chdr_w() const
     {
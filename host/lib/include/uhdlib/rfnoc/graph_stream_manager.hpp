@@ -15,11 +15,13 @@
 #include <uhdlib/rfnoc/ctrlport_endpoint.hpp>
 #include <uhdlib/rfnoc/epid_allocator.hpp>
 #include <uhdlib/rfnoc/mb_iface.hpp>
+#include <uhdlib/transport/links.hpp>
 #include <functional>
 #include <memory>
 #include <set>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace uhd { namespace rfnoc {
 
@@ -32,6 +34,19 @@ class graph_stream_manager
 public:
     using uptr = std::unique_ptr<graph_stream_manager>;
 
+    //! Host adapter allocation of a single data stream
+    struct data_stream_alloc_t
+    {
+        //! The host transport adapter carrying the stream
+        uhd::transport::adapter_id_t adapter;
+        //! RX_DATA or TX_DATA
+        uhd::transport::link_type_t link_type;
+        //! The sample rate the stream was created with (0 if unknown)
+        double samp_rate;
+        //! The estimated load in bytes per second, including CHDR overhead
+        double load;
+    };
+
     virtual ~graph_stream_manager() = 0;
 
     /*! \brief Get all the local devices that can be taken from this graph
@@ -115,6 +130,8 @@ public:
      * \param adapter The preference for the adapter to use to get to the destination
      * \param xport_args The transport arguments
      * \param streamer_id A unique identifier for the streamer that will own the transport
+     * \param samp_rate The sample rate of the stream, 0 if unknown. If no adapter
+     *                  is given, it is used to pick the least loaded one.
      * \return An transport instance
      */
     virtual chdr_rx_data_xport::uptr create_device_to_host_data_stream(
@@ -123,7 +140,8 @@ public:
         const sw_buff_t mdata_buff_fmt,
         const uhd::transport::adapter_id_t adapter,
         const device_addr_t& xport_args,
-        const std::string& streamer_id) = 0;
+        const std::string& streamer_id,
+        const double samp_rate = 0.0) = 0;
 
     /*! \brief Create a data stream going from the host to the device
      *
@@ -133,6 +151,8 @@ public:
      * \param adapter The preference for the adapter to use to get to the destination
      * \param xport_args The transport arguments
      * \param streamer_id A unique identifier for the streamer that will own the transport
+     * \param samp_rate The sample rate of the stream, 0 if unknown. If no adapter
+     *                  is given, it is used to pick the least loaded one.
      * \return An transport instance
      */
     virtual chdr_tx_data_xport::uptr create_host_to_device_data_stream(
@@ -141,7 +161,36 @@ public:
         const sw_buff_t mdata_buff_fmt,
         const uhd::transport::adapter_id_t adapter,
         const device_addr_t& xport_args,
-        const std::string& streamer_id) = 0;
+        const std::string& streamer_id,
+        const double samp_rate = 0.0) = 0;
+
+    /*! \brief Get the adapter allocations of all data streams of a streamer
+     *
+     * \param streamer_id The unique identifier of the streamer
+     * \return The allocations, in the order the streams were created
+     */
+    virtual std::vector<data_stream_alloc_t> get_data_stream_allocs(
+        const std::string& streamer_id) const = 0;
+
+    /*! \brief Release the adapter allocations of all data streams of a streamer
+     *
+     * Call this when the streamer is disconnected, so its load no longer
+     * counts when placing new streams.
+     *
+     * \param streamer_id The unique identifier of the streamer
+     */
+    virtual void release_data_streams(const std::string& streamer_id) = 0;
+
+    /*! \brief Release the adapter allocation of a single data stream
+     *
+     * Call this when a single channel of a streamer is disconnected.
+     *
+     * \param streamer_id The unique identifier of the streamer
+     * \param alloc The allocation of the stream, as returned by
+     *              get_data_stream_allocs()
+     */
+    virtual void release_data_stream(
+        const std::string& streamer_id, const data_stream_alloc_t& alloc) = 0;
 
     /*! \brief Get all the adapters that can reach the specified endpoint
      *
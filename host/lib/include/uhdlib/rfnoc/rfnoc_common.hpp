@@ -59,6 +59,11 @@ constexpr sw_buff_t bits_to_sw_buff(size_t bits)
         return BUFF_U64;
     }
 }
+//! Conversion from sw_buff to the number of bytes per item
+constexpr size_t sw_buff_to_bytes(sw_buff_t buff)
+{
+    return size_t(8) >> buff;
+}
 
 //----------------------------------------------
 // Constants
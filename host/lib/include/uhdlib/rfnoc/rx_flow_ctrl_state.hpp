@@ -8,17 +8,53 @@
 
 #include <uhd/utils/log.hpp>
 #include <uhdlib/rfnoc/rfnoc_common.hpp>
+#include <algorithm>
 
 namespace uhd { namespace rfnoc {
 
-//! Class to manage rx flow control state
+/*! Class to manage rx flow control state
+ *
+ * Flow control responses (strs packets) tell the sender how much buffer space
+ * was freed up. The sender requests a response at least every fc_freq bytes
+ * or packets. Every response costs a send buffer and a system call on the
+ * streaming thread, though, so if the buffer capacity is known, responses are
+ * coalesced for as long as the sender has plenty of room left:
+ *
+ * - The sender considers everything that was not acknowledged yet to be in the
+ *   buffer. As long as that is less than half the capacity, responses are
+ *   held back until the coalescing limit is reached.
+ * - Above half the capacity, a response is sent whenever fc_freq is reached,
+ *   as without coalescing.
+ * - The coalescing limit grows by fc_freq after every response sent because
+ *   it was reached, up to an eighth of the capacity. It is halved whenever a
+ *   response had to be sent because the buffer filled up, i.e., when data
+ *   arrives faster than it is consumed, or the round trip to the sender is
+ *   long enough to put a lot of data in flight.
+ *
+ * Holding back responses can never overflow the buffer, because the sender
+ * won't exceed the buffer space it knows of. It can only stall the sender,
+ * which is what the watermark prevents.
+ */
 class rx_flow_ctrl_state
 {
 public:
-    //! Constructor
-    rx_flow_ctrl_state(
-        const rfnoc::sep_id_pair_t epids, const stream_buff_params_t fc_freq)
-        : _fc_freq(fc_freq), _epids(epids)
+    /*! Constructor
+     *
+     * \param epids Source and destination endpoint IDs, for log messages
+     * \param fc_freq Frequency of flow control responses requested by the sender
+     * \param buff_capacity Capacity of the receive buffer. If zero, responses
+     *        are sent at fc_freq and never coalesced.
+     */
+    rx_flow_ctrl_state(const rfnoc::sep_id_pair_t epids,
+        const stream_buff_params_t fc_freq,
+        const stream_buff_params_t buff_capacity = {0, 0})
+        : _fc_freq(fc_freq)
+        , _coalesce_limit(fc_freq)
+        , _coalesce_enabled(buff_capacity.bytes > 0 && buff_capacity.packets > 0)
+        , _high_watermark({buff_capacity.bytes / 2, buff_capacity.packets / 2})
+        , _max_coalesce_limit({std::max(fc_freq.bytes, buff_capacity.bytes / 8),
+              std::max(fc_freq.packets, buff_capacity.packets / 8)})
+        , _epids(epids)
     {
     }
 
@@ -70,13 +106,30 @@ public:
             _xfer_counts.bytes - _last_fc_resp_counts.bytes,
             _xfer_counts.packets - _last_fc_resp_counts.packets};
 
-        return accum_counts.bytes >= _fc_freq.bytes
-               || accum_counts.packets >= _fc_freq.packets;
+        if (accum_counts.bytes < _fc_freq.bytes
+            && accum_counts.packets < _fc_freq.packets) {
+            return false;
+        }
+        return !_coalesce_enabled || _above_high_watermark()
+               || accum_counts.bytes >= _coalesce_limit.bytes
+               || accum_counts.packets >= _coalesce_limit.packets;
     }
 
     //! Update state after flow control response was sent
     void fc_resp_sent()
     {
+        if (_coalesce_enabled) {
+            if (_above_high_watermark()) {
+                _coalesce_limit = {std::max(_fc_freq.bytes, _coalesce_limit.bytes / 2),
+                    std::max(_fc_freq.packets, _coalesce_limit.packets / 2)};
+            } else {
+                // Written to saturate, as the frequency may be the maximum value
+                _coalesce_limit.bytes += std::min(
+                    _fc_freq.bytes, _max_coalesce_limit.bytes - _coalesce_limit.bytes);
+                _coalesce_limit.packets += std::min(_fc_freq.packets,
+                    _max_coalesce_limit.packets - _coalesce_limit.packets);
+            }
+        }
         _last_fc_resp_counts = _xfer_counts;
     }
 
@@ -98,7 +151,21 @@ public:
         return _fc_freq;
     }
 
+    //! Returns the amount of freed buffer space responses are held back for
+    stream_buff_params_t get_coalesce_limit() const
+    {
+        return _coalesce_limit;
+    }
+
 private:
+    //! Returns whether the sender thinks the buffer is more than half full
+    bool _above_high_watermark() const
+    {
+        return _recv_counts.bytes - _last_fc_resp_counts.bytes >= _high_watermark.bytes
+               || _recv_counts.packets - _last_fc_resp_counts.packets
+                      >= _high_watermark.packets;
+    }
+
     // Counts for data received, including any data still in use
     stream_buff_params_t _recv_counts{0, 0};
 
@@ -111,6 +178,18 @@ private:
     // Frequency of flow control responses
     stream_buff_params_t _fc_freq{0, 0};
 
+    // Amount of freed buffer space responses are currently held back for
+    stream_buff_params_t _coalesce_limit;
+
+    // Whether responses may be held back at all
+    const bool _coalesce_enabled;
+
+    // Buffer fullness above which responses aren't held back
+    const stream_buff_params_t _high_watermark;
+
+    // Upper limit for _coalesce_limit
+    const stream_buff_params_t _max_coalesce_limit;
+
     // Endpoint ID for log messages
     const sep_id_pair_t _epids;
 };
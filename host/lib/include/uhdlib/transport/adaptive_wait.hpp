@@ -0,0 +1,165 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/config.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace uhd { namespace transport {
+
+/*!
+ * Wait strategy that polls for a while, and then blocks
+ *
+ * Blocking in a link's get_recv_buff() adds a wake-up latency to every packet,
+ * while polling uses up a CPU core per stream. This strategy polls the link
+ * for up to a spin budget, and only blocks for the rest of the timeout if
+ * nothing arrived by then.
+ *
+ * The spin budget tunes itself: a moving average of the time it takes for a
+ * wait to succeed is kept, and the budget is twice that average. If data
+ * takes longer to arrive than the maximum spin time, polling would only burn
+ * CPU time, so the budget drops to zero until data arrives faster again.
+ *
+ * An instance is used by one thread at a time, but its statistics may be read
+ * from any thread.
+ */
+class adaptive_wait
+{
+public:
+    using sptr = std::shared_ptr<adaptive_wait>;
+
+    struct stats_t
+    {
+        //! Total time spent polling, in seconds
+        double spin_time = 0.0;
+        //! Total time spent blocking, in seconds
+        double block_time = 0.0;
+        //! Number of waits that succeeded while polling
+        uint64_t num_spin_hits = 0;
+        //! Number of waits that had to block
+        uint64_t num_blocks = 0;
+    };
+
+    /*!
+     * \param max_spin_time The upper limit of the spin budget, in seconds. If
+     *        zero, wait() always blocks right away.
+     */
+    adaptive_wait(const double max_spin_time)
+        : _max_spin(std::chrono::duration_cast<clock_type::duration>(
+            std::chrono::duration<double>(max_spin_time)))
+        , _latency_avg(_max_spin / 2)
+        , _spin_budget(_max_spin)
+    {
+    }
+
+    /*!
+     * Wait for data, using a wait function with a timeout
+     *
+     * \param timeout_ms The timeout of the entire wait, in ms. A negative value
+     *        means to wait forever.
+     * \param wait_fn A function that takes a timeout in ms, and returns a
+     *        value that converts to false if it timed out.
+     * \return The value returned by the last call to wait_fn
+     */
+    template <typename wait_fn_t>
+    auto wait(const int32_t timeout_ms, wait_fn_t&& wait_fn)
+        -> decltype(wait_fn(timeout_ms))
+    {
+        if (timeout_ms == 0) {
+            return wait_fn(0);
+        }
+
+        const auto start    = clock_type::now();
+        const auto deadline = (timeout_ms < 0)
+                                  ? clock_type::time_point::max()
+                                  : start + std::chrono::milliseconds(timeout_ms);
+        const auto spin_end = std::min(start + _spin_budget, deadline);
+
+        auto now = start;
+        while (now < spin_end) {
+            auto result = wait_fn(0);
+            now         = clock_type::now();
+            if (result) {
+                _add(_spin_time_ns, now - start);
+                _num_spin_hits.fetch_add(1, std::memory_order_relaxed);
+                _update_budget(now - start);
+                return result;
+            }
+        }
+        _add(_spin_time_ns, now - start);
+
+        int32_t remaining_ms = -1;
+        if (timeout_ms >= 0) {
+            // Round up, so we never return before the timeout
+            const auto remaining_us =
+                std::chrono::duration_cast<std::chrono::microseconds>(deadline - now)
+                    .count();
+            remaining_ms = static_cast<int32_t>(
+                std::max<int64_t>(0, (remaining_us + 999) / 1000));
+        }
+        auto result    = wait_fn(remaining_ms);
+        const auto end = clock_type::now();
+        _add(_block_time_ns, end - now);
+        _num_blocks.fetch_add(1, std::memory_order_relaxed);
+        if (result) {
+            _update_budget(end - start);
+        }
+        return result;
+    }
+
+    //! Return the current spin budget, in seconds
+    double get_spin_budget() const
+    {
+        return std::chrono::duration<double>(_spin_budget).count();
+    }
+
+    //! Return the time spent polling and blocking so far
+    stats_t get_stats() const
+    {
+        stats_t stats;
+        stats.spin_time     = _spin_time_ns.load(std::memory_order_relaxed) / 1e9;
+        stats.block_time    = _block_time_ns.load(std::memory_order_relaxed) / 1e9;
+        stats.num_spin_hits = _num_spin_hits.load(std::memory_order_relaxed);
+        stats.num_blocks    = _num_blocks.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    //! Weight of a new sample in the moving average, as a power of two
+    static constexpr int AVG_SHIFT = 3;
+
+    static void _add(std::atomic<uint64_t>& total, const clock_type::duration& time)
+    {
+        total.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+            std::memory_order_relaxed);
+    }
+
+    void _update_budget(const clock_type::duration& latency)
+    {
+        _latency_avg += (latency - _latency_avg) / (1 << AVG_SHIFT);
+        const auto budget = _latency_avg * 2;
+        _spin_budget      = (budget <= _max_spin) ? budget : clock_type::duration::zero();
+    }
+
+    const clock_type::duration _max_spin;
+    clock_type::duration _latency_avg;
+    clock_type::duration _spin_budget;
+
+    std::atomic<uint64_t> _spin_time_ns{0};
+    std::atomic<uint64_t> _block_time_ns{0};
+    std::atomic<uint64_t> _num_spin_hits{0};
+    std::atomic<uint64_t> _num_blocks{0};
+};
+
+}} // namespace uhd::transport
@@ -18,10 +18,18 @@ struct arp_request
     ipv4_addr tpa;
 };
 
+//! A request waiting for an ARP reply, and the service queue of the I/O
+// service that owns it
+struct arp_waiter
+{
+    wait_req* req;
+    service_queue* servq;
+};
+
 struct arp_entry
 {
     struct ether_addr mac_addr;
-    std::vector<wait_req*> reqs;
+    std::vector<arp_waiter> reqs;
 };
 
 }}} /* namespace uhd::transport::dpdk */
@@ -19,7 +19,9 @@
 #include <rte_version.h>
 #include <unordered_map>
 #include <array>
+#include <vector>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
@@ -255,6 +257,83 @@ public:
      */
     uint16_t alloc_udp_port(uint16_t udp_port);
 
+    /*! Determine if UDP flows can be steered to individual RX queues
+     *
+     * This is only true if the port was configured with multiple queues and
+     * the NIC accepted a UDP destination port flow rule. Without flow
+     * steering, all received UDP traffic must be handled by queue 0.
+     *
+     * \return whether add_udp_flow() may direct traffic to queues other than 0
+     */
+    inline bool has_flow_steering() const
+    {
+        return _flow_steering;
+    }
+
+    /*!
+     * Install a flow rule that directs all UDP packets with the given
+     * destination port to an RX queue
+     *
+     * \param udp_port The local UDP port (in network order)
+     * \param queue_id The RX queue that shall receive the packets
+     * \return 0 on success, else a negative errno value
+     */
+    int add_udp_flow(uint16_t udp_port, queue_id_t queue_id);
+
+    /*!
+     * Remove a flow rule previously installed by add_udp_flow()
+     *
+     * \param udp_port The local UDP port (in network order)
+     */
+    void del_udp_flow(uint16_t udp_port);
+
+    /*!
+     * Buffer a packet for transmission on a TX queue
+     *
+     * The packet will be sent once enough packets were buffered to fill a
+     * burst, or when flush_tx() is called. Only the I/O service that owns the
+     * TX queue may call this.
+     *
+     * \param queue_id The TX queue
+     * \param mbuf The packet to send
+     */
+    inline void buffer_tx(queue_id_t queue_id, struct rte_mbuf* mbuf)
+    {
+        rte_eth_tx_buffer(_port, queue_id, _tx_buffers[queue_id], mbuf);
+    }
+
+    /*!
+     * Transmit all packets that were buffered on a TX queue
+     *
+     * Only the I/O service that owns the TX queue may call this.
+     *
+     * \param queue_id The TX queue
+     * \return the number of packets sent
+     */
+    inline uint16_t flush_tx(queue_id_t queue_id)
+    {
+        return rte_eth_tx_buffer_flush(_port, queue_id, _tx_buffers[queue_id]);
+    }
+
+    /*!
+     * Get the number of buffered packets that were dropped on a TX queue,
+     * because the NIC didn't accept them (e.g., while the link was down)
+     *
+     * \param queue_id The TX queue
+     */
+    inline uint64_t get_tx_dropped(queue_id_t queue_id) const
+    {
+        return _tx_retry_ctxs[queue_id]->num_dropped;
+    }
+
+    //! State of the TX buffer error callback of one queue
+    struct tx_retry_ctx_t
+    {
+        port_id_t port;
+        queue_id_t queue;
+        std::atomic<uint64_t> num_dropped{0};
+    };
+
 private:
     friend uhd::transport::dpdk_io_service;
 
@@ -263,9 +342,31 @@ private:
      */
     int _arp_reply(queue_id_t queue_id, struct arp_hdr* arp_req);
 
+    /*!
+     * Configure the RX/TX queues and TX buffers for _num_queues, then start
+     * the device
+     */
+    void _configure(const struct rte_eth_dev_info& dev_info, uint16_t num_desc);
+
+    /*!
+     * Point every entry of the RSS redirection table at queue 0
+     *
+     * \return whether the NIC accepted the new table
+     */
+    bool _redirect_rss_to_queue_0(const struct rte_eth_dev_info& dev_info);
+
+    /*!
+     * Check if the NIC accepts the flow rules used for steering UDP traffic
+     */
+    bool _probe_flow_steering();
+
     port_id_t _port;
     size_t _mtu;
     size_t _num_queues;
+    bool _flow_steering = false;
+    //! Per-queue TX packet buffers, used to send packets in bursts
+    std::vector<struct rte_eth_dev_tx_buffer*> _tx_buffers;
+    std::vector<std::unique_ptr<tx_retry_ctx_t>> _tx_retry_ctxs;
     struct rte_mempool* _rx_pktbuf_pool;
     struct rte_mempool* _tx_pktbuf_pool;
     struct ether_addr _mac_addr;
@@ -276,6 +377,7 @@ private:
     std::mutex _mutex;
     std::set<uint16_t> _udp_ports;
     uint16_t _next_udp_port = 0xffff;
+    std::unordered_map<uint16_t, struct rte_flow*> _udp_flows;
 
     // Structures protected by spin lock
     rte_spinlock_t _spinlock = RTE_SPINLOCK_INITIALIZER;
@@ -356,9 +458,28 @@ public:
     bool is_init_done(void) const;
 
     /*! Return a reference to an IO service given a port ID
+     *
+     * If the port is served by multiple I/O services (one per DMA queue), this
+     * returns the one that services queue 0.
      */
     std::shared_ptr<uhd::transport::dpdk_io_service> get_io_service(const size_t port_id);
 
+    /*! Return a reference to the IO service that serves a given DMA queue of
+     * a port
+     */
+    std::shared_ptr<uhd::transport::dpdk_io_service> get_io_service(
+        const size_t port_id, const queue_id_t queue_id);
+
+    /*! Return the IO service of a port that currently has the fewest links
+     * attached
+     *
+     * This is used to spread new links over all the DMA queues (and thus
+     * lcores) of a port. If the port does not support flow steering, only
+     * the IO service for queue 0 is considered.
+     */
+    std::shared_ptr<uhd::transport::dpdk_io_service> get_least_loaded_io_service(
+        const size_t port_id);
+
 private:
     /*! Convert the args to DPDK's EAL args and Initialize the EAL
      *
@@ -9,16 +9,18 @@
 #include <uhdlib/transport/dpdk/service_queue.hpp>
 #include <uhdlib/transport/io_service.hpp>
 #include <rte_arp.h>
-#include <rte_hash.h>
 #include <rte_ip.h>
 #include <rte_mbuf.h>
 #include <rte_udp.h>
+#include <array>
+#include <list>
 #include <vector>
 
 namespace uhd { namespace transport {
 
 class dpdk_send_io;
 class dpdk_recv_io;
+class udp_dpdk_link;
 struct dpdk_io_if;
 
 class dpdk_io_service : public virtual io_service,
@@ -27,8 +29,19 @@ class dpdk_io_service : public virtual io_service,
 public:
     using sptr = std::shared_ptr<dpdk_io_service>;
 
-    static sptr make(
-        unsigned int lcore_id, std::vector<dpdk::dpdk_port*> ports, size_t servq_depth);
+    /*!
+     * Create an I/O service and launch it on an lcore
+     *
+     * \param lcore_id The lcore that will run the I/O service's work routine
+     * \param ports The NIC ports served by this I/O service
+     * \param queues The DMA queue to use on each of the ports. Each DMA queue
+     *               of a port must be served by exactly one I/O service.
+     * \param servq_depth The depth of the service queue for client requests
+     */
+    static sptr make(unsigned int lcore_id,
+        std::vector<dpdk::dpdk_port*> ports,
+        std::vector<dpdk::queue_id_t> queues,
+        size_t servq_depth);
 
     ~dpdk_io_service();
 
@@ -50,7 +63,8 @@ public:
         recv_callback_t cb,
         send_link_if::sptr fc_link,
         size_t num_send_frames,
-        recv_io_if::fc_callback_t fc_cb);
+        recv_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
 
     send_io_if::sptr make_send_client(send_link_if::sptr send_link,
         size_t num_send_frames,
@@ -58,17 +72,49 @@ public:
         recv_link_if::sptr recv_link,
         size_t num_recv_frames,
         recv_callback_t recv_cb,
-        send_io_if::fc_callback_t fc_cb);
+        send_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
 
+    /*!
+     * Get the DMA queue this I/O service uses on a NIC port
+     *
+     * \param port_id The NIC port ID
+     * \return the queue ID, or -1 if the port isn't served by this I/O service
+     */
+    int get_queue_id(dpdk::port_id_t port_id) const;
+
+    /*!
+     * Get the number of links currently attached to this I/O service
+     */
+    size_t get_num_links();
 
 private:
     friend class dpdk_recv_io;
     friend class dpdk_send_io;
 
-    dpdk_io_service(
-        unsigned int lcore_id, std::vector<dpdk::dpdk_port*> ports, size_t servq_depth);
+    static constexpr int RX_BURST_SIZE = 32;
+    static constexpr int TX_BURST_SIZE = 32;
+
+    dpdk_io_service(unsigned int lcore_id,
+        std::vector<dpdk::dpdk_port*> ports,
+        std::vector<dpdk::queue_id_t> queues,
+        size_t servq_depth);
     dpdk_io_service(const dpdk_io_service&) = delete;
 
+    //! List of transports that receive on a given UDP port
+    using rx_flow_list = std::list<dpdk_io_if*>;
+
+    /*!
+     * Received buffers for one transport, which are collected while processing
+     * an RX burst and then handed to the transport at once
+     */
+    struct rx_stage
+    {
+        dpdk_io_if* io_if;
+        unsigned int num_buffs;
+        dpdk::dpdk_frame_buff* buffs[RX_BURST_SIZE];
+    };
+
     /*!
      * I/O worker function to be passed to the DPDK lcore
      *
@@ -84,6 +130,11 @@ private:
      */
     int _service_requests();
 
+    /*!
+     * Free the RX tables and the transport lists they hold
+     */
+    void _free_rx_tables();
+
     /*!
      * Helper function for I/O thread to service a WAIT_FLOW_OPEN request
      *
@@ -129,10 +180,15 @@ private:
      * Helper function for I/O thread to do a burst of packet retrieval and
      * processing on an RX queue
      *
-     * \param port the DPDK NIC port used for RX
-     * \param queue the DMA queue on the port to recv from
+     * \param port_idx the index of the DPDK NIC port used for RX (into _ports)
      */
-    int _rx_burst(dpdk::dpdk_port* port, dpdk::queue_id_t queue);
+    int _rx_burst(size_t port_idx);
+
+    /*!
+     * Helper function for I/O thread to hand all buffers collected during an
+     * RX burst to their transports, and wake them up
+     */
+    void _rx_flush_stage();
 
     /*!
      * Helper function for I/O thread to do a burst of packet transmission on a
@@ -176,22 +232,41 @@ private:
      * Helper function for I/O thread to process an IPv4 packet
      *
      * \param port the DPDK NIC port to send any ARP replies from
+     * \param rx_table the RX flow index for the port
      * \param mbuf a pointer to the packet buffer container
      * \param pkt a pointer to the IPv4 header of the packet
      */
-    int _process_ipv4(dpdk::dpdk_port* port, struct rte_mbuf* mbuf, struct ipv4_hdr* pkt);
+    int _process_ipv4(dpdk::dpdk_port* port,
+        rx_flow_list** rx_table,
+        struct rte_mbuf* mbuf,
+        struct ipv4_hdr* pkt);
 
     /*!
      * Helper function for I/O thread to process an IPv4 packet
      *
-     * \param port the DPDK NIC port to send any ARP replies from
+     * \param rx_table the RX flow index for the port
      * \param mbuf a pointer to the packet buffer container
      * \param pkt a pointer to the UDP header of the packet
      * \param bcast whether this packet was destined for the port's broadcast
      *              IPv4 address
      */
-    int _process_udp(
-        dpdk::dpdk_port* port, struct rte_mbuf* mbuf, struct udp_hdr* pkt, bool bcast);
+    int _process_udp(rx_flow_list** rx_table,
+        struct rte_mbuf* mbuf,
+        struct udp_hdr* pkt,
+        bool bcast);
+
+    /*!
+     * Get the index of a NIC port in _ports
+     *
+     * \param port_id The NIC port ID
+     * \return the index, or -1 if the port isn't served by this I/O service
+     */
+    int _get_port_idx(dpdk::port_id_t port_id) const;
+
+    /*!
+     * Get the RX flow index entry for a link's local UDP port
+     */
+    rx_flow_list*& _get_rx_entry(udp_dpdk_link* link);
 
     /*!
      * Helper function to get a unique client ID
@@ -211,12 +286,20 @@ private:
     unsigned int _lcore_id;
     //! The NIC ports served by this dpdk_io_service
     std::vector<dpdk::dpdk_port*> _ports;
+    //! The DMA queue used on each of the NIC ports (same order as _ports)
+    std::vector<dpdk::queue_id_t> _queues;
     //! The set of TX queues associated with a given port
     std::unordered_map<dpdk::port_id_t, std::list<dpdk_send_io*>> _tx_queues;
     //! The list of recv_io for each port
     std::unordered_map<dpdk::port_id_t, std::list<dpdk_recv_io*>> _recv_xport_map;
-    //! The RX table, which provides lists of dpdk_recv_io for an IPv4 tuple
-    struct rte_hash* _rx_table;
+    //! The RX tables (one per NIC port, same order as _ports). These are
+    //! directly indexed by the destination UDP port (in host order), and
+    //! provide the lists of dpdk_io_if that receive on that port.
+    std::vector<rx_flow_list**> _rx_tables;
+    //! Buffers of the current RX burst, per transport
+    std::array<rx_stage, RX_BURST_SIZE> _rx_stage;
+    //! Number of valid entries in _rx_stage
+    size_t _num_rx_stage = 0;
     //! Service queue for clients to make requests
     dpdk::service_queue _servq;
     //! Retry list for waking clients
@@ -234,10 +317,8 @@ private:
     uint16_t _next_client_id;
 
     static constexpr int MAX_PENDING_SERVICE_REQS = 32;
-    static constexpr int MAX_FLOWS                = 128;
     static constexpr int MAX_CLIENTS              = 2048;
-    static constexpr int RX_BURST_SIZE            = 16;
-    static constexpr int TX_BURST_SIZE            = 16;
+    static constexpr size_t NUM_UDP_PORTS         = 65536;
 };
 
 }} // namespace uhd::transport
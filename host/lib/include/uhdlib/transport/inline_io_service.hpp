@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <uhdlib/transport/adaptive_wait.hpp>
 #include <uhdlib/transport/io_service.hpp>
 #include <unordered_map>
 #include <list>
@@ -44,7 +45,8 @@ public:
         recv_callback_t cb,
         send_link_if::sptr fc_link,
         size_t num_send_frames,
-        recv_io_if::fc_callback_t fc_cb);
+        recv_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
 
     send_io_if::sptr make_send_client(send_link_if::sptr send_link,
         size_t num_send_frames,
@@ -52,7 +54,31 @@ public:
         recv_link_if::sptr recv_link,
         size_t num_recv_frames,
         recv_callback_t recv_cb,
-        send_io_if::fc_callback_t fc_cb);
+        send_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
+
+    /*!
+     * Set how clients wait for data on a recv link
+     *
+     * Each client that connects to the link afterwards gets its own
+     * adaptive_wait, so the spin budget is tuned to the traffic of that
+     * client, by the thread of that client. Clients that are already
+     * connected keep their wait strategy.
+     *
+     * \param link the recv link, which must be attached to this I/O service
+     * \param max_spin_time the maximum time a client polls the link before it
+     *        blocks, in seconds. If zero, clients block right away.
+     */
+    void set_adaptive_wait(recv_link_if::sptr link, const double max_spin_time);
+
+    /*!
+     * Get the sum of the adaptive wait statistics of the clients that are
+     * connected to a recv link. Must not be called while clients connect or
+     * disconnect.
+     *
+     * \param link the recv link
+     */
+    adaptive_wait::stats_t get_adaptive_wait_stats(recv_link_if::sptr link) const;
 
 private:
     friend class inline_recv_io;
@@ -125,6 +151,9 @@ private:
     /* Shared ptr kept to avoid untimely release */
     std::list<send_link_if::sptr> _send_links;
     std::list<recv_link_if::sptr> _recv_links;
+
+    /* Maximum spin time of the adaptive wait of new clients, per recv link */
+    std::unordered_map<recv_link_if*, double> _max_spin_times;
 };
 
 }} // namespace uhd::transport
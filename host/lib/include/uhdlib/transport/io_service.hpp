@@ -37,6 +37,7 @@
 #pragma once
 
 #include <uhdlib/transport/link_if.hpp>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -77,6 +78,28 @@ namespace uhd { namespace transport {
 using recv_callback_t =
     std::function<bool(frame_buff::uptr&, recv_link_if*, send_link_if*)>;
 
+/*!
+ * Destination of the packets a client receives from a shared recv link
+ *
+ * When several clients share a recv link, an I/O service may use the route to
+ * offer a packet only to the clients registered for its destination endpoint,
+ * after reading that endpoint from the packet header. The recv_callback_t of
+ * those clients still decides whether they take the packet. Clients without a
+ * route are offered every packet that no routed client takes.
+ *
+ * A client with a route must not take packets for any other endpoint.
+ */
+struct recv_route_t
+{
+    //! Function that reads the destination endpoint ID from a received frame
+    using get_dst_epid_fn_t = uint16_t (*)(const void* frame);
+
+    //! Reads the destination endpoint ID, or nullptr if the client has no route
+    get_dst_epid_fn_t get_dst_epid = nullptr;
+    //! The destination endpoint ID of the packets the client takes
+    uint16_t dst_epid = 0;
+};
+
 /*!
  * Callback to disconnect links.  This allows a function to be registered
  * that can call back to the io_service_mgr to completely disconnect the
@@ -333,6 +356,7 @@ public:
      * \param num_recv_frames Number of buffers to reserve in recv_link
      * \param recv_cb callback function for receiving packets from recv_link
      * \param fc_cb callback function to check if destination is ready for data
+     * \param recv_route destination of the packets recv_cb takes from recv_link
      * \return a send_io_if for interfacing with the link
      */
     virtual send_io_if::sptr make_send_client(send_link_if::sptr send_link,
@@ -341,7 +365,8 @@ public:
         recv_link_if::sptr recv_link,
         size_t num_recv_frames,
         recv_callback_t recv_cb,
-        send_io_if::fc_callback_t fc_cb) = 0;
+        send_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t()) = 0;
 
     /*!
      * Create a recv_io_if and registers the transport's callbacks.
@@ -354,6 +379,7 @@ public:
      * \param fc_link the link used to send flow control responses
      * \param fc_cb callback function for handling flow control
      * \param num_send_frames Number of buffers to reserve in fc_link
+     * \param recv_route destination of the packets cb takes from data_link
      * \return a recv_io_if for interfacing with the link
      */
     virtual recv_io_if::sptr make_recv_client(recv_link_if::sptr data_link,
@@ -361,7 +387,8 @@ public:
         recv_callback_t cb,
         send_link_if::sptr fc_link,
         size_t num_send_frames,
-        recv_io_if::fc_callback_t fc_cb) = 0;
+        recv_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t()) = 0;
 
     io_service()                  = default;
     io_service(const io_service&) = delete;
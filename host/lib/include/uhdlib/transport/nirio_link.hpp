@@ -15,6 +15,8 @@
 #include <uhdlib/transport/adapter_info.hpp>
 #include <uhdlib/transport/link_base.hpp>
 #include <uhdlib/transport/links.hpp>
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -63,6 +65,17 @@ private:
 };
 
 /*! Link object to talking to NI-RIO USRPs (X310 variants using PCIe)
+ *
+ * On the receive side, the link acquires as many frames from the DMA FIFO as
+ * are known to be available (up to the recv_batch_frames hint) in a single
+ * call, and hands them out one frame_buff at a time. Released frames are
+ * granted back to the DMA engine in one call per batch, instead of one driver
+ * call per frame.
+ *
+ * With the busy_poll hint, the link never sleeps in the driver while waiting
+ * for a frame. Instead, it spins on non-blocking acquires until a frame is
+ * available or the timeout expires. This trades a CPU core for lower and more
+ * predictable latency.
  *
  * \b Note: This link cannot release frame buffers out of order, which means it
  *          can't be used with an IO service that does that.
@@ -79,6 +92,8 @@ public:
      * \param addr a string representing the destination address
      * \param port a string representing the destination port
      * \param params Values for frame sizes, num frames, and buffer sizes
+     * \param hints Overrides for the link params, and the recv_batch_frames
+     *              and busy_poll options
      * \param[out] recv_buff_size Returns the recv buffer size
      * \param[out] send_buff_size Returns the send buffer size
      */
@@ -133,7 +148,9 @@ private:
 
     nirio_link(uhd::niusrprio::niusrprio_session::sptr fpga_session,
         uint32_t instance,
-        const link_params_t& params);
+        const link_params_t& params,
+        const size_t recv_batch_frames,
+        const bool busy_poll);
 
     /**************************************************************************
      * NI-RIO specific helpers
@@ -148,31 +165,27 @@ private:
     // Methods called by recv_link_base
     UHD_FORCE_INLINE size_t get_recv_buff_derived(frame_buff& buff, int32_t timeout_ms)
     {
-        using namespace uhd::niusrprio;
-        nirio_status status    = 0;
-        size_t elems_acquired  = 0;
-        size_t elems_remaining = 0;
-        // This will modify the data pointer in buff if successful:
-        fifo_data_t** data_ptr = static_cast<nirio_frame_buff&>(buff).get_fifo_ptr_ref();
-        nirio_status_chain(_recv_fifo->acquire(*data_ptr,
-                               _link_params.recv_frame_size / sizeof(fifo_data_t),
-                               static_cast<uint32_t>(timeout_ms),
-                               elems_acquired,
-                               elems_remaining),
-            status);
-        const size_t length = elems_acquired * sizeof(fifo_data_t);
-
-        if (nirio_status_not_fatal(status)) {
-            return length;
-        } else if (status == NiRio_Status_CommunicationTimeout) {
-            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
+        if (_recv_batch_left == 0) {
+            // Hand the frames released since the last batch back to the DMA
+            // engine before waiting for more data
+            _release_recv_elems();
+            if (!_acquire_recv_batch(timeout_ms)) {
+                return 0; // zero for timeout or error.
+            }
         }
-        return 0; // zero for timeout or error.
+        // This will modify the data pointer in buff:
+        *static_cast<nirio_frame_buff&>(buff).get_fifo_ptr_ref() = _recv_batch_ptr;
+        _recv_batch_ptr += _recv_frame_elems;
+        _recv_batch_left--;
+        return _link_params.recv_frame_size;
     }
 
     UHD_FORCE_INLINE void release_recv_buff_derived(frame_buff& /*buff*/)
     {
-        _recv_fifo->release(_link_params.recv_frame_size / sizeof(fifo_data_t));
+        _recv_elems_to_release += _recv_frame_elems;
+        if (_recv_elems_to_release >= _recv_batch_frames * _recv_frame_elems) {
+            _release_recv_elems();
+        }
     }
 
     // Methods called by send_link_base
@@ -184,9 +197,10 @@ private:
         size_t elems_remaining = 0;
         // This will modify the data pointer in buff if successful:
         fifo_data_t** data_ptr = static_cast<nirio_frame_buff&>(buff).get_fifo_ptr_ref();
-        nirio_status_chain(_send_fifo->acquire(*data_ptr,
+        nirio_status_chain(_acquire(*_send_fifo,
+                               *data_ptr,
                                _link_params.send_frame_size / sizeof(fifo_data_t),
-                               static_cast<uint32_t>(timeout_ms),
+                               timeout_ms,
                                elems_acquired,
                                elems_remaining),
             status);
@@ -205,6 +219,80 @@ private:
         _send_fifo->release(_link_params.send_frame_size / sizeof(fifo_data_t));
     }
 
+    /**************************************************************************
+     * Hot path helpers
+     *************************************************************************/
+    /*! Acquire elements from a FIFO, honouring the busy-poll setting
+     *
+     * Arguments are the same as for nirio_fifo::acquire(). A negative timeout
+     * means to wait forever.
+     */
+    UHD_FORCE_INLINE nirio_status _acquire(niusrprio::nirio_fifo<fifo_data_t>& fifo,
+        fifo_data_t*& elements,
+        const size_t elements_requested,
+        const int32_t timeout_ms,
+        size_t& elements_acquired,
+        size_t& elements_remaining)
+    {
+        if (!_busy_poll) {
+            return fifo.acquire(elements,
+                elements_requested,
+                static_cast<uint32_t>(timeout_ms),
+                elements_acquired,
+                elements_remaining);
+        }
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (true) {
+            const nirio_status status = fifo.acquire(
+                elements, elements_requested, 0, elements_acquired, elements_remaining);
+            if (status != NiRio_Status_FifoTimeout
+                || (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline)) {
+                return status;
+            }
+        }
+    }
+
+    /*! Acquire the next batch of receive frames
+     *
+     * Only the frames the FIFO reported as available during the last acquire
+     * are requested, so a batch never waits longer than a single frame would.
+     *
+     * \returns true if at least one frame was acquired
+     */
+    UHD_FORCE_INLINE bool _acquire_recv_batch(const int32_t timeout_ms)
+    {
+        using namespace uhd::niusrprio;
+        const size_t num_frames = std::max<size_t>(
+            1, std::min(_recv_batch_frames, _recv_elems_available / _recv_frame_elems));
+        nirio_status status   = 0;
+        size_t elems_acquired = 0;
+        nirio_status_chain(_acquire(*_recv_fifo,
+                               _recv_batch_ptr,
+                               num_frames * _recv_frame_elems,
+                               timeout_ms,
+                               elems_acquired,
+                               _recv_elems_available),
+            status);
+
+        if (nirio_status_not_fatal(status)) {
+            _recv_batch_left = elems_acquired / _recv_frame_elems;
+            return _recv_batch_left > 0;
+        } else if (status == NiRio_Status_CommunicationTimeout) {
+            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
+        }
+        return false;
+    }
+
+    //! Grant all released receive frames back to the DMA engine
+    UHD_FORCE_INLINE void _release_recv_elems()
+    {
+        if (_recv_elems_to_release > 0) {
+            _recv_fifo->release(_recv_elems_to_release);
+            _recv_elems_to_release = 0;
+        }
+    }
+
     /**************************************************************************
      * Private attributes
      *************************************************************************/
@@ -217,6 +305,22 @@ private:
 
     const link_params_t _link_params;
 
+    //! Number of FIFO elements in a receive frame
+    const size_t _recv_frame_elems;
+    //! Maximum number of receive frames to acquire or release at once
+    const size_t _recv_batch_frames;
+    //! Spin on non-blocking acquires instead of waiting in the driver
+    const bool _busy_poll;
+
+    //! Next frame of the current receive batch
+    fifo_data_t* _recv_batch_ptr = nullptr;
+    //! Number of frames left in the current receive batch
+    size_t _recv_batch_left = 0;
+    //! Number of elements the FIFO reported as available during the last acquire
+    size_t _recv_elems_available = 0;
+    //! Number of elements released by the user, but not yet granted to the FIFO
+    size_t _recv_elems_to_release = 0;
+
     std::vector<nirio_frame_buff> _recv_buffs;
     std::vector<nirio_frame_buff> _send_buffs;
 
@@ -0,0 +1,221 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/exception.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/utils/noncopyable.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uhd { namespace transport {
+
+/*! Continuously receive into a ring of blocks
+ *
+ * A thread calls recv() into a fixed set of blocks. Completed blocks are
+ * handed out by get(), and go back into the ring when they are passed to
+ * release(). If the consumer holds on to all blocks, the receive thread
+ * stalls until a block is released.
+ *
+ * A new block is started after an overflow, so the timestamp in the metadata
+ * of every block refers to its first sample, and the samples within a block
+ * are contiguous.
+ */
+class rx_ring : uhd::noncopyable
+{
+public:
+    struct block_t
+    {
+        size_t num_samps = 0;
+        uhd::rx_metadata_t metadata;
+    };
+
+    /*!
+     * \param rx_stream The streamer to receive from
+     * \param bytes_per_samp The size of a sample in the CPU format of \p rx_stream
+     * \param num_blocks The number of blocks in the ring
+     * \param block_size The capacity of a block, in samples per channel
+     * \throws uhd::value_error if any of the sizes is zero
+     */
+    rx_ring(uhd::rx_streamer::sptr rx_stream,
+        const size_t bytes_per_samp,
+        const size_t num_blocks,
+        const size_t block_size)
+        : _rx_stream(rx_stream)
+        , _num_chans(rx_stream->get_num_channels())
+        , _bytes_per_samp(bytes_per_samp)
+        , _block_size(block_size)
+        , _blocks(num_blocks)
+        , _storage(num_blocks * _num_chans * block_size * bytes_per_samp)
+        , _free(num_blocks)
+        , _full(num_blocks)
+    {
+        if (num_blocks == 0 or block_size == 0 or bytes_per_samp == 0) {
+            throw uhd::value_error(
+                "rx_ring: num_blocks, block_size and the sample size must be nonzero");
+        }
+        for (size_t i = 0; i < num_blocks; i++) {
+            _free.push_with_haste(i);
+        }
+    }
+
+    ~rx_ring()
+    {
+        stop();
+    }
+
+    //! Start the receive thread. Streaming is controlled by the caller.
+    void start()
+    {
+        if (_thread.joinable()) {
+            return;
+        }
+        _error.clear();
+        _running = true;
+        _thread  = std::thread([this]() { _recv_loop(); });
+    }
+
+    //! Stop the receive thread. Blocks already handed out remain valid.
+    void stop()
+    {
+        _running = false;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    /*! Get the index of the next completed block
+     *
+     * \return false on timeout
+     * \throws uhd::runtime_error if the receive thread stopped on an error
+     */
+    bool get(size_t& index, const double timeout)
+    {
+        if (_full.pop_with_timed_wait(index, timeout)) {
+            return true;
+        }
+        // _error is written before _running is cleared
+        if (!_running and !_error.empty()) {
+            throw uhd::runtime_error(_error);
+        }
+        return false;
+    }
+
+    //! Return a block that was handed out by get() to the ring
+    void release(const size_t index)
+    {
+        _free.push_with_haste(index);
+    }
+
+    //! Return the sample count and metadata of a block handed out by get()
+    const block_t& get_block(const size_t index) const
+    {
+        return _blocks[index];
+    }
+
+    //! Return the samples of channel \p chan in block \p index
+    char* get_block_ptr(const size_t index, const size_t chan)
+    {
+        return _storage.data()
+               + ((index * _num_chans) + chan) * _block_size * _bytes_per_samp;
+    }
+
+    size_t get_num_chans() const
+    {
+        return _num_chans;
+    }
+
+    size_t get_block_size() const
+    {
+        return _block_size;
+    }
+
+    //! Number of overflows reported by the streamer
+    size_t get_num_overflows() const
+    {
+        return _num_overflows;
+    }
+
+    //! Number of times the receive thread found no free block
+    size_t get_num_stalls() const
+    {
+        return _num_stalls;
+    }
+
+private:
+    void _recv_loop()
+    {
+        // Short enough to notice stop() in time
+        constexpr double POLL_TIMEOUT = 0.1;
+        std::vector<void*> buffs(_num_chans);
+        size_t index;
+        while (_running) {
+            if (!_free.pop_with_haste(index)) {
+                _num_stalls++;
+                if (!_free.pop_with_timed_wait(index, POLL_TIMEOUT)) {
+                    continue;
+                }
+            }
+            block_t& blk = _blocks[index];
+            blk          = block_t();
+            uhd::rx_metadata_t md;
+            while (_running and blk.num_samps < _block_size) {
+                for (size_t chan = 0; chan < _num_chans; chan++) {
+                    buffs[chan] =
+                        get_block_ptr(index, chan) + blk.num_samps * _bytes_per_samp;
+                }
+                const size_t num_rx_samps = _rx_stream->recv(
+                    buffs, _block_size - blk.num_samps, md, POLL_TIMEOUT);
+                if (blk.num_samps == 0 and num_rx_samps > 0) {
+                    blk.metadata = md;
+                }
+                blk.num_samps += num_rx_samps;
+                if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
+                    // Samples after the gap go into a new block, so the
+                    // timestamp of every block stays meaningful
+                    _num_overflows++;
+                    if (blk.num_samps > 0) {
+                        break;
+                    }
+                } else if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                    // Not streaming (yet), or streaming stopped
+                    if (blk.num_samps > 0) {
+                        break;
+                    }
+                } else if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) {
+                    _error   = "rx_ring: Receiver error: " + md.strerror();
+                    _running = false;
+                }
+            }
+            if (blk.num_samps > 0) {
+                _full.push_with_haste(index);
+            } else {
+                _free.push_with_haste(index);
+            }
+        }
+    }
+
+    uhd::rx_streamer::sptr _rx_stream;
+    const size_t _num_chans;
+    const size_t _bytes_per_samp;
+    const size_t _block_size;
+    std::vector<block_t> _blocks;
+    std::vector<char> _storage;
+    bounded_buffer<size_t> _free;
+    bounded_buffer<size_t> _full;
+    std::thread _thread;
+    std::atomic<bool> _running{false};
+    std::atomic<size_t> _num_overflows{0};
+    std::atomic<size_t> _num_stalls{0};
+    std::string _error;
+};
+
+}} // namespace uhd::transport
@@ -105,6 +105,12 @@ public:
         }
     }
 
+    //! Disconnect a channel from the streamer, which releases its transport
+    virtual void disconnect_channel(const size_t channel)
+    {
+        _zero_copy_streamer.disconnect_channel(channel);
+    }
+
     //! Implementation of rx_streamer API method
     size_t get_num_channels() const
     {
@@ -132,65 +138,15 @@ public:
         const double timeout,
         const bool one_packet)
     {
-        if (_error_metadata_cache.check(metadata)) {
-            return 0;
-        }
-
-        if (nsamps_per_buff == 0) {
-            metadata.reset();
-            return 0;
-        }
-
-        const int32_t timeout_ms = static_cast<int32_t>(timeout * 1000);
-
-        detail::eov_data_wrapper eov_positions(metadata);
-
-        size_t total_samps_recv =
-            _recv_one_packet(buffs, nsamps_per_buff, metadata, eov_positions, timeout_ms);
-
-        if (one_packet or metadata.end_of_burst
-            or (eov_positions.data() and eov_positions.remaining() == 0)) {
-            return total_samps_recv;
-        }
+        const size_t num_samps =
+            _recv(buffs, nsamps_per_buff, metadata, timeout, one_packet);
 
-        // First set of packets recv had an error, return immediately
-        if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
-            return total_samps_recv;
+        // The packets only carry the tick count. It is converted to a
+        // time_spec once per call, for the metadata that gets returned.
+        if (metadata.time_ticks.is_valid()) {
+            metadata.time_spec = metadata.time_ticks.to_time_spec();
         }
-
-        // Loop until buffer is filled or error code. This method returns the
-        // metadata from the first packet received, with the exception of
-        // end-of-burst and end-of-vector indications (if requested).
-        uhd::rx_metadata_t loop_metadata;
-
-        while (total_samps_recv < nsamps_per_buff) {
-            size_t num_samps = _recv_one_packet(buffs,
-                nsamps_per_buff - total_samps_recv,
-                loop_metadata,
-                eov_positions,
-                timeout_ms,
-                total_samps_recv * _convert_info.bytes_per_cpu_item);
-
-            // If metadata had an error code set, store for next call and return
-            if (loop_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
-                _error_metadata_cache.store(loop_metadata);
-                break;
-            }
-
-            total_samps_recv += num_samps;
-
-            // Return immediately if end of burst
-            if (loop_metadata.end_of_burst) {
-                metadata.end_of_burst = true;
-                break;
-            }
-            // Return if the end-of-vector position array has been exhausted
-            if (eov_positions.data() and eov_positions.remaining() == 0) {
-                break;
-            }
-        }
-
-        return total_samps_recv;
+        return num_samps;
     }
 
 protected:
@@ -254,6 +210,74 @@ private:
         size_t otw_item_bit_width;
     };
 
+    //! Receive samples, without filling in metadata.time_spec
+    UHD_FORCE_INLINE size_t _recv(const uhd::rx_streamer::buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t& metadata,
+        const double timeout,
+        const bool one_packet)
+    {
+        if (_error_metadata_cache.check(metadata)) {
+            return 0;
+        }
+
+        if (nsamps_per_buff == 0) {
+            metadata.reset();
+            return 0;
+        }
+
+        const int32_t timeout_ms = static_cast<int32_t>(timeout * 1000);
+
+        detail::eov_data_wrapper eov_positions(metadata);
+
+        size_t total_samps_recv =
+            _recv_one_packet(buffs, nsamps_per_buff, metadata, eov_positions, timeout_ms);
+
+        if (one_packet or metadata.end_of_burst
+            or (eov_positions.data() and eov_positions.remaining() == 0)) {
+            return total_samps_recv;
+        }
+
+        // First set of packets recv had an error, return immediately
+        if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            return total_samps_recv;
+        }
+
+        // Loop until buffer is filled or error code. This method returns the
+        // metadata from the first packet received, with the exception of
+        // end-of-burst and end-of-vector indications (if requested).
+        uhd::rx_metadata_t loop_metadata;
+
+        while (total_samps_recv < nsamps_per_buff) {
+            size_t num_samps = _recv_one_packet(buffs,
+                nsamps_per_buff - total_samps_recv,
+                loop_metadata,
+                eov_positions,
+                timeout_ms,
+                total_samps_recv * _convert_info.bytes_per_cpu_item);
+
+            // If metadata had an error code set, store for next call and return
+            if (loop_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+                _error_metadata_cache.store(loop_metadata);
+                break;
+            }
+
+            total_samps_recv += num_samps;
+
+            // Return immediately if end of burst
+            if (loop_metadata.end_of_burst) {
+                metadata.end_of_burst = true;
+                break;
+            }
+            // Return if the end-of-vector position array has been exhausted
+            if (eov_positions.data() and eov_positions.remaining() == 0) {
+                break;
+            }
+        }
+
+        return total_samps_recv;
+    }
+
     //! Receive a single packet
     UHD_FORCE_INLINE size_t _recv_one_packet(const uhd::rx_streamer::buffs_type& buffs,
         const size_t nsamps_per_buff,
@@ -270,7 +294,7 @@ private:
         } else {
             // There are samples still left in the current set of buffers
             metadata = _last_fragment_metadata;
-            metadata.time_spec += time_spec_t::from_ticks(
+            metadata.time_ticks.advance(
                 _fragment_offset_in_samps - metadata.fragment_offset, _samp_rate);
         }
 
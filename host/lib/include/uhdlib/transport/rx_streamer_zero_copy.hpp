@@ -122,6 +122,20 @@ public:
         _xports[port] = std::move(xport);
     }
 
+    //! Disconnect a channel from the streamer, releasing its transport
+    void disconnect_channel(const size_t port)
+    {
+        if (port >= get_num_channels()) {
+            throw uhd::index_error(
+                "Port number indexes beyond the number of streamer ports");
+        }
+
+        if (_frame_buffs[port]) {
+            _xports[port]->release_recv_buff(std::move(_frame_buffs[port]));
+        }
+        _xports[port].reset();
+    }
+
     //! Returns number of channels handled by this streamer
     size_t get_num_channels() const
     {
@@ -195,8 +209,7 @@ public:
                         break;
 
                     case get_aligned_buffs_t::SEQUENCE_ERROR:
-                        std::tie(metadata.has_time_spec, metadata.time_spec) =
-                            _last_read_time_info.get_next_packet_time(_samp_rate);
+                        _last_read_time_info.get_next_packet_time(metadata, _samp_rate);
                         metadata.out_of_sequence = true;
                         metadata.error_code      = rx_metadata_t::ERROR_CODE_OVERFLOW;
                         break;
@@ -218,8 +231,7 @@ public:
                 // that were buffered prior to the overrun. Call the overrun
                 // handler and return overrun error.
                 _handle_overrun();
-                std::tie(metadata.has_time_spec, metadata.time_spec) =
-                    _last_read_time_info.get_next_packet_time(_samp_rate);
+                _last_read_time_info.get_next_packet_time(metadata, _samp_rate);
                 metadata.error_code     = rx_metadata_t::ERROR_CODE_OVERFLOW;
                 _stopped_due_to_overrun = false;
                 return 0;
@@ -257,8 +269,10 @@ public:
         // Set the metadata from the buffer information at index zero
         const auto& info_0 = _infos[0];
 
+        // Only keep the exact tick count, the caller converts it to seconds
+        // if needed
         metadata.has_time_spec  = info_0.has_tsf;
-        metadata.time_spec      = time_spec_t::from_ticks(info_0.tsf, _tick_rate);
+        metadata.time_ticks     = time_ticks_t(info_0.tsf, _tick_rate);
         metadata.start_of_burst = false;
         metadata.end_of_burst   = eob;
         metadata.error_code     = rx_metadata_t::ERROR_CODE_NONE;
@@ -274,7 +288,7 @@ public:
 
         // Done with these packets, save timestamp info for next call
         _last_read_time_info.has_time_spec = metadata.has_time_spec;
-        _last_read_time_info.time_spec     = metadata.time_spec;
+        _last_read_time_info.time_ticks    = metadata.time_ticks;
         _last_read_time_info.num_samps     = info_0.payload_bytes / _bytes_per_item;
         eov_positions.update_running_sample_count(_last_read_time_info.num_samps);
 
@@ -329,15 +343,18 @@ private:
     {
         size_t num_samps   = 0;
         bool has_time_spec = false;
-        time_spec_t time_spec;
+        time_ticks_t time_ticks;
 
-        std::tuple<bool, time_spec_t> get_next_packet_time(double samp_rate)
+        //! Write the time of the packet following the last one into \p metadata
+        void get_next_packet_time(rx_metadata_t& metadata, double samp_rate) const
         {
+            metadata.has_time_spec = has_time_spec;
             if (has_time_spec) {
-                return std::make_tuple(
-                    true, time_spec + time_spec_t::from_ticks(num_samps, samp_rate));
+                metadata.time_ticks = time_ticks;
+                metadata.time_ticks.advance(num_samps, samp_rate);
             } else {
-                return std::make_tuple(false, time_spec_t());
+                metadata.time_ticks = time_ticks_t();
+                metadata.time_spec  = time_spec_t();
             }
         }
     };
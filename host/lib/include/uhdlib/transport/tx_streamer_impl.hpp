@@ -42,8 +42,10 @@ public:
         if (_cached_metadata) {
             // Only use cached time_spec if metadata does not have one
             if (!metadata.has_time_spec) {
-                metadata.has_time_spec = _metadata_cache.has_time_spec;
-                metadata.time_spec     = _metadata_cache.time_spec;
+                metadata.has_time_spec  = _metadata_cache.has_time_spec;
+                metadata.time_spec      = _metadata_cache.time_spec;
+                metadata.time_ticks     = _metadata_cache.time_ticks;
+                metadata.has_time_ticks = _metadata_cache.has_time_ticks;
             }
             metadata.start_of_burst = _metadata_cache.start_of_burst;
             metadata.end_of_burst   = _metadata_cache.end_of_burst;
@@ -127,6 +129,12 @@ public:
         }
     }
 
+    //! Disconnect a channel from the streamer, which releases its transport
+    virtual void disconnect_channel(const size_t channel)
+    {
+        _zero_copy_streamer.disconnect_channel(channel);
+    }
+
     size_t get_num_channels() const
     {
         return _zero_copy_streamer.get_num_channels();
@@ -161,6 +169,11 @@ public:
 
         const bool eob_on_last_packet = metadata.end_of_burst;
 
+        // The time of every fragment is computed from the time of the first
+        // sample, so that rounding errors don't add up over the fragments
+        const time_spec_t first_time   = metadata.time_spec;
+        const time_ticks_t first_ticks = metadata.time_ticks;
+
         const int32_t timeout_ms = static_cast<int32_t>(timeout * 1000);
 
         detail::tx_eov_data_wrapper eov_positions(metadata);
@@ -270,9 +283,7 @@ public:
 
                     // Setup timespec for the next fragment
                     if (metadata.has_time_spec) {
-                        metadata.time_spec =
-                            metadata.time_spec
-                            + time_spec_t::from_ticks(num_samps_sent, _samp_rate);
+                        _set_time(metadata, first_time, first_ticks, total_nsamps_sent);
                     }
 
                     metadata.start_of_burst = false;
@@ -300,9 +311,7 @@ public:
             // trip around the do/while loop, update the timespec in the
             // metadata for the next fragment (if desired)
             if (nsamps_to_send_remaining > 0 and metadata.has_time_spec) {
-                metadata.time_spec =
-                    metadata.time_spec
-                    + time_spec_t::from_ticks(num_samps_sent, _samp_rate);
+                _set_time(metadata, first_time, first_ticks, total_nsamps_sent);
             }
 
             last_eov_position = total_nsamps_sent;
@@ -359,6 +368,21 @@ private:
         size_t otw_item_bit_width;
     };
 
+    //! Set the time of the next sample to send, \p num_samps after the first one
+    UHD_FORCE_INLINE void _set_time(tx_metadata_t& metadata,
+        const time_spec_t& first_time,
+        const time_ticks_t& first_ticks,
+        const size_t num_samps)
+    {
+        if (metadata.has_time_ticks) {
+            metadata.time_ticks =
+                time_ticks_t(first_ticks).advance(num_samps, _samp_rate);
+        } else {
+            metadata.time_spec =
+                first_time + time_spec_t::from_ticks(num_samps, _samp_rate);
+        }
+    }
+
     //! Convert samples for one channel and sends a packet
     size_t _send_one_packet(const uhd::tx_streamer::buffs_type& buffs,
         const size_t buffer_offset_in_samps,
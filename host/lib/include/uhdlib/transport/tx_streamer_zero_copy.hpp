@@ -44,6 +44,17 @@ public:
         _xports[port] = std::move(xport);
     }
 
+    //! Disconnect a channel from the streamer, releasing its transport
+    void disconnect_channel(const size_t port)
+    {
+        if (port >= get_num_channels()) {
+            throw uhd::index_error(
+                "Port number indexes beyond the number of streamer ports");
+        }
+
+        _xports[port].reset();
+    }
+
     //! Returns number of channels handled by this streamer
     size_t get_num_channels() const
     {
@@ -102,7 +113,9 @@ public:
         info.has_tsf = metadata.has_time_spec;
 
         if (metadata.has_time_spec) {
-            info.tsf = metadata.time_spec.to_ticks(_tick_rate);
+            info.tsf = metadata.has_time_ticks
+                           ? metadata.time_ticks.to_ticks(_tick_rate)
+                           : metadata.time_spec.to_ticks(_tick_rate);
         }
 
         info.payload_bytes = nsamps_per_buff * _bytes_per_item;
@@ -83,6 +83,20 @@ public:
         return _queue;
     }
 
+    /*!
+     * Set the DMA queue associated with this link
+     *
+     * This is done by the I/O service when the link is attached to it. All
+     * packets of this link are then sent on that queue, and the received
+     * packets are steered to it (if the NIC supports it).
+     *
+     * \param queue the queue ID for this link's DMA queue
+     */
+    inline void set_queue_id(dpdk::queue_id_t queue)
+    {
+        _queue = queue;
+    }
+
     /*!
      * Get the local UDP port used by this link
      *
@@ -217,14 +231,26 @@ public:
      */
     frame_buff::uptr get_send_buff(int32_t /*timeout_ms*/);
 
+    /*!
+     * Get multiple empty frame buffers at once. This is equivalent to calling
+     * get_send_buff() num_buffs times, but allocates the packet buffers in
+     * bulk.
+     *
+     * \param buffs array to store the frame buffers
+     * \param num_buffs number of frame buffers to get
+     * \return num_buffs on success, or 0 if not enough buffers were available
+     */
+    size_t get_send_buffs(dpdk::dpdk_frame_buff** buffs, size_t num_buffs);
+
     /*!
      * Send a packet with the contents of the frame buffer and release the
      * buffer, allowing the link driver to reuse it. If the size of the frame
      * buffer is 0, the buffer is released with no packet being sent.
      *
-     * Note that this function will only fill in the L2 header and send the
-     * mbuf. The L3 and L4 headers, in addition to the lengths in the rte_mbuf
-     * fields, must be set in the I/O service.
+     * Note that this function will only fill in the L2 header and queue the
+     * mbuf for transmission on the link's DMA queue. The owning I/O service
+     * flushes the queue. The L3 and L4 headers, in addition to the lengths in
+     * the rte_mbuf fields, must be set in the I/O service.
      *
      * \param buffer frame buffer containing packet data
      *
@@ -257,7 +283,7 @@ private:
     adapter_id_t _adapter_id;
     //! The RX frame buff list head
     dpdk::dpdk_frame_buff* _recv_buff_head = nullptr;
-    // TODO: Implement ability to use multiple queues
+    //! The DMA queue used by this link, assigned by the I/O service
     dpdk::queue_id_t _queue = 0;
 };
 
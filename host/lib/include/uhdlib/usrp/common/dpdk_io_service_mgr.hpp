@@ -28,7 +28,12 @@ public:
         const uhd::device_addr_t& /*stream_args*/,
         const std::string& /*streamer_id*/)
     {
-        auto io_srv = _get_io_service(recv_link, send_link);
+        // Spread the links over all the I/O services (i.e., DMA queues and
+        // lcores) of the port
+        auto link   = _get_link(recv_link, send_link);
+        auto io_srv = _dpdk_ctx->get_least_loaded_io_service(
+            link->get_port()->get_port_id());
+        UHD_ASSERT_THROW(io_srv);
         io_srv->attach_recv_link(recv_link);
         io_srv->attach_send_link(send_link);
         return io_srv;
@@ -37,27 +42,26 @@ public:
     void disconnect_links(
         transport::recv_link_if::sptr recv_link, transport::send_link_if::sptr send_link)
     {
-        auto io_srv = _get_io_service(recv_link, send_link);
+        // The link was assigned the DMA queue of its I/O service on attach
+        auto link   = _get_link(recv_link, send_link);
+        auto io_srv = _dpdk_ctx->get_io_service(
+            link->get_port()->get_port_id(), link->get_queue_id());
+        UHD_ASSERT_THROW(io_srv);
         io_srv->detach_recv_link(recv_link);
         io_srv->detach_send_link(send_link);
     }
 
 private:
-    transport::io_service::sptr _get_io_service(
+    std::shared_ptr<transport::udp_dpdk_link> _get_link(
         transport::recv_link_if::sptr recv_link, transport::send_link_if::sptr send_link)
     {
-        using namespace transport::dpdk;
-
         // For DPDK, the same object implements the send and recv link
         // interfaces so we should always have both parameters.
         UHD_ASSERT_THROW(recv_link && send_link);
 
         auto link = std::dynamic_pointer_cast<transport::udp_dpdk_link>(recv_link);
-        port_id_t port_id = link->get_port()->get_port_id();
-
-        auto io_srv = _dpdk_ctx->get_io_service(port_id);
-        UHD_ASSERT_THROW(io_srv);
-        return io_srv;
+        UHD_ASSERT_THROW(link);
+        return link;
     }
 
     transport::dpdk::dpdk_ctx::sptr _dpdk_ctx;
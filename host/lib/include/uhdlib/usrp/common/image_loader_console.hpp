@@ -0,0 +1,79 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/image_loader.hpp>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+namespace uhd { namespace usrp {
+
+/*! Output stream for the status messages of an image loader
+ *
+ * If the message callback of the image loader arguments is set, the output is
+ * split into lines, which are passed to the callback. When a line is
+ * overwritten with "\r", only its last state is passed on. Any incomplete line
+ * is passed on when the stream is destroyed.
+ *
+ * Without a callback, the output goes straight to std::cout.
+ */
+class image_loader_console : public std::ostream
+{
+public:
+    image_loader_console(const image_loader::message_fcn_t& message)
+        : std::ostream(nullptr), _buf(message)
+    {
+        rdbuf(message ? static_cast<std::streambuf*>(&_buf) : std::cout.rdbuf());
+    }
+
+    ~image_loader_console()
+    {
+        _buf.flush_line();
+    }
+
+private:
+    class line_buf : public std::streambuf
+    {
+    public:
+        line_buf(const image_loader::message_fcn_t& message) : _message(message) {}
+
+        void flush_line()
+        {
+            if (not _line.empty()) {
+                _message(_line);
+                _line.clear();
+            }
+        }
+
+    protected:
+        int overflow(int c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            const char ch = traits_type::to_char_type(c);
+            if (ch == '\n') {
+                _message(_line);
+                _line.clear();
+            } else if (ch == '\r') {
+                _line.clear();
+            } else {
+                _line.push_back(ch);
+            }
+            return c;
+        }
+
+    private:
+        image_loader::message_fcn_t _message;
+        std::string _line;
+    };
+
+    line_buf _buf;
+};
+
+}} // namespace uhd::usrp
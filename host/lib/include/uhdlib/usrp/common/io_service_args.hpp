@@ -8,6 +8,7 @@
 
 #include <uhd/types/device_addr.hpp>
 #include <map>
+#include <vector>
 
 namespace uhd { namespace usrp {
 
@@ -23,11 +24,22 @@ namespace uhd { namespace usrp {
  *                         thread, set to "block" to use a blocking strategy.
  * send_offload_wait_mode: set to "poll" to use a polling strategy in the offload
  *                         thread, set to "block" to use a blocking strategy.
+ * recv_adaptive_wait: set to "true" to have an inline I/O service poll RX_DATA
+ *                     links for a self-tuned amount of time before it blocks,
+ *                     "false" to block right away.
+ * send_adaptive_wait: set to "true" to have an inline I/O service poll TX_DATA
+ *                     links for flow control packets for a self-tuned amount
+ *                     of time before it blocks, "false" to block right away.
+ * adaptive_wait_max_spin_us: the maximum time, in microseconds, an adaptive
+ *                            wait polls before it blocks. The default is 100.
  * num_poll_offload_threads: set to the total number of offload threads to use for
  *                           RX_DATA and TX_DATA in this rfnoc_graph. New connections
- *                           always go to the offload thread containing the fewest
- *                           connections, with lowest numbered thread as a second
+ *                           always go to the offload thread with the lowest
+ *                           stream_load, with the fewest connections as a second
  *                           criterion. The default is 1.
+ * stream_load: the estimated load of the stream in bytes per second. This is
+ *              set by the graph stream manager when the sample rate of a stream
+ *              is known, and only read from the stream args.
  * recv_offload_thread_<N>_cpu: an integer to specify cpu affinity of the offload
  *                              thread. N indicates the thread instance, starting
  *                              with 0 for each streamer and ending with the number
@@ -42,6 +54,11 @@ namespace uhd { namespace usrp {
  *                              thread. N indicates the thread instance, starting
  *                              with 0 and up to num_poll_offload_threads minus 1.
  *                              Only used if the I/O service is configured to poll.
+ * cpu_affinity: a list of CPUs, e.g. "4-7", for offload threads that have no
+ *               CPU assigned by one of the args above. Threads created for a
+ *               stream by a polling I/O service are shared with other streams.
+ * numa_node: an integer to place offload threads on all CPUs of a NUMA node,
+ *            if cpu_affinity is not specified.
  */
 struct io_service_args_t
 {
@@ -59,9 +76,21 @@ struct io_service_args_t
     //! Whether the offload thread should poll or block
     wait_mode_t send_offload_wait_mode = BLOCK;
 
+    //! Whether inline I/O services poll RX_DATA links before they block
+    bool recv_adaptive_wait = false;
+
+    //! Whether inline I/O services poll TX_DATA links before they block
+    bool send_adaptive_wait = false;
+
+    //! Maximum time an adaptive wait polls before it blocks, in microseconds
+    double adaptive_wait_max_spin_us = 100.0;
+
     //! Number of polling threads to use, if wait_mode is set to POLL
     size_t num_poll_offload_threads = 1;
 
+    //! Estimated load of the stream in bytes per second, 0 if unknown
+    double stream_load = 0.0;
+
     //! CPU affinity of offload threads, if wait_mode is set to BLOCK
     std::map<size_t, size_t> recv_offload_thread_cpu;
 
@@ -70,6 +99,9 @@ struct io_service_args_t
 
     //! CPU affinity of offload threads, if wait_mode is set to POLL
     std::map<size_t, size_t> poll_offload_thread_cpu;
+
+    //! CPU affinity of offload threads without a thread specific affinity
+    std::vector<size_t> cpu_affinity;
 };
 
 /*! Reads I/O service args from provided dictionary
@@ -32,7 +32,8 @@ namespace uhd { namespace usrp {
  * If polling I/O services are requested, the I/O service manager instantiates
  * the number of I/O services specified by the user through args. It chooses
  * which I/O service to connect a set of links to by selecting the I/O service
- * with the fewest number of connections.
+ * with the lowest load (the sum of the stream_load args of its connections),
+ * and the fewest number of connections if the loads are equal.
  *
  * If blocking I/O services are requested, the I/O service manager instantiates
  * one offload I/O service for each transport adapter used by a streamer. When
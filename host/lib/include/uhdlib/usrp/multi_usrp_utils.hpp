@@ -0,0 +1,44 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uhd { namespace usrp {
+
+/*! Apply a setting to several channels, one radio after the other
+ *
+ * \p chans is a list of (radio block ID, channel) pairs. The channels are
+ * visited one radio after the other, so the register writes for a block go out
+ * back to back. Channels of the same radio keep their order.
+ *
+ * Property propagation is not held off. The graph resolves every setting
+ * before the next channel is visited, so the values that \p chan_fn reads back
+ * (e.g., the actual frequency) are final.
+ *
+ * If \p chan_fn throws, the remaining channels are skipped, and the exception
+ * is passed on.
+ *
+ * \param chans The channels, and the ID of the radio block of each
+ * \param chan_fn Gets called with the channel for every entry of \p chans
+ */
+template <typename chan_fn_t>
+void for_each_chan_by_radio(
+    std::vector<std::pair<std::string, size_t>> chans, chan_fn_t&& chan_fn)
+{
+    std::stable_sort(chans.begin(), chans.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (const auto& chan : chans) {
+        chan_fn(chan.second);
+    }
+}
+
+}} // namespace uhd::usrp
@@ -0,0 +1,31 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#pragma once
+
+#include <uhd/types/device_addr.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd {
+
+/*! Read the CPUs to place threads on from device or stream args
+ *
+ * The args may contain:
+ * - cpu_affinity: a list of CPUs, as accepted by uhd::parse_cpu_list()
+ * - numa_node: the number of a NUMA node, to use all of its CPUs
+ *
+ * If both are given, cpu_affinity takes precedence.
+ *
+ * \return list of CPU numbers, empty if the threads should not be pinned
+ * \throw uhd::value_error if cpu_affinity is malformed
+ */
+std::vector<size_t> read_cpu_placement(const device_addr_t& args);
+
+//! Format a list of CPUs for log messages, e.g. "0-3,8"
+std::string format_cpu_list(const std::vector<size_t>& cpu_affinity_list);
+
+} // namespace uhd
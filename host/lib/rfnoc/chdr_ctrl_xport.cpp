@@ -42,8 +42,15 @@ chdr_ctrl_xport::chdr_ctrl_xport(io_service::sptr io_srv,
             this->_release_cb(std::move(buff), link);
         };
 
-    _ctrl_recv_if = io_srv->make_recv_client(
-        recv_link, num_recv_frames, ctrl_recv_cb, send_link_if::sptr(), 0, release_cb);
+    const recv_route_t recv_route{pkt_factory.get_dst_epid_fn(), my_epid};
+
+    _ctrl_recv_if = io_srv->make_recv_client(recv_link,
+        num_recv_frames,
+        ctrl_recv_cb,
+        send_link_if::sptr(),
+        0,
+        release_cb,
+        recv_route);
 
     uhd::transport::recv_callback_t mgmt_recv_cb =
         [this](frame_buff::uptr& buff,
@@ -51,7 +58,7 @@ chdr_ctrl_xport::chdr_ctrl_xport(io_service::sptr io_srv,
             send_link_if * /*send_link*/) -> bool { return this->_mgmt_recv_cb(buff); };
 
     _mgmt_recv_if = io_srv->make_recv_client(
-        recv_link, 1, mgmt_recv_cb, send_link_if::sptr(), 0, release_cb);
+        recv_link, 1, mgmt_recv_cb, send_link_if::sptr(), 0, release_cb, recv_route);
 }
 
 bool chdr_ctrl_xport::_ctrl_recv_cb(uhd::transport::frame_buff::uptr& buff)
@@ -220,3 +220,19 @@ chdr_mgmt_packet::uptr chdr_packet_factory::make_mgmt(size_t mtu_bytes) const
 {
     return std::make_unique<chdr_mgmt_packet>(make_generic(mtu_bytes));
 }
+
+chdr_packet_factory::dst_epid_fn_t chdr_packet_factory::get_dst_epid_fn() const
+{
+    // The header is the first 64 bits of a packet, regardless of the CHDR width
+    if (_endianness == ENDIANNESS_BIG) {
+        return [](const void* pkt_buff) -> uint16_t {
+            const uint64_t header = *static_cast<const uint64_t*>(pkt_buff);
+            return chdr_header(uhd::ntohx<uint64_t>(header)).get_dst_epid();
+        };
+    } else {
+        return [](const void* pkt_buff) -> uint16_t {
+            const uint64_t header = *static_cast<const uint64_t*>(pkt_buff);
+            return chdr_header(uhd::wtohx<uint64_t>(header)).get_dst_epid();
+        };
+    }
+}
@@ -38,7 +38,7 @@ chdr_rx_data_xport::chdr_rx_data_xport(uhd::transport::io_service::sptr io_srv,
     const size_t num_recv_frames,
     const fc_params_t& fc_params,
     disconnect_callback_t disconnect)
-    : _fc_state(epids, fc_params.freq)
+    : _fc_state(epids, fc_params.freq, fc_params.buff_capacity)
     , _fc_sender(pkt_factory, epids)
     , _epid(epids.second)
     , _chdr_w_bytes(chdr_w_to_bits(pkt_factory.get_chdr_w()) / 8)
@@ -74,7 +74,8 @@ chdr_rx_data_xport::chdr_rx_data_xport(uhd::transport::io_service::sptr io_srv,
         recv_cb,
         send_link,
         /* num_send_frames*/ 1,
-        fc_cb);
+        fc_cb,
+        {pkt_factory.get_dst_epid_fn(), _epid});
 
     UHD_LOG_TRACE("XPORT::RX_DATA_XPORT",
         "Stream endpoint was configured with:"
@@ -161,7 +162,8 @@ chdr_rx_data_xport::fc_params_t chdr_rx_data_xport::configure_sep(io_service::sp
         recv_cb,
         send_link,
         1, // num_send_frames
-        fc_cb);
+        fc_cb,
+        {pkt_factory.get_dst_epid_fn(), local_epid});
 
     // Create a control transport with the rx data links to send mgmt packets
     // needed to setup the stream
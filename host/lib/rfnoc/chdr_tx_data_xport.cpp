@@ -73,7 +73,8 @@ chdr_tx_data_xport::chdr_tx_data_xport(uhd::transport::io_service::sptr io_srv,
         recv_link,
         /* num_recv_frames */ 1,
         recv_cb,
-        fc_cb);
+        fc_cb,
+        {pkt_factory.get_dst_epid_fn(), _epid});
 }
 
 chdr_tx_data_xport::~chdr_tx_data_xport()
@@ -140,7 +141,8 @@ static chdr_tx_data_xport::fc_params_t configure_flow_ctrl(io_service::sptr io_s
         recv_cb,
         nullptr,
         0, // num_send_frames
-        fc_cb);
+        fc_cb,
+        {pkt_factory.get_dst_epid_fn(), epids.first});
 
     // Function to send a strc init
     auto send_strc_init = [&send_io, epids, &strc_packet](
@@ -33,6 +33,8 @@ constexpr double DEFAULT_TIMEOUT = 1.0;
 constexpr double MASSIVE_TIMEOUT = 10.0;
 //! Default value for whether ACKs are always required
 constexpr bool DEFAULT_FORCE_ACKS = false;
+//! Default value for whether timed commands that share a timestamp are coalesced
+constexpr bool DEFAULT_COALESCE_TIMED = true;
 } // namespace
 
 ctrlport_endpoint::~ctrlport_endpoint() = default;
@@ -201,6 +203,8 @@ public:
         if (name == "default") {
             _policy.timeout    = args.cast<double>("timeout", DEFAULT_TIMEOUT);
             _policy.force_acks = DEFAULT_FORCE_ACKS;
+            _policy.coalesce_timed =
+                args.cast<bool>("coalesce_timed", DEFAULT_COALESCE_TIMED);
         } else {
             // TODO: Uncomment when custom policies are implemented
             throw uhd::not_implemented_error("Policy implemented in the FPGA");
@@ -220,7 +224,7 @@ public:
                     resp_status = RESP_SIZEERR;
                 }
                 // Pop the request from the queue
-                _req_queue.pop_front();
+                pop_request();
                 // Push the response into the response queue
                 _resp_queue.push(std::make_tuple(rx_ctrl, resp_status));
                 _resp_ready_cond.notify_one();
@@ -236,7 +240,7 @@ public:
                 _resp_queue.push(std::make_tuple(resp, RESP_DROPPED));
                 _resp_ready_cond.notify_one();
                 // Pop the request from the queue
-                _req_queue.pop_front();
+                pop_request();
             };
 
             // Peek at the request queue to check the expected sequence number
@@ -340,12 +344,16 @@ private:
     //! Returns whether or not we have a timed command queued
     bool check_timed_in_queue() const
     {
-        for (const auto& pyld : _req_queue) {
-            if (pyld.has_timestamp()) {
-                return true;
-            }
+        return _num_timed_in_queue > 0;
+    }
+
+    //! Pops the oldest outstanding request and updates the timed command count
+    void pop_request()
+    {
+        if (_req_queue.front().has_timestamp()) {
+            _num_timed_in_queue--;
         }
-        return false;
+        _req_queue.pop_front();
     }
 
     //! Sends a request control packet to a remote device
@@ -369,6 +377,18 @@ private:
 
         std::unique_lock<std::mutex> lock(_mutex);
 
+        // Coalesce timed commands: The command queue executes in order, and
+        // a timed command stalls everything behind it until its time has
+        // come. If the most recent timed command that's still outstanding has
+        // the same timestamp, this command will execute right after it even
+        // without a timestamp. Dropping the timestamp saves two words of
+        // buffer space per command and keeps the queue free of redundant
+        // timed commands (e.g., when retuning many channels at once).
+        if (timestamp && _policy.coalesce_timed && check_timed_in_queue()
+            && _last_timestamp == timestamp.get()) {
+            timestamp = boost::none;
+        }
+
         // Assemble the control payload
         ctrl_payload tx_ctrl;
         tx_ctrl.dst_port    = _local_port;
@@ -406,6 +426,10 @@ private:
         }
         _buff_occupied += pyld_size;
         _req_queue.push_back(tx_ctrl);
+        if (timestamp) {
+            _num_timed_in_queue++;
+            _last_timestamp = timestamp.get();
+        }
 
         // Send the payload as soon as there is room in the buffer
         _handle_send(tx_ctrl, _policy.timeout);
@@ -470,8 +494,9 @@ private:
     //! The parameters associated with the policy that governs this object
     struct policy_args
     {
-        double timeout  = DEFAULT_TIMEOUT;
-        bool force_acks = DEFAULT_FORCE_ACKS;
+        double timeout      = DEFAULT_TIMEOUT;
+        bool force_acks     = DEFAULT_FORCE_ACKS;
+        bool coalesce_timed = DEFAULT_COALESCE_TIMED;
     };
     //! The software status (different from the transaction status) of the response
     enum response_status_t { RESP_VALID, RESP_DROPPED, RESP_RTERR, RESP_SIZEERR };
@@ -507,6 +532,10 @@ private:
     std::condition_variable _buff_free_cond;
     //! A queue that holds all outstanding requests
     std::deque<ctrl_payload> _req_queue;
+    //! The number of outstanding requests that carry a timestamp
+    size_t _num_timed_in_queue = 0;
+    //! The timestamp of the most recently sent timed request
+    uint64_t _last_timestamp = 0;
     //! A queue that holds all outstanding responses and their status
     std::queue<std::tuple<ctrl_payload, response_status_t>> _resp_queue;
     //! A condition variable that hold the "response is available" condition
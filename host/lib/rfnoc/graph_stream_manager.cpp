@@ -10,9 +10,11 @@
 #include <uhdlib/rfnoc/link_stream_manager.hpp>
 #include <uhdlib/transport/links.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
+#include <tuple>
 
 using namespace uhd;
 using namespace uhd::rfnoc;
@@ -27,6 +29,9 @@ public:
         const epid_allocator::sptr& epid_alloc,
         const std::vector<std::pair<device_id_t, mb_iface*>>& links)
         : _epid_alloc(epid_alloc)
+        , _chdr_hdr_bytes(pkt_factory.get_chdr_w() == CHDR_W_64
+                              ? 2 * sizeof(uint64_t)
+                              : chdr_w_to_bits(pkt_factory.get_chdr_w()) / 8)
     {
         for (const auto& lnk : links) {
             UHD_ASSERT_THROW(lnk.second);
@@ -35,7 +40,7 @@ public:
                     pkt_factory, *lnk.second, epid_alloc, lnk.first)));
             auto adapter = _link_mgrs.at(lnk.first)->get_adapter_id();
             if (_alloc_map.count(adapter) == 0) {
-                _alloc_map[adapter] = allocation_info{0, 0};
+                _alloc_map[adapter] = allocation_info{0, 0, 0.0, 0.0};
             }
         }
         for (const auto& mgr_pair : _link_mgrs) {
@@ -190,16 +195,23 @@ public:
         const sw_buff_t mdata_buff_fmt,
         const uhd::transport::adapter_id_t adapter,
         const device_addr_t& xport_args,
-        const std::string& streamer_id)
+        const std::string& streamer_id,
+        const double samp_rate = 0.0)
     {
-        device_id_t dev = _check_dst_and_find_src(
+        const double load = _estimate_load(pyld_buff_fmt, samp_rate);
+        device_id_t dev   = _check_dst_and_find_src(
             src_addr, adapter, uhd::transport::link_type_t::RX_DATA);
-        uhd::transport::adapter_id_t chosen = _link_mgrs.at(dev)->get_adapter_id();
-        auto allocs                         = _alloc_map.at(chosen);
-        allocs.rx++;
-        _alloc_map[chosen] = allocs;
-        return _link_mgrs.at(dev)->create_device_to_host_data_stream(
-            src_addr, pyld_buff_fmt, mdata_buff_fmt, xport_args, streamer_id);
+        auto xport = _link_mgrs.at(dev)->create_device_to_host_data_stream(src_addr,
+            pyld_buff_fmt,
+            mdata_buff_fmt,
+            _add_load_arg(xport_args, load),
+            streamer_id);
+        _allocate(dev,
+            streamer_id,
+            uhd::transport::link_type_t::RX_DATA,
+            samp_rate,
+            _add_overhead(load, xport->get_max_payload_size()));
+        return xport;
     }
 
     virtual chdr_tx_data_xport::uptr create_host_to_device_data_stream(
@@ -208,16 +220,68 @@ public:
         const sw_buff_t mdata_buff_fmt,
         const uhd::transport::adapter_id_t adapter,
         const device_addr_t& xport_args,
-        const std::string& streamer_id)
+        const std::string& streamer_id,
+        const double samp_rate = 0.0)
     {
-        device_id_t dev = _check_dst_and_find_src(
+        const double load = _estimate_load(pyld_buff_fmt, samp_rate);
+        device_id_t dev   = _check_dst_and_find_src(
             dst_addr, adapter, uhd::transport::link_type_t::TX_DATA);
-        uhd::transport::adapter_id_t chosen = _link_mgrs.at(dev)->get_adapter_id();
-        auto allocs                         = _alloc_map.at(chosen);
-        allocs.tx++;
-        _alloc_map[chosen] = allocs;
-        return _link_mgrs.at(dev)->create_host_to_device_data_stream(
-            dst_addr, pyld_buff_fmt, mdata_buff_fmt, xport_args, streamer_id);
+        auto xport = _link_mgrs.at(dev)->create_host_to_device_data_stream(dst_addr,
+            pyld_buff_fmt,
+            mdata_buff_fmt,
+            _add_load_arg(xport_args, load),
+            streamer_id);
+        _allocate(dev,
+            streamer_id,
+            uhd::transport::link_type_t::TX_DATA,
+            samp_rate,
+            _add_overhead(load, xport->get_max_payload_size()));
+        return xport;
+    }
+
+    std::vector<data_stream_alloc_t> get_data_stream_allocs(
+        const std::string& streamer_id) const
+    {
+        if (_stream_allocs.count(streamer_id) == 0) {
+            return {};
+        }
+        return _stream_allocs.at(streamer_id);
+    }
+
+    void release_data_streams(const std::string& streamer_id)
+    {
+        if (_stream_allocs.count(streamer_id) == 0) {
+            return;
+        }
+        for (const auto& stream_alloc : _stream_allocs.at(streamer_id)) {
+            _deallocate(stream_alloc);
+        }
+        _stream_allocs.erase(streamer_id);
+    }
+
+    void release_data_stream(
+        const std::string& streamer_id, const data_stream_alloc_t& alloc)
+    {
+        if (_stream_allocs.count(streamer_id) == 0) {
+            return;
+        }
+        auto& stream_allocs = _stream_allocs.at(streamer_id);
+        auto it             = std::find_if(stream_allocs.begin(),
+            stream_allocs.end(),
+            [&alloc](const data_stream_alloc_t& stream_alloc) {
+                return stream_alloc.adapter == alloc.adapter
+                       && stream_alloc.link_type == alloc.link_type
+                       && stream_alloc.samp_rate == alloc.samp_rate
+                       && stream_alloc.load == alloc.load;
+            });
+        if (it == stream_allocs.end()) {
+            return;
+        }
+        _deallocate(*it);
+        stream_allocs.erase(it);
+        if (stream_allocs.empty()) {
+            _stream_allocs.erase(streamer_id);
+        }
     }
 
     std::vector<uhd::transport::adapter_id_t> get_adapters(sep_addr_t addr) const
@@ -246,8 +310,9 @@ private:
         if (_src_map.count(dst_addr) > 0) {
             const auto& src_devs = _src_map.at(dst_addr);
             if (adapter == uhd::transport::NULL_ADAPTER_ID) {
-                // TODO: Maybe we can come up with a better heuristic for when the user
-                // gives no preference
+                // Data streams go to the adapter that carries the least load
+                // in their direction. Streams of unknown rate don't add load,
+                // so the number of streams is the second criterion.
                 auto dev       = src_devs[0];
                 auto dev_alloc = _alloc_map.at(_link_mgrs.at(dev)->get_adapter_id());
                 for (auto candidate : src_devs) {
@@ -255,13 +320,15 @@ private:
                         _alloc_map.at(_link_mgrs.at(candidate)->get_adapter_id());
                     switch (link_type) {
                         case uhd::transport::link_type_t::TX_DATA:
-                            if (candidate_alloc.tx < dev_alloc.tx) {
+                            if (std::tie(candidate_alloc.tx_load, candidate_alloc.tx)
+                                < std::tie(dev_alloc.tx_load, dev_alloc.tx)) {
                                 dev       = candidate;
                                 dev_alloc = candidate_alloc;
                             }
                             break;
                         case uhd::transport::link_type_t::RX_DATA:
-                            if (candidate_alloc.rx < dev_alloc.rx) {
+                            if (std::tie(candidate_alloc.rx_load, candidate_alloc.rx)
+                                < std::tie(dev_alloc.rx_load, dev_alloc.rx)) {
                                 dev       = candidate;
                                 dev_alloc = candidate_alloc;
                             }
@@ -286,8 +353,74 @@ private:
         }
     }
 
+    //! Return the payload rate of a stream in bytes per second (0 if unknown)
+    double _estimate_load(const sw_buff_t pyld_buff_fmt, const double samp_rate) const
+    {
+        // Streams carry complex samples, one I and one Q item per sample
+        return samp_rate * 2 * sw_buff_to_bytes(pyld_buff_fmt);
+    }
+
+    //! Add the CHDR header overhead to a payload rate, given the payload size
+    double _add_overhead(const double load, const size_t max_payload_size) const
+    {
+        if (max_payload_size == 0) {
+            return load;
+        }
+        return load * (max_payload_size + _chdr_hdr_bytes) / max_payload_size;
+    }
+
+    //! Pass the estimated load on to the I/O service manager
+    static device_addr_t _add_load_arg(const device_addr_t& xport_args, const double load)
+    {
+        device_addr_t args = xport_args;
+        if (load > 0.0) {
+            args["stream_load"] = std::to_string(load);
+        }
+        return args;
+    }
+
+    //! Record the allocation of a data stream on the adapter of a device
+    void _allocate(const device_id_t dev,
+        const std::string& streamer_id,
+        const uhd::transport::link_type_t link_type,
+        const double samp_rate,
+        const double load)
+    {
+        const uhd::transport::adapter_id_t chosen = _link_mgrs.at(dev)->get_adapter_id();
+        auto& allocs                              = _alloc_map.at(chosen);
+        if (link_type == uhd::transport::link_type_t::RX_DATA) {
+            allocs.rx++;
+            allocs.rx_load += load;
+        } else {
+            allocs.tx++;
+            allocs.tx_load += load;
+        }
+        _stream_allocs[streamer_id].push_back({chosen, link_type, samp_rate, load});
+        UHD_LOGGER_DEBUG("RFNOC::GRAPH")
+            << boost::format("Placed %s data stream of %s on adapter %d (%.1f MB/s). "
+                             "Adapter load is now RX %.1f MB/s (%d streams), "
+                             "TX %.1f MB/s (%d streams).")
+                   % (link_type == uhd::transport::link_type_t::RX_DATA ? "RX" : "TX")
+                   % streamer_id % chosen % (load / 1e6) % (allocs.rx_load / 1e6)
+                   % allocs.rx % (allocs.tx_load / 1e6) % allocs.tx;
+    }
+
+    void _deallocate(const data_stream_alloc_t& stream_alloc)
+    {
+        auto& allocs = _alloc_map.at(stream_alloc.adapter);
+        if (stream_alloc.link_type == uhd::transport::link_type_t::RX_DATA) {
+            allocs.rx--;
+            allocs.rx_load -= stream_alloc.load;
+        } else {
+            allocs.tx--;
+            allocs.tx_load -= stream_alloc.load;
+        }
+    }
+
     // The cached EPID allocator object
     epid_allocator::sptr _epid_alloc;
+    // The number of bytes of CHDR header (including the timestamp) per data packet
+    const size_t _chdr_hdr_bytes;
     // A map the contains all link manager indexed by the device ID
     std::map<device_id_t, link_stream_manager::uptr> _link_mgrs;
     // A set of the addresses of all devices reachable from this graph
@@ -300,10 +433,15 @@ private:
     {
         size_t rx;
         size_t tx;
+        // Estimated load in bytes per second
+        double rx_load;
+        double tx_load;
     };
 
     // A map of allocations for each host transport adapter
     std::map<uhd::transport::adapter_id_t, allocation_info> _alloc_map;
+    // The data streams of every streamer, in the order they were created
+    std::map<std::string, std::vector<data_stream_alloc_t>> _stream_allocs;
 };
 
 graph_stream_manager::uptr graph_stream_manager::make(
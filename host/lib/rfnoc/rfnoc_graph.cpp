@@ -15,6 +15,8 @@
 #include <uhdlib/rfnoc/factory.hpp>
 #include <uhdlib/rfnoc/graph.hpp>
 #include <uhdlib/rfnoc/graph_stream_manager.hpp>
+#include <uhdlib/rfnoc/node_accessor.hpp>
+#include <uhdlib/rfnoc/prop_accessor.hpp>
 #include <uhdlib/rfnoc/rfnoc_device.hpp>
 #include <uhdlib/rfnoc/rfnoc_rx_streamer.hpp>
 #include <uhdlib/rfnoc/rfnoc_tx_streamer.hpp>
@@ -49,6 +51,7 @@ struct streamer_info_t
 {
     detail::graph_t::node_ref_t node;
     std::map<size_t, connection_info_t> connections;
+    std::map<size_t, rfnoc_graph::stream_placement_t> placements;
 };
 
 //! Information about a route (used for physical connect/disconnect)
@@ -298,23 +301,31 @@ public:
             bits_to_sw_buff(rfnoc_streamer->get_otw_item_comp_bit_width());
         const sw_buff_t mdata_fmt = BUFF_U64;
 
+        auto dst              = get_block(dst_blk);
+        const double samp_rate = _get_edge_samp_rate(
+            dst.get(), {res_source_info::INPUT_EDGE, dst_port});
+
         auto xport = _gsm->create_host_to_device_data_stream(sep_addr,
             pyld_fmt,
             mdata_fmt,
             adapter_id,
             rfnoc_streamer->get_stream_args().args,
-            rfnoc_streamer->get_unique_id());
+            rfnoc_streamer->get_unique_id(),
+            samp_rate);
 
         rfnoc_streamer->connect_channel(strm_port, std::move(xport));
 
         // If this worked, then also connect the streamer in the BGL graph
-        auto dst = get_block(dst_blk);
         graph_edge_t edge_info(strm_port, dst_port, graph_edge_t::TX_STREAM, true);
         _graph->connect(rfnoc_streamer.get(), dst.get(), edge_info);
 
         _tx_streamers[rfnoc_streamer->get_unique_id()].node = rfnoc_streamer.get();
         _tx_streamers[rfnoc_streamer->get_unique_id()].connections[strm_port] = {
             rfnoc_streamer.get(), dst.get(), edge_info};
+        _tx_streamers[rfnoc_streamer->get_unique_id()].placements[strm_port] =
+            _make_placement(rfnoc_streamer->get_unique_id(),
+                strm_port,
+                graph_edge_t::TX_STREAM);
     }
 
     void connect(const block_id_t& src_blk,
@@ -359,23 +370,31 @@ public:
             bits_to_sw_buff(rfnoc_streamer->get_otw_item_comp_bit_width());
         const sw_buff_t mdata_fmt = BUFF_U64;
 
+        auto src              = get_block(src_blk);
+        const double samp_rate = _get_edge_samp_rate(
+            src.get(), {res_source_info::OUTPUT_EDGE, src_port});
+
         auto xport = _gsm->create_device_to_host_data_stream(sep_addr,
             pyld_fmt,
             mdata_fmt,
             adapter_id,
             rfnoc_streamer->get_stream_args().args,
-            rfnoc_streamer->get_unique_id());
+            rfnoc_streamer->get_unique_id(),
+            samp_rate);
 
         rfnoc_streamer->connect_channel(strm_port, std::move(xport));
 
         // If this worked, then also connect the streamer in the BGL graph
-        auto src = get_block(src_blk);
         graph_edge_t edge_info(src_port, strm_port, graph_edge_t::RX_STREAM, true);
         _graph->connect(src.get(), rfnoc_streamer.get(), edge_info);
 
         _rx_streamers[rfnoc_streamer->get_unique_id()].node = rfnoc_streamer.get();
         _rx_streamers[rfnoc_streamer->get_unique_id()].connections[strm_port] = {
             src.get(), rfnoc_streamer.get(), edge_info};
+        _rx_streamers[rfnoc_streamer->get_unique_id()].placements[strm_port] =
+            _make_placement(rfnoc_streamer->get_unique_id(),
+                strm_port,
+                graph_edge_t::RX_STREAM);
     }
 
     void disconnect(const std::string& streamer_id)
@@ -392,6 +411,7 @@ public:
 
             // Remove the streamer from the map
             _tx_streamers.erase(streamer_id);
+            _gsm->release_data_streams(streamer_id);
         } else if (_rx_streamers.count(streamer_id)) {
             // TODO: Physically disconnect all connections
 
@@ -400,6 +420,7 @@ public:
 
             // Remove the streamer from the map
             _rx_streamers.erase(streamer_id);
+            _gsm->release_data_streams(streamer_id);
         }
         UHD_LOG_TRACE(LOG_ID, std::string("Disconnected ") + streamer_id);
     }
@@ -413,6 +434,12 @@ public:
                 auto connection = _tx_streamers[streamer_id].connections[port];
                 _graph->disconnect(connection.src, connection.dst, connection.edge);
                 _tx_streamers[streamer_id].connections.erase(port);
+                // Destroying the transport disconnects it from its I/O service
+                auto streamer =
+                    dynamic_cast<rfnoc_tx_streamer*>(_tx_streamers[streamer_id].node);
+                UHD_ASSERT_THROW(streamer);
+                streamer->disconnect_channel(port);
+                _release_placement(_tx_streamers[streamer_id], port);
             } else {
                 throw uhd::lookup_error(
                     std::string("Cannot disconnect. Port not connected: ") + id_str);
@@ -423,6 +450,11 @@ public:
                 // TODO: Physically disconnect port
                 _graph->disconnect(connection.src, connection.dst, connection.edge);
                 _rx_streamers[streamer_id].connections.erase(port);
+                auto streamer =
+                    dynamic_cast<rfnoc_rx_streamer*>(_rx_streamers[streamer_id].node);
+                UHD_ASSERT_THROW(streamer);
+                streamer->disconnect_channel(port);
+                _release_placement(_rx_streamers[streamer_id], port);
             } else {
                 throw uhd::lookup_error(
                     std::string("Cannot disconnect. Port not connected: ") + id_str);
@@ -547,6 +579,19 @@ public:
         return _gsm->get_adapters(sep_addr);
     }
 
+    std::vector<stream_placement_t> get_stream_placements() const
+    {
+        std::vector<stream_placement_t> placements;
+        for (const auto& streamers : {&_rx_streamers, &_tx_streamers}) {
+            for (const auto& streamer : *streamers) {
+                for (const auto& placement : streamer.second.placements) {
+                    placements.push_back(placement.second);
+                }
+            }
+        }
+        return placements;
+    }
+
     std::vector<graph_edge_t> enumerate_active_connections()
 
     {
@@ -979,6 +1024,61 @@ private:
         return edge_o.get();
     }
 
+    /*! Return the sample rate on a block port, or 0 if it's not known yet
+     */
+    double _get_edge_samp_rate(node_t* node, const res_source_info& src_info)
+    {
+        auto props = node_accessor_t{}.filter_props(node, [&](property_base_t* prop) {
+            return prop->get_id() == PROP_KEY_SAMP_RATE
+                   && prop->get_src_info() == src_info;
+        });
+        for (auto prop : props) {
+            auto rate_prop = dynamic_cast<property_t<double>*>(prop);
+            if (rate_prop && rate_prop->is_valid()) {
+                auto access = prop_accessor_t{}.get_scoped_prop_access(
+                    *rate_prop, property_base_t::RO, rate_prop->get_access_mode());
+                return rate_prop->get();
+            }
+        }
+        return 0.0;
+    }
+
+    /*! Look up the adapter allocation of the data stream that was just created
+     * for a streamer channel
+     */
+    stream_placement_t _make_placement(const std::string& streamer_id,
+        const size_t port,
+        const graph_edge_t::edge_t direction)
+    {
+        const auto allocs = _gsm->get_data_stream_allocs(streamer_id);
+        UHD_ASSERT_THROW(!allocs.empty());
+        const auto& alloc = allocs.back();
+        UHD_LOG_DEBUG(LOG_ID,
+            "Streamer " << streamer_id << ":" << port << " uses adapter "
+                        << alloc.adapter << ", estimated load " << (alloc.load / 1e6)
+                        << " MB/s");
+        return {streamer_id, port, direction, alloc.adapter, alloc.samp_rate, alloc.load};
+    }
+
+    /*! Remove the placement of a streamer channel, and release its adapter
+     * allocation
+     */
+    void _release_placement(streamer_info_t& streamer_info, const size_t port)
+    {
+        if (streamer_info.placements.count(port) == 0) {
+            return;
+        }
+        const auto& placement = streamer_info.placements.at(port);
+        _gsm->release_data_stream(placement.streamer_id,
+            {placement.adapter_id,
+                placement.direction == graph_edge_t::RX_STREAM
+                    ? uhd::transport::link_type_t::RX_DATA
+                    : uhd::transport::link_type_t::TX_DATA,
+                placement.samp_rate,
+                placement.load});
+        streamer_info.placements.erase(port);
+    }
+
     /**************************************************************************
      * Attributes
      *************************************************************************/
@@ -159,6 +159,14 @@ void export_rfnoc(py::module& m)
         // Operators
         .def(py::self == py::self);
 
+    py::class_<rfnoc_graph::stream_placement_t>(m, "stream_placement")
+        .def_readonly("streamer_id", &rfnoc_graph::stream_placement_t::streamer_id)
+        .def_readonly("port", &rfnoc_graph::stream_placement_t::port)
+        .def_readonly("direction", &rfnoc_graph::stream_placement_t::direction)
+        .def_readonly("adapter_id", &rfnoc_graph::stream_placement_t::adapter_id)
+        .def_readonly("samp_rate", &rfnoc_graph::stream_placement_t::samp_rate)
+        .def_readonly("load", &rfnoc_graph::stream_placement_t::load);
+
     py::class_<rfnoc_graph, rfnoc_graph::sptr>(m, "rfnoc_graph")
         .def(py::init(&rfnoc_graph::make))
 
@@ -211,11 +219,17 @@ void export_rfnoc(py::module& m)
             py::overload_cast<const std::string&, size_t>(&rfnoc_graph::disconnect))
         .def("enumerate_adapters_from_src", &rfnoc_graph::enumerate_adapters_from_src)
         .def("enumerate_adapters_to_dst", &rfnoc_graph::enumerate_adapters_to_dst)
+        .def("get_stream_placements", &rfnoc_graph::get_stream_placements)
         .def("enumerate_static_connections", &rfnoc_graph::enumerate_static_connections)
         .def("enumerate_active_connections", &rfnoc_graph::enumerate_active_connections)
         .def("commit", &rfnoc_graph::commit)
         .def("release", &rfnoc_graph::release)
-        .def("create_rx_streamer", &rfnoc_graph::create_rx_streamer)
+        .def("create_rx_streamer",
+            [](rfnoc_graph& self,
+                const size_t num_ports,
+                const uhd::stream_args_t& args) {
+                return wrap_rx_stream(self.create_rx_streamer(num_ports, args), args);
+            })
         .def("create_tx_streamer", &rfnoc_graph::create_tx_streamer)
         .def("get_num_mboards", &rfnoc_graph::get_num_mboards)
         .def(
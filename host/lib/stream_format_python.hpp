@@ -0,0 +1,29 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#ifndef INCLUDED_UHD_STREAM_FORMAT_PYTHON_HPP
+#define INCLUDED_UHD_STREAM_FORMAT_PYTHON_HPP
+
+#include <uhd/stream.hpp>
+#include <string>
+
+//! Attribute of a Python rx_streamer that holds the CPU format it was created with
+static constexpr const char* RX_STREAM_FORMAT_ATTR = "_cpu_format";
+
+/*! Return \p rx_stream as a Python object that knows its CPU format
+ *
+ * The streamer itself can't report its CPU format, but the rx_ring needs it
+ * to size its blocks.
+ */
+static py::object wrap_rx_stream(
+    uhd::rx_streamer::sptr rx_stream, const uhd::stream_args_t& args)
+{
+    py::object rx_stream_obj = py::cast(rx_stream);
+    py::setattr(rx_stream_obj, RX_STREAM_FORMAT_ATTR, py::str(args.cpu_format));
+    return rx_stream_obj;
+}
+
+#endif /* INCLUDED_UHD_STREAM_FORMAT_PYTHON_HPP */
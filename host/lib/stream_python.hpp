@@ -8,66 +8,150 @@
 #ifndef INCLUDED_UHD_STREAM_PYTHON_HPP
 #define INCLUDED_UHD_STREAM_PYTHON_HPP
 
+#include "include/uhdlib/transport/rx_ring.hpp"
+#include "stream_format_python.hpp"
 #include <uhd/stream.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/utils/noncopyable.hpp>
 #include <boost/format.hpp>
+#include <complex>
+#include <map>
+#include <memory>
 
-static size_t wrap_recv(uhd::rx_streamer* rx_stream,
-    py::object& np_array,
-    uhd::rx_metadata_t& metadata,
-    const double timeout = 0.1)
+/*! Channel pointers into a numpy array, as expected by recv() and send()
+ *
+ * The array is validated once on construction. The reference to the array
+ * object that the numpy C API hands out is dropped on destruction.
+ *
+ * By default, the array must be C-contiguous. With other \p requirements, only
+ * the rows need to be contiguous, so slices like arr[:, offset:] can be used
+ * without numpy making a copy.
+ */
+class np_array_buffs
 {
-    // Get a numpy array object from given python object
-    // No sanity checking possible!
-    PyObject* array_obj           = PyArray_FROM_OF(np_array.ptr(), NPY_ARRAY_CARRAY);
-    PyArrayObject* array_type_obj = reinterpret_cast<PyArrayObject*>(array_obj);
-
-    // Get dimensions of the numpy array
-    const size_t dims     = PyArray_NDIM(array_type_obj);
-    const npy_intp* shape = PyArray_SHAPE(array_type_obj);
-
-    // How many bytes to jump to get to the next element of this stride
-    // (next row)
-    const npy_intp* strides = PyArray_STRIDES(array_type_obj);
-    const size_t channels   = rx_stream->get_num_channels();
-
-    // Check if numpy array sizes are okay
-    if (((channels > 1) && (dims != 2)) or ((size_t)shape[0] < channels)) {
-        // Manually decrement the ref count
-        Py_DECREF(array_obj);
-        // If we don't have a 2D NumPy array, assume we have a 1D array
-        size_t input_channels = (dims != 2) ? 1 : shape[0];
-        throw uhd::runtime_error(
-            str(boost::format("Number of RX channels (%d) does not match the dimensions "
-                              "of the data array (%d)")
-                % channels % input_channels));
+public:
+    np_array_buffs(py::object& np_array,
+        const size_t channels,
+        const char* direction,
+        const int requirements = NPY_ARRAY_CARRAY)
+    {
+        // Get a numpy array object from given python object
+        // No sanity checking possible!
+        // Note: this increases the ref count, which we decrease in the destructor
+        _array_obj = PyArray_FROM_OF(np_array.ptr(), requirements);
+        PyArrayObject* array_type_obj = reinterpret_cast<PyArrayObject*>(_array_obj);
+
+        // Get dimensions of the numpy array
+        const size_t dims     = PyArray_NDIM(array_type_obj);
+        const npy_intp* shape = PyArray_SHAPE(array_type_obj);
+
+        // How many bytes to jump to get to the next element of this stride
+        // (next row)
+        const npy_intp* strides = PyArray_STRIDES(array_type_obj);
+
+        // Check if numpy array sizes are okay
+        if (((channels > 1) && (dims != 2)) or ((size_t)shape[0] < channels)) {
+            Py_DECREF(_array_obj);
+            // If we don't have a 2D NumPy array, assume we have a 1D array
+            size_t input_channels = (dims != 2) ? 1 : shape[0];
+            throw uhd::runtime_error(
+                str(boost::format("Number of %s channels (%d) does not match the "
+                                  "dimensions of the data array (%d)")
+                    % direction % channels % input_channels));
+        }
+
+        // Get a pointer to the storage
+        char* data = PyArray_BYTES(array_type_obj);
+        for (size_t i = 0; i < channels; ++i) {
+            ptrs.push_back((void*)(data + i * strides[0]));
+        }
+
+        // Get data buffer and size of the array
+        nsamps   = (dims > 1) ? (size_t)shape[1] : PyArray_SIZE(array_type_obj);
+        itemsize = PyArray_ITEMSIZE(array_type_obj);
+        if (dims > 0 and nsamps > 1 and (size_t)strides[dims - 1] != itemsize) {
+            Py_DECREF(_array_obj);
+            throw uhd::runtime_error("The samples of each channel must be contiguous");
+        }
     }
 
-    // Get a pointer to the storage
-    std::vector<void*> channel_storage;
-    char* data = PyArray_BYTES(array_type_obj);
-    for (size_t i = 0; i < channels; ++i) {
-        channel_storage.push_back((void*)(data + i * strides[0]));
+    ~np_array_buffs()
+    {
+        Py_DECREF(_array_obj);
     }
 
-    // Get data buffer and size of the array
-    size_t nsamps_per_buff;
-    if (dims > 1) {
-        nsamps_per_buff = (size_t)shape[1];
-    } else {
-        nsamps_per_buff = PyArray_SIZE(array_type_obj);
+    //! Return the pointers advanced by \p offset samples
+    std::vector<void*> at(const size_t offset) const
+    {
+        std::vector<void*> result(ptrs);
+        for (auto& ptr : result) {
+            ptr = static_cast<char*>(ptr) + offset * itemsize;
+        }
+        return result;
     }
 
+    std::vector<void*> ptrs;
+    size_t nsamps;
+    size_t itemsize;
+
+private:
+    PyObject* _array_obj;
+};
+
+static size_t wrap_recv(uhd::rx_streamer* rx_stream,
+    py::object& np_array,
+    uhd::rx_metadata_t& metadata,
+    const double timeout = 0.1)
+{
+    np_array_buffs buffs(np_array, rx_stream->get_num_channels(), "RX");
+
     // Release the GIL only for the recv() call
-    const size_t result = [&]() {
-        py::gil_scoped_release release;
-        // Call the real recv()
-        return rx_stream->recv(channel_storage, nsamps_per_buff, metadata, timeout);
-    }();
+    py::gil_scoped_release release;
+    // Call the real recv()
+    return rx_stream->recv(buffs.ptrs, buffs.nsamps, metadata, timeout);
+}
 
-    // Manually decrement the ref count
-    Py_DECREF(array_obj);
-    return result;
+/*! Fill the entire array in a single call
+ *
+ * recv() is called with the GIL released until the array is full, recv()
+ * times out, or an error other than an overflow is reported. The returned
+ * metadata describes the first received sample; its error code is the first
+ * error that occurred (an overflow means the array contains a gap).
+ */
+static size_t wrap_recv_num_samps(uhd::rx_streamer* rx_stream,
+    py::object& np_array,
+    uhd::rx_metadata_t& metadata,
+    const double timeout = 0.1)
+{
+    np_array_buffs buffs(np_array,
+        rx_stream->get_num_channels(),
+        "RX",
+        NPY_ARRAY_ALIGNED | NPY_ARRAY_WRITEABLE);
+
+    py::gil_scoped_release release;
+    auto error = uhd::rx_metadata_t::ERROR_CODE_NONE;
+    uhd::rx_metadata_t md;
+    metadata.reset();
+    size_t num_samps = 0;
+    while (num_samps < buffs.nsamps) {
+        const size_t num_rx_samps = rx_stream->recv(
+            buffs.at(num_samps), buffs.nsamps - num_samps, md, timeout);
+        if (num_samps == 0 and num_rx_samps > 0) {
+            metadata = md;
+        }
+        num_samps += num_rx_samps;
+        if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE) {
+            continue;
+        }
+        if (error == uhd::rx_metadata_t::ERROR_CODE_NONE) {
+            error = md.error_code;
+        }
+        if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
+            break;
+        }
+    }
+    metadata.error_code = error;
+    return num_samps;
 }
 
 static size_t wrap_send(uhd::tx_streamer* tx_stream,
@@ -75,55 +159,216 @@ static size_t wrap_send(uhd::tx_streamer* tx_stream,
     uhd::tx_metadata_t& metadata,
     const double timeout = 0.1)
 {
-    // Get a numpy array object from given python object
-    // No sanity checking possible!
-    // Note: this increases the ref count, which we'll need to manually decrease at the
-    // end
-    PyObject* array_obj           = PyArray_FROM_OF(np_array.ptr(), NPY_ARRAY_CARRAY);
-    PyArrayObject* array_type_obj = reinterpret_cast<PyArrayObject*>(array_obj);
-
-    // Get dimensions of the numpy array
-    const size_t dims     = PyArray_NDIM(array_type_obj);
-    const npy_intp* shape = PyArray_SHAPE(array_type_obj);
-
-    // How many bytes to jump to get to the next element of the stride
-    // (next row)
-    const npy_intp* strides = PyArray_STRIDES(array_type_obj);
-    const size_t channels   = tx_stream->get_num_channels();
-
-    // Check if numpy array sizes are ok
-    if (((channels > 1) && (dims != 2)) or ((size_t)shape[0] < channels)) {
-        // Manually decrement the ref count
-        Py_DECREF(array_obj);
-        // If we don't have a 2D NumPy array, assume we have a 1D array
-        size_t input_channels = (dims != 2) ? 1 : shape[0];
-        throw uhd::runtime_error(
-            str(boost::format("Number of TX channels (%d) does not match the dimensions "
-                              "of the data array (%d)")
-                % channels % input_channels));
+    np_array_buffs buffs(np_array, tx_stream->get_num_channels(), "TX");
+
+    // Release the GIL only for the send() call
+    py::gil_scoped_release release;
+    // Call the real send()
+    return tx_stream->send(buffs.ptrs, buffs.nsamps, metadata, timeout);
+}
+
+/*! Send the entire array in a single call
+ *
+ * send() is called with the GIL released until all samples were sent, or
+ * until send() times out without sending anything. Start of burst and the
+ * time spec only apply to the first sample, end of burst to the last one.
+ */
+static size_t wrap_send_num_samps(uhd::tx_streamer* tx_stream,
+    py::object& np_array,
+    const uhd::tx_metadata_t& metadata,
+    const double timeout = 0.1)
+{
+    np_array_buffs buffs(
+        np_array, tx_stream->get_num_channels(), "TX", NPY_ARRAY_ALIGNED);
+
+    py::gil_scoped_release release;
+    uhd::tx_metadata_t md = metadata;
+    size_t num_samps      = 0;
+    while (num_samps < buffs.nsamps) {
+        const size_t num_tx_samps =
+            tx_stream->send(buffs.at(num_samps), buffs.nsamps - num_samps, md, timeout);
+        if (num_tx_samps == 0) {
+            break;
+        }
+        num_samps += num_tx_samps;
+        md.start_of_burst = false;
+        md.has_time_spec  = false;
     }
+    return num_samps;
+}
+
+/*! Python interface of uhd::transport::rx_ring
+ *
+ * Completed blocks are handed to Python as rx_ring_block objects, which expose
+ * the samples through the buffer protocol (e.g., numpy.asarray(block)) without
+ * copying. A block goes back into the ring once the last reference to it is
+ * gone.
+ */
+class py_rx_ring : public std::enable_shared_from_this<py_rx_ring>
+{
+public:
+    using sptr = std::shared_ptr<py_rx_ring>;
+
+    class block : uhd::noncopyable
+    {
+    public:
+        block(py_rx_ring::sptr ring, const size_t index) : _ring(ring), _index(index)
+        {
+        }
+
+        ~block()
+        {
+            _ring->_ring.release(_index);
+        }
+
+        size_t get_num_samps() const
+        {
+            return _ring->_ring.get_block(_index).num_samps;
+        }
+
+        uhd::rx_metadata_t get_metadata() const
+        {
+            return _ring->_ring.get_block(_index).metadata;
+        }
 
-    // Get a pointer to the storage
-    std::vector<void*> channel_storage;
-    char* data = PyArray_BYTES(array_type_obj);
-    for (size_t i = 0; i < channels; ++i) {
-        channel_storage.push_back((void*)(data + i * strides[0]));
+        py::buffer_info get_buffer_info()
+        {
+            const auto& fmt = _ring->_format;
+            std::vector<ssize_t> shape{
+                ssize_t(_ring->_ring.get_num_chans()), ssize_t(get_num_samps())};
+            std::vector<ssize_t> strides{
+                ssize_t(_ring->_ring.get_block_size() * fmt.itemsize),
+                ssize_t(fmt.itemsize)};
+            if (fmt.components > 1) {
+                shape.push_back(ssize_t(fmt.components));
+                strides.push_back(ssize_t(fmt.itemsize / fmt.components));
+            }
+            return py::buffer_info(_ring->_ring.get_block_ptr(_index, 0),
+                ssize_t(fmt.itemsize / fmt.components),
+                fmt.descriptor,
+                ssize_t(shape.size()),
+                shape,
+                strides);
+        }
+
+    private:
+        py_rx_ring::sptr _ring;
+        const size_t _index;
+    };
+
+    /*! Create a ring for a streamer
+     *
+     * The CPU format determines the size of the blocks, so it has to match the
+     * streamer. It is taken from the streamer if the streamer was created from
+     * Python. Otherwise, it has to be given as \p cpu_format.
+     *
+     * \throws uhd::value_error if the CPU format is unknown, unsupported, or
+     *         doesn't match the streamer
+     */
+    static sptr make(py::object rx_stream,
+        const std::string& cpu_format,
+        const size_t num_blocks,
+        const size_t block_size)
+    {
+        std::string format = cpu_format;
+        if (py::hasattr(rx_stream, RX_STREAM_FORMAT_ATTR)) {
+            const auto stream_format =
+                rx_stream.attr(RX_STREAM_FORMAT_ATTR).cast<std::string>();
+            if (!format.empty() and format != stream_format) {
+                throw uhd::value_error("rx_ring: CPU format " + format
+                                       + " does not match the streamer ("
+                                       + stream_format + ")");
+            }
+            format = stream_format;
+        }
+        if (format.empty()) {
+            throw uhd::value_error(
+                "rx_ring: The CPU format of the streamer is unknown, specify it");
+        }
+        return sptr(new py_rx_ring(
+            rx_stream.cast<uhd::rx_streamer::sptr>(), format, num_blocks, block_size));
     }
 
-    // Get data buffer and size of the array
-    size_t nsamps_per_buff = (dims > 1) ? (size_t)shape[1] : PyArray_SIZE(array_type_obj);
+    //! Start the receive thread. Streaming is controlled by the caller.
+    void start()
+    {
+        _ring.start();
+    }
 
-    // Release the GIL only for the send() call
-    const size_t result = [&]() {
+    //! Stop the receive thread. Blocks already handed out remain valid.
+    void stop()
+    {
         py::gil_scoped_release release;
-        // Call the real send()
-        return tx_stream->send(channel_storage, nsamps_per_buff, metadata, timeout);
-    }();
+        _ring.stop();
+    }
 
-    // Manually decrement the ref count
-    Py_DECREF(array_obj);
-    return result;
-}
+    /*! Return the next completed block, or None on timeout
+     *
+     * \throws uhd::runtime_error if the receive thread stopped on an error
+     */
+    std::unique_ptr<block> get(const double timeout)
+    {
+        size_t index;
+        bool got_block;
+        {
+            py::gil_scoped_release release;
+            got_block = _ring.get(index, timeout);
+        }
+        if (!got_block) {
+            return nullptr;
+        }
+        return std::unique_ptr<block>(new block(shared_from_this(), index));
+    }
+
+    size_t get_num_overflows() const
+    {
+        return _ring.get_num_overflows();
+    }
+
+    size_t get_num_stalls() const
+    {
+        return _ring.get_num_stalls();
+    }
+
+private:
+    struct format_t
+    {
+        std::string descriptor;
+        size_t itemsize;
+        size_t components;
+    };
+
+    py_rx_ring(uhd::rx_streamer::sptr rx_stream,
+        const std::string& cpu_format,
+        const size_t num_blocks,
+        const size_t block_size)
+        : _format(_get_format(cpu_format))
+        , _ring(rx_stream, _format.itemsize, num_blocks, block_size)
+    {
+    }
+
+    static format_t _get_format(const std::string& cpu_format)
+    {
+        // Complex integers have no buffer protocol equivalent, so they are
+        // exposed with an extra dimension for I and Q
+        static const std::map<std::string, format_t> formats{
+            {"fc64", {py::format_descriptor<std::complex<double>>::format(), 16, 1}},
+            {"fc32", {py::format_descriptor<std::complex<float>>::format(), 8, 1}},
+            {"sc16", {py::format_descriptor<int16_t>::format(), 4, 2}},
+            {"sc8", {py::format_descriptor<int8_t>::format(), 2, 2}},
+            {"f64", {py::format_descriptor<double>::format(), 8, 1}},
+            {"f32", {py::format_descriptor<float>::format(), 4, 1}},
+            {"s16", {py::format_descriptor<int16_t>::format(), 2, 1}},
+            {"s8", {py::format_descriptor<int8_t>::format(), 1, 1}}};
+        if (!formats.count(cpu_format)) {
+            throw uhd::value_error("rx_ring: Unsupported CPU format: " + cpu_format);
+        }
+        return formats.at(cpu_format);
+    }
+
+    const format_t _format;
+    uhd::transport::rx_ring _ring;
+};
 
 static bool wrap_recv_async_msg(uhd::tx_streamer* tx_stream,
     uhd::async_metadata_t& async_metadata,
@@ -148,13 +393,20 @@ void export_stream(py::module& m)
         .def_readwrite("args", &stream_args_t::args)
         .def_readwrite("channels", &stream_args_t::channels);
 
-    py::class_<rx_streamer, rx_streamer::sptr>(m, "rx_streamer", "See: uhd::rx_streamer")
+    // Dynamic attributes let the streamer factories record the CPU format
+    py::class_<rx_streamer, rx_streamer::sptr>(
+        m, "rx_streamer", "See: uhd::rx_streamer", py::dynamic_attr())
         // Methods
         .def("recv",
             &wrap_recv,
             py::arg("np_array"),
             py::arg("metadata"),
             py::arg("timeout") = 0.1)
+        .def("recv_num_samps",
+            &wrap_recv_num_samps,
+            py::arg("np_array"),
+            py::arg("metadata"),
+            py::arg("timeout") = 0.1)
         .def("get_num_channels", &uhd::rx_streamer::get_num_channels)
         .def("get_max_num_samps", &uhd::rx_streamer::get_max_num_samps)
         .def("issue_stream_cmd", &uhd::rx_streamer::issue_stream_cmd);
@@ -166,12 +418,35 @@ void export_stream(py::module& m)
             py::arg("np_array"),
             py::arg("metadata"),
             py::arg("timeout") = 0.1)
+        .def("send_num_samps",
+            &wrap_send_num_samps,
+            py::arg("np_array"),
+            py::arg("metadata"),
+            py::arg("timeout") = 0.1)
         .def("get_num_channels", &tx_streamer::get_num_channels)
         .def("get_max_num_samps", &tx_streamer::get_max_num_samps)
         .def("recv_async_msg",
             &wrap_recv_async_msg,
             py::arg("async_metadata"),
             py::arg("timeout") = 0.1);
+
+    py::class_<py_rx_ring, py_rx_ring::sptr>(m, "rx_ring")
+        .def(py::init(&py_rx_ring::make),
+            py::arg("rx_streamer"),
+            py::arg("cpu_format") = "",
+            py::arg("num_blocks") = 16,
+            py::arg("block_size") = 65536)
+        // Methods
+        .def("start", &py_rx_ring::start)
+        .def("stop", &py_rx_ring::stop)
+        .def("get", &py_rx_ring::get, py::arg("timeout") = 0.1)
+        .def("get_num_overflows", &py_rx_ring::get_num_overflows)
+        .def("get_num_stalls", &py_rx_ring::get_num_stalls);
+
+    py::class_<py_rx_ring::block>(m, "rx_ring_block", py::buffer_protocol())
+        .def_buffer(&py_rx_ring::block::get_buffer_info)
+        .def_property_readonly("num_samps", &py_rx_ring::block::get_num_samps)
+        .def_property_readonly("metadata", &py_rx_ring::block::get_metadata);
 }
 
 #endif /* INCLUDED_UHD_STREAM_PYTHON_HPP */
@@ -9,10 +9,43 @@
 #include <uhd/utils/log.hpp>
 #include <uhdlib/transport/inline_io_service.hpp>
 #include <boost/circular_buffer.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
 #include <cassert>
+#include <memory>
+#include <vector>
 
 namespace uhd { namespace transport {
 
+/*!
+ * Get a buffer from a recv link, using the adaptive wait strategy if there is
+ * one, or blocking for the full timeout otherwise
+ */
+static UHD_FORCE_INLINE frame_buff::uptr get_recv_buff(
+    recv_link_if* recv_link, const int32_t timeout_ms, adaptive_wait* wait)
+{
+    if (wait) {
+        return wait->wait(timeout_ms, [recv_link](const int32_t wait_timeout_ms) {
+            return recv_link->get_recv_buff(wait_timeout_ms);
+        });
+    }
+    return recv_link->get_recv_buff(timeout_ms);
+}
+
+/*!
+ * Add the statistics of an adaptive wait to a sum, if there is one
+ */
+static void add_wait_stats(adaptive_wait::stats_t& sum, const adaptive_wait* wait)
+{
+    if (wait) {
+        const auto stats = wait->get_stats();
+        sum.spin_time += stats.spin_time;
+        sum.block_time += stats.block_time;
+        sum.num_spin_hits += stats.num_spin_hits;
+        sum.num_blocks += stats.num_blocks;
+    }
+}
+
 /*!
  * Interface class for unifying callback processing between both inline_send_io
  * and inline_recv_io
@@ -33,19 +66,35 @@ public:
     }
 
 protected:
-    inline_recv_cb(recv_callback_t cb, send_link_if* send_link)
-        : _recv_cb(cb), _cb_send_link(send_link)
+    inline_recv_cb(
+        recv_callback_t cb, send_link_if* send_link, const recv_route_t& recv_route)
+        : _recv_cb(cb), _cb_send_link(send_link), _recv_route(recv_route)
     {
     }
 
     recv_callback_t _recv_cb;
     // pointer to send link used with the callback
     send_link_if* _cb_send_link;
+
+private:
+    friend class inline_recv_mux;
+    friend class inline_io_service;
+
+    // destination of the packets the callback takes
+    const recv_route_t _recv_route;
+    // queue of packets for this callback, when the recv link is muxed
+    std::unique_ptr<boost::circular_buffer<frame_buff*>> _mux_queue;
+    // wait strategy of this callback's thread, nullptr to block
+    std::unique_ptr<adaptive_wait> _wait;
 };
 
 /*!
  * Mux class that intercepts packets from the link and distributes them to
  * queues for each client that is not the caller of the recv() function
+ *
+ * Receivers with a route are indexed by their destination EPID, so a packet is
+ * offered to the receivers of its EPID first (usually one), instead of to every
+ * receiver on the link. Receivers without a route are tried after that.
  */
 class inline_recv_mux
 {
@@ -61,14 +110,25 @@ public:
      */
     void connect(inline_recv_cb* cb)
     {
-        UHD_ASSERT_THROW(_queues.count(cb) == 0);
+        UHD_ASSERT_THROW(!cb->_mux_queue);
         /* Always create queue of max size, since we don't know when there are
          * virtual channels (which share frames)
          */
-        auto queue =
-            new boost::circular_buffer<frame_buff*>(_link->get_num_recv_frames());
-        _queues[cb] = queue;
-        _callbacks.push_back(cb);
+        cb->_mux_queue = std::make_unique<boost::circular_buffer<frame_buff*>>(
+            _link->get_num_recv_frames());
+        _num_rcvrs++;
+
+        const recv_route_t& route = cb->_recv_route;
+        if (route.get_dst_epid
+            && (!_get_dst_epid || _get_dst_epid == route.get_dst_epid)) {
+            _get_dst_epid = route.get_dst_epid;
+            if (route.dst_epid >= _routes.size()) {
+                _routes.resize(route.dst_epid + 1);
+            }
+            _routes[route.dst_epid].push_back(cb);
+        } else {
+            _unrouted.push_back(cb);
+        }
     }
 
     /*!
@@ -77,15 +137,23 @@ public:
      */
     void disconnect(inline_recv_cb* cb)
     {
-        auto queue = _queues.at(cb);
+        auto& queue = cb->_mux_queue;
+        UHD_ASSERT_THROW(queue);
         while (!queue->empty()) {
             frame_buff* buff = queue->front();
             _link->release_recv_buff(frame_buff::uptr(buff));
             queue->pop_front();
         }
-        delete queue;
-        _queues.erase(cb);
-        _callbacks.remove(cb);
+        queue.reset();
+        _num_rcvrs--;
+
+        _unrouted.erase(
+            std::remove(_unrouted.begin(), _unrouted.end(), cb), _unrouted.end());
+        const uint16_t epid = cb->_recv_route.dst_epid;
+        if (epid < _routes.size()) {
+            auto& rcvrs = _routes[epid];
+            rcvrs.erase(std::remove(rcvrs.begin(), rcvrs.end(), cb), rcvrs.end());
+        }
     }
 
     /*!
@@ -94,7 +162,23 @@ public:
      */
     UHD_FORCE_INLINE bool is_empty(void) const
     {
-        return _callbacks.empty();
+        return _num_rcvrs == 0;
+    }
+
+    /*!
+     * Add the adaptive wait statistics of all receivers to a sum
+     * \param sum the sum to add to
+     */
+    void add_wait_stats(adaptive_wait::stats_t& sum) const
+    {
+        for (const auto& rcvrs : _routes) {
+            for (const inline_recv_cb* rcvr : rcvrs) {
+                transport::add_wait_stats(sum, rcvr->_wait.get());
+            }
+        }
+        for (const inline_recv_cb* rcvr : _unrouted) {
+            transport::add_wait_stats(sum, rcvr->_wait.get());
+        }
     }
 
     /*!
@@ -106,38 +190,28 @@ public:
      */
     frame_buff::uptr recv(inline_recv_cb* cb, recv_link_if* recv_link, int32_t timeout_ms)
     {
-        auto queue = _queues.at(cb);
+        auto& queue = cb->_mux_queue;
         if (!queue->empty()) {
             frame_buff* buff = queue->front();
             queue->pop_front();
             return frame_buff::uptr(buff);
         }
         while (true) {
-            frame_buff::uptr buff = recv_link->get_recv_buff(timeout_ms);
+            frame_buff::uptr buff = get_recv_buff(recv_link, timeout_ms, cb->_wait.get());
             /* Process buffer */
             if (buff) {
-                bool rcvr_found = false;
-                for (auto& rcvr : _callbacks) {
-                    if (rcvr->callback(buff, recv_link)) {
-                        rcvr_found = true;
-                        if (buff) {
-                            if (rcvr == cb) {
-                                return frame_buff::uptr(std::move(buff));
-                            } else {
-                                /* NOTE: Should not overflow, by construction
-                                 * Every queue can hold link->get_num_recv_frames()
-                                 */
-                                _queues[rcvr]->push_back(buff.release());
-                            }
-                        }
-                        /* Continue looping if buffer was consumed */
-                        break;
+                inline_recv_cb* rcvr = _dispatch(buff, recv_link);
+                if (rcvr && buff) {
+                    if (rcvr == cb) {
+                        return frame_buff::uptr(std::move(buff));
+                    } else {
+                        /* NOTE: Should not overflow, by construction
+                         * Every queue can hold link->get_num_recv_frames()
+                         */
+                        rcvr->_mux_queue->push_back(buff.release());
                     }
                 }
-                if (not rcvr_found) {
-                    UHD_LOG_DEBUG("IO_SRV", "Dropping packet with no receiver");
-                    recv_link->release_recv_buff(std::move(buff));
-                }
+                /* Continue looping if buffer was consumed */
             } else { /* Timeout */
                 return frame_buff::uptr();
             }
@@ -147,32 +221,21 @@ public:
     bool recv_flow_ctrl(inline_recv_cb* cb, recv_link_if* recv_link, int32_t timeout_ms)
     {
         while (true) {
-            frame_buff::uptr buff = recv_link->get_recv_buff(timeout_ms);
+            frame_buff::uptr buff = get_recv_buff(recv_link, timeout_ms, cb->_wait.get());
             /* Process buffer */
             if (buff) {
-                bool rcvr_found = false;
-                for (auto& rcvr : _callbacks) {
-                    if (rcvr->callback(buff, recv_link)) {
-                        rcvr_found = true;
-                        if (rcvr == cb) {
-                            assert(!buff);
-                            return true;
-                        } else if (buff) {
-                            /* NOTE: Should not overflow, by construction
-                             * Every queue can hold link->get_num_recv_frames()
-                             */
-                            _queues[rcvr]->push_back(buff.release());
-                        } else {
-                            /* Continue looping if buffer was consumed and
-                               receiver is not the requested one */
-                            break;
-                        }
-                    }
-                }
-                if (not rcvr_found) {
-                    UHD_LOG_DEBUG("IO_SRV", "Dropping packet with no receiver");
-                    recv_link->release_recv_buff(std::move(buff));
+                inline_recv_cb* rcvr = _dispatch(buff, recv_link);
+                if (rcvr == cb) {
+                    assert(!buff);
+                    return true;
+                } else if (rcvr && buff) {
+                    /* NOTE: Should not overflow, by construction
+                     * Every queue can hold link->get_num_recv_frames()
+                     */
+                    rcvr->_mux_queue->push_back(buff.release());
                 }
+                /* Continue looping if buffer was consumed and receiver is not
+                   the requested one */
             } else { /* Timeout */
                 return false;
             }
@@ -180,9 +243,45 @@ public:
     }
 
 private:
+    /*!
+     * Find the receiver that takes a buffer. If no receiver takes it, the
+     * buffer is released.
+     *
+     * \param buff the buffer received
+     * \param recv_link the link the buffer was received on
+     * \return the receiver that took the buffer, or nullptr
+     */
+    UHD_FORCE_INLINE inline_recv_cb* _dispatch(
+        frame_buff::uptr& buff, recv_link_if* recv_link)
+    {
+        if (_get_dst_epid) {
+            const uint16_t epid = _get_dst_epid(buff->data());
+            if (epid < _routes.size()) {
+                for (inline_recv_cb* rcvr : _routes[epid]) {
+                    if (rcvr->callback(buff, recv_link)) {
+                        return rcvr;
+                    }
+                }
+            }
+        }
+        for (inline_recv_cb* rcvr : _unrouted) {
+            if (rcvr->callback(buff, recv_link)) {
+                return rcvr;
+            }
+        }
+        UHD_LOG_DEBUG("IO_SRV", "Dropping packet with no receiver");
+        recv_link->release_recv_buff(std::move(buff));
+        return nullptr;
+    }
+
     recv_link_if* _link;
-    std::list<inline_recv_cb*> _callbacks;
-    std::unordered_map<inline_recv_cb*, boost::circular_buffer<frame_buff*>*> _queues;
+    size_t _num_rcvrs = 0;
+    // reads the destination EPID of a packet, shared by all routed receivers
+    recv_route_t::get_dst_epid_fn_t _get_dst_epid = nullptr;
+    // receivers with a route, indexed by destination EPID
+    std::vector<std::vector<inline_recv_cb*>> _routes;
+    // receivers without a route, in the order they were connected
+    std::vector<inline_recv_cb*> _unrouted;
 };
 
 class inline_recv_io : public virtual recv_io_if, public virtual inline_recv_cb
@@ -196,8 +295,9 @@ public:
         recv_callback_t recv_cb,
         send_link_if::sptr fc_link,
         size_t num_send_frames,
-        fc_callback_t fc_cb)
-        : inline_recv_cb(recv_cb, fc_link.get())
+        fc_callback_t fc_cb,
+        const recv_route_t& recv_route)
+        : inline_recv_cb(recv_cb, fc_link.get(), recv_route)
         , _io_srv(io_srv)
         , _data_link(data_link)
         , _fc_link(fc_link)
@@ -251,8 +351,9 @@ public:
         recv_link_if::sptr recv_link,
         size_t num_recv_frames,
         recv_callback_t recv_cb,
-        send_io_if::fc_callback_t fc_cb)
-        : inline_recv_cb(recv_cb, send_link.get())
+        send_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route)
+        : inline_recv_cb(recv_cb, send_link.get(), recv_route)
         , _io_srv(io_srv)
         , _send_link(send_link)
         , _send_cb(send_cb)
@@ -333,6 +434,7 @@ void inline_io_service::detach_recv_link(recv_link_if::sptr link)
     auto link_ptr = link.get();
     UHD_ASSERT_THROW(_recv_tbl.count(link_ptr) != 0);
     _recv_tbl.erase(link_ptr);
+    _max_spin_times.erase(link_ptr);
 
     _recv_links.remove_if(
         [link_ptr](recv_link_if::sptr& item) { return item.get() == link_ptr; });
@@ -343,7 +445,8 @@ recv_io_if::sptr inline_io_service::make_recv_client(recv_link_if::sptr data_lin
     recv_callback_t cb,
     send_link_if::sptr fc_link,
     size_t num_send_frames,
-    recv_io_if::fc_callback_t fc_cb)
+    recv_io_if::fc_callback_t fc_cb,
+    const recv_route_t& recv_route)
 {
     UHD_ASSERT_THROW(data_link);
     UHD_ASSERT_THROW(num_recv_frames > 0);
@@ -354,12 +457,41 @@ recv_io_if::sptr inline_io_service::make_recv_client(recv_link_if::sptr data_lin
         connect_sender(fc_link.get(), num_send_frames);
     }
     sptr io_srv  = shared_from_this();
-    auto recv_io = std::make_shared<inline_recv_io>(
-        io_srv, data_link, num_recv_frames, cb, fc_link, num_send_frames, fc_cb);
+    auto recv_io = std::make_shared<inline_recv_io>(io_srv,
+        data_link,
+        num_recv_frames,
+        cb,
+        fc_link,
+        num_send_frames,
+        fc_cb,
+        recv_route);
     connect_receiver(data_link.get(), recv_io.get(), num_recv_frames);
     return recv_io;
 }
 
+void inline_io_service::set_adaptive_wait(
+    recv_link_if::sptr link, const double max_spin_time)
+{
+    UHD_ASSERT_THROW(_recv_tbl.count(link.get()) != 0);
+    _max_spin_times[link.get()] = max_spin_time;
+}
+
+adaptive_wait::stats_t inline_io_service::get_adaptive_wait_stats(
+    recv_link_if::sptr link) const
+{
+    inline_recv_mux* mux;
+    inline_recv_cb* rcvr;
+    std::tie(mux, rcvr) = _recv_tbl.at(link.get());
+
+    adaptive_wait::stats_t stats;
+    if (mux) {
+        mux->add_wait_stats(stats);
+    } else if (rcvr) {
+        add_wait_stats(stats, rcvr->_wait.get());
+    }
+    return stats;
+}
+
 void inline_io_service::attach_send_link(send_link_if::sptr link)
 {
     UHD_ASSERT_THROW(
@@ -380,7 +512,8 @@ send_io_if::sptr inline_io_service::make_send_client(send_link_if::sptr send_lin
     recv_link_if::sptr recv_link,
     size_t num_recv_frames,
     recv_callback_t recv_cb,
-    send_io_if::fc_callback_t fc_cb)
+    send_io_if::fc_callback_t fc_cb,
+    const recv_route_t& recv_route)
 {
     UHD_ASSERT_THROW(send_link);
     UHD_ASSERT_THROW(num_send_frames > 0);
@@ -394,7 +527,8 @@ send_io_if::sptr inline_io_service::make_send_client(send_link_if::sptr send_lin
         recv_link,
         num_recv_frames,
         recv_cb,
-        fc_cb);
+        fc_cb,
+        recv_route);
     if (recv_link) {
         UHD_ASSERT_THROW(recv_cb);
         UHD_ASSERT_THROW(fc_cb);
@@ -429,6 +563,12 @@ void inline_io_service::connect_receiver(
     inline_recv_mux* mux;
     inline_recv_cb* rcvr;
     std::tie(mux, rcvr) = _recv_tbl.at(link);
+
+    auto max_spin_time = _max_spin_times.find(link);
+    if (max_spin_time != _max_spin_times.end() && max_spin_time->second > 0.0) {
+        cb->_wait = std::make_unique<adaptive_wait>(max_spin_time->second);
+    }
+
     if (mux) {
         mux->connect(cb);
     } else if (rcvr) {
@@ -444,6 +584,16 @@ void inline_io_service::connect_receiver(
 
 void inline_io_service::disconnect_receiver(recv_link_if* link, inline_recv_cb* cb)
 {
+    if (cb->_wait) {
+        const auto stats = cb->_wait->get_stats();
+        UHD_LOG_DEBUG("IO_SRV",
+            boost::format("Adaptive wait: spun %.3f ms (%u waits satisfied), blocked "
+                          "%.3f ms (%u waits)")
+                % (stats.spin_time * 1e3) % stats.num_spin_hits
+                % (stats.block_time * 1e3) % stats.num_blocks);
+        cb->_wait.reset();
+    }
+
     inline_recv_mux* mux;
     inline_recv_cb* rcvr;
     std::tie(mux, rcvr) = _recv_tbl.at(link);
@@ -474,7 +624,7 @@ frame_buff::uptr inline_io_service::recv(
     }
 
     while (true) {
-        frame_buff::uptr buff = recv_link->get_recv_buff(timeout_ms);
+        frame_buff::uptr buff = get_recv_buff(recv_link, timeout_ms, rcvr->_wait.get());
         /* Process buffer */
         if (buff) {
             if (rcvr->callback(buff, recv_link)) {
@@ -507,7 +657,7 @@ bool inline_io_service::recv_flow_ctrl(
     }
 
     while (true) {
-        frame_buff::uptr buff = recv_link->get_recv_buff(timeout_ms);
+        frame_buff::uptr buff = get_recv_buff(recv_link, timeout_ms, rcvr->_wait.get());
         /* Process buffer */
         if (buff) {
             if (rcvr->callback(buff, recv_link)) {
@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
+#include <uhd/utils/cast.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/safe_call.hpp>
 #include <uhdlib/transport/adapter.hpp>
@@ -40,6 +41,9 @@ size_t get_page_size()
 #endif
 const size_t page_size = get_page_size();
 
+//! Default upper limit for the number of receive frames acquired at once
+constexpr size_t DEFAULT_RECV_BATCH_FRAMES = 16;
+
 } // namespace
 
 #define PROXY _fpga_session->get_kernel_proxy()
@@ -49,12 +53,17 @@ const size_t page_size = get_page_size();
  *****************************************************************************/
 nirio_link::nirio_link(uhd::niusrprio::niusrprio_session::sptr fpga_session,
     uint32_t instance,
-    const link_params_t& params)
+    const link_params_t& params,
+    const size_t recv_batch_frames,
+    const bool busy_poll)
     : recv_link_base_t(params.num_recv_frames, params.recv_frame_size)
     , send_link_base_t(params.num_send_frames, params.send_frame_size)
     , _fpga_session(fpga_session)
     , _fifo_instance(instance)
     , _link_params(params)
+    , _recv_frame_elems(params.recv_frame_size / sizeof(fifo_data_t))
+    , _recv_batch_frames(recv_batch_frames)
+    , _busy_poll(busy_poll)
 {
     UHD_LOG_TRACE("NIRIO", "Creating PCIe transport for channel " << instance);
     UHD_LOGGER_TRACE("NIRIO")
@@ -67,6 +76,9 @@ nirio_link::nirio_link(uhd::niusrprio::niusrprio_session::sptr fpga_session,
                          "%u, #frames = %u, buffer size = %u\n")
                % _link_params.send_frame_size % _link_params.num_send_frames
                % (_link_params.send_frame_size * _link_params.num_send_frames);
+    UHD_LOG_TRACE("NIRIO",
+        "RX batch size = " << _recv_batch_frames << " frames, busy-poll "
+                           << (_busy_poll ? "enabled" : "disabled"));
 
     nirio_status status = 0;
     size_t actual_depth = 0, actual_size = 0;
@@ -159,7 +171,10 @@ nirio_link::~nirio_link()
     PROXY->poke(PCIE_TX_DMA_REG(DMA_CTRL_STATUS_REG, _fifo_instance), DMA_CTRL_DISABLED);
     PROXY->poke(PCIE_RX_DMA_REG(DMA_CTRL_STATUS_REG, _fifo_instance), DMA_CTRL_DISABLED);
 
-    UHD_SAFE_CALL(_flush_rx_buff();)
+    // Give back the frames of the current batch before flushing
+    _recv_elems_to_release += _recv_batch_left * _recv_frame_elems;
+    _recv_batch_left = 0;
+    UHD_SAFE_CALL(_release_recv_elems(); _flush_rx_buff();)
 
     // Stop DMA channels. Stop is called in the fifo dtor but
     // it doesn't hurt to do it here.
@@ -294,10 +309,19 @@ nirio_link::sptr nirio_link::make(uhd::niusrprio::niusrprio_session::sptr fpga_s
                 .str());
     }
 
+    // Batching: Leave most of the ring to the DMA engine, even if the user
+    // asks for large batches
+    const size_t recv_batch_frames = std::max<size_t>(1,
+        std::min(link_params.num_recv_frames / 4,
+            hints.cast<size_t>("recv_batch_frames", DEFAULT_RECV_BATCH_FRAMES)));
+    const bool busy_poll =
+        hints.has_key("busy_poll") && uhd::cast::from_str<bool>(hints["busy_poll"]);
+
     recv_buff_size = link_params.num_recv_frames * link_params.recv_frame_size;
     send_buff_size = link_params.num_send_frames * link_params.send_frame_size;
 
-    return nirio_link::sptr(new nirio_link(fpga_session, instance, link_params));
+    return nirio_link::sptr(new nirio_link(
+        fpga_session, instance, link_params, recv_batch_frames, busy_poll));
 }
 
 
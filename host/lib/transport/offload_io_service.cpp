@@ -270,7 +270,8 @@ public:
         recv_callback_t cb,
         send_link_if::sptr fc_link,
         size_t num_send_frames,
-        recv_io_if::fc_callback_t fc_cb);
+        recv_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
 
     send_io_if::sptr make_send_client(send_link_if::sptr send_link,
         size_t num_send_frames,
@@ -278,7 +279,8 @@ public:
         recv_link_if::sptr recv_link,
         size_t num_recv_frames,
         recv_callback_t recv_cb,
-        send_io_if::fc_callback_t fc_cb);
+        send_io_if::fc_callback_t fc_cb,
+        const recv_route_t& recv_route = recv_route_t());
 
 private:
     offload_io_service_impl(const offload_io_service_impl&) = delete;
@@ -461,7 +463,8 @@ recv_io_if::sptr offload_io_service_impl::make_recv_client(recv_link_if::sptr re
     recv_callback_t cb,
     send_link_if::sptr fc_link,
     size_t num_send_frames,
-    recv_io_if::fc_callback_t fc_cb)
+    recv_io_if::fc_callback_t fc_cb,
+    const recv_route_t& recv_route)
 {
     UHD_ASSERT_THROW(_offload_thread);
 
@@ -472,25 +475,37 @@ recv_io_if::sptr offload_io_service_impl::make_recv_client(recv_link_if::sptr re
     auto port = std::make_shared<client_port_t>(num_recv_frames);
 
     // Create a request to create a new receiver in the offload thread
-    auto req_fn =
-        [this, recv_link, num_recv_frames, cb, fc_link, num_send_frames, fc_cb, port]() {
-            frame_reservation_t frames = {
-                recv_link, num_recv_frames, fc_link, num_send_frames};
-            _reservation_mgr.reserve_frames(frames);
+    auto req_fn = [this,
+                      recv_link,
+                      num_recv_frames,
+                      cb,
+                      fc_link,
+                      num_send_frames,
+                      fc_cb,
+                      recv_route,
+                      port]() {
+        frame_reservation_t frames = {
+            recv_link, num_recv_frames, fc_link, num_send_frames};
+        _reservation_mgr.reserve_frames(frames);
 
-            auto inline_recv_io = _io_srv->make_recv_client(
-                recv_link, num_recv_frames, cb, fc_link, num_send_frames, fc_cb);
+        auto inline_recv_io = _io_srv->make_recv_client(recv_link,
+            num_recv_frames,
+            cb,
+            fc_link,
+            num_send_frames,
+            fc_cb,
+            recv_route);
 
-            recv_client_info_t client_info;
-            client_info.inline_io       = inline_recv_io;
-            client_info.port            = port;
-            client_info.frames_reserved = frames;
+        recv_client_info_t client_info;
+        client_info.inline_io       = inline_recv_io;
+        client_info.port            = port;
+        client_info.frames_reserved = frames;
 
-            _recv_clients.push_back(client_info);
+        _recv_clients.push_back(client_info);
 
-            // Notify that the connection is created
-            port->offload_thread_set_connected(true);
-        };
+        // Notify that the connection is created
+        port->offload_thread_set_connected(true);
+    };
 
     _queue_client_req(req_fn);
     port->client_wait_until_connected();
@@ -511,7 +526,8 @@ send_io_if::sptr offload_io_service_impl::make_send_client(send_link_if::sptr se
     recv_link_if::sptr recv_link,
     size_t num_recv_frames,
     recv_callback_t recv_cb,
-    send_io_if::fc_callback_t fc_cb)
+    send_io_if::fc_callback_t fc_cb,
+    const recv_route_t& recv_route)
 {
     UHD_ASSERT_THROW(_offload_thread);
 
@@ -530,6 +546,7 @@ send_io_if::sptr offload_io_service_impl::make_send_client(send_link_if::sptr se
                       num_recv_frames,
                       recv_cb,
                       fc_cb,
+                      recv_route,
                       port]() {
         frame_reservation_t frames = {
             recv_link, num_recv_frames, send_link, num_send_frames};
@@ -541,7 +558,8 @@ send_io_if::sptr offload_io_service_impl::make_send_client(send_link_if::sptr se
             recv_link,
             num_recv_frames,
             recv_cb,
-            fc_cb);
+            fc_cb,
+            recv_route);
 
         send_client_info_t client_info;
         client_info.inline_io       = inline_send_io;
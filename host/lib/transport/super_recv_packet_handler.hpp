@@ -228,58 +228,15 @@ public:
         const double timeout,
         const bool one_packet)
     {
-        // handle metadata queued from a previous receive
-        if (_queue_error_for_next_call) {
-            _queue_error_for_next_call = false;
-            metadata                   = _queue_metadata;
-            // We want to allow a full buffer recv to be cut short by a timeout,
-            // but do not want to generate an inline timeout message packet.
-            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT)
-                return 0;
-        }
-
-        // Just return if no samples requested
-        if (nsamps_per_buff == 0) {
-            metadata.reset();
-            return 0;
-        }
-
-        size_t accum_num_samps =
-            recv_one_packet(buffs, nsamps_per_buff, metadata, timeout);
-
-        if (one_packet or metadata.end_of_burst) {
-            return accum_num_samps;
-        }
-
-        // first recv had an error code set, return immediately
-        if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
-            return accum_num_samps;
-        }
-
-        // loop until buffer is filled or error code
-        while (accum_num_samps < nsamps_per_buff) {
-            size_t num_samps = recv_one_packet(buffs,
-                nsamps_per_buff - accum_num_samps,
-                _queue_metadata,
-                timeout,
-                accum_num_samps * _bytes_per_cpu_item);
-
-            metadata.end_of_burst = _queue_metadata.end_of_burst;
-
-            // metadata had an error code set, store for next call and return
-            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
-                _queue_error_for_next_call = true;
-                break;
-            }
-
-            accum_num_samps += num_samps;
+        const size_t num_samps =
+            recv_packets(buffs, nsamps_per_buff, metadata, timeout, one_packet);
 
-            // return immediately if end of burst
-            if (_queue_metadata.end_of_burst) {
-                break;
-            }
+        // The packets only carry the tick count. It is converted to a
+        // time_spec once per call, for the metadata that gets returned.
+        if (metadata.time_ticks.is_valid()) {
+            metadata.time_spec = metadata.time_ticks.to_time_spec();
         }
-        return accum_num_samps;
+        return num_samps;
     }
 
 private:
@@ -635,8 +592,8 @@ private:
                 case PACKET_INLINE_MESSAGE:
                     std::swap(curr_info, next_info); // save progress from curr -> next
                     curr_info.metadata.has_time_spec = next_info[index].ifpi.has_tsf;
-                    curr_info.metadata.time_spec =
-                        time_spec_t::from_ticks(next_info[index].time, _tick_rate);
+                    curr_info.metadata.time_ticks =
+                        time_ticks_t(next_info[index].time, _tick_rate);
                     curr_info.metadata.error_code =
                         rx_metadata_t::error_code_t(get_context_code(
                             next_info[index].vrt_hdr, next_info[index].ifpi));
@@ -673,12 +630,11 @@ private:
                     alignment_check(index, curr_info);
                     std::swap(curr_info, next_info); // save progress from curr -> next
                     curr_info.metadata.has_time_spec = prev_info.metadata.has_time_spec;
-                    curr_info.metadata.time_spec =
-                        prev_info.metadata.time_spec
-                        + time_spec_t::from_ticks(
-                              prev_info[index].ifpi.num_payload_words32 * sizeof(uint32_t)
-                                  / _bytes_per_otw_item,
-                              _samp_rate);
+                    curr_info.metadata.time_ticks    = prev_info.metadata.time_ticks;
+                    curr_info.metadata.time_ticks.advance(
+                        prev_info[index].ifpi.num_payload_words32 * sizeof(uint32_t)
+                            / _bytes_per_otw_item,
+                        _samp_rate);
                     curr_info.metadata.out_of_sequence = true;
                     curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
                     UHD_LOG_FASTPATH("D");
@@ -702,14 +658,76 @@ private:
         }
 
         // set the metadata from the buffer information at index zero
-        curr_info.metadata.has_time_spec = curr_info[0].ifpi.has_tsf;
-        curr_info.metadata.time_spec =
-            time_spec_t::from_ticks(curr_info[0].time, _tick_rate);
+        curr_info.metadata.has_time_spec   = curr_info[0].ifpi.has_tsf;
+        curr_info.metadata.time_ticks      = time_ticks_t(curr_info[0].time, _tick_rate);
         curr_info.metadata.more_fragments  = false;
         curr_info.metadata.fragment_offset = 0;
         curr_info.metadata.error_code      = rx_metadata_t::ERROR_CODE_NONE;
     }
 
+    /*******************************************************************
+     * Receive samples, without filling in metadata.time_spec
+     ******************************************************************/
+    UHD_INLINE size_t recv_packets(const uhd::rx_streamer::buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t& metadata,
+        const double timeout,
+        const bool one_packet)
+    {
+        // handle metadata queued from a previous receive
+        if (_queue_error_for_next_call) {
+            _queue_error_for_next_call = false;
+            metadata                   = _queue_metadata;
+            // We want to allow a full buffer recv to be cut short by a timeout,
+            // but do not want to generate an inline timeout message packet.
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT)
+                return 0;
+        }
+
+        // Just return if no samples requested
+        if (nsamps_per_buff == 0) {
+            metadata.reset();
+            return 0;
+        }
+
+        size_t accum_num_samps =
+            recv_one_packet(buffs, nsamps_per_buff, metadata, timeout);
+
+        if (one_packet or metadata.end_of_burst) {
+            return accum_num_samps;
+        }
+
+        // first recv had an error code set, return immediately
+        if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            return accum_num_samps;
+        }
+
+        // loop until buffer is filled or error code
+        while (accum_num_samps < nsamps_per_buff) {
+            size_t num_samps = recv_one_packet(buffs,
+                nsamps_per_buff - accum_num_samps,
+                _queue_metadata,
+                timeout,
+                accum_num_samps * _bytes_per_cpu_item);
+
+            metadata.end_of_burst = _queue_metadata.end_of_burst;
+
+            // metadata had an error code set, store for next call and return
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+                _queue_error_for_next_call = true;
+                break;
+            }
+
+            accum_num_samps += num_samps;
+
+            // return immediately if end of burst
+            if (_queue_metadata.end_of_burst) {
+                break;
+            }
+        }
+        return accum_num_samps;
+    }
+
     /*******************************************************************
      * Receive a single packet on all channels
      * Handles fragmentation, messages, errors, and copy-conversion.
@@ -731,9 +749,10 @@ private:
         buffers_info_type& info = get_curr_buffer_info();
         metadata                = info.metadata;
 
-        // interpolate the time spec (useful when this is a fragment)
-        metadata.time_spec +=
-            time_spec_t::from_ticks(info.fragment_offset_in_samps, _samp_rate);
+        // interpolate the time (useful when this is a fragment)
+        if (info.fragment_offset_in_samps != 0) {
+            metadata.time_ticks.advance(info.fragment_offset_in_samps, _samp_rate);
+        }
 
         // extract the number of samples available to copy
         const size_t nsamps_available = info.data_bytes_to_copy / _bytes_per_otw_item;
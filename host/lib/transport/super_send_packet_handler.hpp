@@ -186,7 +186,7 @@ public:
         if_packet_info.has_tlr = _has_tlr;
         if_packet_info.has_tsi = false;
         if_packet_info.has_tsf = metadata.has_time_spec;
-        if_packet_info.tsf     = metadata.time_spec.to_ticks(_tick_rate);
+        if_packet_info.tsf     = get_tsf(metadata);
         if_packet_info.sob     = metadata.start_of_burst;
         if_packet_info.eob     = metadata.end_of_burst;
         if_packet_info.fc_ack  = false; // This is a data packet
@@ -200,7 +200,7 @@ public:
             // If the new metada has a time_spec, do not use the cached time_spec.
             if (!metadata.has_time_spec) {
                 if_packet_info.has_tsf = _metadata_cache.has_time_spec;
-                if_packet_info.tsf     = _metadata_cache.time_spec.to_ticks(_tick_rate);
+                if_packet_info.tsf     = get_tsf(_metadata_cache);
             }
             if_packet_info.sob = _metadata_cache.start_of_burst;
             if_packet_info.eob = _metadata_cache.end_of_burst;
@@ -253,10 +253,16 @@ public:
                 return total_num_samps_sent;
 
             // setup metadata for the next fragment
-            const time_spec_t time_spec =
-                metadata.time_spec
-                + time_spec_t::from_ticks(total_num_samps_sent, _samp_rate);
-            if_packet_info.tsf = time_spec.to_ticks(_tick_rate);
+            if (metadata.has_time_ticks) {
+                if_packet_info.tsf = time_ticks_t(metadata.time_ticks)
+                                         .advance(total_num_samps_sent, _samp_rate)
+                                         .to_ticks(_tick_rate);
+            } else {
+                const time_spec_t time_spec =
+                    metadata.time_spec
+                    + time_spec_t::from_ticks(total_num_samps_sent, _samp_rate);
+                if_packet_info.tsf = time_spec.to_ticks(_tick_rate);
+            }
             if_packet_info.sob = false;
         }
 
@@ -297,6 +303,12 @@ private:
     bool _cached_metadata;
     uhd::tx_metadata_t _metadata_cache;
 
+    //! Return the timestamp in ticks, from the exact tick count if requested
+    UHD_INLINE uint64_t get_tsf(const uhd::tx_metadata_t& metadata) const
+    {
+        return metadata.has_time_ticks ? metadata.time_ticks.to_ticks(_tick_rate)
+                                              : metadata.time_spec.to_ticks(_tick_rate);
+    }
 
     /*******************************************************************
      * Send a single packet:
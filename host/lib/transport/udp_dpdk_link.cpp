@@ -161,6 +161,22 @@ frame_buff::uptr udp_dpdk_link::get_send_buff(int32_t /*timeout_ms*/)
     return frame_buff::uptr();
 }
 
+size_t udp_dpdk_link::get_send_buffs(dpdk_frame_buff** buffs, size_t num_buffs)
+{
+    // Use the output array as temporary storage for the rte_mbuf pointers
+    auto mbufs = reinterpret_cast<struct rte_mbuf**>(buffs);
+    if (rte_pktmbuf_alloc_bulk(_port->get_tx_pktbuf_pool(), mbufs, num_buffs)) {
+        return 0;
+    }
+    for (size_t i = 0; i < num_buffs; i++) {
+        struct rte_mbuf* mbuf = mbufs[i];
+        buffs[i]              = new (rte_mbuf_to_priv(mbuf)) dpdk_frame_buff(mbuf);
+        buffs[i]->header_jump(
+            sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) + sizeof(struct udp_hdr));
+    }
+    return num_buffs;
+}
+
 void udp_dpdk_link::release_send_buff(frame_buff::uptr buff)
 {
     dpdk_frame_buff* buff_ptr = (dpdk_frame_buff*)buff.release();
@@ -180,17 +196,13 @@ void udp_dpdk_link::release_send_buff(frame_buff::uptr buff)
             _local_port,
             _remote_port,
             buff_ptr->packet_size());
-        // Prepare the packet buffer and send it out
+        // Prepare the packet buffer and queue it up. The I/O service owning
+        // this link's DMA queue sends it out with the next burst.
         int status = rte_eth_tx_prepare(_port->get_port_id(), _queue, &mbuf, 1);
         if (status != 1) {
             throw uhd::runtime_error("DPDK: Failed to prepare TX buffer for send");
         }
-        status = rte_eth_tx_burst(_port->get_port_id(), _queue, &mbuf, 1);
-        while (status != 1) {
-            status = rte_eth_tx_burst(_port->get_port_id(), _queue, &mbuf, 1);
-            // FIXME: Should we make available retrying?
-            // throw uhd::runtime_error("DPDK: Failed to send TX buffer");
-        }
+        _port->buffer_tx(_queue, mbuf);
     } else {
         // Release the buffer if there is nothing in it
         rte_pktmbuf_free(mbuf);
@@ -13,7 +13,10 @@
 #include <uhdlib/utils/prefs.hpp>
 #include <arpa/inet.h>
 #include <rte_arp.h>
+#include <rte_flow.h>
+#include <rte_malloc.h>
 #include <boost/algorithm/string.hpp>
+#include <limits>
 
 namespace uhd { namespace transport { namespace dpdk {
 
@@ -26,6 +29,8 @@ constexpr size_t DPDK_HEADERS_SIZE           = 14 + 20 + 8; // Ethernet + IPv4 +
 constexpr uint16_t DPDK_DEFAULT_RING_SIZE    = 512;
 constexpr int DEFAULT_DPDK_LINK_INIT_TIMEOUT = 1000;
 constexpr int LINK_STATUS_INTERVAL           = 250;
+constexpr uint16_t TX_BUFFER_SIZE            = 32;
+constexpr size_t TX_BUFFER_MAX_RETRIES       = 10000;
 
 inline char* eal_add_opt(
     std::vector<const char*>& argv, size_t n, char* dst, const char* opt, const char* arg)
@@ -53,6 +58,95 @@ inline void separate_ipv4_addr(
     int netbits = std::atoi(result[1].c_str());
     netmask     = htonl(0xffffffff << (32 - netbits));
 }
+
+/* Parse the dpdk_lcore argument, which is either a single lcore ID or a
+ * comma-separated list with one lcore per DMA queue
+ */
+std::vector<size_t> get_lcore_list(const std::string& lcores)
+{
+    std::vector<std::string> tokens;
+    boost::algorithm::split(tokens,
+        lcores,
+        [](const char& in) { return in == ','; },
+        boost::token_compress_on);
+    std::vector<size_t> lcore_ids;
+    for (const auto& token : tokens) {
+        const size_t lcore_id = std::stoul(boost::algorithm::trim_copy(token));
+        if (!uhd::has(lcore_ids, lcore_id)) {
+            lcore_ids.push_back(lcore_id);
+        }
+    }
+    UHD_ASSERT_THROW(!lcore_ids.empty());
+    return lcore_ids;
+}
+
+/* Error callback for buffered TX: Unlike DPDK's default callback, which drops
+ * the unsent packets right away, retry until the descriptor ring accepts them.
+ * This matches the behaviour of the unbuffered send path. If the NIC doesn't
+ * accept them after TX_BUFFER_MAX_RETRIES attempts (e.g., because the link is
+ * down), the rest is freed and counted as dropped, like the default
+ * rte_eth_tx_buffer_count_callback() does, so the I/O service doesn't hang.
+ */
+void tx_buffer_retry_cb(struct rte_mbuf** pkts, uint16_t unsent, void* userdata)
+{
+    auto ctx = static_cast<dpdk_port::tx_retry_ctx_t*>(userdata);
+    for (size_t i = 0; unsent && i < TX_BUFFER_MAX_RETRIES; i++) {
+        uint16_t sent = rte_eth_tx_burst(ctx->port, ctx->queue, pkts, unsent);
+        pkts += sent;
+        unsent -= sent;
+    }
+    for (uint16_t i = 0; i < unsent; i++) {
+        rte_pktmbuf_free(pkts[i]);
+    }
+    ctx->num_dropped += unsent;
+}
+
+/* Build the flow rule that steers UDP packets for dst_port to an RX queue,
+ * and either validate or create it.
+ */
+struct rte_flow* make_udp_flow(port_id_t port,
+    uint16_t dst_port,
+    queue_id_t queue_id,
+    bool validate_only,
+    int* status)
+{
+    struct rte_flow_attr attr = {};
+    attr.ingress              = 1;
+
+    struct rte_flow_item_udp udp_spec = {};
+    struct rte_flow_item_udp udp_mask = {};
+    udp_spec.hdr.dst_port             = dst_port;
+    udp_mask.hdr.dst_port             = 0xffff;
+
+    struct rte_flow_item pattern[4] = {};
+    pattern[0].type                 = RTE_FLOW_ITEM_TYPE_ETH;
+    pattern[1].type                 = RTE_FLOW_ITEM_TYPE_IPV4;
+    pattern[2].type                 = RTE_FLOW_ITEM_TYPE_UDP;
+    pattern[2].spec                 = &udp_spec;
+    pattern[2].mask                 = &udp_mask;
+    pattern[3].type                 = RTE_FLOW_ITEM_TYPE_END;
+
+    struct rte_flow_action_queue queue = {};
+    queue.index                        = queue_id;
+    struct rte_flow_action actions[2]  = {};
+    actions[0].type                    = RTE_FLOW_ACTION_TYPE_QUEUE;
+    actions[0].conf                    = &queue;
+    actions[1].type                    = RTE_FLOW_ACTION_TYPE_END;
+
+    struct rte_flow_error error;
+    if (validate_only) {
+        *status = rte_flow_validate(port, &attr, pattern, actions, &error);
+        return nullptr;
+    }
+    struct rte_flow* flow = rte_flow_create(port, &attr, pattern, actions, &error);
+    *status               = flow ? 0 : -rte_errno;
+    if (!flow) {
+        UHD_LOG_DEBUG("DPDK",
+            "Port " << port << ": Could not create flow rule: "
+                    << (error.message ? error.message : "unknown error"));
+    }
+    return flow;
+}
 } // namespace
 
 dpdk_port::uptr dpdk_port::make(port_id_t port,
@@ -121,11 +215,151 @@ dpdk_port::dpdk_port(port_id_t port,
         _num_queues = num_queues;
     }
 
+    _configure(dev_info, num_desc);
+
+    /* With multiple queues, UDP flows must be steered to the queue of the
+     * I/O service that owns them. Traffic that RSS hashes to any other queue
+     * would be dropped, so if neither flow rules nor the redirection table can
+     * send it to queue 0, the port falls back to a single queue. */
+    if (_num_queues > 1) {
+        _flow_steering = _probe_flow_steering();
+        if (!_flow_steering) {
+            UHD_LOGGER_WARNING("DPDK")
+                << boost::format("Port %d: NIC does not support UDP flow rules. All "
+                                 "received traffic will be handled by queue 0.")
+                       % _port;
+            if (!_redirect_rss_to_queue_0(dev_info)) {
+                UHD_LOGGER_WARNING("DPDK")
+                    << boost::format("Port %d: Could not update RSS redirection table. "
+                                     "Reconfiguring with a single queue.")
+                           % _port;
+                rte_eth_dev_stop(_port);
+                _num_queues = 1;
+                _configure(dev_info, num_desc);
+            }
+        }
+    }
+
+    /* Grab and display the port MAC address. */
+    rte_eth_macaddr_get(_port, &_mac_addr);
+    UHD_LOGGER_TRACE("DPDK") << "Port " << _port
+                             << " MAC: " << eth_addr_to_string(_mac_addr);
+}
+
+dpdk_port::~dpdk_port()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        struct rte_flow_error error;
+        for (auto& flow : _udp_flows) {
+            rte_flow_destroy(_port, flow.second, &error);
+        }
+        _udp_flows.clear();
+    }
+    rte_eth_dev_stop(_port);
+    for (auto buffer : _tx_buffers) {
+        rte_free(buffer);
+    }
+    rte_spinlock_lock(&_spinlock);
+    for (auto kv : _arp_table) {
+        for (auto& waiter : kv.second->reqs) {
+            waiter.req->cond.notify_one();
+        }
+        rte_free(kv.second);
+    }
+    _arp_table.clear();
+    rte_spinlock_unlock(&_spinlock);
+}
+
+uint16_t dpdk_port::alloc_udp_port(uint16_t udp_port)
+{
+    uint16_t port_selected;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (udp_port) {
+        if (_udp_ports.count(rte_be_to_cpu_16(udp_port))) {
+            return 0;
+        }
+        port_selected = rte_be_to_cpu_16(udp_port);
+    } else {
+        if (_udp_ports.size() >= 65535) {
+            UHD_LOG_WARNING("DPDK", "Attempted to allocate UDP port, but none remain");
+            return 0;
+        }
+        port_selected = _next_udp_port;
+        while (true) {
+            if (port_selected == 0) {
+                continue;
+            }
+            if (_udp_ports.count(port_selected) == 0) {
+                _next_udp_port = port_selected - 1;
+                break;
+            }
+            if (port_selected - 1 == _next_udp_port) {
+                return 0;
+            }
+            port_selected--;
+        }
+    }
+    _udp_ports.insert(port_selected);
+    return rte_cpu_to_be_16(port_selected);
+}
+
+int dpdk_port::add_udp_flow(uint16_t udp_port, queue_id_t queue_id)
+{
+    if (!_flow_steering) {
+        return (queue_id == 0) ? 0 : -ENOTSUP;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_udp_flows.count(udp_port)) {
+        return -EADDRINUSE;
+    }
+    int status;
+    auto flow = make_udp_flow(_port, udp_port, queue_id, false, &status);
+    if (!flow) {
+        return status;
+    }
+    _udp_flows[udp_port] = flow;
+    UHD_LOG_TRACE("DPDK",
+        "Port " << _port << ": Steering UDP port " << rte_be_to_cpu_16(udp_port)
+                << " to queue " << queue_id);
+    return 0;
+}
+
+void dpdk_port::del_udp_flow(uint16_t udp_port)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto flow = _udp_flows.find(udp_port);
+    if (flow == _udp_flows.end()) {
+        return;
+    }
+    struct rte_flow_error error;
+    if (rte_flow_destroy(_port, flow->second, &error)) {
+        UHD_LOG_WARNING("DPDK",
+            "Port " << _port << ": Could not remove flow rule for UDP port "
+                    << rte_be_to_cpu_16(udp_port));
+    }
+    _udp_flows.erase(flow);
+}
+
+void dpdk_port::_configure(const struct rte_eth_dev_info& dev_info, uint16_t num_desc)
+{
+    int retval;
+    const uint64_t rx_offloads = DEV_RX_OFFLOAD_IPV4_CKSUM;
+    const uint64_t tx_offloads = DEV_TX_OFFLOAD_IPV4_CKSUM;
+
     struct rte_eth_conf port_conf   = {};
     port_conf.rxmode.offloads       = rx_offloads | DEV_RX_OFFLOAD_JUMBO_FRAME;
     port_conf.rxmode.max_rx_pkt_len = _mtu;
     port_conf.txmode.offloads       = tx_offloads;
     port_conf.intr_conf.lsc         = 1;
+    if (_num_queues > 1) {
+        // Spread any traffic that isn't explicitly steered (see
+        // add_udp_flow()) across the RX queues
+        port_conf.rxmode.mq_mode               = ETH_MQ_RX_RSS;
+        port_conf.rx_adv_conf.rss_conf.rss_key = NULL;
+        port_conf.rx_adv_conf.rss_conf.rss_hf =
+            ETH_RSS_NONFRAG_IPV4_UDP & dev_info.flow_type_rss_offloads;
+    }
 
     retval = rte_eth_dev_configure(_port, _num_queues, _num_queues, &port_conf);
     if (retval != 0) {
@@ -188,7 +422,30 @@ dpdk_port::dpdk_port(port_id_t port,
         }
     }
 
-    /* TODO: Enable multiple queues (only support 1 right now) */
+    /* Set up the TX buffers, so the I/O services can send in bursts */
+    for (auto buffer : _tx_buffers) {
+        rte_free(buffer);
+    }
+    _tx_buffers.clear();
+    _tx_retry_ctxs.clear();
+    for (uint16_t i = 0; i < _num_queues; i++) {
+        auto buffer = (struct rte_eth_dev_tx_buffer*)rte_zmalloc_socket(NULL,
+            RTE_ETH_TX_BUFFER_SIZE(TX_BUFFER_SIZE),
+            0,
+            cpu_socket);
+        if (!buffer) {
+            UHD_LOGGER_ERROR("DPDK")
+                << boost::format("Port %d: Could not allocate TX buffer %d") % _port % i;
+            throw uhd::runtime_error("DPDK: Failure to allocate TX buffer");
+        }
+        rte_eth_tx_buffer_init(buffer, TX_BUFFER_SIZE);
+        auto retry_ctx   = std::unique_ptr<tx_retry_ctx_t>(new tx_retry_ctx_t);
+        retry_ctx->port  = _port;
+        retry_ctx->queue = i;
+        rte_eth_tx_buffer_set_err_callback(buffer, tx_buffer_retry_cb, retry_ctx.get());
+        _tx_buffers.push_back(buffer);
+        _tx_retry_ctxs.push_back(std::move(retry_ctx));
+    }
 
     /* Start the Ethernet device */
     retval = rte_eth_dev_start(_port);
@@ -197,58 +454,25 @@ dpdk_port::dpdk_port(port_id_t port,
             << boost::format("Port %d: Could not start device") % _port;
         throw uhd::runtime_error("DPDK: Failure to start device");
     }
-
-    /* Grab and display the port MAC address. */
-    rte_eth_macaddr_get(_port, &_mac_addr);
-    UHD_LOGGER_TRACE("DPDK") << "Port " << _port
-                             << " MAC: " << eth_addr_to_string(_mac_addr);
 }
 
-dpdk_port::~dpdk_port()
+bool dpdk_port::_redirect_rss_to_queue_0(const struct rte_eth_dev_info& dev_info)
 {
-    rte_eth_dev_stop(_port);
-    rte_spinlock_lock(&_spinlock);
-    for (auto kv : _arp_table) {
-        for (auto req : kv.second->reqs) {
-            req->cond.notify_one();
-        }
-        rte_free(kv.second);
+    constexpr size_t RETA_GROUPS = ETH_RSS_RETA_SIZE_512 / RTE_RETA_GROUP_SIZE;
+    struct rte_eth_rss_reta_entry64 reta_conf[RETA_GROUPS] = {};
+    for (auto& entry : reta_conf) {
+        entry.mask = ~0ULL;
     }
-    _arp_table.clear();
-    rte_spinlock_unlock(&_spinlock);
+    const uint16_t reta_size =
+        std::min<uint16_t>(dev_info.reta_size, ETH_RSS_RETA_SIZE_512);
+    return reta_size && !rte_eth_dev_rss_reta_update(_port, reta_conf, reta_size);
 }
 
-uint16_t dpdk_port::alloc_udp_port(uint16_t udp_port)
+bool dpdk_port::_probe_flow_steering()
 {
-    uint16_t port_selected;
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (udp_port) {
-        if (_udp_ports.count(rte_be_to_cpu_16(udp_port))) {
-            return 0;
-        }
-        port_selected = rte_be_to_cpu_16(udp_port);
-    } else {
-        if (_udp_ports.size() >= 65535) {
-            UHD_LOG_WARNING("DPDK", "Attempted to allocate UDP port, but none remain");
-            return 0;
-        }
-        port_selected = _next_udp_port;
-        while (true) {
-            if (port_selected == 0) {
-                continue;
-            }
-            if (_udp_ports.count(port_selected) == 0) {
-                _next_udp_port = port_selected - 1;
-                break;
-            }
-            if (port_selected - 1 == _next_udp_port) {
-                return 0;
-            }
-            port_selected--;
-        }
-    }
-    _udp_ports.insert(port_selected);
-    return rte_cpu_to_be_16(port_selected);
+    int status;
+    make_udp_flow(_port, rte_cpu_to_be_16(0xffff), _num_queues - 1, true, &status);
+    return status == 0;
 }
 
 int dpdk_port::_arp_reply(queue_id_t queue_id, struct arp_hdr* arp_req)
@@ -357,6 +581,9 @@ void dpdk_ctx::_eal_init(const device_addr_t& eal_args)
             opt = eal_add_opt(argv, end - opt, opt, "--file-prefix", val.c_str());
         } else if (key == "dpdk_driver") {
             opt = eal_add_opt(argv, end - opt, opt, "-d", val.c_str());
+        } else if (key == "dpdk_vdev") {
+            /* Virtual devices, e.g. net_null0 or net_ring0 for benchmarking */
+            opt = eal_add_opt(argv, end - opt, opt, "--vdev", val.c_str());
         }
         /* TODO: Change where log goes?
            int rte_openlog_stream( FILE * f)
@@ -439,8 +666,11 @@ void dpdk_ctx::init(const device_addr_t& user_args)
             }
             /* Now combine user args with conf file */
             auto conf = uhd::prefs::get_dpdk_nic_args(nic);
-            // TODO: Enable the use of multiple DMA queues
-            conf["dpdk_num_queues"] = "1";
+            /* One DMA queue per lcore servicing this NIC */
+            if (conf.has_key("dpdk_lcore")) {
+                conf["dpdk_num_queues"] =
+                    std::to_string(get_lcore_list(conf["dpdk_lcore"]).size());
+            }
 
             /* Update config, and remove ports that aren't fully configured */
             if (conf.has_key("dpdk_ipv4")) {
@@ -452,16 +682,14 @@ void dpdk_ctx::init(const device_addr_t& user_args)
             }
         }
 
-        std::map<size_t, std::vector<size_t>> lcore_to_port_id_map;
+        std::map<size_t, std::vector<std::pair<size_t, queue_id_t>>>
+            lcore_to_port_id_map;
         RTE_ETH_FOREACH_DEV(i)
         {
             auto& conf = nics.at(i);
             if (conf.has_key("dpdk_ipv4")) {
                 UHD_ASSERT_THROW(conf.has_key("dpdk_lcore"));
-                const size_t lcore_id = conf.cast<size_t>("dpdk_lcore", 0);
-                if (!lcore_to_port_id_map.count(lcore_id)) {
-                    lcore_to_port_id_map.insert({lcore_id, {}});
-                }
+                const auto lcore_ids = get_lcore_list(conf["dpdk_lcore"]);
 
                 // Allocating enough buffers for all DMA queues for each CPU socket
                 // - This is a bit inefficient for larger systems, since NICs may not
@@ -480,8 +708,13 @@ void dpdk_ctx::init(const device_addr_t& user_args)
                     tx_pool,
                     conf["dpdk_ipv4"]);
 
-                // Remember all port IDs that map to an lcore
-                lcore_to_port_id_map.at(lcore_id).push_back(i);
+                // Remember all port IDs (and the DMA queue) that map to an
+                // lcore. The port may have gotten fewer queues than requested.
+                const size_t num_queues = _ports[i]->get_queue_count();
+                for (size_t q = 0; q < num_queues; q++) {
+                    lcore_to_port_id_map[lcore_ids.at(q)].push_back(
+                        {i, static_cast<queue_id_t>(q)});
+                }
             }
         }
 
@@ -518,18 +751,21 @@ void dpdk_ctx::init(const device_addr_t& user_args)
         for (auto& lcore_portids_pair : lcore_to_port_id_map) {
             const size_t lcore_id = lcore_portids_pair.first;
             std::vector<dpdk_port*> dpdk_ports;
-            dpdk_ports.reserve(lcore_portids_pair.second.size());
-            for (const size_t port_id : lcore_portids_pair.second) {
-                dpdk_ports.push_back(get_port(port_id));
+            std::vector<queue_id_t> dpdk_queues;
+            std::vector<size_t> port_ids;
+            for (const auto& port_queue : lcore_portids_pair.second) {
+                dpdk_ports.push_back(get_port(port_queue.first));
+                dpdk_queues.push_back(port_queue.second);
+                port_ids.push_back(port_queue.first);
             }
             const size_t servq_depth = 32; // FIXME
             UHD_LOG_TRACE("DPDK",
                 "Creating I/O service for lcore "
                     << lcore_id << ", servicing " << dpdk_ports.size()
                     << " ports, service queue depth " << servq_depth);
-            _io_srv_portid_map.insert(
-                {uhd::transport::dpdk_io_service::make(lcore_id, dpdk_ports, servq_depth),
-                    lcore_portids_pair.second});
+            auto io_srv = uhd::transport::dpdk_io_service::make(
+                lcore_id, dpdk_ports, dpdk_queues, servq_depth);
+            _io_srv_portid_map.insert({io_srv, port_ids});
         }
     }
 }
@@ -602,9 +838,16 @@ bool dpdk_ctx::is_init_done(void) const
 }
 
 uhd::transport::dpdk_io_service::sptr dpdk_ctx::get_io_service(const size_t port_id)
+{
+    return get_io_service(port_id, 0);
+}
+
+uhd::transport::dpdk_io_service::sptr dpdk_ctx::get_io_service(
+    const size_t port_id, const queue_id_t queue_id)
 {
     for (auto& io_srv_portid_pair : _io_srv_portid_map) {
-        if (uhd::has(io_srv_portid_pair.second, port_id)) {
+        if (uhd::has(io_srv_portid_pair.second, port_id)
+            && io_srv_portid_pair.first->get_queue_id(port_id) == queue_id) {
             return io_srv_portid_pair.first;
         }
     }
@@ -615,6 +858,31 @@ uhd::transport::dpdk_io_service::sptr dpdk_ctx::get_io_service(const size_t port
     throw uhd::lookup_error(err_msg);
 }
 
+uhd::transport::dpdk_io_service::sptr dpdk_ctx::get_least_loaded_io_service(
+    const size_t port_id)
+{
+    auto port = get_port(port_id);
+    if (!port || !port->has_flow_steering()) {
+        return get_io_service(port_id, 0);
+    }
+    uhd::transport::dpdk_io_service::sptr io_srv;
+    size_t min_links = std::numeric_limits<size_t>::max();
+    for (auto& io_srv_portid_pair : _io_srv_portid_map) {
+        if (!uhd::has(io_srv_portid_pair.second, port_id)) {
+            continue;
+        }
+        const size_t num_links = io_srv_portid_pair.first->get_num_links();
+        if (num_links < min_links) {
+            min_links = num_links;
+            io_srv    = io_srv_portid_pair.first;
+        }
+    }
+    if (!io_srv) {
+        return get_io_service(port_id, 0);
+    }
+    return io_srv;
+}
+
 struct rte_mempool* dpdk_ctx::_get_rx_pktbuf_pool(
     unsigned int cpu_socket, size_t num_bufs)
 {
@@ -10,6 +10,7 @@
 #include <uhdlib/transport/dpdk/udp.hpp>
 #include <uhdlib/transport/dpdk_io_service_client.hpp>
 #include <uhdlib/utils/narrow.hpp>
+#include <rte_malloc.h>
 #include <cmath>
 
 /*
@@ -49,30 +50,55 @@
 
 using namespace uhd::transport;
 
-dpdk_io_service::dpdk_io_service(
-    unsigned int lcore_id, std::vector<dpdk::dpdk_port*> ports, size_t servq_depth)
+dpdk_io_service::dpdk_io_service(unsigned int lcore_id,
+    std::vector<dpdk::dpdk_port*> ports,
+    std::vector<dpdk::queue_id_t> queues,
+    size_t servq_depth)
     : _ctx(dpdk::dpdk_ctx::get())
     , _lcore_id(lcore_id)
     , _ports(ports)
+    , _queues(queues)
+    , _rx_tables(ports.size(), nullptr)
     , _servq(servq_depth, lcore_id)
 {
     UHD_LOG_TRACE("DPDK::IO_SERVICE", "Launching I/O service for lcore " << lcore_id);
-    for (auto port : _ports) {
+    UHD_ASSERT_THROW(!_ports.empty() && _ports.size() == _queues.size());
+    for (size_t i = 0; i < _ports.size(); i++) {
+        auto port = _ports[i];
         UHD_LOG_TRACE("DPDK::IO_SERVICE",
-            "lcore_id " << lcore_id << ": Adding port index " << port->get_port_id());
+            "lcore_id " << lcore_id << ": Adding port index " << port->get_port_id()
+                        << ", queue " << _queues[i]);
         _tx_queues[port->get_port_id()]      = std::list<dpdk_send_io*>();
         _recv_xport_map[port->get_port_id()] = std::list<dpdk_recv_io*>();
     }
+    /* The RX tables are indexed by UDP port, so we need no hashing to look up
+     * the receivers of a packet. They're allocated here rather than on the
+     * lcore, so a failure can be reported before any client submits requests
+     * to the service queue. */
+    for (auto& rx_table : _rx_tables) {
+        rx_table = (rx_flow_list**)rte_zmalloc_socket(NULL,
+            NUM_UDP_PORTS * sizeof(rx_flow_list*),
+            RTE_CACHE_LINE_SIZE,
+            uhd::narrow_cast<int>(rte_lcore_to_socket_id(lcore_id)));
+        if (rx_table == NULL) {
+            _free_rx_tables();
+            throw uhd::runtime_error("DPDK: Could not allocate RX table");
+        }
+    }
     int status = rte_eal_remote_launch(_io_worker, this, lcore_id);
     if (status) {
+        _free_rx_tables();
         throw uhd::runtime_error("DPDK: I/O service cannot launch on busy lcore");
     }
 }
 
-dpdk_io_service::sptr dpdk_io_service::make(
-    unsigned int lcore_id, std::vector<dpdk::dpdk_port*> ports, size_t servq_depth)
+dpdk_io_service::sptr dpdk_io_service::make(unsigned int lcore_id,
+    std::vector<dpdk::dpdk_port*> ports,
+    std::vector<dpdk::queue_id_t> queues,
+    size_t servq_depth)
 {
-    return dpdk_io_service::sptr(new dpdk_io_service(lcore_id, ports, servq_depth));
+    return dpdk_io_service::sptr(
+        new dpdk_io_service(lcore_id, ports, queues, servq_depth));
 }
 
 dpdk_io_service::~dpdk_io_service()
@@ -96,6 +122,18 @@ void dpdk_io_service::attach_recv_link(recv_link_if::sptr link)
     data.link    = dynamic_cast<udp_dpdk_link*>(link.get());
     data.is_recv = true;
     assert(data.link);
+    // Use this I/O service's DMA queue, and make the NIC deliver the link's
+    // packets to it
+    auto port       = data.link->get_port();
+    const int queue = get_queue_id(port->get_port_id());
+    UHD_ASSERT_THROW(queue >= 0);
+    data.link->set_queue_id(queue);
+    if (port->add_udp_flow(data.link->get_local_port(), queue)) {
+        UHD_LOG_ERROR("DPDK::IO_SERVICE",
+            "Could not steer UDP port " << rte_be_to_cpu_16(data.link->get_local_port())
+                                        << " to queue " << queue);
+        throw uhd::runtime_error("DPDK: Could not steer UDP port to DMA queue");
+    }
     auto req = wait_req_alloc(dpdk::wait_type::WAIT_FLOW_OPEN, (void*)&data);
     if (!req) {
         UHD_LOG_ERROR(
@@ -114,6 +152,9 @@ void dpdk_io_service::attach_send_link(send_link_if::sptr link)
 {
     udp_dpdk_link* dpdk_link = dynamic_cast<udp_dpdk_link*>(link.get());
     assert(dpdk_link);
+    const int queue = get_queue_id(dpdk_link->get_port()->get_port_id());
+    UHD_ASSERT_THROW(queue >= 0);
+    dpdk_link->set_queue_id(queue);
 
     // First, fill in destination MAC address
     struct dpdk::arp_request arp_data;
@@ -175,6 +216,7 @@ void dpdk_io_service::detach_recv_link(recv_link_if::sptr link)
     }
     _servq.submit(req, std::chrono::microseconds(-1));
     wait_req_put(req);
+    data.link->get_port()->del_udp_flow(data.link->get_local_port());
     {
         std::lock_guard<std::mutex> lock(_mutex);
         _recv_links.remove_if(
@@ -208,7 +250,8 @@ recv_io_if::sptr dpdk_io_service::make_recv_client(recv_link_if::sptr data_link,
     recv_callback_t cb,
     send_link_if::sptr /*fc_link*/,
     size_t num_send_frames,
-    recv_io_if::fc_callback_t fc_cb)
+    recv_io_if::fc_callback_t fc_cb,
+    const recv_route_t& /*recv_route*/)
 {
     auto link    = dynamic_cast<udp_dpdk_link*>(data_link.get());
     auto recv_io = std::make_shared<dpdk_recv_io>(
@@ -223,13 +266,26 @@ recv_io_if::sptr dpdk_io_service::make_recv_client(recv_link_if::sptr data_link,
     return recv_io;
 }
 
+int dpdk_io_service::get_queue_id(dpdk::port_id_t port_id) const
+{
+    const int port_idx = _get_port_idx(port_id);
+    return (port_idx < 0) ? -1 : _queues[port_idx];
+}
+
+size_t dpdk_io_service::get_num_links()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _recv_links.size();
+}
+
 send_io_if::sptr dpdk_io_service::make_send_client(send_link_if::sptr send_link,
     size_t num_send_frames,
     send_io_if::send_callback_t send_cb,
     recv_link_if::sptr /*recv_link*/,
     size_t num_recv_frames,
     recv_callback_t recv_cb,
-    send_io_if::fc_callback_t fc_cb)
+    send_io_if::fc_callback_t fc_cb,
+    const recv_route_t& /*recv_route*/)
 {
     auto link    = dynamic_cast<udp_dpdk_link*>(send_link.get());
     auto send_io = std::make_shared<dpdk_send_io>(shared_from_this(),
@@ -261,10 +317,6 @@ int dpdk_io_service::_io_worker(void* arg)
     if (lcore_id == LCORE_ID_ANY)
         return -ENODEV;
 
-    /* Check that this lcore has ports */
-    if (srv->_ports.size() == 0)
-        return -ENODEV;
-
     char name[16];
     snprintf(name, sizeof(name), "dpdk-io_%hu", (uint16_t)lcore_id);
     rte_thread_setname(pthread_self(), name);
@@ -273,25 +325,11 @@ int dpdk_io_service::_io_worker(void* arg)
 
     uhd::set_thread_priority_safe();
 
-    snprintf(name, sizeof(name), "rx-tbl_%hu", (uint16_t)lcore_id);
-    struct rte_hash_parameters hash_params = {.name = name,
-        .entries                                    = MAX_FLOWS,
-        .reserved                                   = 0,
-        .key_len                                    = sizeof(struct dpdk::ipv4_5tuple),
-        .hash_func                                  = NULL,
-        .hash_func_init_val                         = 0,
-        .socket_id  = uhd::narrow_cast<int>(rte_socket_id()),
-        .extra_flag = 0};
-    srv->_rx_table                         = rte_hash_create(&hash_params);
-    if (srv->_rx_table == NULL) {
-        return rte_errno;
-    }
-
     int status = 0;
     while (!status) {
         /* For each port, attempt to receive packets and process */
-        for (auto port : srv->_ports) {
-            srv->_rx_burst(port, 0);
+        for (size_t i = 0; i < srv->_ports.size(); i++) {
+            srv->_rx_burst(i);
         }
         /* For each port's TX queues, do TX */
         for (auto port : srv->_ports) {
@@ -301,6 +339,10 @@ int dpdk_io_service::_io_worker(void* arg)
         for (auto port : srv->_ports) {
             srv->_rx_release(port);
         }
+        /* Send out whatever the transports queued up on our DMA queues */
+        for (size_t i = 0; i < srv->_ports.size(); i++) {
+            srv->_ports[i]->flush_tx(srv->_queues[i]);
+        }
         /* Retry waking clients */
         if (srv->_retry_head) {
             dpdk_io_if* node = srv->_retry_head;
@@ -325,6 +367,20 @@ int dpdk_io_service::_io_worker(void* arg)
     return status;
 }
 
+void dpdk_io_service::_free_rx_tables()
+{
+    for (auto& rx_table : _rx_tables) {
+        if (!rx_table) {
+            continue;
+        }
+        for (size_t i = 0; i < NUM_UDP_PORTS; i++) {
+            delete rx_table[i];
+        }
+        rte_free(rx_table);
+        rx_table = nullptr;
+    }
+}
+
 int dpdk_io_service::_service_requests()
 {
     for (int i = 0; i < MAX_PENDING_SERVICE_REQS; i++) {
@@ -365,7 +421,7 @@ int dpdk_io_service::_service_requests()
                 break;
             }
             case dpdk::wait_type::WAIT_LCORE_TERM:
-                rte_free(_rx_table);
+                _free_rx_tables();
                 while (_servq.complete(req) == -ENOBUFS)
                     ;
                 // Return a positive value to indicate we should terminate
@@ -387,13 +443,9 @@ void dpdk_io_service::_service_flow_open(dpdk::wait_req* req)
     assert(flow_req_data);
     if (flow_req_data->is_recv) {
         // If RX, add to RX table. Currently, nothing to do for TX.
-        struct dpdk::ipv4_5tuple ht_key = {.flow_type = dpdk::flow_type::FLOW_TYPE_UDP,
-            .src_ip                                   = 0,
-            .dst_ip   = flow_req_data->link->get_port()->get_ipv4(),
-            .src_port = 0,
-            .dst_port = flow_req_data->link->get_local_port()};
+        auto& rx_entry = _get_rx_entry(flow_req_data->link);
         // Check the UDP port isn't in use
-        if (rte_hash_lookup(_rx_table, &ht_key) > 0) {
+        if (rx_entry) {
             req->retval = -EADDRINUSE;
             UHD_LOG_ERROR("DPDK::IO_SERVICE", "Cannot add to RX table");
             while (_servq.complete(req) == -ENOBUFS)
@@ -401,15 +453,7 @@ void dpdk_io_service::_service_flow_open(dpdk::wait_req* req)
             return;
         }
         // Add xport list for this UDP port
-        auto rx_entry = new std::list<dpdk_io_if*>();
-        if (rte_hash_add_key_data(_rx_table, &ht_key, rx_entry)) {
-            UHD_LOG_ERROR("DPDK::IO_SERVICE", "Could not add new RX list to table");
-            delete rx_entry;
-            req->retval = -ENOMEM;
-            while (_servq.complete(req) == -ENOBUFS)
-                ;
-            return;
-        }
+        rx_entry = new rx_flow_list();
     }
     while (_servq.complete(req) == -ENOBUFS)
         ;
@@ -421,20 +465,11 @@ void dpdk_io_service::_service_flow_close(dpdk::wait_req* req)
     assert(flow_req_data);
     if (flow_req_data->is_recv) {
         // If RX, remove from RX table. Currently, nothing to do for TX.
-        struct dpdk::ipv4_5tuple ht_key = {.flow_type = dpdk::flow_type::FLOW_TYPE_UDP,
-            .src_ip                                   = 0,
-            .dst_ip   = flow_req_data->link->get_port()->get_ipv4(),
-            .src_port = 0,
-            .dst_port = flow_req_data->link->get_local_port()};
-        std::list<dpdk_io_if*>* xport_list;
-
-        if (rte_hash_lookup_data(_rx_table, &ht_key, (void**)&xport_list) > 0) {
-            UHD_ASSERT_THROW(xport_list->empty());
-            delete xport_list;
-            rte_hash_del_key(_rx_table, &ht_key);
-            while (_servq.complete(req) == -ENOBUFS)
-                ;
-            return;
+        auto& rx_entry = _get_rx_entry(flow_req_data->link);
+        if (rx_entry) {
+            UHD_ASSERT_THROW(rx_entry->empty());
+            delete rx_entry;
+            rx_entry = nullptr;
         }
     }
     while (_servq.complete(req) == -ENOBUFS)
@@ -448,13 +483,8 @@ void dpdk_io_service::_service_xport_connect(dpdk::wait_req* req)
     auto port = dpdk_io->link->get_port();
     if (dpdk_io->recv_cb) {
         // Add to RX table only if have a callback.
-        struct dpdk::ipv4_5tuple ht_key = {.flow_type = dpdk::flow_type::FLOW_TYPE_UDP,
-            .src_ip                                   = 0,
-            .dst_ip                                   = port->get_ipv4(),
-            .src_port                                 = 0,
-            .dst_port                                 = dpdk_io->link->get_local_port()};
-        void* hash_data;
-        if (rte_hash_lookup_data(_rx_table, &ht_key, &hash_data) < 0) {
+        auto rx_entry = _get_rx_entry(dpdk_io->link);
+        if (!rx_entry) {
             req->retval = -ENOENT;
             UHD_LOG_ERROR("DPDK::IO_SERVICE", "Cannot add xport to RX table");
             while (_servq.complete(req) == -ENOBUFS)
@@ -462,7 +492,6 @@ void dpdk_io_service::_service_xport_connect(dpdk::wait_req* req)
             return;
         }
         // Add to xport list for this UDP port
-        auto rx_entry = (std::list<dpdk_io_if*>*)(hash_data);
         rx_entry->push_back(dpdk_io);
     }
     if (dpdk_io->is_recv) {
@@ -502,15 +531,9 @@ void dpdk_io_service::_service_xport_disconnect(dpdk::wait_req* req)
     auto port = dpdk_io->link->get_port();
     if (dpdk_io->recv_cb) {
         // Remove from RX table only if have a callback.
-        struct dpdk::ipv4_5tuple ht_key = {.flow_type = dpdk::flow_type::FLOW_TYPE_UDP,
-            .src_ip                                   = 0,
-            .dst_ip                                   = port->get_ipv4(),
-            .src_port                                 = 0,
-            .dst_port                                 = dpdk_io->link->get_local_port()};
-        void* hash_data;
-        if (rte_hash_lookup_data(_rx_table, &ht_key, &hash_data) >= 0) {
+        auto rx_entry = _get_rx_entry(dpdk_io->link);
+        if (rx_entry) {
             // Remove from xport list for this UDP port
-            auto rx_entry = (std::list<dpdk_io_if*>*)(hash_data);
             rx_entry->remove(dpdk_io);
         } else {
             req->retval = -EINVAL;
@@ -588,19 +611,19 @@ int dpdk_io_service::_service_arp_request(dpdk::wait_req* req)
             goto arp_end;
         }
         entry = new (entry) dpdk::arp_entry();
-        entry->reqs.push_back(req);
+        entry->reqs.push_back({req, &_servq});
         port->_arp_table[dst_addr] = entry;
         status                     = -EAGAIN;
         UHD_LOG_TRACE("DPDK::IO_SERVICE", "Address not in table. Sending ARP request.");
-        _send_arp_request(port, 0, arp_req_data->tpa);
+        _send_arp_request(port, get_queue_id(port->get_port_id()), arp_req_data->tpa);
     } else {
         entry = port->_arp_table.at(dst_addr);
         if (is_zero_ether_addr(&entry->mac_addr)) {
             UHD_LOG_TRACE("DPDK::IO_SERVICE",
                 "ARP: Address in table, but not populated yet. Resending ARP request.");
-            port->_arp_table.at(dst_addr)->reqs.push_back(req);
+            port->_arp_table.at(dst_addr)->reqs.push_back({req, &_servq});
             status = -EAGAIN;
-            _send_arp_request(port, 0, arp_req_data->tpa);
+            _send_arp_request(port, get_queue_id(port->get_port_id()), arp_req_data->tpa);
         } else {
             UHD_LOG_TRACE("DPDK::IO_SERVICE", "ARP: Address in table.");
             ether_addr_copy(&entry->mac_addr, &arp_req_data->tha);
@@ -655,11 +678,14 @@ int dpdk_io_service::_send_arp_request(
 }
 
 /* Do a burst of RX on port */
-int dpdk_io_service::_rx_burst(dpdk::dpdk_port* port, dpdk::queue_id_t queue)
+int dpdk_io_service::_rx_burst(size_t port_idx)
 {
     struct ether_hdr* hdr;
     char* l2_data;
     struct rte_mbuf* bufs[RX_BURST_SIZE];
+    dpdk::dpdk_port* port        = _ports[port_idx];
+    const dpdk::queue_id_t queue = _queues[port_idx];
+    rx_flow_list** rx_table      = _rx_tables[port_idx];
     const uint16_t num_rx =
         rte_eth_rx_burst(port->get_port_id(), queue, bufs, RX_BURST_SIZE);
     if (unlikely(num_rx == 0)) {
@@ -681,7 +707,7 @@ int dpdk_io_service::_rx_burst(dpdk::dpdk_port* port, dpdk::queue_id_t queue)
                 } else if ((ol_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_NONE) {
                     UHD_LOG_WARNING("DPDK::IO_SERVICE", "RX packet missing IP cksum");
                 } else {
-                    _process_ipv4(port, bufs[buf], (struct ipv4_hdr*)l2_data);
+                    _process_ipv4(port, rx_table, bufs[buf], (struct ipv4_hdr*)l2_data);
                 }
                 break;
             default:
@@ -689,9 +715,34 @@ int dpdk_io_service::_rx_burst(dpdk::dpdk_port* port, dpdk::queue_id_t queue)
                 break;
         }
     }
+    _rx_flush_stage();
     return num_rx;
 }
 
+void dpdk_io_service::_rx_flush_stage()
+{
+    for (size_t i = 0; i < _num_rx_stage; i++) {
+        auto& stage          = _rx_stage[i];
+        auto recv_io         = (dpdk_recv_io*)stage.io_if->io_client;
+        unsigned int num_enq = rte_ring_enqueue_burst(
+            recv_io->_recv_queue, (void**)stage.buffs, stage.num_buffs, NULL);
+        if (num_enq < stage.num_buffs) {
+            UHD_LOG_WARNING("DPDK::IO_SERVICE",
+                "Dropping " << (stage.num_buffs - num_enq)
+                            << " packets: No space in recv queue");
+            for (unsigned int j = num_enq; j < stage.num_buffs; j++) {
+                rte_pktmbuf_free(stage.buffs[j]->get_pktmbuf());
+            }
+        }
+        if (num_enq) {
+            recv_io->_num_frames_in_use += num_enq;
+            assert(recv_io->_num_frames_in_use <= recv_io->_num_recv_frames);
+            _wake_client(stage.io_if);
+        }
+    }
+    _num_rx_stage = 0;
+}
+
 int dpdk_io_service::_process_arp(
     dpdk::dpdk_port* port, dpdk::queue_id_t queue_id, struct arp_hdr* arp_frame)
 {
@@ -706,6 +757,7 @@ int dpdk_io_service::_process_arp(
     if (port->_arp_table.count(dest_ip) == 0) {
         entry = (struct dpdk::arp_entry*)rte_zmalloc(NULL, sizeof(*entry), 0);
         if (!entry) {
+            rte_spinlock_unlock(&port->_spinlock);
             return -ENOMEM;
         }
         entry = new (entry) dpdk::arp_entry();
@@ -714,10 +766,12 @@ int dpdk_io_service::_process_arp(
     } else {
         entry = port->_arp_table.at(dest_ip);
         ether_addr_copy(&dest_addr, &entry->mac_addr);
-        for (auto req : entry->reqs) {
-            auto arp_data = (struct dpdk::arp_request*)req->data;
+        // The reply may arrive on another I/O service's queue than the
+        // request was made on, so complete it through the requester's queue
+        for (auto& waiter : entry->reqs) {
+            auto arp_data = (struct dpdk::arp_request*)waiter.req->data;
             ether_addr_copy(&dest_addr, &arp_data->tha);
-            while (_servq.complete(req) == -ENOBUFS)
+            while (waiter.servq->complete(waiter.req) == -ENOBUFS)
                 ;
         }
         entry->reqs.clear();
@@ -734,8 +788,10 @@ int dpdk_io_service::_process_arp(
     return 0;
 }
 
-int dpdk_io_service::_process_ipv4(
-    dpdk::dpdk_port* port, struct rte_mbuf* mbuf, struct ipv4_hdr* pkt)
+int dpdk_io_service::_process_ipv4(dpdk::dpdk_port* port,
+    rx_flow_list** rx_table,
+    struct rte_mbuf* mbuf,
+    struct ipv4_hdr* pkt)
 {
     bool bcast = port->dst_is_broadcast(pkt->dst_addr);
     if (pkt->dst_addr != port->get_ipv4() && !bcast) {
@@ -743,30 +799,25 @@ int dpdk_io_service::_process_ipv4(
         return -ENODEV;
     }
     if (pkt->next_proto_id == IPPROTO_UDP) {
-        return _process_udp(port, mbuf, (struct udp_hdr*)&pkt[1], bcast);
+        return _process_udp(rx_table, mbuf, (struct udp_hdr*)&pkt[1], bcast);
     }
     rte_pktmbuf_free(mbuf);
     return -EINVAL;
 }
 
 
-int dpdk_io_service::_process_udp(
-    dpdk::dpdk_port* port, struct rte_mbuf* mbuf, struct udp_hdr* pkt, bool /*bcast*/)
+int dpdk_io_service::_process_udp(rx_flow_list** rx_table,
+    struct rte_mbuf* mbuf,
+    struct udp_hdr* pkt,
+    bool /*bcast*/)
 {
-    // Get the link
-    struct dpdk::ipv4_5tuple ht_key = {.flow_type = dpdk::flow_type::FLOW_TYPE_UDP,
-        .src_ip                                   = 0,
-        .dst_ip                                   = port->get_ipv4(),
-        .src_port                                 = 0,
-        .dst_port                                 = pkt->dst_port};
-    void* hash_data;
-    if (rte_hash_lookup_data(_rx_table, &ht_key, &hash_data) < 0) {
+    // Get xport list for this UDP port
+    auto rx_entry = rx_table[rte_be_to_cpu_16(pkt->dst_port)];
+    if (!rx_entry) {
         UHD_LOG_WARNING("DPDK::IO_SERVICE", "Dropping packet: No link entry in rx table");
         rte_pktmbuf_free(mbuf);
         return -ENOENT;
     }
-    // Get xport list for this UDP port
-    auto rx_entry = (std::list<dpdk_io_if*>*)(hash_data);
     if (rx_entry->empty()) {
         UHD_LOG_WARNING("DPDK::IO_SERVICE", "Dropping packet: No xports for link");
         rte_pktmbuf_free(mbuf);
@@ -783,17 +834,22 @@ int dpdk_io_service::_process_udp(
             rcvr_found = true;
             if (buff) {
                 assert(client_if->is_recv);
-                auto recv_io  = (dpdk_recv_io*)client_if->io_client;
-                auto buff_ptr = (dpdk::dpdk_frame_buff*)buff.release();
-                if (rte_ring_enqueue(recv_io->_recv_queue, buff_ptr)) {
-                    rte_pktmbuf_free(buff_ptr->get_pktmbuf());
-                    UHD_LOG_WARNING(
-                        "DPDK::IO_SERVICE", "Dropping packet: No space in recv queue");
-                } else {
-                    recv_io->_num_frames_in_use++;
-                    assert(recv_io->_num_frames_in_use <= recv_io->_num_recv_frames);
-                    _wake_client(client_if);
+                // Hold on to the buffer until the end of the burst, so all of
+                // the transport's packets are handed over at once
+                size_t i = 0;
+                for (; i < _num_rx_stage; i++) {
+                    if (_rx_stage[i].io_if == client_if) {
+                        break;
+                    }
+                }
+                if (i == _num_rx_stage) {
+                    _rx_stage[i].io_if     = client_if;
+                    _rx_stage[i].num_buffs = 0;
+                    _num_rx_stage++;
                 }
+                auto& stage = _rx_stage[i];
+                stage.buffs[stage.num_buffs++] =
+                    (dpdk::dpdk_frame_buff*)buff.release();
             }
             break;
         }
@@ -814,36 +870,50 @@ int dpdk_io_service::_tx_burst(dpdk::dpdk_port* port)
     auto& queues          = _tx_queues.at(port->get_port_id());
 
     for (auto& send_io : queues) {
-        unsigned int num_tx   = rte_ring_count(send_io->_send_queue);
-        num_tx                = (num_tx < TX_BURST_SIZE) ? num_tx : TX_BURST_SIZE;
-        bool replaced_buffers = false;
-        for (unsigned int i = 0; i < num_tx; i++) {
-            size_t frame_size = send_io->_dpdk_io_if.link->get_send_frame_size();
-            if (send_io->_fc_cb && !send_io->_fc_cb(frame_size)) {
-                break;
+        auto link = send_io->_dpdk_io_if.link;
+        dpdk::dpdk_frame_buff* buffs[TX_BURST_SIZE];
+        unsigned int num_tx = 0;
+        if (send_io->_fc_cb) {
+            // Flow control must be checked before every frame, since sending
+            // one changes the state for the next
+            const size_t frame_size = link->get_send_frame_size();
+            unsigned int num_avail  = rte_ring_count(send_io->_send_queue);
+            num_avail = (num_avail < TX_BURST_SIZE) ? num_avail : TX_BURST_SIZE;
+            for (; num_tx < num_avail; num_tx++) {
+                if (!send_io->_fc_cb(frame_size)) {
+                    break;
+                }
+                if (rte_ring_dequeue(send_io->_send_queue, (void**)&buffs[num_tx])) {
+                    UHD_LOG_ERROR("DPDK::IO_SERVICE", "TX Q Count doesn't match actual");
+                    break;
+                }
+                send_io->_send_cb(frame_buff::uptr(buffs[num_tx]), link);
             }
-            dpdk::dpdk_frame_buff* buff_ptr;
-            int status = rte_ring_dequeue(send_io->_send_queue, (void**)&buff_ptr);
-            if (status) {
-                UHD_LOG_ERROR("DPDK::IO_SERVICE", "TX Q Count doesn't match actual");
-                break;
+        } else {
+            num_tx = rte_ring_dequeue_burst(
+                send_io->_send_queue, (void**)buffs, TX_BURST_SIZE, NULL);
+            for (unsigned int i = 0; i < num_tx; i++) {
+                send_io->_send_cb(frame_buff::uptr(buffs[i]), link);
             }
-            send_io->_send_cb(frame_buff::uptr(buff_ptr), send_io->_dpdk_io_if.link);
-            // Attempt to replace buffer
-            buff_ptr = (dpdk::dpdk_frame_buff*)send_io->_dpdk_io_if.link->get_send_buff(0)
-                           .release();
-            if (!buff_ptr) {
-                UHD_LOG_ERROR("DPDK::IO_SERVICE",
-                    "TX mempool out of memory. Please increase dpdk_num_mbufs.");
-                send_io->_num_frames_in_use--;
-            } else if (rte_ring_enqueue(send_io->_buffer_queue, buff_ptr)) {
-                rte_pktmbuf_free(buff_ptr->get_pktmbuf());
-                send_io->_num_frames_in_use--;
-            } else {
-                replaced_buffers = true;
+        }
+        if (num_tx == 0) {
+            continue;
+        }
+
+        // Attempt to replace the buffers
+        unsigned int num_replaced = 0;
+        if (link->get_send_buffs(buffs, num_tx)) {
+            num_replaced = rte_ring_enqueue_burst(
+                send_io->_buffer_queue, (void**)buffs, num_tx, NULL);
+            for (unsigned int i = num_replaced; i < num_tx; i++) {
+                rte_pktmbuf_free(buffs[i]->get_pktmbuf());
             }
+        } else {
+            UHD_LOG_ERROR("DPDK::IO_SERVICE",
+                "TX mempool out of memory. Please increase dpdk_num_mbufs.");
         }
-        if (replaced_buffers) {
+        send_io->_num_frames_in_use -= (num_tx - num_replaced);
+        if (num_replaced) {
             _wake_client(&send_io->_dpdk_io_if);
         }
         total_tx += num_tx;
@@ -858,26 +928,38 @@ int dpdk_io_service::_rx_release(dpdk::dpdk_port* port)
     auto& queues            = _recv_xport_map.at(port->get_port_id());
 
     for (auto& recv_io : queues) {
-        unsigned int num_buf = rte_ring_count(recv_io->_release_queue);
-        num_buf              = (num_buf < RX_BURST_SIZE) ? num_buf : RX_BURST_SIZE;
+        dpdk::dpdk_frame_buff* buffs[RX_BURST_SIZE];
+        unsigned int num_buf = rte_ring_dequeue_burst(
+            recv_io->_release_queue, (void**)buffs, RX_BURST_SIZE, NULL);
         for (unsigned int i = 0; i < num_buf; i++) {
-            dpdk::dpdk_frame_buff* buff_ptr;
-            int status = rte_ring_dequeue(recv_io->_release_queue, (void**)&buff_ptr);
-            if (status) {
-                UHD_LOG_ERROR("DPDK::IO_SERVICE", "RX Q Count doesn't match actual");
-                break;
-            }
-            recv_io->_fc_cb(frame_buff::uptr(buff_ptr),
+            recv_io->_fc_cb(frame_buff::uptr(buffs[i]),
                 recv_io->_dpdk_io_if.link,
                 recv_io->_dpdk_io_if.link);
-            recv_io->_num_frames_in_use--;
         }
+        recv_io->_num_frames_in_use -= num_buf;
         total_bufs += num_buf;
     }
 
     return total_bufs;
 }
 
+int dpdk_io_service::_get_port_idx(dpdk::port_id_t port_id) const
+{
+    for (size_t i = 0; i < _ports.size(); i++) {
+        if (_ports[i]->get_port_id() == port_id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+dpdk_io_service::rx_flow_list*& dpdk_io_service::_get_rx_entry(udp_dpdk_link* link)
+{
+    const int port_idx = _get_port_idx(link->get_port()->get_port_id());
+    UHD_ASSERT_THROW(port_idx >= 0);
+    return _rx_tables[port_idx][rte_be_to_cpu_16(link->get_local_port())];
+}
+
 uint16_t dpdk_io_service::_get_unique_client_id()
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -9,6 +9,7 @@
 #define INCLUDED_UHD_TIME_SPEC_PYTHON_HPP
 
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/time_ticks.hpp>
 #include <pybind11/operators.h>
 
 void export_time_spec(py::module& m)
@@ -38,6 +39,25 @@ void export_time_spec(py::module& m)
         .def(py::self -= double())
         .def(py::self + double())
         .def(py::self - double());
+
+    using time_ticks_t = uhd::time_ticks_t;
+
+    py::class_<time_ticks_t>(m, "time_ticks")
+        .def(py::init<>())
+        .def(py::init<uint64_t, double>())
+
+        // Methods
+        .def_static("from_time_spec", &time_ticks_t::from_time_spec)
+
+        .def("is_valid", &time_ticks_t::is_valid)
+        .def("get_ticks", &time_ticks_t::get_ticks)
+        .def("get_tick_rate", &time_ticks_t::get_tick_rate)
+        .def("to_ticks", &time_ticks_t::to_ticks)
+        .def("to_time_spec", &time_ticks_t::to_time_spec)
+        .def("advance", &time_ticks_t::advance)
+
+        .def(py::self == py::self)
+        .def(py::self != py::self);
 }
 
 #endif /* INCLUDED_UHD_TIME_SPEC_PYTHON_HPP */
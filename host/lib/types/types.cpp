@@ -25,6 +25,7 @@ stream_cmd_t::stream_cmd_t(const stream_mode_t& stream_mode)
 tx_metadata_t::tx_metadata_t(void)
     : has_time_spec(false)
     , time_spec(time_spec_t())
+    , has_time_ticks(false)
     , start_of_burst(false)
     , end_of_burst(false)
 {
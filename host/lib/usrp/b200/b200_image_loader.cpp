@@ -13,6 +13,7 @@
 #include <uhd/usrp/mboard_eeprom.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhdlib/usrp/common/image_loader_console.hpp>
 #include <boost/assign.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -126,12 +127,16 @@ static bool b200_image_loader(const image_loader::image_loader_args_t& image_loa
     } else
         fpga_path = image_loader_args.fpga_path;
 
-    std::cout << boost::format("Unit: USRP %s (%s)")
+    image_loader_console console(image_loader_args.message);
+    console << boost::format("Unit: USRP %s (%s)")
                      % B2XX_STR_NAMES.get(get_b200_product(handle, mb_eeprom), "B2XX")
                      % mb_eeprom.get("serial")
               << std::endl;
 
     iface->load_fpga(fpga_path, true);
+    if (image_loader_args.progress) {
+        image_loader_args.progress(1.0);
+    }
 
     return true;
 }
@@ -96,7 +96,12 @@ const double ad9361_device_t::DEFAULT_TX_FREQ = 850e6;
  *
  * The process is the same for both filters, but the function must be told
  * how many taps are in the filter, and given a vector of the taps
- * themselves.  */
+ * themselves.
+ *
+ * Writing a full table takes several hundred SPI transactions. The
+ * coefficient memory keeps its contents across rate changes, so if the
+ * selected chains already hold these taps, only the filter configuration is
+ * written. */
 
 void ad9361_device_t::_program_fir_filter(
     direction_t direction, chain_t chain, int num_taps, uint16_t* coeffs)
@@ -126,6 +131,24 @@ void ad9361_device_t::_program_fir_filter(
             reg_chain = 0x03 << 3;
     }
 
+    const std::vector<uint16_t> taps(coeffs, coeffs + num_taps);
+    const bool programmed =
+        (chain == CHAIN_2 or _fir_taps[direction][CHAIN_1] == taps)
+        and (chain == CHAIN_1 or _fir_taps[direction][CHAIN_2] == taps);
+    if (programmed) {
+        UHD_LOG_TRACE("AD936X",
+            "[ad9361_device_t::_program_fir_filter] Reusing programmed "
+                << (direction == RX ? "RX" : "TX") << " FIR taps");
+        _io_iface->poke8(base + 5, reg_numtaps | reg_chain);
+        if (direction == RX) {
+            _io_iface->poke8(base + 6, 0x02);
+        }
+        return;
+    }
+    /* If we fail halfway, we don't know what's in the coefficient memory */
+    _fir_taps[direction][CHAIN_1].clear();
+    _fir_taps[direction][CHAIN_2].clear();
+
     /* Turn on the filter clock. */
     _io_iface->poke8(base + 5, reg_numtaps | reg_chain | 0x02);
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -173,6 +196,13 @@ void ad9361_device_t::_program_fir_filter(
            page 25 of UG-671 */
         _io_iface->poke8(base + 5, reg_numtaps | reg_chain);
     }
+
+    if (chain != CHAIN_2) {
+        _fir_taps[direction][CHAIN_1] = taps;
+    }
+    if (chain != CHAIN_1) {
+        _fir_taps[direction][CHAIN_2] = taps;
+    }
 }
 
 
@@ -760,16 +790,10 @@ void ad9361_device_t::_calibrate_baseband_dc_offset()
     _io_iface->poke8(0x194, 0x01); // More calibration settings
 
     /* Start that calibration, baby. */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x01);
-    while (_io_iface->peek8(0x016) & 0x01) {
-        if (count > 100) {
-            throw uhd::runtime_error(
-                "[ad9361_device_t] Baseband DC Offset Calibration Failure");
-            break;
-        }
-        count++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (not _wait_for_calibration(0x01, std::chrono::milliseconds(500))) {
+        throw uhd::runtime_error(
+            "[ad9361_device_t] Baseband DC Offset Calibration Failure");
     }
 }
 
@@ -794,16 +818,9 @@ void ad9361_device_t::_calibrate_rf_dc_offset()
     _io_iface->poke8(0x189, 0x30);
 
     /* Run the calibration! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x02);
-    while (_io_iface->peek8(0x016) & 0x02) {
-        if (count > 200) {
-            throw uhd::runtime_error(
-                "[ad9361_device_t] RF DC Offset Calibration Failure");
-            break;
-        }
-        count++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (not _wait_for_calibration(0x02, std::chrono::milliseconds(10000))) {
+        throw uhd::runtime_error("[ad9361_device_t] RF DC Offset Calibration Failure");
     }
 
     _io_iface->poke8(0x18b, 0x8d); // Enable RF DC tracking
@@ -846,16 +863,9 @@ void ad9361_device_t::_calibrate_rx_quadrature()
     double current_tx_freq = _tx_freq;
     _tune_helper(TX, _rx_freq + _rx_bb_lp_bw / 2.0);
 
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x20);
-    while (_io_iface->peek8(0x016) & 0x20) {
-        if (count > 1000) {
-            throw uhd::runtime_error(
-                "[ad9361_device_t] Rx Quadrature Calibration Failure");
-            break;
-        }
-        count++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (not _wait_for_calibration(0x20, std::chrono::milliseconds(5000))) {
+        throw uhd::runtime_error("[ad9361_device_t] Rx Quadrature Calibration Failure");
     }
 
     _io_iface->poke8(0x057, 0x30); // Re-enable Tx mixers
@@ -915,16 +925,9 @@ void ad9361_device_t::_tx_quadrature_cal_routine()
     _io_iface->poke8(0x0ae, 0x00); // Cal LPF gain index (split mode)
 
     /* Now, calibrate the TX quadrature! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x10);
-    while (_io_iface->peek8(0x016) & 0x10) {
-        if (count > 100) {
-            throw uhd::runtime_error(
-                "[ad9361_device_t] TX Quadrature Calibration Failure");
-            break;
-        }
-        count++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (not _wait_for_calibration(0x10, std::chrono::milliseconds(1000))) {
+        throw uhd::runtime_error("[ad9361_device_t] TX Quadrature Calibration Failure");
     }
 }
 
@@ -988,6 +991,12 @@ void ad9361_device_t::_program_mixer_gm_subtable()
             0x33, 0x34, 0x35, 0x3A, 0x3D, 0x3E };
     // clang-format on
 
+    /* The table is the same for all rates, so it only needs to be written
+     * once after a reset. */
+    if (_mixer_gm_subtable_programmed) {
+        return;
+    }
+
     /* Start the clock. */
     _io_iface->poke8(0x13f, 0x02);
 
@@ -1008,6 +1017,7 @@ void ad9361_device_t::_program_mixer_gm_subtable()
     _io_iface->poke8(0x13C, 0x00);
     _io_iface->poke8(0x13C, 0x00);
     _io_iface->poke8(0x13f, 0x00);
+    _mixer_gm_subtable_programmed = true;
 }
 
 /* Program the gain table.
@@ -1150,6 +1160,13 @@ void ad9361_device_t::_setup_synth(direction_t direction, double vcorate)
     if (vcoindex > 53)
         throw uhd::runtime_error("[ad9361_device_t] vcoindex > 53");
 
+    /* Neighbouring frequencies share a row of the LUT, so when retuning, the
+     * synthesizer is usually already set up. */
+    if (_synth_lut_index[direction] == vcoindex) {
+        return;
+    }
+    _synth_lut_index[direction] = -1;
+
     /* Parse the values out of the LUT based on our calculated index... */
     uint8_t vco_output_level = synth_cal_lut[vcoindex][0];
     uint8_t vco_varactor     = synth_cal_lut[vcoindex][1];
@@ -1192,8 +1209,46 @@ void ad9361_device_t::_setup_synth(direction_t direction, double vcorate)
     } else {
         throw uhd::runtime_error("[ad9361_device_t] [_setup_synth] INVALID_CODE_PATH");
     }
+    _synth_lut_index[direction] = vcoindex;
 }
 
+/* Wait for an RF PLL to lock.
+ *
+ * Writing the integer word starts the VCO calibration. Lock usually takes
+ * a few hundred microseconds, so poll the lock bit instead of waiting for
+ * the worst case. */
+bool ad9361_device_t::_wait_for_rfpll_lock(const uint32_t lock_reg)
+{
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+    while (true) {
+        if (_io_iface->peek8(lock_reg) & 0x02) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() > timeout) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+/* Wait for a calibration that was started through register 0x016 to finish.
+ *
+ * The calibration clears its bit in 0x016 when it is done. Most of them take
+ * a fraction of their timeout, so poll the bit instead of sleeping for the
+ * worst case. The timeout is measured on a steady clock, so slow register
+ * accesses don't stretch it. */
+bool ad9361_device_t::_wait_for_calibration(
+    const uint8_t cal_bit, const std::chrono::milliseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (_io_iface->peek8(0x016) & cal_bit) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
 
 /* Tune the baseband VCO.
  *
@@ -1353,8 +1408,7 @@ double ad9361_device_t::_tune_helper(direction_t direction, const double value)
         _io_iface->poke8(0x005, _regs.vcodivs);
 
         /* Lock the PLL! */
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-        if ((_io_iface->peek8(0x247) & 0x02) == 0) {
+        if (not _wait_for_rfpll_lock(0x247)) {
             throw uhd::runtime_error("[ad9361_device_t] RX PLL NOT LOCKED");
         }
 
@@ -1393,8 +1447,7 @@ double ad9361_device_t::_tune_helper(direction_t direction, const double value)
         _io_iface->poke8(0x005, _regs.vcodivs);
 
         /* Lock the PLL! */
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-        if ((_io_iface->peek8(0x287) & 0x02) == 0) {
+        if (not _wait_for_rfpll_lock(0x287)) {
             throw uhd::runtime_error("[ad9361_device_t] TX PLL NOT LOCKED");
         }
 
@@ -1598,6 +1651,14 @@ void ad9361_device_t::initialize()
     _rx_bb_lp_bw             = 0;
     _tx_bb_lp_bw             = 0;
 
+    /* The reset below clears the synthesizer, FIR and mixer GM settings. */
+    _mixer_gm_subtable_programmed = false;
+    for (direction_t direction : {RX, TX}) {
+        _synth_lut_index[direction] = -1;
+        _fir_taps[direction][CHAIN_1].clear();
+        _fir_taps[direction][CHAIN_2].clear();
+    }
+
     /* Reset the device. */
     _io_iface->poke8(0x000, 0x01);
     _io_iface->poke8(0x000, 0x00);
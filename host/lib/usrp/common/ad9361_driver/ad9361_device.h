@@ -12,6 +12,7 @@
 #include <uhd/types/filters.hpp>
 #include <uhd/types/sensors.hpp>
 #include <uhd/utils/noncopyable.hpp>
+#include <chrono>
 #include <complex>
 #include <vector>
 #include <map>
@@ -282,6 +283,9 @@ private:    //Methods
     void _program_gain_table();
     void _setup_gain_control(bool use_agc);
     void _setup_synth(direction_t direction, double vcorate);
+    bool _wait_for_rfpll_lock(const uint32_t lock_reg);
+    bool _wait_for_calibration(
+        const uint8_t cal_bit, const std::chrono::milliseconds timeout);
     double _tune_bbvco(const double rate);
     void _reprogram_gains();
     double _tune_helper(direction_t direction, const double value);
@@ -359,6 +363,13 @@ private:    //Members
     std::map<std::string, filter_tuple> _rx_filters;
     std::map<std::string, filter_tuple> _tx_filters;
 
+    //Programmed settings, so they aren't rewritten if they don't change
+    //! Row of the synthesizer LUT, by direction. -1 if unknown.
+    int _synth_lut_index[2] = {-1, -1};
+    //! FIR coefficient memories, by direction and chain. Empty if unknown.
+    std::vector<uint16_t> _fir_taps[2][2];
+    bool _mixer_gm_subtable_programmed = false;
+
 };
 
 }}  //namespace
@@ -7,6 +7,7 @@
 #include <uhd/utils/log.hpp>
 #include <uhdlib/usrp/common/io_service_args.hpp>
 #include <uhdlib/usrp/constrained_device_args.hpp>
+#include <uhdlib/utils/thread_placement.hpp>
 #include <boost/format.hpp>
 #include <regex>
 #include <string>
@@ -17,7 +18,13 @@ static const char* recv_offload_str             = "recv_offload";
 static const char* send_offload_str             = "send_offload";
 static const char* recv_offload_wait_mode_str   = "recv_offload_wait_mode";
 static const char* send_offload_wait_mode_str   = "send_offload_wait_mode";
+static const char* recv_adaptive_wait_str       = "recv_adaptive_wait";
+static const char* send_adaptive_wait_str       = "send_adaptive_wait";
+static const char* adaptive_wait_max_spin_str   = "adaptive_wait_max_spin_us";
 static const char* num_poll_offload_threads_str = "num_poll_offload_threads";
+static const char* stream_load_str              = "stream_load";
+static const char* cpu_affinity_str             = "cpu_affinity";
+static const char* numa_node_str                = "numa_node";
 
 static const std::regex recv_offload_thread_cpu_expr("^recv_offload_thread_(\\d+)_cpu");
 static const std::regex send_offload_thread_cpu_expr("^send_offload_thread_(\\d+)_cpu");
@@ -68,6 +75,19 @@ io_service_args_t read_io_service_args(
     io_srv_args.send_offload_wait_mode = get_wait_mode_arg(
         args, send_offload_wait_mode_str, defaults.send_offload_wait_mode);
 
+    io_srv_args.recv_adaptive_wait =
+        get_bool_arg(args, recv_adaptive_wait_str, defaults.recv_adaptive_wait);
+    io_srv_args.send_adaptive_wait =
+        get_bool_arg(args, send_adaptive_wait_str, defaults.send_adaptive_wait);
+    io_srv_args.adaptive_wait_max_spin_us = args.cast<double>(
+        adaptive_wait_max_spin_str, defaults.adaptive_wait_max_spin_us);
+    if (io_srv_args.adaptive_wait_max_spin_us < 0.0) {
+        UHD_LOG_WARNING(LOG_ID,
+            "Invalid value for adaptive_wait_max_spin_us. "
+            "Value must not be negative.");
+        io_srv_args.adaptive_wait_max_spin_us = defaults.adaptive_wait_max_spin_us;
+    }
+
     io_srv_args.num_poll_offload_threads = args.cast<size_t>(
         num_poll_offload_threads_str, defaults.num_poll_offload_threads);
     if (io_srv_args.num_poll_offload_threads == 0) {
@@ -77,6 +97,8 @@ io_service_args_t read_io_service_args(
         io_srv_args.num_poll_offload_threads = 1;
     }
 
+    io_srv_args.stream_load = args.cast<double>(stream_load_str, defaults.stream_load);
+
     auto read_thread_args = [&args](
                                 const std::regex& expr, std::map<size_t, size_t>& dest) {
         auto keys = args.keys();
@@ -95,6 +117,11 @@ io_service_args_t read_io_service_args(
     read_thread_args(send_offload_thread_cpu_expr, io_srv_args.send_offload_thread_cpu);
     read_thread_args(poll_offload_thread_cpu_expr, io_srv_args.poll_offload_thread_cpu);
 
+    io_srv_args.cpu_affinity = (args.has_key(cpu_affinity_str)
+                                   || args.has_key(numa_node_str))
+                                   ? read_cpu_placement(args)
+                                   : defaults.cpu_affinity;
+
     return io_srv_args;
 }
 
@@ -117,7 +144,15 @@ device_addr_t merge_io_service_dev_args(
     merge_args(dev_args, args, send_offload_str);
     merge_args(dev_args, args, recv_offload_wait_mode_str);
     merge_args(dev_args, args, send_offload_wait_mode_str);
+    merge_args(dev_args, args, recv_adaptive_wait_str);
+    merge_args(dev_args, args, send_adaptive_wait_str);
+    merge_args(dev_args, args, adaptive_wait_max_spin_str);
     merge_args(dev_args, args, num_poll_offload_threads_str);
+    // The placement of a stream replaces the placement of the device as a whole
+    if (!args.has_key(cpu_affinity_str) && !args.has_key(numa_node_str)) {
+        merge_args(dev_args, args, cpu_affinity_str);
+        merge_args(dev_args, args, numa_node_str);
+    }
 
     auto merge_thread_args = [&merge_args](const device_addr_t& dev_args,
                                  device_addr_t& stream_args,
@@ -8,6 +8,7 @@
 #include <uhd/transport/adapter_id.hpp>
 #include <uhd/utils/algorithm.hpp>
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/thread.hpp>
 #include <uhdlib/transport/inline_io_service.hpp>
 #include <uhdlib/transport/offload_io_service.hpp>
 #ifdef HAVE_DPDK
@@ -15,7 +16,9 @@
 #endif
 #include <uhdlib/usrp/common/io_service_mgr.hpp>
 #include <uhdlib/usrp/constrained_device_args.hpp>
+#include <uhdlib/utils/thread_placement.hpp>
 #include <map>
+#include <tuple>
 #include <vector>
 
 using namespace uhd;
@@ -40,15 +43,17 @@ namespace uhd { namespace usrp {
 class inline_io_service_mgr
 {
 public:
-    io_service::sptr connect_links(
-        recv_link_if::sptr recv_link, send_link_if::sptr send_link);
+    io_service::sptr connect_links(recv_link_if::sptr recv_link,
+        send_link_if::sptr send_link,
+        const link_type_t link_type,
+        const io_service_args_t& args);
 
     void disconnect_links(recv_link_if::sptr recv_link, send_link_if::sptr send_link);
 
 private:
     struct link_info_t
     {
-        io_service::sptr io_srv;
+        inline_io_service::sptr io_srv;
         size_t mux_ref_count;
     };
 
@@ -56,9 +61,25 @@ private:
     std::map<link_pair_t, link_info_t> _link_info_map;
 };
 
-io_service::sptr inline_io_service_mgr::connect_links(
-    recv_link_if::sptr recv_link, send_link_if::sptr send_link)
+io_service::sptr inline_io_service_mgr::connect_links(recv_link_if::sptr recv_link,
+    send_link_if::sptr send_link,
+    const link_type_t link_type,
+    const io_service_args_t& args)
 {
+    // The clients made for this link type poll their recv link before they
+    // block if it is enabled for it. Control links always block, they don't
+    // carry enough traffic to make polling pay off.
+    const bool adaptive_wait_enabled =
+        (link_type == link_type_t::RX_DATA && args.recv_adaptive_wait)
+        || (link_type == link_type_t::TX_DATA && args.send_adaptive_wait);
+    const double max_spin_time =
+        adaptive_wait_enabled ? args.adaptive_wait_max_spin_us / 1e6 : 0.0;
+    if (adaptive_wait_enabled) {
+        UHD_LOG_TRACE(LOG_ID,
+            "Using adaptive wait on inline I/O service, max. spin time "
+                << args.adaptive_wait_max_spin_us << " us");
+    }
+
     // Check if links are already connected
     const link_pair_t links{recv_link, send_link};
     auto it = _link_info_map.find(links);
@@ -66,6 +87,9 @@ io_service::sptr inline_io_service_mgr::connect_links(
     if (it != _link_info_map.end()) {
         // Muxing links, add to mux ref count
         it->second.mux_ref_count++;
+        if (recv_link) {
+            it->second.io_srv->set_adaptive_wait(recv_link, max_spin_time);
+        }
         return it->second.io_srv;
     }
 
@@ -74,6 +98,7 @@ io_service::sptr inline_io_service_mgr::connect_links(
 
     if (recv_link) {
         io_srv->attach_recv_link(recv_link);
+        io_srv->set_adaptive_wait(recv_link, max_spin_time);
     }
     if (send_link) {
         io_srv->attach_send_link(send_link);
@@ -255,14 +280,15 @@ io_service::sptr blocking_io_service_mgr::_create_new_io_service(
                               ? args.recv_offload_thread_cpu
                               : args.send_offload_thread_cpu;
 
-    std::string cpu_affinity_str;
     if (cpu_map.count(thread_index) != 0) {
-        const size_t cpu         = cpu_map.at(thread_index);
-        params.cpu_affinity_list = {cpu};
-        cpu_affinity_str         = ", cpu affinity: " + std::to_string(cpu);
+        params.cpu_affinity_list = {cpu_map.at(thread_index)};
+    } else if (!args.cpu_affinity.empty()) {
+        params.cpu_affinity_list = args.cpu_affinity;
     } else {
-        cpu_affinity_str = ", cpu affinity: none";
+        params.cpu_affinity_list = get_default_thread_affinity();
     }
+    const std::string cpu_affinity_str =
+        ", cpu affinity: " + format_cpu_list(params.cpu_affinity_list);
 
     std::string link_type_str = (link_type == link_type_t::RX_DATA) ? "RX data"
                                                                     : "TX data";
@@ -277,8 +303,8 @@ io_service::sptr blocking_io_service_mgr::_create_new_io_service(
  *
  * I/O service manager for offload I/O services configured to poll. Creates the
  * number of I/O services specified by the user in stream_args, and distributes
- * links among them. New connections always go to the offload thread containing
- * the fewest connections, with lowest numbered thread as a second criterion.
+ * links among them. New connections always go to the offload thread with the
+ * lowest load, with the fewest connections as a second criterion.
  */
 class polling_io_service_mgr
 {
@@ -294,10 +320,12 @@ private:
     {
         io_service::sptr io_srv;
         size_t mux_ref_count;
+        double load;
     };
     struct io_srv_info_t
     {
         size_t connection_count;
+        double load;
     };
 
     io_service::sptr _create_new_io_service(
@@ -319,32 +347,37 @@ io_service::sptr polling_io_service_mgr::connect_links(recv_link_if::sptr recv_l
     const link_pair_t links{recv_link, send_link};
     auto it = _link_info_map.find(links);
     if (it != _link_info_map.end()) {
-        // Muxing links, add to mux ref count and connection count
+        // Muxing links, add to mux ref count, connection count, and load
         it->second.mux_ref_count++;
+        it->second.load += args.stream_load;
         _io_srv_info_map[it->second.io_srv].connection_count++;
+        _io_srv_info_map[it->second.io_srv].load += args.stream_load;
         return it->second.io_srv;
     }
 
     // Links are not muxed. If there are fewer offload threads than requested in
     // the args, create a new service and add the links to it. Otherwise, add it
-    // to the service that has the fewest connections.
+    // to the service that has the lowest load, or the fewest connections if the
+    // loads are equal (e.g., because the rates aren't known).
     io_service::sptr io_srv;
     if (_io_srv_info_map.size() < args.num_poll_offload_threads) {
         const size_t thread_index = _io_srv_info_map.size();
         io_srv                    = _create_new_io_service(args, thread_index);
-        _link_info_map[links]     = {io_srv, 1 /*mux_ref_count*/};
-        _io_srv_info_map[io_srv]  = {1 /*connection_count*/};
+        _io_srv_info_map[io_srv]  = {1 /*connection_count*/, args.stream_load};
     } else {
         using map_pair_t = std::pair<io_service::sptr, io_srv_info_t>;
         auto cmp         = [](const map_pair_t& left, const map_pair_t& right) {
-            return left.second.connection_count < right.second.connection_count;
+            return std::tie(left.second.load, left.second.connection_count)
+                   < std::tie(right.second.load, right.second.connection_count);
         };
 
         auto it = std::min_element(_io_srv_info_map.begin(), _io_srv_info_map.end(), cmp);
         UHD_ASSERT_THROW(it != _io_srv_info_map.end());
         io_srv = it->first;
         _io_srv_info_map[io_srv].connection_count++;
+        _io_srv_info_map[io_srv].load += args.stream_load;
     }
+    _link_info_map[links] = {io_srv, 1 /*mux_ref_count*/, args.stream_load};
 
     if (recv_link) {
         io_srv->attach_recv_link(recv_link);
@@ -363,7 +396,14 @@ void polling_io_service_mgr::disconnect_links(
     UHD_ASSERT_THROW(it != _link_info_map.end());
 
     auto io_srv = it->second.io_srv;
+    // The load of the individual muxed connections isn't tracked, so every
+    // disconnect removes an equal share of the link's load
+    const double load = it->second.load / it->second.mux_ref_count;
+    it->second.load -= load;
     it->second.mux_ref_count--;
+    auto& io_srv_info = _io_srv_info_map.at(io_srv);
+    io_srv_info.connection_count--;
+    io_srv_info.load -= load;
 
     if (it->second.mux_ref_count == 0) {
         if (recv_link) {
@@ -374,7 +414,9 @@ void polling_io_service_mgr::disconnect_links(
         }
 
         _link_info_map.erase(it);
-        _io_srv_info_map.erase(io_srv);
+        if (io_srv_info.connection_count == 0) {
+            _io_srv_info_map.erase(io_srv);
+        }
     }
 }
 
@@ -387,14 +429,15 @@ io_service::sptr polling_io_service_mgr::_create_new_io_service(
 
     const auto& cpu_map = args.poll_offload_thread_cpu;
 
-    std::string cpu_affinity_str;
     if (cpu_map.count(thread_index) != 0) {
-        const size_t cpu         = cpu_map.at(thread_index);
-        params.cpu_affinity_list = {cpu};
-        cpu_affinity_str         = ", cpu affinity: " + std::to_string(cpu);
+        params.cpu_affinity_list = {cpu_map.at(thread_index)};
+    } else if (!args.cpu_affinity.empty()) {
+        params.cpu_affinity_list = args.cpu_affinity;
     } else {
-        cpu_affinity_str = ", cpu affinity: none";
+        params.cpu_affinity_list = get_default_thread_affinity();
     }
+    const std::string cpu_affinity_str =
+        ", cpu affinity: " + format_cpu_list(params.cpu_affinity_list);
 
     UHD_LOG_INFO(LOG_ID, "Creating new polling I/O service" << cpu_affinity_str);
 
@@ -431,6 +474,7 @@ private:
     {
         io_service::sptr io_srv;
         io_service_type_t io_srv_type;
+        size_t mux_ref_count;
     };
     using link_pair_t = std::pair<recv_link_if::sptr, send_link_if::sptr>;
 
@@ -532,7 +576,17 @@ io_service::sptr io_service_mgr_impl::connect_links(recv_link_if::sptr recv_link
 
     switch (io_srv_type) {
         case INLINE_IO_SRV:
-            io_srv = _inline_io_srv_mgr.connect_links(recv_link, send_link);
+            io_srv =
+                _inline_io_srv_mgr.connect_links(recv_link, send_link, link_type, args);
+            // There's no thread of our own to pin, data moves in the caller
+            if (link_type != link_type_t::CTRL && !args.cpu_affinity.empty()) {
+                UHD_LOG_INFO(LOG_ID,
+                    "Using inline I/O service for "
+                        << (link_type == link_type_t::RX_DATA ? "RX data" : "TX data")
+                        << ", pin the thread calling "
+                        << (link_type == link_type_t::RX_DATA ? "recv()" : "send()")
+                        << " to CPUs " << format_cpu_list(args.cpu_affinity));
+            }
             break;
         case BLOCKING_IO_SRV:
             io_srv = _blocking_io_srv_mgr.connect_links(
@@ -545,7 +599,11 @@ io_service::sptr io_service_mgr_impl::connect_links(recv_link_if::sptr recv_link
             UHD_THROW_INVALID_CODE_PATH();
     }
 
-    _link_info_map[links] = {io_srv, io_srv_type};
+    if (it != _link_info_map.end()) {
+        it->second.mux_ref_count++;
+    } else {
+        _link_info_map[links] = {io_srv, io_srv_type, 1 /*mux_ref_count*/};
+    }
     return io_srv;
 }
 
@@ -570,7 +628,10 @@ void io_service_mgr_impl::disconnect_links(
             UHD_THROW_INVALID_CODE_PATH();
     }
 
-    _link_info_map.erase(it);
+    // Muxed links stay attached until their last connection is gone
+    if (--it->second.mux_ref_count == 0) {
+        _link_info_map.erase(it);
+    }
 }
 
 bool io_service_mgr_impl::_out_of_order_supported(
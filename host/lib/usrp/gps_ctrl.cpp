@@ -9,19 +9,20 @@
 #include <uhd/types/sensors.hpp>
 #include <uhd/usrp/gps_ctrl.hpp>
 #include <uhd/utils/log.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread.hpp>
 #include <stdint.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time.hpp>
 #include <boost/format.hpp>
-#include <boost/thread/mutex.hpp>
-#include <boost/thread/thread.hpp>
-#include <boost/tokenizer.hpp>
+#include <array>
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
-#include <regex>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
-#include <tuple>
 
 using namespace uhd;
 using namespace boost::posix_time;
@@ -34,6 +35,104 @@ constexpr int GPS_SERVO_FRESHNESS       = 1000;
 constexpr int GPS_LOCK_FRESHNESS        = 2500;
 constexpr int GPS_TIMEOUT_DELAY_MS      = 200;
 constexpr int GPSDO_COMMAND_DELAY_MS    = 200;
+// Polling intervals of the reader thread, while a sensor read waits for a
+// sentence and while nobody waits. Some UARTs are polled over the control bus,
+// so the reader doesn't block on them, and it polls rarely when idle.
+constexpr int GPS_POLL_INTERVAL_MS      = 10;
+constexpr int GPS_IDLE_POLL_INTERVAL_MS = 1000;
+
+using clock_type = std::chrono::steady_clock;
+
+enum sentence_type_t { GPGGA, GPRMC, SERVO, NUM_SENTENCE_TYPES };
+
+//! Latest sentence of a given type
+struct sentence_t
+{
+    std::string text;
+    clock_type::time_point received;
+    //! Number of sentences of this type received so far
+    uint64_t count = 0;
+};
+
+//! Everything the GPS told us so far. Published states are never modified.
+struct gps_state_t
+{
+    std::array<sentence_t, NUM_SENTENCE_TYPES> sentences;
+    //! Epoch time from the latest GPRMC, or -1 if it had no valid time
+    int64_t epoch_time = -1;
+    //! Fix quality from the latest GPGGA was not zero
+    bool locked = false;
+};
+
+using gps_state_ptr = std::shared_ptr<const gps_state_t>;
+
+bool is_digits(const std::string& str, const size_t pos, const size_t len)
+{
+    if (str.size() < pos + len) {
+        return false;
+    }
+    for (size_t i = pos; i < pos + len; i++) {
+        if (str[i] < '0' or str[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int hex_value(const char ch)
+{
+    if (ch >= '0' and ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'A' and ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    return -1;
+}
+
+//! Return the field at a given offset of a comma separated NMEA sentence
+std::string get_token(const std::string& sentence, const size_t offset)
+{
+    size_t start = 0;
+    for (size_t i = 0; i < offset; i++) {
+        start = sentence.find(',', start);
+        if (start == std::string::npos) {
+            throw uhd::value_error(
+                str(boost::format("Invalid response \"%s\"") % sentence));
+        }
+        start++;
+    }
+    const size_t end = sentence.find_first_of(",*", start);
+    return sentence.substr(start, end == std::string::npos ? end : end - start);
+}
+
+//! Return the time of a GPRMC sentence in seconds since the epoch, or -1
+int64_t parse_gprmc_time(const std::string& sentence)
+{
+    try {
+        const std::string datestr = get_token(sentence, 9);
+        const std::string timestr = get_token(sentence, 1);
+        if (not is_digits(datestr, 0, 6) or not is_digits(timestr, 0, 6)) {
+            return -1;
+        }
+
+        struct tm raw_date;
+        raw_date.tm_year =
+            std::stoi(datestr.substr(4, 2)) + 2000 - 1900; // years since 1900
+        raw_date.tm_mon =
+            std::stoi(datestr.substr(2, 2)) - 1; // months since january (0-11)
+        raw_date.tm_mday = std::stoi(datestr.substr(0, 2)); // dom (1-31)
+        raw_date.tm_hour = std::stoi(timestr.substr(0, 2));
+        raw_date.tm_min  = std::stoi(timestr.substr(2, 2));
+        raw_date.tm_sec  = std::stoi(timestr.substr(4, 2));
+        const ptime gps_time = boost::posix_time::ptime_from_tm(raw_date);
+        return (gps_time - from_time_t(0)).total_seconds();
+    } catch (const std::exception& e) {
+        UHD_LOGGER_DEBUG("GPS") << "Invalid time in " << sentence << ": " << e.what();
+        return -1;
+    }
+}
+
 } // namespace
 
 /*!
@@ -48,137 +147,225 @@ gps_ctrl::~gps_ctrl(void)
 class gps_ctrl_impl : public gps_ctrl
 {
 private:
-    std::map<std::string, std::tuple<std::string, boost::system_time, bool>> sentences;
-    boost::mutex cache_mutex;
-    boost::system_time _last_cache_update;
-
-    std::string get_sentence(const std::string which,
-        const int max_age_ms,
-        const int timeout,
-        const bool wait_for_next = false)
+    //! Only accessed through std::atomic_load() and std::atomic_store()
+    gps_state_ptr _state = std::make_shared<const gps_state_t>();
+    //! Protects the members below, and the wait for new sentences
+    std::mutex _update_mutex;
+    //! Notified by the reader after every poll of the UART
+    std::condition_variable _update_cond;
+    //! Notified to have the reader poll the UART right away
+    std::condition_variable _poll_cond;
+    //! Number of completed polls of the UART
+    uint64_t _num_polls = 0;
+    //! Number of sensor reads waiting for a sentence
+    size_t _num_waiters = 0;
+    bool _poll_requested = false;
+    bool _stop           = false;
+    std::thread _reader_thread;
+
+    /*! Return the latest sentence of a type
+     *
+     * If the cached sentence is older than max_age_ms, wait up to timeout ms
+     * for the next one.
+     */
+    std::string get_sentence(
+        const sentence_type_t which, const int max_age_ms, const int timeout)
     {
-        std::string sentence;
-        boost::system_time now       = boost::get_system_time();
-        boost::system_time exit_time = now + milliseconds(timeout);
-        boost::posix_time::time_duration age;
-
-        if (wait_for_next) {
-            boost::lock_guard<boost::mutex> lock(cache_mutex);
-            update_cache();
-            // mark sentence as touched
-            if (sentences.find(which) != sentences.end())
-                std::get<2>(sentences[which]) = true;
+        gps_state_ptr state = wait_for_sentence(which, max_age_ms, timeout);
+        if (not is_fresh(state->sentences[which], max_age_ms)) {
+            static const std::array<std::string, NUM_SENTENCE_TYPES> names{
+                {"GPGGA", "GPRMC", "SERVO"}};
+            throw uhd::value_error("gps ctrl: No " + names[which] + " message found");
         }
-        while (1) {
-            try {
-                boost::lock_guard<boost::mutex> lock(cache_mutex);
+        return state->sentences[which].text;
+    }
 
-                // update cache if older than a millisecond
-                if (now - _last_cache_update > milliseconds(1)) {
-                    update_cache();
-                }
+    static bool is_fresh(const sentence_t& sentence, const int max_age_ms)
+    {
+        return sentence.count > 0
+               and clock_type::now() - sentence.received
+                       < std::chrono::milliseconds(max_age_ms);
+    }
 
-                if (sentences.find(which) == sentences.end()) {
-                    age = milliseconds(max_age_ms);
-                } else {
-                    age = boost::get_system_time() - std::get<1>(sentences[which]);
-                }
-                if (age < milliseconds(max_age_ms)
-                    and (not(wait_for_next and std::get<2>(sentences[which])))) {
-                    sentence                      = std::get<0>(sentences[which]);
-                    std::get<2>(sentences[which]) = true;
-                }
-            } catch (std::exception& e) {
-                UHD_LOGGER_DEBUG("GPS") << "get_sentence: " << e.what();
-            }
+    //! Return the state once it has a sentence that satisfies get_sentence()
+    gps_state_ptr wait_for_sentence(
+        const sentence_type_t which, const int max_age_ms, const int timeout)
+    {
+        gps_state_ptr state = std::atomic_load(&_state);
+        if (is_fresh(state->sentences[which], max_age_ms) or not gps_detected()) {
+            return state;
+        }
 
-            if (not sentence.empty() or now > exit_time) {
-                break;
-            }
+        std::unique_lock<std::mutex> lock(_update_mutex);
+        start_waiting();
+        _update_cond.wait_for(lock, std::chrono::milliseconds(timeout), [&]() {
+            state = std::atomic_load(&_state);
+            return is_fresh(state->sentences[which], max_age_ms);
+        });
+        _num_waiters--;
+        return state;
+    }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            now = boost::get_system_time();
+    /*! Wait for the next sentence of a type that is sent by the GPS
+     *
+     * \return the state with that sentence, or nullptr on timeout
+     */
+    gps_state_ptr wait_for_next_sentence(const sentence_type_t which, const int timeout)
+    {
+        if (not gps_detected()) {
+            return nullptr;
         }
 
-        if (sentence.empty()) {
-            throw uhd::value_error("gps ctrl: No " + which + " message found");
-        }
+        std::unique_lock<std::mutex> lock(_update_mutex);
+        start_waiting();
+        // Sentences that were already waiting in the UART are not the next
+        // ones, so only start counting after a poll that started after this
+        // call. The poll that is in progress may have missed some of them.
+        const uint64_t first_poll = _num_polls + 2;
+        uint64_t count            = 0;
+        gps_state_ptr state;
+        const bool found =
+            _update_cond.wait_for(lock, std::chrono::milliseconds(timeout), [&]() {
+                if (_num_polls < first_poll) {
+                    return false;
+                }
+                state = std::atomic_load(&_state);
+                if (_num_polls == first_poll) {
+                    count = state->sentences[which].count;
+                    return false;
+                }
+                return state->sentences[which].count > count;
+            });
+        _num_waiters--;
+        return found ? state : nullptr;
+    }
 
-        return sentence;
+    //! Have the reader poll right away, and quickly until the wait is over.
+    // Must be called with _update_mutex held.
+    void start_waiting(void)
+    {
+        _num_waiters++;
+        _poll_requested = true;
+        _poll_cond.notify_one();
     }
 
-    static bool is_nmea_checksum_ok(std::string nmea)
+    static bool is_nmea_checksum_ok(const std::string& nmea)
     {
         if (nmea.length() < 5 || nmea[0] != '$' || nmea[nmea.length() - 3] != '*')
             return false;
 
-        std::stringstream ss;
-        uint32_t string_crc;
-        uint32_t calculated_crc = 0;
-
         // get crc from string
-        ss << std::hex << nmea.substr(nmea.length() - 2, 2);
-        ss >> string_crc;
+        const int crc_high = hex_value(nmea[nmea.length() - 2]);
+        const int crc_low  = hex_value(nmea[nmea.length() - 1]);
+        if (crc_high < 0 or crc_low < 0) {
+            return false;
+        }
+        const uint32_t string_crc = (crc_high << 4) | crc_low;
 
         // calculate crc
+        uint32_t calculated_crc = 0;
         for (size_t i = 1; i < nmea.length() - 3; i++)
-            calculated_crc ^= nmea[i];
+            calculated_crc ^= uint8_t(nmea[i]);
 
         // return comparison
         return (string_crc == calculated_crc);
     }
 
-    void update_cache()
+    //! SERVO lines start with the date, e.g. "20-01-15"
+    static bool is_servo(const std::string& msg)
     {
-        if (not gps_detected()) {
-            return;
+        return is_digits(msg, 0, 2) and msg[2] == '-' and is_digits(msg, 3, 2)
+               and msg[5] == '-' and is_digits(msg, 6, 2);
+    }
+
+    /*! Parse a line from the GPS, and publish it if it is one we track
+     *
+     * \returns true if the state was updated
+     */
+    bool handle_line(std::string msg, gps_state_t& state)
+    {
+        // Strip any end of line characters
+        erase_all(msg, "\r");
+        erase_all(msg, "\n");
+
+        if (msg.empty()) {
+            // Ignore empty strings
+            return false;
         }
 
-        const std::list<std::string> keys{"GPGGA", "GPRMC", "SERVO"};
-        static const std::regex servo_regex("^\\d\\d-\\d\\d-\\d\\d.*$");
-        static const std::regex gp_msg_regex("^\\$GP.*,\\*[0-9A-F]{2}$");
-        std::map<std::string, std::string> msgs;
-
-        // Get all GPSDO messages available
-        // Creating a map here because we only want the latest of each message type
-        for (std::string msg = _recv(0); not msg.empty(); msg = _recv(0)) {
-            // Strip any end of line characters
-            erase_all(msg, "\r");
-            erase_all(msg, "\n");
-
-            if (msg.empty()) {
-                // Ignore empty strings
-                continue;
-            }
+        if (msg.length() < 6) {
+            UHD_LOGGER_WARNING("GPS") << __FUNCTION__ << ": Short GPSDO string: " << msg;
+            return false;
+        }
 
-            if (msg.length() < 6) {
-                UHD_LOGGER_WARNING("GPS")
-                    << __FUNCTION__ << ": Short GPSDO string: " << msg;
-                continue;
+        sentence_type_t type;
+        if (is_servo(msg)) {
+            type = SERVO;
+        } else if (msg.compare(0, 3, "$GP") == 0 and is_nmea_checksum_ok(msg)) {
+            if (msg.compare(3, 3, "GGA") == 0) {
+                type = GPGGA;
+            } else if (msg.compare(3, 3, "RMC") == 0) {
+                type = GPRMC;
+            } else {
+                return false;
             }
+        } else {
+            UHD_LOGGER_WARNING("GPS")
+                << __FUNCTION__ << ": Malformed GPSDO string: " << msg;
+            return false;
+        }
 
-            // Look for SERVO message
-            if (std::regex_search(
-                    msg, servo_regex, std::regex_constants::match_continuous)) {
-                msgs["SERVO"] = msg;
-            } else if (std::regex_match(msg, gp_msg_regex) and is_nmea_checksum_ok(msg)) {
-                msgs[msg.substr(1, 5)] = msg;
-            } else {
-                UHD_LOGGER_WARNING("GPS")
-                    << __FUNCTION__ << ": Malformed GPSDO string: " << msg;
+        sentence_t& sentence = state.sentences[type];
+        sentence.received    = clock_type::now();
+        sentence.count++;
+        if (type == GPRMC) {
+            state.epoch_time = parse_gprmc_time(msg);
+        } else if (type == GPGGA) {
+            try {
+                state.locked = (get_token(msg, 6) != "0");
+            } catch (const uhd::value_error&) {
+                state.locked = false;
             }
         }
+        sentence.text = std::move(msg);
+        return true;
+    }
 
-        boost::system_time time = boost::get_system_time();
+    /*! Read all lines from the GPS, and keep the latest state
+     *
+     * The UART is polled quickly while a sensor read waits for a sentence,
+     * and once a second otherwise. The UART buffers the sentences in between.
+     */
+    void reader_loop(void)
+    {
+        std::unique_lock<std::mutex> lock(_update_mutex);
+        while (not _stop) {
+            lock.unlock();
+            gps_state_t state = *std::atomic_load(&_state);
+            bool updated      = false;
+            try {
+                for (std::string msg = _recv(0); not msg.empty(); msg = _recv(0)) {
+                    updated = handle_line(std::move(msg), state) or updated;
+                }
+            } catch (const std::exception& e) {
+                UHD_LOGGER_DEBUG("GPS") << "reader: " << e.what();
+            }
 
-        // Update sentences with newly read data
-        for (std::string key : keys) {
-            if (not msgs[key].empty()) {
-                sentences[key] = std::make_tuple(msgs[key], time, false);
+            lock.lock();
+            if (updated) {
+                std::atomic_store(
+                    &_state, gps_state_ptr(std::make_shared<gps_state_t>(state)));
             }
+            _num_polls++;
+            _update_cond.notify_all();
+
+            const int interval_ms =
+                (_num_waiters > 0) ? GPS_POLL_INTERVAL_MS : GPS_IDLE_POLL_INTERVAL_MS;
+            _poll_cond.wait_for(lock, std::chrono::milliseconds(interval_ms), [this]() {
+                return _stop or _poll_requested;
+            });
+            _poll_requested = false;
         }
-
-        _last_cache_update = time;
     }
 
 public:
@@ -244,13 +431,24 @@ public:
                 break;
         }
 
-        // initialize cache
-        update_cache();
+        // Sentences are read as they arrive, so sensor reads don't have to
+        // wait for the UART
+        if (gps_detected()) {
+            _reader_thread = std::thread([this]() { reader_loop(); });
+            uhd::set_thread_name(&_reader_thread, "gps_reader");
+        }
     }
 
     ~gps_ctrl_impl(void)
     {
-        /* NOP */
+        {
+            std::lock_guard<std::mutex> lock(_update_mutex);
+            _stop = true;
+        }
+        _poll_cond.notify_one();
+        if (_reader_thread.joinable()) {
+            UHD_SAFE_CALL(_reader_thread.join();)
+        }
     }
 
     // return a list of supported sensors
@@ -265,7 +463,7 @@ public:
     {
         if (key == "gps_gpgga" or key == "gps_gprmc") {
             return sensor_value_t(boost::to_upper_copy(key),
-                get_sentence(boost::to_upper_copy(key.substr(4, 8)),
+                get_sentence(key == "gps_gpgga" ? GPGGA : GPRMC,
                     GPS_NMEA_NORMAL_FRESHNESS,
                     GPS_TIMEOUT_DELAY_MS),
                 "");
@@ -275,9 +473,7 @@ public:
             return sensor_value_t("GPS lock status", locked(), "locked", "unlocked");
         } else if (key == "gps_servo") {
             return sensor_value_t(boost::to_upper_copy(key),
-                get_sentence(boost::to_upper_copy(key.substr(4, 8)),
-                    GPS_SERVO_FRESHNESS,
-                    GPS_TIMEOUT_DELAY_MS),
+                get_sentence(SERVO, GPS_SERVO_FRESHNESS, GPS_TIMEOUT_DELAY_MS),
                 "");
         } else {
             throw uhd::value_error("gps ctrl get_sensor unknown key: " + key);
@@ -305,67 +501,29 @@ private:
         }
     }
 
-    // helper function to retrieve a field from an NMEA sentence
-    std::string get_token(std::string sentence, size_t offset)
-    {
-        boost::tokenizer<boost::escaped_list_separator<char>> tok(sentence);
-        std::vector<std::string> toked;
-        tok.assign(sentence); // this can throw
-        toked.assign(tok.begin(), tok.end());
-
-        if (toked.size() <= offset) {
-            throw uhd::value_error(
-                str(boost::format("Invalid response \"%s\"") % sentence));
-        }
-        return toked[offset];
-    }
-
-    ptime get_time(void)
+    /*! Return the GPS time of the last PPS edge
+     *
+     * This waits for the next GPRMC sentence, so it returns shortly after a
+     * PPS edge, leaving most of a second to act on it.
+     */
+    int64_t get_epoch_time(void)
     {
+        gps_state_ptr state;
         int error_cnt = 0;
-        ptime gps_time;
-        while (error_cnt < 2) {
-            try {
-                // wait for next GPRMC string
-                std::string reply = get_sentence(
-                    "GPRMC", GPS_NMEA_NORMAL_FRESHNESS, GPS_COMM_TIMEOUT_MS, true);
-
-                std::string datestr = get_token(reply, 9);
-                std::string timestr = get_token(reply, 1);
-
-                if (datestr.size() == 0 or timestr.size() == 0) {
-                    throw uhd::value_error(
-                        str(boost::format("Invalid response \"%s\"") % reply));
-                }
-
-                struct tm raw_date;
-                raw_date.tm_year =
-                    std::stoi(datestr.substr(4, 2)) + 2000 - 1900; // years since 1900
-                raw_date.tm_mon =
-                    std::stoi(datestr.substr(2, 2)) - 1; // months since january (0-11)
-                raw_date.tm_mday = std::stoi(datestr.substr(0, 2)); // dom (1-31)
-                raw_date.tm_hour = std::stoi(timestr.substr(0, 2));
-                raw_date.tm_min  = std::stoi(timestr.substr(2, 2));
-                raw_date.tm_sec  = std::stoi(timestr.substr(4, 2));
-                gps_time         = boost::posix_time::ptime_from_tm(raw_date);
-
-                UHD_LOG_TRACE(
-                    "GPS", "GPS time: " + boost::posix_time::to_simple_string(gps_time));
-                return gps_time;
-
-            } catch (std::exception& e) {
-                UHD_LOGGER_DEBUG("GPS") << "get_time: " << e.what();
-                error_cnt++;
+        while (not state or state->epoch_time < 0) {
+            if (error_cnt++ >= 2) {
+                throw uhd::value_error("get_time: Timeout after no valid message found");
+            }
+            state = wait_for_next_sentence(GPRMC, GPS_COMM_TIMEOUT_MS);
+            if (state and state->epoch_time < 0) {
+                UHD_LOGGER_DEBUG("GPS")
+                    << "get_time: No valid GPRMC: " << state->sentences[GPRMC].text;
             }
         }
-        throw uhd::value_error("get_time: Timeout after no valid message found");
-
-        return gps_time; // keep gcc from complaining
-    }
-
-    int64_t get_epoch_time(void)
-    {
-        return (get_time() - from_time_t(0)).total_seconds();
+        UHD_LOG_TRACE("GPS",
+            "GPS time: " + boost::posix_time::to_simple_string(
+                               from_time_t(0) + seconds(long(state->epoch_time))));
+        return state->epoch_time;
     }
 
     bool gps_detected(void)
@@ -375,21 +533,12 @@ private:
 
     bool locked(void)
     {
-        int error_cnt = 0;
-        while (error_cnt < 3) {
-            try {
-                std::string reply =
-                    get_sentence("GPGGA", GPS_LOCK_FRESHNESS, GPS_COMM_TIMEOUT_MS);
-                if (reply.empty())
-                    error_cnt++;
-                else
-                    return (get_token(reply, 6) != "0");
-            } catch (std::exception& e) {
-                UHD_LOGGER_DEBUG("GPS") << "locked: " << e.what();
-                error_cnt++;
-            }
+        gps_state_ptr state =
+            wait_for_sentence(GPGGA, GPS_LOCK_FRESHNESS, GPS_COMM_TIMEOUT_MS);
+        if (not is_fresh(state->sentences[GPGGA], GPS_LOCK_FRESHNESS)) {
+            throw uhd::value_error("locked(): unable to determine GPS lock status");
         }
-        throw uhd::value_error("locked(): unable to determine GPS lock status");
+        return state->locked;
     }
 
     uart_iface::sptr _uart;
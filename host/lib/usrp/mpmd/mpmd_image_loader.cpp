@@ -64,19 +64,22 @@ uhd::usrp::component_file_t generate_component(
     }
 
     // Read the component file image into a structure suitable to sent as a binary string
-    // to MPM
-    std::vector<uint8_t> data;
+    // to MPM. The file is read in one go, straight into the component.
     std::ifstream component_ifstream(filepath.c_str(), std::ios::binary);
     if (component_ifstream.is_open()) {
-        data.insert(data.begin(),
-            std::istreambuf_iterator<char>(component_ifstream),
-            std::istreambuf_iterator<char>());
+        component_ifstream.seekg(0, std::ios::end);
+        component_file.data.resize(size_t(component_ifstream.tellg()));
+        component_ifstream.seekg(0, std::ios::beg);
+        component_ifstream.read(reinterpret_cast<char*>(component_file.data.data()),
+            component_file.data.size());
+        if (!component_ifstream) {
+            throw uhd::io_error("Could not read component file: " + filepath);
+        }
         component_ifstream.close();
     } else {
         const std::string err_msg("Component file does not exist: " + filepath);
         throw uhd::runtime_error(err_msg);
     }
-    component_file.data = data;
     return component_file;
 }
 
@@ -214,6 +217,9 @@ static bool mpmd_image_loader(const image_loader::image_loader_args_t& image_loa
     tree->access<uhd::usrp::component_files_t>("/mboards/0/components/fpga")
         .set(all_component_files);
     UHD_LOG_INFO("MPMD IMAGE LOADER", "Update component function succeeded.");
+    if (image_loader_args.progress) {
+        image_loader_args.progress(1.0);
+    }
 
     return true;
 }
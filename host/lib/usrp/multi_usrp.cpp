@@ -25,12 +25,14 @@
 #include <boost/assign/list_of.hpp>
 #include <boost/format.hpp>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cmath>
 #include <functional>
 #include <memory>
 #include <thread>
+#include <vector>
 
 namespace uhd { namespace rfnoc {
 
@@ -212,30 +214,28 @@ static meta_range_t make_overall_tune_range(
 /***********************************************************************
  * Gain helper functions
  **********************************************************************/
-static double get_gain_value(property_tree::sptr subtree)
-{
-    return subtree->access<double>("value").get();
-}
-
-static void set_gain_value(property_tree::sptr subtree, const double gain)
-{
-    subtree->access<double>("value").set(gain);
-}
-
-static meta_range_t get_gain_range(property_tree::sptr subtree)
-{
-    return subtree->access<meta_range_t>("range").get();
-}
-
 static gain_fcns_t make_gain_fcns_from_subtree(property_tree::sptr subtree)
 {
+    // Look up the properties only once, gain groups are kept around. Each
+    // function holds on to the subtree, which keeps the tree alive.
+    property<meta_range_t>* range = &subtree->access<meta_range_t>("range");
+    property<double>* value       = &subtree->access<double>("value");
     gain_fcns_t gain_fcns;
-    gain_fcns.get_range = std::bind(&get_gain_range, subtree);
-    gain_fcns.get_value = std::bind(&get_gain_value, subtree);
-    gain_fcns.set_value = std::bind(&set_gain_value, subtree, std::placeholders::_1);
+    gain_fcns.get_range = [subtree, range]() { return range->get(); };
+    gain_fcns.get_value = [subtree, value]() { return value->get(); };
+    gain_fcns.set_value = [subtree, value](const double gain) { value->set(gain); };
     return gain_fcns;
 }
 
+//! Return a cached property, or look it up in the tree if it wasn't there when
+// the cache was filled (the tree then throws the usual error)
+template <typename T>
+static property<T>& get_prop(
+    property<T>* prop, property_tree::sptr subtree, const fs_path& path)
+{
+    return prop ? *prop : subtree->access<T>(path);
+}
+
 /***********************************************************************
  * Tune Helper Functions
  **********************************************************************/
@@ -399,9 +399,33 @@ static double derive_freq_from_xx_subdev_and_dsp(const double xx_sign,
 class multi_usrp_impl : public multi_usrp
 {
 public:
-    multi_usrp_impl(device::sptr dev) : _dev(dev)
+    multi_usrp_impl(device::sptr dev)
+        : _dev(dev), _chan_props_generation(std::make_shared<std::atomic<uint64_t>>(0))
     {
         _tree = _dev->get_tree();
+
+        // The channel property cache depends on the frontend specs and the
+        // channel to DSP mappings, no matter who changes them. The subscribers
+        // only hold on to the generation counter, because the tree may outlive
+        // this object.
+        auto generation = _chan_props_generation;
+        for (size_t m = 0; m < get_num_mboards(); m++) {
+            for (const char* spec : {"rx_subdev_spec", "tx_subdev_spec"}) {
+                if (_tree->exists(mb_root(m) / spec)) {
+                    _tree->access<subdev_spec_t>(mb_root(m) / spec)
+                        .add_coerced_subscriber(
+                            [generation](const subdev_spec_t&) { (*generation)++; });
+                }
+            }
+            for (const char* map : {"rx_chan_dsp_mapping", "tx_chan_dsp_mapping"}) {
+                if (_tree->exists(mb_root(m) / map)) {
+                    _tree->access<std::vector<size_t>>(mb_root(m) / map)
+                        .add_coerced_subscriber([generation](const std::vector<size_t>&) {
+                            (*generation)++;
+                        });
+                }
+            }
+        }
     }
 
     device::sptr get_device(void)
@@ -684,7 +708,8 @@ public:
     void issue_stream_cmd(const stream_cmd_t& stream_cmd, size_t chan)
     {
         if (chan != ALL_CHANS) {
-            _tree->access<stream_cmd_t>(rx_dsp_root(chan) / "stream_cmd").set(stream_cmd);
+            const auto props = rx_chan_props(chan);
+            get_prop(props->stream_cmd, props->dsp_subtree, "stream_cmd").set(stream_cmd);
             return;
         }
         for (size_t c = 0; c < get_rx_num_channels(); c++) {
@@ -1026,7 +1051,8 @@ public:
     void set_rx_rate(double rate, size_t chan)
     {
         if (chan != ALL_CHANS) {
-            _tree->access<double>(rx_dsp_root(chan) / "rate" / "value").set(rate);
+            const auto props = rx_chan_props(chan);
+            get_prop(props->rate, props->dsp_subtree, "rate/value").set(rate);
             do_samp_rate_warning_message(rate, get_rx_rate(chan), "RX");
             return;
         }
@@ -1042,7 +1068,8 @@ public:
 
     double get_rx_rate(size_t chan)
     {
-        return _tree->access<double>(rx_dsp_root(chan) / "rate" / "value").get();
+        const auto props = rx_chan_props(chan);
+        return get_prop(props->rate, props->dsp_subtree, "rate/value").get();
     }
 
     meta_range_t get_rx_rates(size_t chan)
@@ -1056,12 +1083,12 @@ public:
         // CORDIC correction is necessary. Since the LO might be sourced from another
         // daughterboard which would normally apply a cordic correction a manual DSP tune
         // policy should be used to ensure identical configurations across daughterboards.
+        const auto props = rx_chan_props(chan);
         if (tune_request.dsp_freq_policy == tune_request.POLICY_AUTO
-            and tune_request.rf_freq_policy == tune_request.POLICY_AUTO) {
+            and tune_request.rf_freq_policy == tune_request.POLICY_AUTO
+            and props->has_all_los) {
             for (size_t c = 0; c < get_rx_num_channels(); c++) {
-                const bool external_all_los =
-                    _tree->exists(rx_rf_fe_root(chan) / "los" / ALL_LOS)
-                    && get_rx_lo_source(ALL_LOS, c) == "external";
+                const bool external_all_los = get_rx_lo_source(ALL_LOS, c) == "external";
                 if (external_all_los) {
                     UHD_LOGGER_WARNING("MULTI_USRP")
                         << "At least one channel is using an external LO."
@@ -1072,19 +1099,17 @@ public:
             }
         }
 
-        tune_result_t result = tune_xx_subdev_and_dsp(RX_SIGN,
-            _tree->subtree(rx_dsp_root(chan)),
-            _tree->subtree(rx_rf_fe_root(chan)),
-            tune_request);
+        tune_result_t result = tune_xx_subdev_and_dsp(
+            RX_SIGN, props->dsp_subtree, props->rf_fe_subtree, tune_request);
         // do_tune_freq_results_message(tune_request, result, get_rx_freq(chan), "RX");
         return result;
     }
 
     double get_rx_freq(size_t chan)
     {
-        return derive_freq_from_xx_subdev_and_dsp(RX_SIGN,
-            _tree->subtree(rx_dsp_root(chan)),
-            _tree->subtree(rx_rf_fe_root(chan)));
+        const auto props = rx_chan_props(chan);
+        return derive_freq_from_xx_subdev_and_dsp(
+            RX_SIGN, props->dsp_subtree, props->rf_fe_subtree);
     }
 
     freq_range_t get_rx_freq_range(size_t chan)
@@ -1549,9 +1574,10 @@ public:
     {
         /* Check if any AGC mode is enable and if so warn the user */
         if (chan != ALL_CHANS) {
-            if (_tree->exists(rx_rf_fe_root(chan) / "gain" / "agc")) {
+            const auto props = rx_chan_props(chan);
+            if (props->has_agc) {
                 bool agc =
-                    _tree->access<bool>(rx_rf_fe_root(chan) / "gain" / "agc" / "enable")
+                    get_prop(props->agc_enable, props->rf_fe_subtree, "gain/agc/enable")
                         .get();
                 if (agc) {
                     UHD_LOGGER_WARNING("MULTI_USRP")
@@ -1743,13 +1769,14 @@ public:
 
     void set_rx_antenna(const std::string& ant, size_t chan)
     {
-        _tree->access<std::string>(rx_rf_fe_root(chan) / "antenna" / "value").set(ant);
+        const auto props = rx_chan_props(chan);
+        get_prop(props->antenna, props->rf_fe_subtree, "antenna/value").set(ant);
     }
 
     std::string get_rx_antenna(size_t chan)
     {
-        return _tree->access<std::string>(rx_rf_fe_root(chan) / "antenna" / "value")
-            .get();
+        const auto props = rx_chan_props(chan);
+        return get_prop(props->antenna, props->rf_fe_subtree, "antenna/value").get();
     }
 
     std::vector<std::string> get_rx_antennas(size_t chan)
@@ -1762,12 +1789,15 @@ public:
 
     void set_rx_bandwidth(double bandwidth, size_t chan)
     {
-        _tree->access<double>(rx_rf_fe_root(chan) / "bandwidth" / "value").set(bandwidth);
+        const auto props = rx_chan_props(chan);
+        get_prop(props->bandwidth, props->rf_fe_subtree, "bandwidth/value")
+            .set(bandwidth);
     }
 
     double get_rx_bandwidth(size_t chan)
     {
-        return _tree->access<double>(rx_rf_fe_root(chan) / "bandwidth" / "value").get();
+        const auto props = rx_chan_props(chan);
+        return get_prop(props->bandwidth, props->rf_fe_subtree, "bandwidth/value").get();
     }
 
     meta_range_t get_rx_bandwidth_range(size_t chan)
@@ -2051,7 +2081,8 @@ public:
     void set_tx_rate(double rate, size_t chan)
     {
         if (chan != ALL_CHANS) {
-            _tree->access<double>(tx_dsp_root(chan) / "rate" / "value").set(rate);
+            const auto props = tx_chan_props(chan);
+            get_prop(props->rate, props->dsp_subtree, "rate/value").set(rate);
             do_samp_rate_warning_message(rate, get_tx_rate(chan), "TX");
             return;
         }
@@ -2062,7 +2093,8 @@ public:
 
     double get_tx_rate(size_t chan)
     {
-        return _tree->access<double>(tx_dsp_root(chan) / "rate" / "value").get();
+        const auto props = tx_chan_props(chan);
+        return get_prop(props->rate, props->dsp_subtree, "rate/value").get();
     }
 
     meta_range_t get_tx_rates(size_t chan)
@@ -2072,19 +2104,18 @@ public:
 
     tune_result_t set_tx_freq(const tune_request_t& tune_request, size_t chan)
     {
-        tune_result_t result = tune_xx_subdev_and_dsp(TX_SIGN,
-            _tree->subtree(tx_dsp_root(chan)),
-            _tree->subtree(tx_rf_fe_root(chan)),
-            tune_request);
+        const auto props     = tx_chan_props(chan);
+        tune_result_t result = tune_xx_subdev_and_dsp(
+            TX_SIGN, props->dsp_subtree, props->rf_fe_subtree, tune_request);
         // do_tune_freq_results_message(tune_request, result, get_tx_freq(chan), "TX");
         return result;
     }
 
     double get_tx_freq(size_t chan)
     {
-        return derive_freq_from_xx_subdev_and_dsp(TX_SIGN,
-            _tree->subtree(tx_dsp_root(chan)),
-            _tree->subtree(tx_rf_fe_root(chan)));
+        const auto props = tx_chan_props(chan);
+        return derive_freq_from_xx_subdev_and_dsp(
+            TX_SIGN, props->dsp_subtree, props->rf_fe_subtree);
     }
 
     freq_range_t get_tx_freq_range(size_t chan)
@@ -2253,13 +2284,14 @@ public:
 
     void set_tx_antenna(const std::string& ant, size_t chan)
     {
-        _tree->access<std::string>(tx_rf_fe_root(chan) / "antenna" / "value").set(ant);
+        const auto props = tx_chan_props(chan);
+        get_prop(props->antenna, props->rf_fe_subtree, "antenna/value").set(ant);
     }
 
     std::string get_tx_antenna(size_t chan)
     {
-        return _tree->access<std::string>(tx_rf_fe_root(chan) / "antenna" / "value")
-            .get();
+        const auto props = tx_chan_props(chan);
+        return get_prop(props->antenna, props->rf_fe_subtree, "antenna/value").get();
     }
 
     std::vector<std::string> get_tx_antennas(size_t chan)
@@ -2272,12 +2304,15 @@ public:
 
     void set_tx_bandwidth(double bandwidth, size_t chan)
     {
-        _tree->access<double>(tx_rf_fe_root(chan) / "bandwidth" / "value").set(bandwidth);
+        const auto props = tx_chan_props(chan);
+        get_prop(props->bandwidth, props->rf_fe_subtree, "bandwidth/value")
+            .set(bandwidth);
     }
 
     double get_tx_bandwidth(size_t chan)
     {
-        return _tree->access<double>(tx_rf_fe_root(chan) / "bandwidth" / "value").get();
+        const auto props = tx_chan_props(chan);
+        return get_prop(props->bandwidth, props->rf_fe_subtree, "bandwidth/value").get();
     }
 
     meta_range_t get_tx_bandwidth_range(size_t chan)
@@ -2564,12 +2599,50 @@ public:
     }
 
 private:
+    //! Properties of a channel, so the hot paths don't have to build paths and
+    // walk the tree on every call. Properties that don't exist are nullptr.
+    // The subtrees keep the tree, and with it the properties, alive for as long
+    // as the properties are used.
+    struct chan_props_t
+    {
+        //! False if the channel's roots couldn't be resolved
+        bool valid = false;
+        property_tree::sptr dsp_subtree;
+        property_tree::sptr rf_fe_subtree;
+        property<double>* rate             = nullptr;
+        property<stream_cmd_t>* stream_cmd = nullptr;
+        property<std::string>* antenna     = nullptr;
+        property<double>* bandwidth        = nullptr;
+        property<bool>* agc_enable         = nullptr;
+        bool has_agc                       = false;
+        bool has_all_los                   = false;
+        gain_group::sptr gains;
+    };
+
+    using chan_props_ptr = std::shared_ptr<const chan_props_t>;
+
+    //! Channel properties of one frontend configuration. The properties of a
+    // channel are looked up when the channel is first used.
+    struct chan_props_cache_t
+    {
+        uint64_t generation;
+        //! Only accessed through std::atomic_load() and std::atomic_store()
+        mutable std::vector<chan_props_ptr> rx;
+        //! Only accessed through std::atomic_load() and std::atomic_store()
+        mutable std::vector<chan_props_ptr> tx;
+    };
+
     device::sptr _dev;
     property_tree::sptr _tree;
 
     //! Container for spp values set in set_rx_spp()
     std::unordered_map<size_t, size_t> _rx_spp;
 
+    //! Incremented whenever the channel property cache is outdated
+    std::shared_ptr<std::atomic<uint64_t>> _chan_props_generation;
+    //! Only accessed through std::atomic_load() and std::atomic_store()
+    std::shared_ptr<const chan_props_cache_t> _chan_props_cache;
+
     struct mboard_chan_pair
     {
         size_t mboard, chan;
@@ -2759,6 +2832,18 @@ private:
     }
 
     gain_group::sptr rx_gain_group(size_t chan)
+    {
+        const auto props = rx_chan_props(chan);
+        return props->gains ? props->gains : make_rx_gain_group(chan);
+    }
+
+    gain_group::sptr tx_gain_group(size_t chan)
+    {
+        const auto props = tx_chan_props(chan);
+        return props->gains ? props->gains : make_tx_gain_group(chan);
+    }
+
+    gain_group::sptr make_rx_gain_group(size_t chan)
     {
         mboard_chan_pair mcp          = rx_chan_to_mcp(chan);
         const subdev_spec_pair_t spec = get_rx_subdev_spec(mcp.mboard).at(mcp.chan);
@@ -2779,7 +2864,7 @@ private:
         return gg;
     }
 
-    gain_group::sptr tx_gain_group(size_t chan)
+    gain_group::sptr make_tx_gain_group(size_t chan)
     {
         mboard_chan_pair mcp          = tx_chan_to_mcp(chan);
         const subdev_spec_pair_t spec = get_tx_subdev_spec(mcp.mboard).at(mcp.chan);
@@ -2800,6 +2885,108 @@ private:
         return gg;
     }
 
+    /**************************************************************************
+     * Channel property cache
+     *************************************************************************/
+    template <typename T>
+    property<T>* find_prop(property_tree::sptr subtree, const fs_path& path)
+    {
+        return subtree->exists(path) ? &subtree->access<T>(path) : nullptr;
+    }
+
+    chan_props_ptr make_chan_props(const size_t chan, const bool is_tx)
+    {
+        auto props_ptr      = std::make_shared<chan_props_t>();
+        chan_props_t& props = *props_ptr;
+        try {
+            props.dsp_subtree =
+                _tree->subtree(is_tx ? tx_dsp_root(chan) : rx_dsp_root(chan));
+            props.rf_fe_subtree =
+                _tree->subtree(is_tx ? tx_rf_fe_root(chan) : rx_rf_fe_root(chan));
+        } catch (const uhd::exception&) {
+            // The accessors will resolve the roots again, and throw
+            return props_ptr;
+        }
+        props.valid = true;
+        props.rate  = find_prop<double>(props.dsp_subtree, "rate/value");
+        if (not is_tx) {
+            props.stream_cmd = find_prop<stream_cmd_t>(props.dsp_subtree, "stream_cmd");
+        }
+        props.antenna     = find_prop<std::string>(props.rf_fe_subtree, "antenna/value");
+        props.bandwidth   = find_prop<double>(props.rf_fe_subtree, "bandwidth/value");
+        props.has_agc     = props.rf_fe_subtree->exists("gain/agc");
+        props.agc_enable  = find_prop<bool>(props.rf_fe_subtree, "gain/agc/enable");
+        props.has_all_los = props.rf_fe_subtree->exists(fs_path("los") / ALL_LOS);
+        try {
+            props.gains = is_tx ? make_tx_gain_group(chan) : make_rx_gain_group(chan);
+        } catch (const uhd::exception&) {
+            // Leave it to the accessors to throw
+        }
+        return props_ptr;
+    }
+
+    std::shared_ptr<const chan_props_cache_t> get_chan_props_cache()
+    {
+        auto cache = std::atomic_load(&_chan_props_cache);
+        if (cache and cache->generation == *_chan_props_generation) {
+            return cache;
+        }
+
+        auto new_cache        = std::make_shared<chan_props_cache_t>();
+        new_cache->generation = *_chan_props_generation;
+        new_cache->rx.resize(get_rx_num_channels());
+        new_cache->tx.resize(get_tx_num_channels());
+        // Counting the channels may have changed the frontend specs (see
+        // get_rx_subdev_spec()). If so, the generation is already outdated, and
+        // the next call sets up the cache again.
+        cache = new_cache;
+        std::atomic_store(&_chan_props_cache, cache);
+        return cache;
+    }
+
+    //! Return the properties of a channel, and look them up on first use
+    chan_props_ptr get_chan_props(const size_t chan, const bool is_tx)
+    {
+        const auto cache = get_chan_props_cache();
+        auto& slots      = is_tx ? cache->tx : cache->rx;
+        if (chan >= slots.size()) {
+            return nullptr;
+        }
+        chan_props_ptr props = std::atomic_load(&slots[chan]);
+        if (not props) {
+            // Two threads may look up the same channel, both get valid results
+            props = make_chan_props(chan, is_tx);
+            std::atomic_store(&slots[chan], props);
+        }
+        return props->valid ? props : nullptr;
+    }
+
+    chan_props_ptr rx_chan_props(const size_t chan)
+    {
+        auto props = get_chan_props(chan, false);
+        if (not props) {
+            // Let the usual path lookup throw the error
+            rx_dsp_root(chan);
+            rx_rf_fe_root(chan);
+            throw uhd::index_error(
+                str(boost::format("multi_usrp: Invalid RX channel %u") % chan));
+        }
+        return props;
+    }
+
+    chan_props_ptr tx_chan_props(const size_t chan)
+    {
+        auto props = get_chan_props(chan, true);
+        if (not props) {
+            // Let the usual path lookup throw the error
+            tx_dsp_root(chan);
+            tx_rf_fe_root(chan);
+            throw uhd::index_error(
+                str(boost::format("multi_usrp: Invalid TX channel %u") % chan));
+        }
+        return props;
+    }
+
     //! \param is_tx True for tx
     // Assumption is that all mboards use the same link
     // and that the rate sum is evenly distributed among the mboards
@@ -2838,6 +3025,96 @@ multi_usrp::~multi_usrp(void)
     /* NOP */
 }
 
+/***********************************************************************
+ * Multi-channel setters: By default, one channel after the other
+ **********************************************************************/
+namespace {
+void assert_chans_valid(
+    const std::vector<size_t>& chans, const size_t num_chans, const std::string& dir)
+{
+    for (const size_t chan : chans) {
+        if (chan >= num_chans) {
+            throw uhd::index_error(
+                str(boost::format("multi_usrp: %s channel %u out of range for "
+                                  "configured frontends")
+                    % dir % chan));
+        }
+    }
+}
+} // namespace
+
+void multi_usrp::set_rx_rate(double rate, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_rx_num_channels(), "RX");
+    for (const size_t chan : chans) {
+        set_rx_rate(rate, chan);
+    }
+}
+
+std::vector<tune_result_t> multi_usrp::set_rx_freq(
+    const tune_request_t& tune_request, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_rx_num_channels(), "RX");
+    std::vector<tune_result_t> results;
+    for (const size_t chan : chans) {
+        results.push_back(set_rx_freq(tune_request, chan));
+    }
+    return results;
+}
+
+void multi_usrp::set_rx_gain(
+    double gain, const std::string& name, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_rx_num_channels(), "RX");
+    for (const size_t chan : chans) {
+        set_rx_gain(gain, name, chan);
+    }
+}
+
+void multi_usrp::set_rx_bandwidth(double bandwidth, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_rx_num_channels(), "RX");
+    for (const size_t chan : chans) {
+        set_rx_bandwidth(bandwidth, chan);
+    }
+}
+
+void multi_usrp::set_tx_rate(double rate, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_tx_num_channels(), "TX");
+    for (const size_t chan : chans) {
+        set_tx_rate(rate, chan);
+    }
+}
+
+std::vector<tune_result_t> multi_usrp::set_tx_freq(
+    const tune_request_t& tune_request, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_tx_num_channels(), "TX");
+    std::vector<tune_result_t> results;
+    for (const size_t chan : chans) {
+        results.push_back(set_tx_freq(tune_request, chan));
+    }
+    return results;
+}
+
+void multi_usrp::set_tx_gain(
+    double gain, const std::string& name, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_tx_num_channels(), "TX");
+    for (const size_t chan : chans) {
+        set_tx_gain(gain, name, chan);
+    }
+}
+
+void multi_usrp::set_tx_bandwidth(double bandwidth, const std::vector<size_t>& chans)
+{
+    assert_chans_valid(chans, get_tx_num_channels(), "TX");
+    for (const size_t chan : chans) {
+        set_tx_bandwidth(bandwidth, chan);
+    }
+}
+
 
 /***********************************************************************
  * The Make Function
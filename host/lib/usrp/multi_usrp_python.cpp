@@ -11,6 +11,7 @@
 
 namespace py = pybind11;
 
+#include "../stream_format_python.hpp"
 #include "multi_usrp_python.hpp"
 #include <uhd/usrp/multi_usrp.hpp>
 
@@ -35,19 +36,25 @@ void export_multi_usrp(py::module& m)
         .def("get_rx_freq"             , &multi_usrp::get_rx_freq, py::arg("chan") = 0)
         .def("get_rx_num_channels"     , &multi_usrp::get_rx_num_channels)
         .def("get_rx_rate"             , &multi_usrp::get_rx_rate, py::arg("chan") = 0)
-        .def("get_rx_stream"           , &multi_usrp::get_rx_stream)
-        .def("set_rx_freq"             , &multi_usrp::set_rx_freq, py::arg("tune_request"), py::arg("chan") = 0)
+        .def("get_rx_stream"           , [](multi_usrp& self, const uhd::stream_args_t& args){ return wrap_rx_stream(self.get_rx_stream(args), args); })
+        .def("set_rx_freq"             , (uhd::tune_result_t (multi_usrp::*)(const uhd::tune_request_t&, size_t)) &multi_usrp::set_rx_freq, py::arg("tune_request"), py::arg("chan") = 0)
+        .def("set_rx_freq"             , (std::vector<uhd::tune_result_t> (multi_usrp::*)(const uhd::tune_request_t&, const std::vector<size_t>&)) &multi_usrp::set_rx_freq, py::arg("tune_request"), py::arg("chans"))
         .def("set_rx_gain"             , (void (multi_usrp::*)(double, const std::string&, size_t)) &multi_usrp::set_rx_gain, py::arg("gain"), py::arg("name"), py::arg("chan") = 0)
+        .def("set_rx_gain"             , (void (multi_usrp::*)(double, const std::string&, const std::vector<size_t>&)) &multi_usrp::set_rx_gain, py::arg("gain"), py::arg("name"), py::arg("chans"))
         .def("set_rx_gain"             , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_rx_gain, py::arg("gain"), py::arg("chan") = 0)
-        .def("set_rx_rate"             , &multi_usrp::set_rx_rate, py::arg("rate"), py::arg("chan") = ALL_CHANS)
+        .def("set_rx_rate"             , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_rx_rate, py::arg("rate"), py::arg("chan") = ALL_CHANS)
+        .def("set_rx_rate"             , (void (multi_usrp::*)(double, const std::vector<size_t>&)) &multi_usrp::set_rx_rate, py::arg("rate"), py::arg("chans"))
         .def("get_tx_freq"             , &multi_usrp::get_tx_freq, py::arg("chan") = 0)
         .def("get_tx_num_channels"     , &multi_usrp::get_tx_num_channels)
         .def("get_tx_rate"             , &multi_usrp::get_tx_rate, py::arg("chan") = 0)
         .def("get_tx_stream"           , &multi_usrp::get_tx_stream)
-        .def("set_tx_freq"             , &multi_usrp::set_tx_freq, py::arg("tune_request"), py::arg("chan") = 0)
+        .def("set_tx_freq"             , (uhd::tune_result_t (multi_usrp::*)(const uhd::tune_request_t&, size_t)) &multi_usrp::set_tx_freq, py::arg("tune_request"), py::arg("chan") = 0)
+        .def("set_tx_freq"             , (std::vector<uhd::tune_result_t> (multi_usrp::*)(const uhd::tune_request_t&, const std::vector<size_t>&)) &multi_usrp::set_tx_freq, py::arg("tune_request"), py::arg("chans"))
         .def("set_tx_gain"             , (void (multi_usrp::*)(double, const std::string&, size_t)) &multi_usrp::set_tx_gain, py::arg("gain"), py::arg("name"), py::arg("chan") = 0)
+        .def("set_tx_gain"             , (void (multi_usrp::*)(double, const std::string&, const std::vector<size_t>&)) &multi_usrp::set_tx_gain, py::arg("gain"), py::arg("name"), py::arg("chans"))
         .def("set_tx_gain"             , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_tx_gain, py::arg("gain"), py::arg("chan") = 0)
-        .def("set_tx_rate"             , &multi_usrp::set_tx_rate, py::arg("rate"), py::arg("chan") = ALL_CHANS)
+        .def("set_tx_rate"             , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_tx_rate, py::arg("rate"), py::arg("chan") = ALL_CHANS)
+        .def("set_tx_rate"             , (void (multi_usrp::*)(double, const std::vector<size_t>&)) &multi_usrp::set_tx_rate, py::arg("rate"), py::arg("chans"))
         .def("get_usrp_rx_info",
             [](multi_usrp& self, const size_t chan = 0) {
                 return static_cast<std::map<std::string, std::string>>(
@@ -120,7 +127,8 @@ void export_multi_usrp(py::module& m)
         .def("set_rx_antenna"          , &multi_usrp::set_rx_antenna, py::arg("ant"), py::arg("chan") = 0)
         .def("get_rx_antenna"          , &multi_usrp::get_rx_antenna, py::arg("chan") = 0)
         .def("get_rx_antennas"         , &multi_usrp::get_rx_antennas, py::arg("chan") = 0)
-        .def("set_rx_bandwidth"        , &multi_usrp::set_rx_bandwidth, py::arg("bandwidth"), py::arg("chan") = 0)
+        .def("set_rx_bandwidth"        , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_rx_bandwidth, py::arg("bandwidth"), py::arg("chan") = 0)
+        .def("set_rx_bandwidth"        , (void (multi_usrp::*)(double, const std::vector<size_t>&)) &multi_usrp::set_rx_bandwidth, py::arg("bandwidth"), py::arg("chans"))
         .def("get_rx_bandwidth"        , &multi_usrp::get_rx_bandwidth, py::arg("chan") = 0)
         .def("get_rx_bandwidth_range"  , &multi_usrp::get_rx_bandwidth_range, py::arg("chan") = 0)
         .def("get_rx_dboard_iface"     , &multi_usrp::get_rx_dboard_iface, py::arg("chan") = 0)
@@ -164,7 +172,8 @@ void export_multi_usrp(py::module& m)
         .def("set_tx_antenna"          , &multi_usrp::set_tx_antenna, py::arg("ant"), py::arg("chan") = 0)
         .def("get_tx_antenna"          , &multi_usrp::get_tx_antenna, py::arg("chan") = 0)
         .def("get_tx_antennas"         , &multi_usrp::get_tx_antennas, py::arg("chan") = 0)
-        .def("set_tx_bandwidth"        , &multi_usrp::set_tx_bandwidth, py::arg("bandwidth"), py::arg("chan") = 0)
+        .def("set_tx_bandwidth"        , (void (multi_usrp::*)(double, size_t)) &multi_usrp::set_tx_bandwidth, py::arg("bandwidth"), py::arg("chan") = 0)
+        .def("set_tx_bandwidth"        , (void (multi_usrp::*)(double, const std::vector<size_t>&)) &multi_usrp::set_tx_bandwidth, py::arg("bandwidth"), py::arg("chans"))
         .def("get_tx_bandwidth"        , &multi_usrp::get_tx_bandwidth, py::arg("chan") = 0)
         .def("get_tx_bandwidth_range"  , &multi_usrp::get_tx_bandwidth_range, py::arg("chan") = 0)
         .def("get_tx_dboard_iface"     , &multi_usrp::get_tx_dboard_iface, py::arg("chan") = 0)
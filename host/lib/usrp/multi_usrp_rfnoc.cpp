@@ -18,13 +18,16 @@
 #include <uhdlib/rfnoc/rfnoc_rx_streamer.hpp>
 #include <uhdlib/rfnoc/rfnoc_tx_streamer.hpp>
 #include <uhdlib/usrp/gpio_defs.hpp>
+#include <uhdlib/usrp/multi_usrp_utils.hpp>
 #include <uhdlib/utils/narrow.hpp>
 #include <unordered_set>
 #include <boost/format.hpp>
 #include <algorithm>
 #include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <thread>
 #include <vector>
 
@@ -52,6 +55,22 @@ using namespace uhd::rfnoc;
 #define MUX_MB_API_CALL(api_call, ...) \
     MUX_API_CALL(get_num_mboards(), api_call, mboard, ALL_MBOARDS, __VA_ARGS__)
 
+//! Forward an API call that is for all channels to its multi-channel version
+#define BATCH_API_CALL(all_chans, api_call, ...) \
+    if (chan == ALL_CHANS) {                     \
+        api_call(__VA_ARGS__, all_chans);        \
+        return;                                  \
+    }
+
+//! Forward an RX-specific API call that is for all channels to its multi-channel
+// version
+#define BATCH_RX_API_CALL(api_call, ...) \
+    BATCH_API_CALL(_get_all_chans(get_rx_num_channels()), api_call, __VA_ARGS__)
+//! Forward a TX-specific API call that is for all channels to its multi-channel
+// version
+#define BATCH_TX_API_CALL(api_call, ...) \
+    BATCH_API_CALL(_get_all_chans(get_tx_num_channels()), api_call, __VA_ARGS__)
+
 
 namespace {
 constexpr char DEFAULT_CPU_FORMAT[] = "fc32";
@@ -1157,7 +1176,7 @@ public:
     void set_rx_rate(double rate, size_t chan = ALL_CHANS)
     {
         std::lock_guard<std::recursive_mutex> l(_graph_mutex);
-        MUX_RX_API_CALL(set_rx_rate, rate);
+        BATCH_RX_API_CALL(set_rx_rate, rate);
         const double actual_rate = [&]() {
             auto rx_chain = _get_rx_chan(chan);
             if (rx_chain.ddc) {
@@ -1175,6 +1194,11 @@ public:
         _rx_rates[chan] = actual_rate;
     }
 
+    void set_rx_rate(double rate, const std::vector<size_t>& chans)
+    {
+        _for_each_rx_chan(chans, [&](const size_t chan) { set_rx_rate(rate, chan); });
+    }
+
     void set_rx_spp(const size_t spp, const size_t chan = ALL_CHANS)
     {
         std::lock_guard<std::recursive_mutex> l(_graph_mutex);
@@ -1254,6 +1278,20 @@ public:
             tune_request);
     }
 
+    std::vector<tune_result_t> set_rx_freq(
+        const tune_request_t& tune_request, const std::vector<size_t>& chans)
+    {
+        std::map<size_t, tune_result_t> results;
+        _for_each_rx_chan(chans, [&](const size_t chan) {
+            results[chan] = set_rx_freq(tune_request, chan);
+        });
+        std::vector<tune_result_t> ordered_results;
+        for (const size_t chan : chans) {
+            ordered_results.push_back(results.at(chan));
+        }
+        return ordered_results;
+    }
+
     double get_rx_freq(size_t chan = 0)
     {
         auto& rx_chain = _get_rx_chan(chan);
@@ -1416,11 +1454,18 @@ public:
      *************************************************************************/
     void set_rx_gain(double gain, const std::string& name, size_t chan = 0)
     {
-        MUX_RX_API_CALL(set_rx_gain, gain, name);
+        BATCH_RX_API_CALL(set_rx_gain, gain, name);
         auto rx_chain = _get_rx_chan(chan);
         rx_chain.radio->set_rx_gain(gain, name, rx_chain.block_chan);
     }
 
+    void set_rx_gain(
+        double gain, const std::string& name, const std::vector<size_t>& chans)
+    {
+        _for_each_rx_chan(
+            chans, [&](const size_t chan) { set_rx_gain(gain, name, chan); });
+    }
+
     std::vector<std::string> get_rx_gain_profile_names(const size_t chan = 0)
     {
         auto rx_chain = _get_rx_chan(chan);
@@ -1537,11 +1582,17 @@ public:
 
     void set_rx_bandwidth(double bandwidth, size_t chan = 0)
     {
-        MUX_RX_API_CALL(set_rx_bandwidth, bandwidth);
+        BATCH_RX_API_CALL(set_rx_bandwidth, bandwidth);
         auto& rx_chain = _get_rx_chan(chan);
         rx_chain.radio->set_rx_bandwidth(bandwidth, rx_chain.block_chan);
     }
 
+    void set_rx_bandwidth(double bandwidth, const std::vector<size_t>& chans)
+    {
+        _for_each_rx_chan(
+            chans, [&](const size_t chan) { set_rx_bandwidth(bandwidth, chan); });
+    }
+
     double get_rx_bandwidth(size_t chan = 0)
     {
         auto& rx_chain = _get_rx_chan(chan);
@@ -1792,7 +1843,7 @@ public:
     void set_tx_rate(double rate, size_t chan = ALL_CHANS)
     {
         std::lock_guard<std::recursive_mutex> l(_graph_mutex);
-        MUX_TX_API_CALL(set_tx_rate, rate);
+        BATCH_TX_API_CALL(set_tx_rate, rate);
         const double actual_rate = [&]() {
             auto tx_chain = _get_tx_chan(chan);
             if (tx_chain.duc) {
@@ -1810,6 +1861,11 @@ public:
         _tx_rates[chan] = actual_rate;
     }
 
+    void set_tx_rate(double rate, const std::vector<size_t>& chans)
+    {
+        _for_each_tx_chan(chans, [&](const size_t chan) { set_tx_rate(rate, chan); });
+    }
+
     double get_tx_rate(size_t chan = 0)
     {
         std::lock_guard<std::recursive_mutex> l(_graph_mutex);
@@ -1877,6 +1933,20 @@ public:
             tune_request);
     }
 
+    std::vector<tune_result_t> set_tx_freq(
+        const tune_request_t& tune_request, const std::vector<size_t>& chans)
+    {
+        std::map<size_t, tune_result_t> results;
+        _for_each_tx_chan(chans, [&](const size_t chan) {
+            results[chan] = set_tx_freq(tune_request, chan);
+        });
+        std::vector<tune_result_t> ordered_results;
+        for (const size_t chan : chans) {
+            ordered_results.push_back(results.at(chan));
+        }
+        return ordered_results;
+    }
+
     double get_tx_freq(size_t chan = 0)
     {
         auto& tx_chain = _get_tx_chan(chan);
@@ -1907,11 +1977,18 @@ public:
 
     void set_tx_gain(double gain, const std::string& name, size_t chan = 0)
     {
-        MUX_TX_API_CALL(set_tx_gain, gain, name);
+        BATCH_TX_API_CALL(set_tx_gain, gain, name);
         auto tx_chain = _get_tx_chan(chan);
         tx_chain.radio->set_tx_gain(gain, name, tx_chain.block_chan);
     }
 
+    void set_tx_gain(
+        double gain, const std::string& name, const std::vector<size_t>& chans)
+    {
+        _for_each_tx_chan(
+            chans, [&](const size_t chan) { set_tx_gain(gain, name, chan); });
+    }
+
     std::vector<std::string> get_tx_gain_profile_names(const size_t chan = 0)
     {
         auto tx_chain = _get_tx_chan(chan);
@@ -2021,11 +2098,17 @@ public:
 
     void set_tx_bandwidth(double bandwidth, size_t chan = 0)
     {
-        MUX_TX_API_CALL(set_tx_bandwidth, bandwidth);
+        BATCH_TX_API_CALL(set_tx_bandwidth, bandwidth);
         auto tx_chain = _get_tx_chan(chan);
         tx_chain.radio->set_tx_bandwidth(bandwidth, tx_chain.block_chan);
     }
 
+    void set_tx_bandwidth(double bandwidth, const std::vector<size_t>& chans)
+    {
+        _for_each_tx_chan(
+            chans, [&](const size_t chan) { set_tx_bandwidth(bandwidth, chan); });
+    }
+
     double get_tx_bandwidth(size_t chan = 0)
     {
         auto tx_chain = _get_tx_chan(chan);
@@ -2474,6 +2557,44 @@ private:
         return _tx_chans.at(chan);
     }
 
+    static std::vector<size_t> _get_all_chans(const size_t num_chans)
+    {
+        std::vector<size_t> chans(num_chans);
+        std::iota(chans.begin(), chans.end(), 0);
+        return chans;
+    }
+
+    //! Apply a setting to several channels in one go, see for_each_chan_by_radio()
+    template <typename chan_fn_t>
+    void _for_each_chan(std::vector<std::pair<std::string, size_t>> chans,
+        chan_fn_t&& chan_fn)
+    {
+        std::lock_guard<std::recursive_mutex> l(_graph_mutex);
+        for_each_chan_by_radio(std::move(chans), std::forward<chan_fn_t>(chan_fn));
+    }
+
+    //! Validate all RX channels, and then apply a setting to them in one go
+    template <typename chan_fn_t>
+    void _for_each_rx_chan(const std::vector<size_t>& chans, chan_fn_t&& chan_fn)
+    {
+        std::vector<std::pair<std::string, size_t>> radio_chans;
+        for (const size_t chan : chans) {
+            radio_chans.emplace_back(_get_rx_chan(chan).radio->get_unique_id(), chan);
+        }
+        _for_each_chan(std::move(radio_chans), std::forward<chan_fn_t>(chan_fn));
+    }
+
+    //! Validate all TX channels, and then apply a setting to them in one go
+    template <typename chan_fn_t>
+    void _for_each_tx_chan(const std::vector<size_t>& chans, chan_fn_t&& chan_fn)
+    {
+        std::vector<std::pair<std::string, size_t>> radio_chans;
+        for (const size_t chan : chans) {
+            radio_chans.emplace_back(_get_tx_chan(chan).radio->get_unique_id(), chan);
+        }
+        _for_each_chan(std::move(radio_chans), std::forward<chan_fn_t>(chan_fn));
+    }
+
     std::vector<graph_edge_t> _connect_rx_chains(std::vector<size_t> chans)
     {
         std::vector<graph_edge_t> edges;
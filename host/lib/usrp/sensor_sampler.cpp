@@ -0,0 +1,239 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/usrp/sensor_sampler.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+namespace {
+
+constexpr char LOG_ID[] = "SENSOR_SAMPLER";
+
+using clock_type = std::chrono::steady_clock;
+
+//! One read of a sensor. Published samples are never modified.
+struct sample_t
+{
+    sample_t(const sensor_value_t& value_) : value(value_) {}
+
+    sensor_value_t value;
+    bool valid = false;
+    clock_type::time_point read_time;
+    std::string error;
+};
+
+using sample_ptr = std::shared_ptr<const sample_t>;
+
+struct slot_t
+{
+    sensor_sampler::sensor_t sensor;
+    clock_type::duration period;
+    clock_type::time_point next_read;
+    //! Only accessed through std::atomic_load() and std::atomic_store()
+    sample_ptr sample;
+};
+
+} // namespace
+
+class sensor_sampler_impl : public sensor_sampler
+{
+public:
+    sensor_sampler_impl(const std::vector<sensor_t>& sensors) : _slots(sensors.size())
+    {
+        const auto now   = clock_type::now();
+        const auto empty = std::make_shared<const sample_t>(cached_value_t().value);
+        for (size_t i = 0; i < sensors.size(); i++) {
+            const sensor_t& sensor = sensors[i];
+            if (not sensor.read) {
+                throw uhd::value_error(
+                    "sensor_sampler: No read function for sensor " + sensor.key);
+            }
+            if (not(sensor.period > 0.0)) {
+                throw uhd::value_error(
+                    "sensor_sampler: Period must be positive for sensor " + sensor.key);
+            }
+            if (_index.count(sensor.key)) {
+                throw uhd::value_error("sensor_sampler: Duplicate key " + sensor.key);
+            }
+            _index[sensor.key] = i;
+            _slots[i].sensor   = sensor;
+            _slots[i].period   = std::chrono::duration_cast<clock_type::duration>(
+                std::chrono::duration<double>(sensor.period));
+            _slots[i].next_read = now;
+            _slots[i].sample    = empty;
+        }
+
+        if (not _slots.empty()) {
+            _thread = std::thread([this]() { sampler_loop(); });
+            uhd::set_thread_name(&_thread, "sensor_sampler");
+        }
+    }
+
+    ~sensor_sampler_impl(void)
+    {
+        UHD_SAFE_CALL(stop();)
+    }
+
+    cached_value_t get(const std::string& key) const
+    {
+        const auto it = _index.find(key);
+        if (it == _index.end()) {
+            throw uhd::key_error("sensor_sampler: No sensor with key " + key);
+        }
+        const sample_ptr sample = std::atomic_load(&_slots[it->second].sample);
+
+        cached_value_t result;
+        result.value = sample->value;
+        result.valid = sample->valid;
+        result.error = sample->error;
+        if (sample->valid) {
+            result.age =
+                std::chrono::duration<double>(clock_type::now() - sample->read_time)
+                    .count();
+        }
+        return result;
+    }
+
+    std::vector<std::string> get_keys(void) const
+    {
+        std::vector<std::string> keys;
+        keys.reserve(_slots.size());
+        for (const auto& slot : _slots) {
+            keys.push_back(slot.sensor.key);
+        }
+        return keys;
+    }
+
+    void stop(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cond.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+private:
+    void sampler_loop(void)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (not _stop) {
+            // Pick the sensor that is due first. Ties go to the one listed
+            // first, so the initial reads happen in order.
+            slot_t* next = &_slots.front();
+            for (auto& slot : _slots) {
+                if (slot.next_read < next->next_read) {
+                    next = &slot;
+                }
+            }
+            if (_cond.wait_until(lock, next->next_read, [this]() { return _stop; })) {
+                break;
+            }
+
+            lock.unlock();
+            read(*next);
+            lock.lock();
+        }
+    }
+
+    void read(slot_t& slot)
+    {
+        const sample_ptr last = std::atomic_load(&slot.sample);
+        auto sample           = std::make_shared<sample_t>(*last);
+        try {
+            sample->value     = slot.sensor.read();
+            sample->valid     = true;
+            sample->read_time = clock_type::now();
+            sample->error.clear();
+        } catch (const std::exception& ex) {
+            // Keep the last good value, it's up to the reader to decide if
+            // it's too old to be useful
+            if (last->error.empty()) {
+                UHD_LOG_WARNING(LOG_ID,
+                    "Failed to read sensor " << slot.sensor.key << ": " << ex.what());
+            }
+            sample->error = ex.what();
+        }
+        std::atomic_store(&slot.sample, sample_ptr(std::move(sample)));
+
+        // Don't try to catch up on missed reads if a read took longer than
+        // the period
+        const auto now = clock_type::now();
+        slot.next_read += slot.period;
+        if (slot.next_read < now) {
+            slot.next_read = now + slot.period;
+        }
+    }
+
+    std::vector<slot_t> _slots;
+    std::unordered_map<std::string, size_t> _index;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _stop = false;
+    std::thread _thread;
+};
+
+sensor_sampler::~sensor_sampler(void)
+{
+    /* NOP */
+}
+
+sensor_sampler::sptr sensor_sampler::make(const std::vector<sensor_t>& sensors)
+{
+    return std::make_shared<sensor_sampler_impl>(sensors);
+}
+
+sensor_sampler::sensor_t sensor_sampler::mboard_sensor(multi_usrp::sptr usrp,
+    const std::string& name,
+    const double period,
+    const size_t mboard)
+{
+    sensor_t sensor;
+    sensor.key    = "mboard" + std::to_string(mboard) + "/" + name;
+    sensor.read   = [usrp, name, mboard]() {
+        return usrp->get_mboard_sensor(name, mboard);
+    };
+    sensor.period = period;
+    return sensor;
+}
+
+sensor_sampler::sensor_t sensor_sampler::rx_sensor(multi_usrp::sptr usrp,
+    const std::string& name,
+    const double period,
+    const size_t chan)
+{
+    sensor_t sensor;
+    sensor.key    = "rx" + std::to_string(chan) + "/" + name;
+    sensor.read   = [usrp, name, chan]() { return usrp->get_rx_sensor(name, chan); };
+    sensor.period = period;
+    return sensor;
+}
+
+sensor_sampler::sensor_t sensor_sampler::tx_sensor(multi_usrp::sptr usrp,
+    const std::string& name,
+    const double period,
+    const size_t chan)
+{
+    sensor_t sensor;
+    sensor.key    = "tx" + std::to_string(chan) + "/" + name;
+    sensor.read   = [usrp, name, chan]() { return usrp->get_tx_sensor(name, chan); };
+    sensor.period = period;
+    return sensor;
+}
@@ -17,6 +17,7 @@
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhdlib/usrp/common/image_loader_console.hpp>
 #include <boost/algorithm/string/erase.hpp>
 #include <boost/asio/ip/address_v4.hpp>
 #include <boost/assign.hpp>
@@ -133,6 +134,7 @@ typedef struct
     uint32_t max_size;
     uint32_t flash_addr;
     udp_simple::sptr xport;
+    image_loader::message_fcn_t message; // Replaces the console output, if set
 } n200_session_t;
 
 /***********************************************************************
@@ -394,6 +396,8 @@ static void n200_setup_session(n200_session_t& session,
 
 static void n200_erase_image(n200_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     n200_fw_update_data_t pkt_out;
     const n200_fw_update_data_t* pkt_in =
@@ -407,18 +411,18 @@ static void n200_erase_image(n200_session_t& session)
     size_t len =
         n200_send_and_recv(session.xport, ERASE_FLASH_CMD, &pkt_out, session.data_in);
     if (n200_response_matches(pkt_in, ERASE_FLASH_ACK, len)) {
-        std::cout << boost::format("-- Erasing %s image...") % session.burn_type
-                  << std::flush;
+        console << boost::format("-- Erasing %s image...") % session.burn_type
+                << std::flush;
     } else if (len < offsetof(n200_fw_update_data_t, data)) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Timed out waiting for reply from device.");
     } else if (ntohl(pkt_in->id) != ERASE_FLASH_ACK) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error(
             str(boost::format("Received invalid reply %d from device.\n")
                 % ntohl(pkt_in->id)));
     } else {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Did not receive response from device.");
     }
 
@@ -427,13 +431,13 @@ static void n200_erase_image(n200_session_t& session)
         len = n200_send_and_recv(
             session.xport, CHECK_ERASING_DONE_CMD, &pkt_out, session.data_in);
         if (n200_response_matches(pkt_in, DONE_ERASING_ACK, len)) {
-            std::cout << "successful." << std::endl;
+            console << "successful." << std::endl;
             break;
         } else if (len < offsetof(n200_fw_update_data_t, data)) {
-            std::cout << "failed." << std::endl;
+            console << "failed." << std::endl;
             throw uhd::runtime_error("Timed out waiting for reply from device.");
         } else if (ntohl(pkt_in->id) != NOT_DONE_ERASING_ACK) {
-            std::cout << "failed." << std::endl;
+            console << "failed." << std::endl;
             throw uhd::runtime_error(
                 str(boost::format("Received invalid reply %d from device.\n")
                     % ntohl(pkt_in->id)));
@@ -443,6 +447,8 @@ static void n200_erase_image(n200_session_t& session)
 
 static void n200_write_image(n200_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     n200_fw_update_data_t pkt_out;
     const n200_fw_update_data_t* pkt_in =
@@ -461,28 +467,28 @@ static void n200_write_image(n200_session_t& session)
         len =
             n200_send_and_recv(session.xport, WRITE_FLASH_CMD, &pkt_out, session.data_in);
         if (n200_response_matches(pkt_in, WRITE_FLASH_ACK, len)) {
-            std::cout << boost::format("\r-- Writing %s image (%d%%)") % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::flush;
+            console << boost::format("\r-- Writing %s image (%d%%)") % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::flush;
         } else if (len < offsetof(n200_fw_update_data_t, data)) {
             image.close();
-            std::cout << boost::format("\r--Writing %s image..failed at %d%%.")
-                             % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::endl;
+            console << boost::format("\r--Writing %s image..failed at %d%%.")
+                           % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::endl;
             throw uhd::runtime_error("Timed out waiting for reply from device.");
         } else if (ntohl(pkt_in->id) != WRITE_FLASH_ACK) {
             image.close();
-            std::cout << boost::format("\r--Writing %s image..failed at %d%%.")
-                             % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::endl;
+            console << boost::format("\r--Writing %s image..failed at %d%%.")
+                           % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::endl;
             throw uhd::runtime_error(
                 str(boost::format("Received invalid reply %d from device.\n")
                     % ntohl(pkt_in->id)));
@@ -490,14 +496,16 @@ static void n200_write_image(n200_session_t& session)
 
         current_addr += N200_FLASH_DATA_PACKET_SIZE;
     }
-    std::cout << boost::format("\r-- Writing %s image...successful.") % session.burn_type
-              << std::endl;
+    console << boost::format("\r-- Writing %s image...successful.") % session.burn_type
+            << std::endl;
 
     image.close();
 }
 
 static void n200_verify_image(n200_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     n200_fw_update_data_t pkt_out;
     const n200_fw_update_data_t* pkt_in =
@@ -521,40 +529,40 @@ static void n200_verify_image(n200_session_t& session)
         len =
             n200_send_and_recv(session.xport, READ_FLASH_CMD, &pkt_out, session.data_in);
         if (n200_response_matches(pkt_in, READ_FLASH_ACK, len)) {
-            std::cout << boost::format("\r-- Verifying %s image (%d%%)")
-                             % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::flush;
+            console << boost::format("\r-- Verifying %s image (%d%%)")
+                           % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::flush;
 
             if (memcmp(image_part, pkt_in->data.flash_args.data, cmp_len)) {
-                std::cout << boost::format("\r-- Verifying %s image...failed at %d%%.")
-                                 % session.burn_type
-                                 % int((double(current_addr - session.flash_addr)
-                                           / double(session.size))
-                                       * 100)
-                          << std::endl;
+                console << boost::format("\r-- Verifying %s image...failed at %d%%.")
+                               % session.burn_type
+                               % int((double(current_addr - session.flash_addr)
+                                         / double(session.size))
+                                     * 100)
+                        << std::endl;
                 throw uhd::runtime_error(
                     str(boost::format("Failed to verify %s image.") % session.burn_type));
             }
         } else if (len < offsetof(n200_fw_update_data_t, data)) {
             image.close();
-            std::cout << boost::format("\r-- Verifying %s image...failed at %d%%.")
-                             % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::endl;
+            console << boost::format("\r-- Verifying %s image...failed at %d%%.")
+                           % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::endl;
             throw uhd::runtime_error("Timed out waiting for reply from device.");
         } else if (ntohl(pkt_in->id) != READ_FLASH_ACK) {
             image.close();
-            std::cout << boost::format("\r-- Verifying %s image...failed at %d%%.")
-                             % session.burn_type
-                             % int((double(current_addr - session.flash_addr)
-                                       / double(session.size))
-                                   * 100)
-                      << std::endl;
+            console << boost::format("\r-- Verifying %s image...failed at %d%%.")
+                           % session.burn_type
+                           % int((double(current_addr - session.flash_addr)
+                                     / double(session.size))
+                                 * 100)
+                    << std::endl;
             throw uhd::runtime_error(
                 str(boost::format("Received invalid reply %d from device.\n")
                     % ntohl(pkt_in->id)));
@@ -562,26 +570,28 @@ static void n200_verify_image(n200_session_t& session)
 
         current_addr += N200_FLASH_DATA_PACKET_SIZE;
     }
-    std::cout << boost::format("\r-- Verifying %s image...successful.")
-                     % session.burn_type
-              << std::endl;
+    console << boost::format("\r-- Verifying %s image...successful.")
+                   % session.burn_type
+            << std::endl;
 
     image.close();
 }
 
 static void n200_reset(n200_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     n200_fw_update_data_t pkt_out;
 
     // There should be no response
-    std::cout << "-- Resetting device..." << std::flush;
+    console << "-- Resetting device..." << std::flush;
     size_t len = n200_send_and_recv(session.xport, RESET_CMD, &pkt_out, session.data_in);
     if (len > 0) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Failed to reset N200.");
     }
-    std::cout << "successful." << std::endl;
+    console << "successful." << std::endl;
 }
 
 // n210_r4 -> N210 r4
@@ -611,16 +621,18 @@ static bool n200_image_loader(const image_loader::image_loader_args_t& image_loa
     if (session.dev_addr.size() == 0) {
         return false;
     }
+    session.message = image_loader_args.message;
+    image_loader_console console(session.message);
 
-    std::cout << boost::format("Unit: USRP %s (%s, %s)")
-                     % nice_name(session.dev_addr.get("hw_rev"))
-                     % session.dev_addr.get("serial") % session.dev_addr.get("addr")
-              << std::endl;
+    console << boost::format("Unit: USRP %s (%s, %s)")
+                   % nice_name(session.dev_addr.get("hw_rev"))
+                   % session.dev_addr.get("serial") % session.dev_addr.get("addr")
+            << std::endl;
 
     if (image_loader_args.load_firmware) {
         n200_setup_session(session, image_loader_args, true);
 
-        std::cout << "Firmware image: " << session.filepath << std::endl;
+        console << "Firmware image: " << session.filepath << std::endl;
 
         n200_erase_image(session);
         n200_write_image(session);
@@ -632,7 +644,7 @@ static bool n200_image_loader(const image_loader::image_loader_args_t& image_loa
     if (image_loader_args.load_fpga) {
         n200_setup_session(session, image_loader_args, false);
 
-        std::cout << "FPGA image: " << session.filepath << std::endl;
+        console << "FPGA image: " << session.filepath << std::endl;
 
         n200_erase_image(session);
         n200_write_image(session);
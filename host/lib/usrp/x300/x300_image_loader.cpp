@@ -18,10 +18,14 @@
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhdlib/usrp/common/image_loader_console.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -29,6 +33,7 @@ namespace fs = boost::filesystem;
 
 using namespace boost::algorithm;
 using namespace uhd;
+using namespace uhd::usrp;
 using namespace uhd::transport;
 
 /*
@@ -101,6 +106,8 @@ typedef struct
     size_t size;
     uint8_t data_in[udp_simple::mtu];
     std::vector<char> bitstream; // .bin image extracted from .lvbitx file
+    image_loader::progress_fcn_t progress; // Replaces the progress output, if set
+    image_loader::message_fcn_t message; // Replaces the console output, if set
 } x300_session_t;
 
 /*
@@ -291,6 +298,8 @@ static UHD_INLINE void x300_bitswap(uint8_t* num)
 
 static void x300_ethernet_load(x300_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     x300_fpga_update_data_t pkt_out;
     const x300_fpga_update_data_t* pkt_in =
@@ -301,34 +310,56 @@ static void x300_ethernet_load(x300_session_t& session)
     size_t len =
         x300_send_and_recv(session.write_xport, flags, &pkt_out, session.data_in);
     if (x300_recv_ok(pkt_in, len)) {
-        std::cout << "-- Initializing FPGA loading..." << std::flush;
+        console << "-- Initializing FPGA loading..." << std::flush;
     } else if (len == 0) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Timed out waiting for reply from device.");
     } else {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Device reported an error during initialization.");
     }
 
-    std::cout << "successful." << std::endl;
+    console << "successful." << std::endl;
     if (session.verify) {
-        std::cout << "-- NOTE: Device is verifying the image it is receiving, increasing "
-                     "the loading time."
-                  << std::endl;
+        console << "-- NOTE: Device is verifying the image it is receiving, increasing "
+                   "the loading time."
+                << std::endl;
     }
 
-    size_t current_pos = 0;
-    size_t sectors     = (session.size / X300_FLASH_SECTOR_SIZE);
-    std::ifstream image(session.filepath.c_str(), std::ios::binary);
+    size_t sectors = (session.size / X300_FLASH_SECTOR_SIZE);
+
+    // Packets are filled straight from the mapped file, so the image is paged
+    // in as it is sent rather than read up front
+    namespace ip = boost::interprocess;
+    ip::mapped_region region;
+    const uint8_t* image;
+    if (session.lvbitx) {
+        image = reinterpret_cast<const uint8_t*>(session.bitstream.data());
+    } else {
+        try {
+            ip::file_mapping file(session.filepath.c_str(), ip::read_only);
+            ip::mapped_region(file, ip::read_only, 0, session.size).swap(region);
+        } catch (const ip::interprocess_exception& ex) {
+            throw uhd::io_error(
+                "Could not map " + session.filepath + ": " + std::string(ex.what()));
+        }
+        region.advise(ip::mapped_region::advice_sequential);
+        image = static_cast<const uint8_t*>(region.get_address());
+    }
 
     // Each sector
     for (size_t i = 0; i < session.size; i += X300_FLASH_SECTOR_SIZE) {
         // Print progress percentage at beginning of each sector
-        std::cout << boost::format("\r-- Loading %s FPGA image: %d%% (%d/%d sectors)")
-                         % session.fpga_type
-                         % (int(double(i) / double(session.size) * 100.0))
-                         % (i / X300_FLASH_SECTOR_SIZE) % sectors
-                  << std::flush;
+        if (session.progress) {
+            session.progress(double(i) / double(session.size));
+        } else {
+            console << boost::format(
+                           "\r-- Loading %s FPGA image: %d%% (%d/%d sectors)")
+                           % session.fpga_type
+                           % (int(double(i) / double(session.size) * 100.0))
+                           % (i / X300_FLASH_SECTOR_SIZE) % sectors
+                    << std::flush;
+        }
 
         // Each packet
         for (size_t j = i; (j < session.size and j < (i + X300_FLASH_SECTOR_SIZE));
@@ -346,15 +377,10 @@ static void x300_ethernet_load(x300_session_t& session)
             pkt_out.size  = htonx<uint32_t>(X300_PACKET_SIZE_BYTES / 2);
 
             // Read next piece of image
+            const size_t num_bytes =
+                std::min<size_t>(X300_PACKET_SIZE_BYTES, session.size - j);
             memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
-            if (session.lvbitx) {
-                memcpy(pkt_out.data8,
-                    &session.bitstream[current_pos],
-                    X300_PACKET_SIZE_BYTES);
-                current_pos += X300_PACKET_SIZE_BYTES;
-            } else {
-                image.read((char*)pkt_out.data8, X300_PACKET_SIZE_BYTES);
-            }
+            memcpy(pkt_out.data8, image + j, num_bytes);
 
             // Data must be bitswapped and byteswapped
             for (size_t k = 0; k < X300_PACKET_SIZE_BYTES; k++) {
@@ -367,62 +393,59 @@ static void x300_ethernet_load(x300_session_t& session)
             len =
                 x300_send_and_recv(session.write_xport, flags, &pkt_out, session.data_in);
             if (len == 0) {
-                if (!session.lvbitx)
-                    image.close();
                 throw uhd::runtime_error("Timed out waiting for reply from device.");
             } else if ((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)) {
-                if (!session.lvbitx)
-                    image.close();
                 throw uhd::runtime_error("Device reported an error.");
             }
         }
     }
-    if (!session.lvbitx) {
-        image.close();
-    }
 
-    std::cout << boost::format("\r-- Loading %s FPGA image: 100%% (%d/%d sectors)")
-                     % session.fpga_type % sectors % sectors
-              << std::endl;
+    if (session.progress) {
+        session.progress(1.0);
+    } else {
+        console << boost::format("\r-- Loading %s FPGA image: 100%% (%d/%d sectors)")
+                       % session.fpga_type % sectors % sectors
+                << std::endl;
+    }
 
     // Cleanup
-    if (!session.lvbitx)
-        image.close();
     flags          = (X300_FPGA_PROG_FLAGS_CLEANUP | X300_FPGA_PROG_FLAGS_ACK);
     pkt_out.sector = pkt_out.index = pkt_out.size = 0;
     memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
-    std::cout << "-- Finalizing image load..." << std::flush;
+    console << "-- Finalizing image load..." << std::flush;
     len = x300_send_and_recv(session.write_xport, flags, &pkt_out, session.data_in);
     if (len == 0) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Timed out waiting for reply from device.");
     } else if ((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Device reported an error during cleanup.");
     } else
-        std::cout << "successful." << std::endl;
+        console << "successful." << std::endl;
 
     // Save new FPGA image (if option set)
     if (session.configure) {
         flags = (X300_FPGA_PROG_CONFIGURE | X300_FPGA_PROG_FLAGS_ACK);
         x300_send_and_recv(session.write_xport, flags, &pkt_out, session.data_in);
-        std::cout << "-- Saving image onto device..." << std::flush;
+        console << "-- Saving image onto device..." << std::flush;
         if (len == 0) {
-            std::cout << "failed." << std::endl;
+            console << "failed." << std::endl;
             throw uhd::runtime_error("Timed out waiting for reply from device.");
         } else if ((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)) {
-            std::cout << "failed." << std::endl;
+            console << "failed." << std::endl;
             throw uhd::runtime_error("Device reported an error while saving the image.");
         } else
-            std::cout << "successful." << std::endl;
+            console << "successful." << std::endl;
     }
-    std::cout << str(boost::format("Power-cycle the USRP %s to use the new image.")
-                     % session.dev_addr.get("product", ""))
-              << std::endl;
+    console << str(boost::format("Power-cycle the USRP %s to use the new image.")
+                   % session.dev_addr.get("product", ""))
+            << std::endl;
 }
 
 static void x300_ethernet_read(x300_session_t& session)
 {
+    image_loader_console console(session.message);
+
     // UDP receive buffer
     x300_fpga_update_data_t pkt_out;
     memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
@@ -434,16 +457,16 @@ static void x300_ethernet_read(x300_session_t& session)
     uint32_t flags = X300_FPGA_READ_FLAGS_ACK | X300_FPGA_READ_FLAGS_INIT;
     size_t len = x300_send_and_recv(session.read_xport, flags, &pkt_out, session.data_in);
     if (x300_recv_ok(pkt_in, len)) {
-        std::cout << "-- Initializing FPGA reading..." << std::flush;
+        console << "-- Initializing FPGA reading..." << std::flush;
     } else if (len == 0) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Timed out waiting for reply from device.");
     } else {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Device reported an error during initialization.");
     }
 
-    std::cout << "successful." << std::endl;
+    console << "successful." << std::endl;
 
     // Read the first packet
     // Acknowledge receipt of the FPGA image data
@@ -479,9 +502,8 @@ static void x300_ethernet_read(x300_session_t& session)
     // The .bit file format includes header information not part of a .bin
     for (size_t i = 0; i < sizeof(X300_FPGA_BIT_HEADER); i++) {
         if (pkt_in->data8[i] != X300_FPGA_BIT_HEADER[i]) {
-            std::cout
-                << "-- No *.bit header detected, FPGA image is a raw stream (*.bin)!"
-                << std::endl;
+            console << "-- No *.bit header detected, FPGA image is a raw stream (*.bin)!"
+                    << std::endl;
             image_size = X300_FPGA_BIN_SIZE_BYTES;
             sectors    = (image_size / X300_FLASH_SECTOR_SIZE);
             extension  = std::string(".bin");
@@ -491,7 +513,7 @@ static void x300_ethernet_read(x300_session_t& session)
 
     session.outpath += extension;
     std::ofstream image(session.outpath.c_str(), std::ios::binary);
-    std::cout << boost::format("-- Output FPGA file: %s\n") % session.outpath;
+    console << boost::format("-- Output FPGA file: %s\n") % session.outpath;
 
     // Write the first packet
     image.write((char*)pkt_in->data8, X300_PACKET_SIZE_BYTES);
@@ -500,11 +522,11 @@ static void x300_ethernet_read(x300_session_t& session)
     size_t pkt_count = X300_PACKET_SIZE_BYTES;
     for (size_t i = 0; i < image_size; i += X300_FLASH_SECTOR_SIZE) {
         // Once we determine the image size, print the progress percentage
-        std::cout << boost::format("\r-- Reading %s FPGA image: %d%% (%d/%d sectors)")
-                         % session.fpga_type
-                         % (int(double(i) / double(image_size) * 100.0))
-                         % (i / X300_FLASH_SECTOR_SIZE) % sectors
-                  << std::flush;
+        console << boost::format("\r-- Reading %s FPGA image: %d%% (%d/%d sectors)")
+                       % session.fpga_type
+                       % (int(double(i) / double(image_size) * 100.0))
+                       % (i / X300_FLASH_SECTOR_SIZE) % sectors
+                << std::flush;
 
         // Each packet
         while (pkt_count < image_size and pkt_count < (i + X300_FLASH_SECTOR_SIZE)) {
@@ -549,33 +571,34 @@ static void x300_ethernet_read(x300_session_t& session)
         pkt_count = i + X300_FLASH_SECTOR_SIZE;
     }
 
-    std::cout << boost::format("\r-- Reading %s FPGA image: 100%% (%d/%d sectors)")
-                     % session.fpga_type % sectors % sectors
-              << std::endl;
+    console << boost::format("\r-- Reading %s FPGA image: 100%% (%d/%d sectors)")
+                   % session.fpga_type % sectors % sectors
+            << std::endl;
 
     // Cleanup
     image.close();
     flags          = (X300_FPGA_READ_FLAGS_CLEANUP | X300_FPGA_READ_FLAGS_ACK);
     pkt_out.sector = pkt_out.index = pkt_out.size = 0;
     memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
-    std::cout << "-- Finalizing image read for verification..." << std::flush;
+    console << "-- Finalizing image read for verification..." << std::flush;
     len = x300_send_and_recv(session.read_xport, flags, &pkt_out, session.data_in);
     if (len == 0) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Timed out waiting for reply from device.");
     } else if ((ntohl(pkt_in->flags) & X300_FPGA_READ_FLAGS_ERROR)) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         throw uhd::runtime_error("Device reported an error during cleanup.");
     } else
-        std::cout << "successful image read." << std::endl;
+        console << "successful image read." << std::endl;
 }
 
 static void x300_pcie_load(x300_session_t& session)
 {
-    std::cout << boost::format(
-                     "\r-- Loading %s FPGA image (this will take 5-10 minutes)...")
-                     % session.fpga_type
-              << std::flush;
+    image_loader_console console(session.message);
+    console << boost::format(
+                   "\r-- Loading %s FPGA image (this will take 5-10 minutes)...")
+                   % session.fpga_type
+            << std::flush;
 
     nirio_status status = NiRio_Status_Success;
     niusrprio::niusrprio_session fpga_session(session.resource, session.rpc_port);
@@ -583,14 +606,17 @@ static void x300_pcie_load(x300_session_t& session)
         fpga_session.download_bitstream_to_flash(session.filepath), status);
 
     if (nirio_status_fatal(status)) {
-        std::cout << "failed." << std::endl;
+        console << "failed." << std::endl;
         niusrprio::nirio_status_to_exception(
             status, "NI-RIO reported the following error:");
     } else
-        std::cout << "successful." << std::endl;
-    std::cout << str(boost::format("Power-cycle the USRP %s to use the new image.")
-                     % session.dev_addr.get("product", ""))
-              << std::endl;
+        console << "successful." << std::endl;
+    if (session.progress) {
+        session.progress(1.0);
+    }
+    console << str(boost::format("Power-cycle the USRP %s to use the new image.")
+                   % session.dev_addr.get("product", ""))
+            << std::endl;
 }
 
 static bool x300_image_loader(const image_loader::image_loader_args_t& image_loader_args)
@@ -609,15 +635,18 @@ static bool x300_image_loader(const image_loader::image_loader_args_t& image_loa
 
     if (!session.found)
         return false;
+    session.progress = image_loader_args.progress;
+    session.message  = image_loader_args.message;
+    image_loader_console console(session.message);
 
-    std::cout << boost::format("Unit: USRP %s (%s, %s)\nFPGA Image: %s\n")
-                     % session.dev_addr["product"] % session.dev_addr["serial"]
-                     % session.dev_addr[session.ethernet ? "addr" : "resource"]
-                     % session.filepath;
+    console << boost::format("Unit: USRP %s (%s, %s)\nFPGA Image: %s\n")
+                   % session.dev_addr["product"] % session.dev_addr["serial"]
+                   % session.dev_addr[session.ethernet ? "addr" : "resource"]
+                   % session.filepath;
 
     // Download the FPGA image to a file
     if (image_loader_args.download) {
-        std::cout << "Attempting to download the FPGA image ..." << std::endl;
+        console << "Attempting to download the FPGA image ..." << std::endl;
         x300_ethernet_read(session);
     }
 
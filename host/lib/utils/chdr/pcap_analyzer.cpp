@@ -0,0 +1,614 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/chdr_types.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/chdr/pcap_analyzer.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+using namespace uhd;
+using namespace uhd::rfnoc::chdr;
+using namespace uhd::utils::chdr;
+
+namespace {
+
+constexpr size_t PCAP_GLOBAL_HDR_LEN = 24;
+constexpr size_t PCAP_RECORD_HDR_LEN = 16;
+
+constexpr uint32_t PCAP_MAGIC_USEC = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NSEC = 0xa1b23c4d;
+
+constexpr uint32_t LINKTYPE_ETHERNET  = 1;
+constexpr uint32_t LINKTYPE_RAW       = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+constexpr uint8_t IP_PROTO_UDP    = 17;
+constexpr size_t UDP_HDR_LEN      = 8;
+
+//! The format of a capture, as given by its global header
+struct pcap_format_t
+{
+    bool swapped;
+    double ts_frac_scale;
+    uint32_t link_type;
+};
+
+template <typename T>
+inline T read_raw(const uint8_t* ptr)
+{
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    return value;
+}
+
+inline uint16_t read_be16(const uint8_t* ptr)
+{
+    return uint16_t((ptr[0] << 8) | ptr[1]);
+}
+
+inline uint32_t read_pcap32(const uint8_t* ptr, const bool swapped)
+{
+    const uint32_t value = read_raw<uint32_t>(ptr);
+    return swapped ? uhd::byteswap(value) : value;
+}
+
+/*! Bookkeeping for one stream within a range of packets
+ *
+ * This is what every chunk fills in, and what the chunk results are merged
+ * into. The public statistics are derived from it at the end.
+ */
+struct stream_state_t
+{
+    uint64_t num_packets       = 0;
+    uint64_t num_bytes         = 0;
+    uint64_t num_payload_bytes = 0;
+    uint64_t num_eob           = 0;
+    double first_time          = 0.0;
+    double last_time           = 0.0;
+
+    bool has_seq              = false;
+    uint16_t first_seq        = 0;
+    uint16_t last_seq         = 0;
+    uint64_t num_seq_gaps     = 0;
+    uint64_t num_lost_packets = 0;
+
+    uint64_t num_timestamps     = 0;
+    uint64_t first_timestamp    = 0;
+    uint64_t last_timestamp     = 0;
+    double first_timestamp_time = 0.0;
+    double last_timestamp_time  = 0.0;
+
+    uint64_t num_strs           = 0;
+    uint64_t num_strs_errors    = 0;
+    double first_strs_time      = 0.0;
+    double last_strs_time       = 0.0;
+    uint64_t num_strs_intervals = 0;
+    double min_strs_interval    = std::numeric_limits<double>::max();
+    double max_strs_interval    = 0.0;
+    double sum_strs_interval    = 0.0;
+
+    void add_seq(const uint16_t seq)
+    {
+        if (not has_seq) {
+            first_seq = seq;
+            has_seq   = true;
+        } else if (seq != uint16_t(last_seq + 1)) {
+            num_seq_gaps++;
+            num_lost_packets += uint16_t(seq - last_seq - 1);
+        }
+        last_seq = seq;
+    }
+
+    void add_strs_interval(const double interval)
+    {
+        num_strs_intervals++;
+        min_strs_interval = std::min(min_strs_interval, interval);
+        max_strs_interval = std::max(max_strs_interval, interval);
+        sum_strs_interval += interval;
+    }
+
+    //! Append the state of the packets that followed the ones in this state
+    void merge(const stream_state_t& next)
+    {
+        if (next.num_packets == 0) {
+            return;
+        }
+        if (num_packets == 0) {
+            *this = next;
+            return;
+        }
+        if (next.has_seq) {
+            add_seq(next.first_seq);
+            num_seq_gaps += next.num_seq_gaps;
+            num_lost_packets += next.num_lost_packets;
+            last_seq = next.last_seq;
+        }
+
+        num_packets += next.num_packets;
+        num_bytes += next.num_bytes;
+        num_payload_bytes += next.num_payload_bytes;
+        num_eob += next.num_eob;
+        last_time = next.last_time;
+
+        if (next.num_timestamps > 0) {
+            if (num_timestamps == 0) {
+                first_timestamp      = next.first_timestamp;
+                first_timestamp_time = next.first_timestamp_time;
+            }
+            num_timestamps += next.num_timestamps;
+            last_timestamp      = next.last_timestamp;
+            last_timestamp_time = next.last_timestamp_time;
+        }
+
+        if (next.num_strs > 0) {
+            if (num_strs == 0) {
+                first_strs_time = next.first_strs_time;
+            } else {
+                add_strs_interval(next.first_strs_time - last_strs_time);
+            }
+            num_strs += next.num_strs;
+            num_strs_errors += next.num_strs_errors;
+            last_strs_time = next.last_strs_time;
+            num_strs_intervals += next.num_strs_intervals;
+            min_strs_interval = std::min(min_strs_interval, next.min_strs_interval);
+            max_strs_interval = std::max(max_strs_interval, next.max_strs_interval);
+            sum_strs_interval += next.sum_strs_interval;
+        }
+    }
+};
+
+//! Streams are identified by destination EPID and stream type
+inline uint32_t make_stream_key(const uint16_t dst_epid, const pcap_stream_type_t type)
+{
+    return (uint32_t(dst_epid) << 8) | uint32_t(type);
+}
+
+//! The result of decoding one chunk of the capture
+struct chunk_result_t
+{
+    uint64_t num_records      = 0;
+    uint64_t num_chdr_packets = 0;
+    uint64_t num_ignored      = 0;
+    uint64_t num_malformed    = 0;
+    double first_time         = 0.0;
+    double last_time          = 0.0;
+    std::unordered_map<uint32_t, stream_state_t> streams;
+};
+
+/*! Decodes records of a capture into a chunk_result_t
+ *
+ * The only allocations happen when a stream is seen for the first time within
+ * a chunk.
+ */
+class chunk_decoder
+{
+public:
+    chunk_decoder(const pcap_format_t& format, const pcap_analyzer_config_t& config)
+        : _format(format)
+        , _config(config)
+        , _chdr_w_bytes(uhd::rfnoc::chdr_w_to_bits(config.chdr_w) / 8)
+        , _big_endian(config.endianness == ENDIANNESS_BIG)
+    {
+        if (config.endianness == ENDIANNESS_BIG) {
+            _conv_byte_order = [](uint64_t x) { return uhd::ntohx<uint64_t>(x); };
+        } else {
+            _conv_byte_order = [](uint64_t x) { return uhd::wtohx<uint64_t>(x); };
+        }
+    }
+
+    void decode(const uint8_t* begin, const uint8_t* end, chunk_result_t& result)
+    {
+        const uint8_t* ptr = begin;
+        while (ptr < end) {
+            const uint32_t ts_sec   = read_pcap32(ptr, _format.swapped);
+            const uint32_t ts_frac  = read_pcap32(ptr + 4, _format.swapped);
+            const uint32_t incl_len = read_pcap32(ptr + 8, _format.swapped);
+            const double time       = ts_sec + ts_frac * _format.ts_frac_scale;
+            const uint8_t* record   = ptr + PCAP_RECORD_HDR_LEN;
+            ptr                     = record + incl_len;
+
+            if (result.num_records == 0) {
+                result.first_time = time;
+            }
+            result.last_time = time;
+            result.num_records++;
+            _decode_record(record, incl_len, time, result);
+        }
+    }
+
+private:
+    void _decode_record(const uint8_t* record,
+        const size_t len,
+        const double time,
+        chunk_result_t& result)
+    {
+        // Find the IPv4 header
+        size_t offset = 0;
+        if (_format.link_type == LINKTYPE_ETHERNET) {
+            offset = 12;
+            if (len >= offset + 2 && read_be16(record + offset) == ETHERTYPE_VLAN) {
+                offset += 4;
+            }
+            if (len < offset + 2 || read_be16(record + offset) != ETHERTYPE_IPV4) {
+                result.num_ignored++;
+                return;
+            }
+            offset += 2;
+        } else if (_format.link_type == LINKTYPE_LINUX_SLL) {
+            if (len < 16 || read_be16(record + 14) != ETHERTYPE_IPV4) {
+                result.num_ignored++;
+                return;
+            }
+            offset = 16;
+        }
+
+        // Find the UDP payload
+        if (len < offset + 20 || (record[offset] >> 4) != 4) {
+            result.num_ignored++;
+            return;
+        }
+        const size_t ip_hdr_len = (record[offset] & 0xf) * 4;
+        if (record[offset + 9] != IP_PROTO_UDP) {
+            result.num_ignored++;
+            return;
+        }
+        offset += ip_hdr_len;
+        if (len < offset + UDP_HDR_LEN) {
+            result.num_malformed++;
+            return;
+        }
+        if (_config.udp_port != 0 && read_be16(record + offset) != _config.udp_port
+            && read_be16(record + offset + 2) != _config.udp_port) {
+            result.num_ignored++;
+            return;
+        }
+        const size_t udp_len = read_be16(record + offset + 4);
+        offset += UDP_HDR_LEN;
+        if (udp_len < UDP_HDR_LEN + sizeof(uint64_t) || len < offset + sizeof(uint64_t)) {
+            result.num_malformed++;
+            return;
+        }
+
+        // The datagram may be truncated by the snapshot length. Everything
+        // but the header is therefore only decoded if it was captured.
+        const uint8_t* pkt     = record + offset;
+        const size_t pkt_len   = udp_len - UDP_HDR_LEN;
+        const size_t avail_len = std::min(pkt_len, len - offset);
+        const chdr_header header(_to_host(read_raw<uint64_t>(pkt)));
+        if (header.get_length() > pkt_len) {
+            result.num_malformed++;
+            return;
+        }
+        result.num_chdr_packets++;
+        _decode_chdr(header, pkt, avail_len, time, result);
+    }
+
+    void _decode_chdr(const chdr_header& header,
+        const uint8_t* pkt,
+        const size_t avail_len,
+        const double time,
+        chunk_result_t& result)
+    {
+        const packet_type_t pkt_type  = header.get_pkt_type();
+        const pcap_stream_type_t type = _get_stream_type(pkt_type);
+        stream_state_t& stream =
+            result.streams[make_stream_key(header.get_dst_epid(), type)];
+
+        if (stream.num_packets == 0) {
+            stream.first_time = time;
+        }
+        stream.last_time = time;
+        stream.num_packets++;
+        stream.num_bytes += header.get_length();
+
+        const bool has_ts = (pkt_type == PKT_TYPE_DATA_WITH_TS);
+        // With CHDR_W > 64, the timestamp shares the first line with the header
+        const size_t payload_offset =
+            _chdr_w_bytes * (1 + header.get_num_mdata())
+            + ((has_ts && _chdr_w_bytes == sizeof(uint64_t)) ? sizeof(uint64_t) : 0);
+        stream.num_payload_bytes += header.get_length() > payload_offset
+                                        ? header.get_length() - payload_offset
+                                        : 0;
+
+        switch (type) {
+            case PCAP_STREAM_DATA:
+                stream.add_seq(header.get_seq_num());
+                if (header.get_eob()) {
+                    stream.num_eob++;
+                }
+                if (has_ts && avail_len >= 2 * sizeof(uint64_t)) {
+                    const uint64_t timestamp =
+                        _to_host(read_raw<uint64_t>(pkt + sizeof(uint64_t)));
+                    if (stream.num_timestamps == 0) {
+                        stream.first_timestamp      = timestamp;
+                        stream.first_timestamp_time = time;
+                    }
+                    stream.num_timestamps++;
+                    stream.last_timestamp      = timestamp;
+                    stream.last_timestamp_time = time;
+                }
+                break;
+            case PCAP_STREAM_STRS:
+                _decode_strs(pkt, avail_len, payload_offset, time, stream);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void _decode_strs(const uint8_t* pkt,
+        const size_t avail_len,
+        const size_t payload_offset,
+        const double time,
+        stream_state_t& stream)
+    {
+        if (stream.num_strs == 0) {
+            stream.first_strs_time = time;
+        } else {
+            stream.add_strs_interval(time - stream.last_strs_time);
+        }
+        stream.num_strs++;
+        stream.last_strs_time = time;
+
+        if (avail_len >= payload_offset + sizeof(_strs_buff)) {
+            std::memcpy(_strs_buff, pkt + payload_offset, sizeof(_strs_buff));
+            _strs.deserialize(_strs_buff, STRS_LEN, _conv_byte_order);
+            if (_strs.status != STRS_OKAY) {
+                stream.num_strs_errors++;
+            }
+        }
+    }
+
+    inline uint64_t _to_host(const uint64_t word) const
+    {
+        return _big_endian ? uhd::ntohx<uint64_t>(word) : uhd::wtohx<uint64_t>(word);
+    }
+
+    static pcap_stream_type_t _get_stream_type(const packet_type_t pkt_type)
+    {
+        switch (pkt_type) {
+            case PKT_TYPE_MGMT:
+                return PCAP_STREAM_MGMT;
+            case PKT_TYPE_STRS:
+                return PCAP_STREAM_STRS;
+            case PKT_TYPE_STRC:
+                return PCAP_STREAM_STRC;
+            case PKT_TYPE_CTRL:
+                return PCAP_STREAM_CTRL;
+            default:
+                return PCAP_STREAM_DATA;
+        }
+    }
+
+    static constexpr size_t STRS_LEN = 4;
+
+    const pcap_format_t _format;
+    const pcap_analyzer_config_t _config;
+    const size_t _chdr_w_bytes;
+    const bool _big_endian;
+    //! Only used for the payload parsers of the CHDR library
+    std::function<uint64_t(uint64_t)> _conv_byte_order;
+    uint64_t _strs_buff[STRS_LEN];
+    strs_payload _strs;
+};
+
+constexpr size_t chunk_decoder::STRS_LEN;
+
+pcap_format_t parse_global_header(const uint8_t* data, const size_t num_bytes)
+{
+    if (num_bytes < PCAP_GLOBAL_HDR_LEN) {
+        throw uhd::value_error("Capture is too short to be a pcap file");
+    }
+    pcap_format_t format;
+    const uint32_t magic = read_raw<uint32_t>(data);
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+        format.swapped = false;
+    } else if (magic == uhd::byteswap(PCAP_MAGIC_USEC)
+               || magic == uhd::byteswap(PCAP_MAGIC_NSEC)) {
+        format.swapped = true;
+    } else {
+        throw uhd::value_error("Capture is not in pcap format (pcapng is not supported)");
+    }
+    format.ts_frac_scale =
+        (read_pcap32(data, format.swapped) == PCAP_MAGIC_NSEC) ? 1e-9 : 1e-6;
+    format.link_type = read_pcap32(data + 20, format.swapped);
+    if (format.link_type != LINKTYPE_ETHERNET && format.link_type != LINKTYPE_RAW
+        && format.link_type != LINKTYPE_LINUX_SLL) {
+        throw uhd::value_error(
+            "Unsupported pcap link type: " + std::to_string(format.link_type));
+    }
+    return format;
+}
+
+/*! Split the records of a capture into chunks of about chunk_size bytes
+ *
+ * This only reads the record headers. Returns the chunk boundaries, and the
+ * number of bytes at the end that don't form a complete record.
+ */
+std::vector<const uint8_t*> find_chunks(const uint8_t* begin,
+    const uint8_t* end,
+    const bool swapped,
+    const size_t chunk_size,
+    size_t& num_trailing)
+{
+    std::vector<const uint8_t*> chunks{begin};
+    const uint8_t* ptr = begin;
+    while (size_t(end - ptr) >= PCAP_RECORD_HDR_LEN) {
+        const uint32_t incl_len = read_pcap32(ptr + 8, swapped);
+        if (size_t(end - ptr) - PCAP_RECORD_HDR_LEN < incl_len) {
+            break;
+        }
+        ptr += PCAP_RECORD_HDR_LEN + incl_len;
+        if (size_t(ptr - chunks.back()) >= chunk_size) {
+            chunks.push_back(ptr);
+        }
+    }
+    if (chunks.back() != ptr) {
+        chunks.push_back(ptr);
+    }
+    num_trailing = end - ptr;
+    return chunks;
+}
+
+pcap_stream_stats_t make_stream_stats(
+    const uint32_t key, const stream_state_t& state, const double tick_rate)
+{
+    pcap_stream_stats_t stats;
+    stats.dst_epid          = uint16_t(key >> 8);
+    stats.type              = pcap_stream_type_t(key & 0xff);
+    stats.num_packets       = state.num_packets;
+    stats.num_bytes         = state.num_bytes;
+    stats.num_payload_bytes = state.num_payload_bytes;
+    stats.first_time        = state.first_time;
+    stats.last_time         = state.last_time;
+    const double duration   = state.last_time - state.first_time;
+    if (duration > 0.0) {
+        stats.throughput = state.num_bytes * 8 / duration;
+    }
+
+    if (stats.type == PCAP_STREAM_DATA) {
+        stats.num_seq_gaps     = state.num_seq_gaps;
+        stats.num_lost_packets = state.num_lost_packets;
+        stats.num_eob          = state.num_eob;
+    }
+
+    stats.num_timestamps  = state.num_timestamps;
+    stats.first_timestamp = state.first_timestamp;
+    stats.last_timestamp  = state.last_timestamp;
+    const double ts_duration = state.last_timestamp_time - state.first_timestamp_time;
+    if (state.num_timestamps > 1 && ts_duration > 0.0) {
+        const double num_ticks = double(state.last_timestamp - state.first_timestamp);
+        stats.tick_rate        = num_ticks / ts_duration;
+        if (tick_rate > 0.0) {
+            stats.drift_ppm = (num_ticks / tick_rate - ts_duration) / ts_duration * 1e6;
+        }
+    }
+
+    stats.num_strs_errors = state.num_strs_errors;
+    if (state.num_strs_intervals > 0) {
+        stats.min_strs_interval  = state.min_strs_interval;
+        stats.max_strs_interval  = state.max_strs_interval;
+        stats.mean_strs_interval = state.sum_strs_interval / state.num_strs_intervals;
+    }
+    return stats;
+}
+
+} // namespace
+
+pcap_stats_t uhd::utils::chdr::analyze_pcap(
+    const void* data, const size_t num_bytes, const pcap_analyzer_config_t& config)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    const uint8_t* begin  = static_cast<const uint8_t*>(data);
+    const pcap_format_t format = parse_global_header(begin, num_bytes);
+
+    size_t num_trailing = 0;
+    const std::vector<const uint8_t*> chunks =
+        find_chunks(begin + PCAP_GLOBAL_HDR_LEN,
+            begin + num_bytes,
+            format.swapped,
+            std::max<size_t>(config.chunk_size, 1),
+            num_trailing);
+    const size_t num_chunks = chunks.size() - 1;
+
+    // Every thread takes the next chunk that is not yet being decoded, until
+    // none are left
+    std::vector<chunk_result_t> results(num_chunks);
+    std::atomic<size_t> next_chunk{0};
+    auto decode_chunks = [&]() {
+        chunk_decoder decoder(format, config);
+        for (size_t i = next_chunk++; i < num_chunks; i = next_chunk++) {
+            decoder.decode(chunks[i], chunks[i + 1], results[i]);
+        }
+    };
+    size_t num_threads = config.num_threads;
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    num_threads = std::max<size_t>(std::min(num_threads, num_chunks), 1);
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < num_threads; i++) {
+        tasks.push_back(std::async(std::launch::async, decode_chunks));
+    }
+    decode_chunks();
+    for (auto& task : tasks) {
+        task.get();
+    }
+
+    // Merge the chunks in capture order
+    pcap_stats_t stats;
+    stats.num_bytes     = num_bytes;
+    stats.num_malformed = num_trailing > 0 ? 1 : 0;
+    std::unordered_map<uint32_t, stream_state_t> streams;
+    for (const chunk_result_t& result : results) {
+        if (result.num_records == 0) {
+            continue;
+        }
+        if (stats.num_records == 0) {
+            stats.first_time = result.first_time;
+        }
+        stats.last_time = result.last_time;
+        stats.num_records += result.num_records;
+        stats.num_chdr_packets += result.num_chdr_packets;
+        stats.num_ignored += result.num_ignored;
+        stats.num_malformed += result.num_malformed;
+        for (const auto& stream : result.streams) {
+            streams[stream.first].merge(stream.second);
+        }
+    }
+
+    std::vector<uint32_t> keys;
+    for (const auto& stream : streams) {
+        keys.push_back(stream.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    for (const uint32_t key : keys) {
+        stats.streams.push_back(
+            make_stream_stats(key, streams.at(key), config.tick_rate));
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    stats.decode_time = elapsed.count();
+    UHD_LOG_DEBUG("CHDR_PCAP",
+        "Decoded " << stats.num_chdr_packets << " CHDR packets in " << num_chunks
+                   << " chunks on " << num_threads << " threads");
+    return stats;
+}
+
+pcap_stats_t uhd::utils::chdr::analyze_pcap_file(
+    const std::string& filename, const pcap_analyzer_config_t& config)
+{
+    namespace ip = boost::interprocess;
+    try {
+        if (boost::filesystem::file_size(filename) == 0) {
+            throw uhd::value_error("Capture file is empty: " + filename);
+        }
+        ip::file_mapping file(filename.c_str(), ip::read_only);
+        ip::mapped_region region(file, ip::read_only);
+        region.advise(ip::mapped_region::advice_willneed);
+        return analyze_pcap(region.get_address(), region.get_size(), config);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        throw uhd::io_error("Could not open " + filename + ": " + ex.what());
+    } catch (const ip::interprocess_exception& ex) {
+        throw uhd::io_error("Could not map " + filename + ": " + ex.what());
+    }
+}
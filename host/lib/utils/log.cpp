@@ -220,8 +220,10 @@ public:
         }
 
         // Launch log message consumer
-        _pop_task =
-            std::make_shared<std::thread>(std::thread([this]() { this->pop_task(); }));
+        _pop_task = std::make_shared<std::thread>(std::thread([this]() {
+            set_affinity();
+            this->pop_task();
+        }));
         uhd::set_thread_name(_pop_task.get(), LOG_THREAD_NAME);
 
         // Fastpath message consumer
@@ -236,12 +238,16 @@ public:
         }();
 
         if (enable_fastpath) {
-            _pop_fastpath_task = std::make_shared<std::thread>(
-                std::thread([this]() { this->pop_fastpath_task(); }));
+            _pop_fastpath_task = std::make_shared<std::thread>(std::thread([this]() {
+                set_affinity();
+                this->pop_fastpath_task();
+            }));
             uhd::set_thread_name(_pop_fastpath_task.get(), LOG_THREAD_NAME_FP);
         } else {
-            _pop_fastpath_task = std::make_shared<std::thread>(
-                std::thread([this]() { this->pop_fastpath_dummy_task(); }));
+            _pop_fastpath_task = std::make_shared<std::thread>(std::thread([this]() {
+                set_affinity();
+                this->pop_fastpath_dummy_task();
+            }));
             uhd::set_thread_name(_pop_fastpath_task.get(), LOG_THREAD_NAME_FP_DUMMY);
             _publish_log_msg("Fastpath logging disabled at runtime.");
         }
@@ -316,6 +322,14 @@ public:
         }
     }
 
+    //! Pin a logging thread. These threads start before the application can
+    // call into UHD, so only the UHD_THREAD_AFFINITY environment variable
+    // affects them.
+    static void set_affinity()
+    {
+        uhd::set_thread_affinity(uhd::get_default_thread_affinity());
+    }
+
     void pop_task()
     {
         uhd::log::logging_info log_info;
@@ -0,0 +1,469 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/replay_utils.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <thread>
+
+namespace uhd { namespace rfnoc {
+
+namespace {
+
+constexpr char LOG_ID[] = "REPLAY_UTILS";
+
+//! Data is moved as sc16 on both sides of the streamer. The sc16 <-> sc16_chdr
+// converters are plain copies, so the bytes arrive in memory unchanged.
+const std::string REPLAY_CPU_FORMAT = "sc16";
+const std::string REPLAY_OTW_FORMAT = "sc16";
+constexpr size_t REPLAY_ITEM_SIZE   = 4;
+
+//! Timeout for a single send() or recv() call
+constexpr double STREAM_TIMEOUT = 1.0;
+//! Time the record fullness may stall before we give up
+constexpr auto RECORD_TIMEOUT = std::chrono::seconds(1);
+//! Time the record fullness must stay at zero for the input to count as flushed
+constexpr auto FLUSH_TIME = std::chrono::milliseconds(250);
+//! Time stale data may keep arriving on an input before we give up flushing it
+constexpr auto FLUSH_TIMEOUT = std::chrono::seconds(2);
+
+//! A contiguous section of a transfer that's handled by a single port
+struct replay_section_t
+{
+    size_t port;
+    uint64_t mem_offset;
+    size_t buff_offset;
+    //! Number of bytes of user data in this section
+    size_t num_bytes;
+    //! Number of bytes this section occupies in memory (word aligned)
+    uint64_t mem_size;
+};
+
+uint64_t align_up(const uint64_t value, const uint64_t align)
+{
+    return ((value + align - 1) / align) * align;
+}
+
+/*! Split a transfer into word-aligned sections, one per port
+ *
+ * All sections but the last one are a multiple of the word size. The last
+ * section also holds the trailing bytes that don't fill a whole word.
+ */
+std::vector<replay_section_t> plan_sections(replay_block_control::sptr replay,
+    const size_t num_bytes,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports)
+{
+    const uint64_t word_size = replay->get_word_size();
+    const uint64_t mem_size  = align_up(num_bytes, word_size);
+    if (mem_offset % word_size) {
+        throw uhd::value_error(
+            "Replay memory offset must be a multiple of the memory word size ("
+            + std::to_string(word_size) + " bytes)");
+    }
+    if (mem_offset + mem_size > replay->get_mem_size()) {
+        throw uhd::value_error("Replay transfer of " + std::to_string(mem_size)
+                               + " bytes at offset " + std::to_string(mem_offset)
+                               + " exceeds memory size of "
+                               + std::to_string(replay->get_mem_size()) + " bytes");
+    }
+
+    if (num_bytes == 0) {
+        return {};
+    }
+
+    const uint64_t num_words = mem_size / word_size;
+    const size_t num_sections =
+        static_cast<size_t>(std::min<uint64_t>(ports.size(), num_words));
+    const uint64_t words_per_section = num_words / num_sections;
+    const uint64_t extra_words       = num_words % num_sections;
+
+    std::vector<replay_section_t> sections;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < num_sections; i++) {
+        const uint64_t words = words_per_section + (i < extra_words ? 1 : 0);
+        replay_section_t section;
+        section.port        = ports.at(i);
+        section.mem_offset  = mem_offset + offset;
+        section.buff_offset = offset;
+        section.mem_size    = words * word_size;
+        section.num_bytes   = std::min<uint64_t>(section.mem_size, num_bytes - offset);
+        sections.push_back(section);
+        offset += section.mem_size;
+    }
+    return sections;
+}
+
+std::vector<size_t> get_ports(const std::vector<size_t>& ports, const size_t num_ports)
+{
+    if (!ports.empty()) {
+        for (const size_t port : ports) {
+            if (port >= num_ports) {
+                throw uhd::value_error(
+                    "Invalid Replay block port: " + std::to_string(port));
+            }
+        }
+        return ports;
+    }
+    std::vector<size_t> all_ports(num_ports);
+    std::iota(all_ports.begin(), all_ports.end(), 0);
+    return all_ports;
+}
+
+uhd::stream_args_t make_stream_args(
+    replay_block_control::sptr replay, const uhd::device_addr_t& args)
+{
+    uhd::stream_args_t stream_args(REPLAY_CPU_FORMAT, REPLAY_OTW_FORMAT);
+    stream_args.args             = args;
+    stream_args.args["block_id"] = replay->get_block_id().to_string();
+    stream_args.channels         = {0};
+    return stream_args;
+}
+
+/*! Empty the record buffer of a port
+ *
+ * Restart recording until no stale data shows up on the input anymore.
+ *
+ * \throws uhd::io_error if data keeps arriving for longer than FLUSH_TIMEOUT
+ */
+void flush_record_buffer(replay_block_control::sptr replay, const size_t port)
+{
+    const auto deadline = std::chrono::steady_clock::now() + FLUSH_TIMEOUT;
+    uint64_t fullness   = 0;
+    do {
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw uhd::io_error("Replay block port " + std::to_string(port)
+                                + " keeps receiving data, could not flush its "
+                                  "record buffer");
+        }
+        replay->record_restart(port);
+        const auto start_time = std::chrono::steady_clock::now();
+        do {
+            fullness = replay->get_record_fullness(port);
+        } while (fullness == 0
+                 && std::chrono::steady_clock::now() - start_time < FLUSH_TIME);
+    } while (fullness);
+}
+
+void upload_section(replay_block_control::sptr replay,
+    uhd::tx_streamer::sptr tx_stream,
+    const uint8_t* data,
+    const replay_section_t& section)
+{
+    replay->record(section.mem_offset, section.mem_size, section.port);
+    flush_record_buffer(replay, section.port);
+
+    // Everything up to the last partial word can be sent straight from the
+    // user buffer, the remainder goes out through a zero-padded word.
+    const size_t word_size  = replay->get_word_size();
+    const size_t main_bytes = (section.num_bytes / word_size) * word_size;
+    std::vector<uint8_t> tail;
+    if (main_bytes != section.num_bytes) {
+        tail.resize(word_size, 0);
+        std::memcpy(tail.data(), data + main_bytes, section.num_bytes - main_bytes);
+    }
+
+    uhd::tx_metadata_t md;
+    md.start_of_burst = true;
+    auto send_all = [&](const uint8_t* buff, const size_t num_bytes, const bool eob) {
+        const size_t num_items = num_bytes / REPLAY_ITEM_SIZE;
+        size_t items_sent      = 0;
+        while (items_sent < num_items) {
+            md.end_of_burst = eob;
+            const size_t sent =
+                tx_stream->send(buff + items_sent * REPLAY_ITEM_SIZE,
+                    num_items - items_sent,
+                    md,
+                    STREAM_TIMEOUT);
+            if (sent == 0) {
+                throw uhd::io_error("Timeout while uploading to Replay block port "
+                                    + std::to_string(section.port));
+            }
+            md.start_of_burst = false;
+            items_sent += sent;
+        }
+    };
+    send_all(data, main_bytes, tail.empty());
+    if (!tail.empty()) {
+        send_all(tail.data(), tail.size(), true);
+    }
+
+    // Wait for the data to be committed to memory
+    uint64_t fullness = replay->get_record_fullness(section.port);
+    auto last_change  = std::chrono::steady_clock::now();
+    while (fullness < section.mem_size) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        const uint64_t new_fullness = replay->get_record_fullness(section.port);
+        if (new_fullness != fullness) {
+            fullness    = new_fullness;
+            last_change = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - last_change > RECORD_TIMEOUT) {
+            throw uhd::io_error("Replay block port " + std::to_string(section.port)
+                                + " stopped recording at " + std::to_string(fullness)
+                                + " of " + std::to_string(section.mem_size)
+                                + " bytes");
+        }
+    }
+}
+
+void download_section(replay_block_control::sptr replay,
+    uhd::rx_streamer::sptr rx_stream,
+    uint8_t* data,
+    const replay_section_t& section)
+{
+    replay->play(section.mem_offset, section.mem_size, section.port);
+
+    // The last partial word (if any) lands in a scratch word, so we never
+    // write past the end of the user buffer.
+    const size_t word_size  = replay->get_word_size();
+    const size_t main_bytes = (section.num_bytes / word_size) * word_size;
+    std::vector<uint8_t> tail(main_bytes != section.num_bytes ? word_size : 0);
+
+    uhd::rx_metadata_t md;
+    auto recv_all = [&](uint8_t* buff, const size_t num_bytes) {
+        const size_t num_items = num_bytes / REPLAY_ITEM_SIZE;
+        size_t items_recvd     = 0;
+        while (items_recvd < num_items) {
+            items_recvd += rx_stream->recv(buff + items_recvd * REPLAY_ITEM_SIZE,
+                num_items - items_recvd,
+                md,
+                STREAM_TIMEOUT);
+            if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) {
+                throw uhd::io_error("Error while downloading from Replay block port "
+                                    + std::to_string(section.port) + ": "
+                                    + md.strerror());
+            }
+        }
+    };
+    recv_all(data, main_bytes);
+    if (!tail.empty()) {
+        recv_all(tail.data(), tail.size());
+        std::memcpy(data + main_bytes, tail.data(), section.num_bytes - main_bytes);
+    }
+}
+
+} // namespace
+
+
+uint64_t replay_upload(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports,
+    const uhd::device_addr_t& stream_args)
+{
+    const auto sections = plan_sections(replay,
+        num_bytes,
+        mem_offset,
+        get_ports(ports, replay->get_num_input_ports()));
+    const size_t items_per_word = replay->get_word_size() / REPLAY_ITEM_SIZE;
+
+    // Graph operations aren't thread-safe, so all streamers are created and
+    // connected up front.
+    std::vector<uhd::tx_streamer::sptr> tx_streams;
+    for (const auto& section : sections) {
+        uhd::stream_args_t args = make_stream_args(replay, stream_args);
+        args.args["block_port"] = std::to_string(section.port);
+        auto tx_stream          = graph->create_tx_streamer(1, args);
+        // Packets must be a multiple of the memory word size
+        const size_t spp = tx_stream->get_max_num_samps();
+        if (spp % items_per_word) {
+            tx_stream.reset();
+            args.args["spp"] = std::to_string(
+                std::max(items_per_word, (spp / items_per_word) * items_per_word));
+            tx_stream = graph->create_tx_streamer(1, args);
+        }
+        graph->connect(tx_stream, 0, replay->get_block_id(), section.port);
+        tx_streams.push_back(tx_stream);
+    }
+    graph->commit();
+
+    UHD_LOG_DEBUG(LOG_ID,
+        "Uploading " << num_bytes << " bytes to " << replay->get_block_id()
+                     << " at offset " << mem_offset << " using " << sections.size()
+                     << " port(s)");
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 0; i < sections.size(); i++) {
+        tasks.emplace_back(std::async(std::launch::async,
+            upload_section,
+            replay,
+            tx_streams[i],
+            static_cast<const uint8_t*>(data) + sections[i].buff_offset,
+            sections[i]));
+    }
+    // get() rethrows any exception from the workers, but we let all of them
+    // finish first so none of them outlives the streamers.
+    for (auto& task : tasks) {
+        task.wait();
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+
+    return align_up(num_bytes, replay->get_word_size());
+}
+
+uint64_t replay_upload_file(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const std::string& filename,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports,
+    const uhd::device_addr_t& stream_args)
+{
+    namespace ip = boost::interprocess;
+    try {
+        if (boost::filesystem::file_size(filename) == 0) {
+            return 0;
+        }
+        ip::file_mapping file(filename.c_str(), ip::read_only);
+        ip::mapped_region region(file, ip::read_only);
+        region.advise(ip::mapped_region::advice_sequential);
+        return replay_upload(graph,
+            replay,
+            region.get_address(),
+            region.get_size(),
+            mem_offset,
+            ports,
+            stream_args);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        throw uhd::io_error("Could not open " + filename + ": " + ex.what());
+    } catch (const ip::interprocess_exception& ex) {
+        throw uhd::io_error("Could not map " + filename + ": " + ex.what());
+    }
+}
+
+void replay_download(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports,
+    const uhd::device_addr_t& stream_args)
+{
+    const auto sections = plan_sections(replay,
+        num_bytes,
+        mem_offset,
+        get_ports(ports, replay->get_num_output_ports()));
+
+    std::vector<uhd::rx_streamer::sptr> rx_streams;
+    for (const auto& section : sections) {
+        uhd::stream_args_t args = make_stream_args(replay, stream_args);
+        args.args["block_port"] = std::to_string(section.port);
+        auto rx_stream          = graph->create_rx_streamer(1, args);
+        graph->connect(replay->get_block_id(), section.port, rx_stream, 0);
+        rx_streams.push_back(rx_stream);
+    }
+    graph->commit();
+
+    UHD_LOG_DEBUG(LOG_ID,
+        "Downloading " << num_bytes << " bytes from " << replay->get_block_id()
+                       << " at offset " << mem_offset << " using " << sections.size()
+                       << " port(s)");
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 0; i < sections.size(); i++) {
+        tasks.emplace_back(std::async(std::launch::async,
+            download_section,
+            replay,
+            rx_streams[i],
+            static_cast<uint8_t*>(data) + sections[i].buff_offset,
+            sections[i]));
+    }
+    for (auto& task : tasks) {
+        task.wait();
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+}
+
+void replay_download_file(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const std::string& filename,
+    const size_t num_bytes,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports,
+    const uhd::device_addr_t& stream_args)
+{
+    namespace ip = boost::interprocess;
+    try {
+        // Create or truncate the file, then grow it to its final size
+        std::filebuf().open(filename, std::ios::out | std::ios::trunc);
+        boost::filesystem::resize_file(filename, num_bytes);
+        if (num_bytes == 0) {
+            return;
+        }
+        ip::file_mapping file(filename.c_str(), ip::read_write);
+        ip::mapped_region region(file, ip::read_write);
+        replay_download(graph,
+            replay,
+            region.get_address(),
+            num_bytes,
+            mem_offset,
+            ports,
+            stream_args);
+        region.flush();
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        throw uhd::io_error("Could not create " + filename + ": " + ex.what());
+    } catch (const ip::interprocess_exception& ex) {
+        throw uhd::io_error("Could not map " + filename + ": " + ex.what());
+    }
+}
+
+uint64_t replay_checksum(const void* data, const size_t num_bytes)
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    constexpr uint64_t FNV_PRIME        = 0x100000001b3ULL;
+
+    const uint8_t* bytes   = static_cast<const uint8_t*>(data);
+    const size_t num_words = num_bytes / sizeof(uint64_t);
+    uint64_t hash          = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < num_words; i++) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(word));
+        hash = (hash ^ uhd::htowx(word)) * FNV_PRIME;
+    }
+    for (size_t i = num_words * sizeof(uint64_t); i < num_bytes; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+bool replay_verify_readback(rfnoc_graph::sptr graph,
+    replay_block_control::sptr replay,
+    const void* data,
+    const size_t num_bytes,
+    const uint64_t mem_offset,
+    const std::vector<size_t>& ports,
+    const uhd::device_addr_t& stream_args)
+{
+    std::vector<uint8_t> readback(num_bytes);
+    replay_download(
+        graph, replay, readback.data(), num_bytes, mem_offset, ports, stream_args);
+    const uint64_t expected = replay_checksum(data, num_bytes);
+    const uint64_t actual   = replay_checksum(readback.data(), num_bytes);
+    if (expected != actual) {
+        UHD_LOG_WARNING(LOG_ID,
+            "Checksum mismatch in " << replay->get_block_id() << " at offset "
+                                    << mem_offset << ": expected 0x" << std::hex
+                                    << expected << ", got 0x" << actual << std::dec);
+        return false;
+    }
+    return true;
+}
+
+}} // namespace uhd::rfnoc
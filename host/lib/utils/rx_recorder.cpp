@@ -0,0 +1,598 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/rx_recorder.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#ifndef UHD_PLATFORM_WIN32
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    include <cerrno>
+#endif
+
+using namespace uhd;
+
+namespace {
+
+constexpr char LOG_ID[] = "RX_RECORDER";
+
+//! Alignment of buffers, write sizes, and file offsets for direct I/O
+constexpr size_t IO_ALIGNMENT = 4096;
+
+size_t round_up(const size_t value, const size_t multiple)
+{
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+uint64_t to_ns(const std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+void update_max(std::atomic<uint64_t>& max, const uint64_t value)
+{
+    uint64_t prev = max.load(std::memory_order_relaxed);
+    while (prev < value
+           && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+/***********************************************************************
+ * Output file
+ **********************************************************************/
+#ifdef UHD_PLATFORM_WIN32
+//! Output file, without direct I/O support
+class recorder_file
+{
+public:
+    recorder_file(const std::string& path, const bool)
+        : _file(path, std::ofstream::binary | std::ofstream::trunc)
+    {
+        if (!_file.is_open()) {
+            throw uhd::io_error("rx_recorder: Unable to create " + path);
+        }
+    }
+
+    void write(const char* data, const size_t len, const size_t)
+    {
+        _file.write(data, len);
+        if (!_file) {
+            throw uhd::io_error("rx_recorder: Error writing to file");
+        }
+    }
+
+    void close(void)
+    {
+        _file.close();
+    }
+
+private:
+    std::ofstream _file;
+};
+
+#else
+//! Output file. With direct I/O, the page cache is bypassed. The size of every
+// write is then padded to the I/O alignment, and the file is truncated to its
+// real length on close().
+class recorder_file
+{
+public:
+    recorder_file(const std::string& path, const bool direct) : _path(path)
+    {
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#    ifdef O_DIRECT
+        if (direct) {
+            _fd     = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            _direct = (_fd >= 0);
+        }
+#    endif
+        if (_fd < 0) {
+            _fd = ::open(path.c_str(), flags, 0644);
+        }
+        if (_fd < 0) {
+            throw uhd::io_error(
+                str(boost::format("rx_recorder: Unable to create %s: %s") % path
+                    % std::strerror(errno)));
+        }
+#    ifdef F_NOCACHE
+        if (direct) {
+            ::fcntl(_fd, F_NOCACHE, 1);
+        }
+#    endif
+        if (direct && !_direct) {
+            UHD_LOG_DEBUG(LOG_ID, "Direct I/O not available for " << path);
+        }
+    }
+
+    ~recorder_file(void)
+    {
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+    }
+
+    void write(const char* data, const size_t len, const size_t padded_len)
+    {
+        size_t remaining = _direct ? padded_len : len;
+        while (remaining > 0) {
+            const ssize_t ret = ::write(_fd, data, remaining);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+#    ifdef O_DIRECT
+            // Some file systems accept O_DIRECT on open(), but not on write()
+            if (ret < 0 && errno == EINVAL && _direct && remaining == padded_len) {
+                UHD_LOG_DEBUG(LOG_ID, "Direct I/O rejected for " << _path);
+                ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT);
+                _direct   = false;
+                remaining = len;
+                continue;
+            }
+#    endif
+            if (ret < 0) {
+                throw uhd::io_error(
+                    str(boost::format("rx_recorder: Error writing to %s: %s") % _path
+                        % std::strerror(errno)));
+            }
+            data += ret;
+            remaining -= size_t(ret);
+        }
+        _size += len;
+    }
+
+    void close(void)
+    {
+        if (_fd < 0) {
+            return;
+        }
+        const int fd = _fd;
+        _fd          = -1;
+        if (_direct && ::ftruncate(fd, off_t(_size)) != 0) {
+            ::close(fd);
+            throw uhd::io_error(
+                str(boost::format("rx_recorder: Unable to truncate %s: %s") % _path
+                    % std::strerror(errno)));
+        }
+        ::close(fd);
+    }
+
+private:
+    const std::string _path;
+    int _fd        = -1;
+    bool _direct   = false;
+    uint64_t _size = 0;
+};
+#endif
+
+//! One buffer of the pool, holding the same span of samples for every channel
+struct buffer_slot
+{
+    std::vector<char*> buffs;
+    size_t num_samps = 0;
+    size_t stripe    = 0;
+};
+
+struct index_entry
+{
+    uint64_t sample;
+    time_spec_t time;
+    const char* event;
+};
+
+} // namespace
+
+/***********************************************************************
+ * Recorder implementation
+ **********************************************************************/
+class rx_recorder_impl : public rx_recorder
+{
+public:
+    rx_recorder_impl(rx_streamer::sptr rx_stream, const config_t& config)
+        : _rx_stream(rx_stream)
+        , _config(config)
+        , _num_chans(rx_stream->get_num_channels())
+        , _bytes_per_samp(convert::get_bytes_per_item(config.cpu_format))
+        , _buffer_size(round_up(config.buffer_size, _bytes_per_samp * IO_ALIGNMENT))
+        , _samps_per_buffer(_buffer_size / _bytes_per_samp)
+        , _free_slots(config.num_buffers)
+    {
+        if (_config.num_buffers < 2) {
+            throw uhd::value_error("rx_recorder: At least two buffers are required");
+        }
+        if (_config.buffer_size == 0) {
+            throw uhd::value_error("rx_recorder: Invalid buffer size");
+        }
+
+        // Carve all buffers out of one allocation
+        _memory.resize(_config.num_buffers * _num_chans * _buffer_size + IO_ALIGNMENT);
+        char* mem = reinterpret_cast<char*>(
+            round_up(reinterpret_cast<size_t>(_memory.data()), IO_ALIGNMENT));
+        _slots.resize(_config.num_buffers);
+        for (auto& slot : _slots) {
+            for (size_t chan = 0; chan < _num_chans; chan++) {
+                slot.buffs.push_back(mem);
+                mem += _buffer_size;
+            }
+            _free_slots.push_with_haste(&slot);
+        }
+
+        if (!_config.filename.empty()) {
+            _open_files();
+        }
+        UHD_LOG_DEBUG(LOG_ID,
+            "Recording " << _num_chans << " channel(s) using " << _config.num_buffers
+                         << " buffers of " << _buffer_size << " bytes per channel");
+    }
+
+    ~rx_recorder_impl(void)
+    {
+        UHD_SAFE_CALL(close();)
+    }
+
+    uint64_t record(const uint64_t num_samps, const double timeout)
+    {
+        if (_closed) {
+            throw uhd::runtime_error("rx_recorder: Recorder was already closed");
+        }
+        uint64_t num_recorded = 0;
+        std::vector<void*> buffs(_num_chans);
+        rx_metadata_t md;
+        while (!_stop && (num_samps == 0 || num_recorded < num_samps)) {
+            _check_write_error();
+            if (!_current) {
+                _current = _acquire_slot();
+                if (!_current) {
+                    break;
+                }
+            }
+
+            size_t samps_to_recv = _samps_per_buffer - _current->num_samps;
+            if (num_samps != 0 && num_samps - num_recorded < samps_to_recv) {
+                samps_to_recv = size_t(num_samps - num_recorded);
+            }
+            for (size_t chan = 0; chan < _num_chans; chan++) {
+                buffs[chan] =
+                    _current->buffs[chan] + _current->num_samps * _bytes_per_samp;
+            }
+
+            const size_t num_rx_samps = _rx_stream->recv(
+                buffs, samps_to_recv, md, timeout, _config.one_packet);
+
+            if (md.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                UHD_LOG_WARNING(LOG_ID, "Timeout while streaming");
+                break;
+            }
+            if (md.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW) {
+                _num_overflows++;
+                _gap_pending = true;
+                continue;
+            }
+            if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+                const std::string error = "rx_recorder: Receiver error: " + md.strerror();
+                if (!_config.continue_on_bad_packet) {
+                    throw uhd::io_error(error);
+                }
+                UHD_LOG_ERROR(LOG_ID, error);
+                continue;
+            }
+            if (num_rx_samps == 0) {
+                continue;
+            }
+
+            if (_config.one_packet) {
+                std::lock_guard<std::mutex> l(_stats_mutex);
+                _recv_sizes[num_rx_samps]++;
+            }
+            if (_config.write_index && md.has_time_spec) {
+                _update_index(md);
+            }
+
+            _current->num_samps += num_rx_samps;
+            _total_samps += num_rx_samps;
+            _num_samps.store(_total_samps, std::memory_order_relaxed);
+            num_recorded += num_rx_samps;
+            if (_current->num_samps == _samps_per_buffer) {
+                _submit(_current);
+                _current = nullptr;
+            }
+        }
+        return num_recorded;
+    }
+
+    void stop(void)
+    {
+        _stop = true;
+    }
+
+    void close(void)
+    {
+        if (_closed) {
+            return;
+        }
+        _closed = true;
+
+        if (_current && _current->num_samps > 0) {
+            _submit(_current);
+        }
+        _current = nullptr;
+        for (auto& queue : _write_queues) {
+            queue->push_with_wait(nullptr);
+        }
+        for (auto& writer : _writers) {
+            writer.join();
+        }
+        for (auto& stripe_files : _files) {
+            for (auto& file : stripe_files) {
+                file->close();
+            }
+        }
+        if (_config.write_index && !_config.filename.empty()) {
+            _write_index();
+        }
+        _check_write_error();
+    }
+
+    stats_t get_stats(void) const
+    {
+        stats_t stats;
+        stats.num_samps      = _num_samps.load(std::memory_order_relaxed);
+        stats.bytes_written  = _bytes_written.load(std::memory_order_relaxed);
+        stats.num_overflows  = _num_overflows.load(std::memory_order_relaxed);
+        stats.num_stalls     = _num_stalls.load(std::memory_order_relaxed);
+        stats.stall_time     = _stall_ns.load(std::memory_order_relaxed) / 1e9;
+        stats.num_queued     = _num_queued.load(std::memory_order_relaxed);
+        stats.max_queued     = _max_queued.load(std::memory_order_relaxed);
+        stats.max_write_time = _max_write_ns.load(std::memory_order_relaxed) / 1e9;
+        if (_config.one_packet) {
+            std::lock_guard<std::mutex> l(_stats_mutex);
+            stats.recv_sizes = _recv_sizes;
+        }
+        return stats;
+    }
+
+    std::vector<std::string> get_filenames(const size_t chan) const
+    {
+        if (chan >= _num_chans) {
+            throw uhd::index_error(
+                str(boost::format("rx_recorder: Invalid channel %d") % chan));
+        }
+        std::vector<std::string> filenames;
+        for (const auto& stripe_names : _filenames) {
+            filenames.push_back(stripe_names.at(chan));
+        }
+        return filenames;
+    }
+
+private:
+    void _open_files(void)
+    {
+        namespace fs = boost::filesystem;
+        const fs::path base(_config.filename);
+        const size_t num_stripes = std::max<size_t>(1, _config.stripe_dirs.size());
+
+        for (size_t stripe = 0; stripe < num_stripes; stripe++) {
+            const fs::path dir = _config.stripe_dirs.empty()
+                                     ? base.parent_path()
+                                     : fs::path(_config.stripe_dirs.at(stripe));
+            std::vector<std::string> stripe_names;
+            std::vector<std::unique_ptr<recorder_file>> stripe_files;
+            for (size_t chan = 0; chan < _num_chans; chan++) {
+                std::string name = base.stem().string();
+                if (_num_chans > 1) {
+                    name += "_ch" + std::to_string(chan);
+                }
+                if (num_stripes > 1) {
+                    name += "_s" + std::to_string(stripe);
+                }
+                name += base.extension().string();
+                stripe_names.push_back((dir / name).string());
+                stripe_files.emplace_back(
+                    new recorder_file(stripe_names.back(), _config.direct_io));
+            }
+            _filenames.push_back(stripe_names);
+            _files.push_back(std::move(stripe_files));
+            _write_queues.emplace_back(
+                new transport::bounded_buffer<buffer_slot*>(_config.num_buffers + 1));
+        }
+
+        for (size_t stripe = 0; stripe < num_stripes; stripe++) {
+            _writers.emplace_back([this, stripe]() { _writer_loop(stripe); });
+            set_thread_name(&_writers.back(), "rx_rec_wr" + std::to_string(stripe));
+        }
+    }
+
+    buffer_slot* _acquire_slot(void)
+    {
+        buffer_slot* slot = nullptr;
+        if (_free_slots.pop_with_haste(slot)) {
+            return slot;
+        }
+        // All buffers are waiting to be written: Storage can't keep up
+        _num_stalls++;
+        const auto start = std::chrono::steady_clock::now();
+        while (!_free_slots.pop_with_timed_wait(slot, 0.1)) {
+            _check_write_error();
+            if (_stop) {
+                break;
+            }
+        }
+        _stall_ns += to_ns(std::chrono::steady_clock::now() - start);
+        return slot;
+    }
+
+    void _submit(buffer_slot* slot)
+    {
+        if (_write_queues.empty()) {
+            slot->num_samps = 0;
+            _free_slots.push_with_haste(slot);
+            return;
+        }
+        slot->stripe = _next_stripe;
+        _next_stripe = (_next_stripe + 1) % _write_queues.size();
+        update_max(_max_queued, ++_num_queued);
+        _write_queues[slot->stripe]->push_with_wait(slot);
+    }
+
+    void _writer_loop(const size_t stripe)
+    {
+        auto& queue = *_write_queues[stripe];
+        auto& files = _files[stripe];
+        while (true) {
+            buffer_slot* slot = nullptr;
+            queue.pop_with_wait(slot);
+            if (!slot) {
+                return;
+            }
+            if (!_has_write_error) {
+                const size_t len        = slot->num_samps * _bytes_per_samp;
+                const size_t padded_len = round_up(len, IO_ALIGNMENT);
+                const auto start        = std::chrono::steady_clock::now();
+                try {
+                    for (size_t chan = 0; chan < _num_chans; chan++) {
+                        files[chan]->write(slot->buffs[chan], len, padded_len);
+                        _bytes_written += len;
+                    }
+                } catch (const std::exception& ex) {
+                    std::lock_guard<std::mutex> l(_error_mutex);
+                    _write_error     = ex.what();
+                    _has_write_error = true;
+                }
+                update_max(
+                    _max_write_ns, to_ns(std::chrono::steady_clock::now() - start));
+            }
+            slot->num_samps = 0;
+            _num_queued--;
+            _free_slots.push_with_haste(slot);
+        }
+    }
+
+    void _check_write_error(void)
+    {
+        if (_has_write_error) {
+            std::lock_guard<std::mutex> l(_error_mutex);
+            throw uhd::io_error(_write_error);
+        }
+    }
+
+    void _update_index(const rx_metadata_t& md)
+    {
+        const char* event = nullptr;
+        if (_index.empty()) {
+            event = "start";
+        } else if (_gap_pending) {
+            event = "overflow";
+        } else if (md.start_of_burst) {
+            event = "sob";
+        } else if (_current->num_samps == 0) {
+            event = "buffer";
+        }
+        _gap_pending = false;
+        if (event) {
+            _index.push_back({_total_samps, md.time_spec, event});
+        }
+    }
+
+    void _write_index(void)
+    {
+        const std::string path = _config.filename + ".idx";
+        std::ofstream index(path.c_str());
+        if (!index.is_open()) {
+            throw uhd::io_error("rx_recorder: Unable to create " + path);
+        }
+        index << "# uhd rx_recorder index" << std::endl;
+        index << "# cpu_format=" << _config.cpu_format << std::endl;
+        index << "# channels=" << _num_chans << std::endl;
+        index << "# stripes=" << _filenames.size() << std::endl;
+        index << "# stripe_size=" << _buffer_size << std::endl;
+        index << "# num_samps=" << _total_samps << std::endl;
+        index << "# overflows=" << _num_overflows << std::endl;
+        for (size_t chan = 0; chan < _num_chans; chan++) {
+            for (const auto& filename : get_filenames(chan)) {
+                index << "# file" << chan << "=" << filename << std::endl;
+            }
+        }
+        index << "# sample,full_secs,frac_secs,event" << std::endl;
+        for (const auto& entry : _index) {
+            index << boost::format("%u,%d,%.12f,%s\n") % entry.sample
+                         % entry.time.get_full_secs() % entry.time.get_frac_secs()
+                         % entry.event;
+        }
+        if (!index) {
+            throw uhd::io_error("rx_recorder: Error writing " + path);
+        }
+    }
+
+    rx_streamer::sptr _rx_stream;
+    const config_t _config;
+    const size_t _num_chans;
+    const size_t _bytes_per_samp;
+    const size_t _buffer_size;
+    const size_t _samps_per_buffer;
+
+    // Buffers
+    std::vector<char> _memory;
+    std::vector<buffer_slot> _slots;
+    transport::bounded_buffer<buffer_slot*> _free_slots;
+    buffer_slot* _current = nullptr;
+    size_t _next_stripe   = 0;
+
+    // Files and writers, indexed by stripe
+    std::vector<std::vector<std::string>> _filenames;
+    std::vector<std::vector<std::unique_ptr<recorder_file>>> _files;
+    std::vector<std::unique_ptr<transport::bounded_buffer<buffer_slot*>>> _write_queues;
+    std::vector<std::thread> _writers;
+
+    // State
+    std::atomic<bool> _stop{false};
+    bool _closed          = false;
+    uint64_t _total_samps = 0;
+    bool _gap_pending     = false;
+    std::vector<index_entry> _index;
+
+    // Errors from the writer threads
+    std::mutex _error_mutex;
+    std::string _write_error;
+    std::atomic<bool> _has_write_error{false};
+
+    // Statistics
+    std::atomic<uint64_t> _num_samps{0};
+    std::atomic<uint64_t> _bytes_written{0};
+    std::atomic<uint64_t> _num_overflows{0};
+    std::atomic<uint64_t> _num_stalls{0};
+    std::atomic<uint64_t> _stall_ns{0};
+    std::atomic<uint64_t> _num_queued{0};
+    std::atomic<uint64_t> _max_queued{0};
+    std::atomic<uint64_t> _max_write_ns{0};
+    mutable std::mutex _stats_mutex;
+    std::map<size_t, size_t> _recv_sizes;
+};
+
+/***********************************************************************
+ * Factory
+ **********************************************************************/
+rx_recorder::~rx_recorder(void)
+{
+    /* NOP */
+}
+
+rx_recorder::sptr rx_recorder::make(rx_streamer::sptr rx_stream, const config_t& config)
+{
+    return std::make_shared<rx_recorder_impl>(rx_stream, config);
+}
@@ -26,7 +26,11 @@ class task_impl : public task
 public:
     task_impl(const task_fcn_type& task_fcn, const std::string& name) : _exit(false)
     {
-        _task = std::thread([this, task_fcn]() { this->task_loop(task_fcn); });
+        const auto cpu_affinity_list = get_default_thread_affinity();
+        _task = std::thread([this, task_fcn, cpu_affinity_list]() {
+            set_thread_affinity(cpu_affinity_list);
+            this->task_loop(task_fcn);
+        });
         if (not name.empty()) {
             set_thread_name(&_task, name);
         }
@@ -86,8 +90,8 @@ class msg_task_impl : public msg_task
 public:
     msg_task_impl(const task_fcn_type& task_fcn) : _spawn_barrier(2)
     {
-        (void)_thread_group.create_thread(
-            std::bind(&msg_task_impl::task_loop, this, task_fcn));
+        (void)_thread_group.create_thread(std::bind(
+            &msg_task_impl::task_loop, this, task_fcn, get_default_thread_affinity()));
         _spawn_barrier.wait();
     }
 
@@ -119,8 +123,10 @@ public:
     }
 
 private:
-    void task_loop(const task_fcn_type& task_fcn)
+    void task_loop(
+        const task_fcn_type& task_fcn, const std::vector<size_t>& cpu_affinity_list)
     {
+        set_thread_affinity(cpu_affinity_list);
         _running = true;
         _spawn_barrier.wait();
 
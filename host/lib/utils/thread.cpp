@@ -8,6 +8,12 @@
 #include <uhd/exception.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/thread.hpp>
+#include <uhdlib/utils/thread_placement.hpp>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
 #include <vector>
 
 bool uhd::set_thread_priority_safe(float priority, bool realtime)
@@ -91,6 +97,23 @@ void uhd::set_thread_affinity(const std::vector<size_t>& cpu_affinity_list)
         UHD_LOG_WARNING("UHD", "Failed to set desired affinity for thread");
     }
 }
+
+std::vector<size_t> uhd::get_thread_affinity()
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0) {
+        return {};
+    }
+
+    std::vector<size_t> cpu_affinity_list;
+    for (size_t cpu_num = 0; cpu_num < CPU_SETSIZE; cpu_num++) {
+        if (CPU_ISSET(cpu_num, &cpu_set)) {
+            cpu_affinity_list.push_back(cpu_num);
+        }
+    }
+    return cpu_affinity_list;
+}
 #endif /* HAVE_PTHREAD_SETAFFINITYNP */
 
 /***********************************************************************
@@ -153,6 +176,12 @@ void uhd::set_thread_affinity(const std::vector<size_t>& cpu_affinity_list)
         UHD_LOG_WARNING("UHD", "Failed to set desired affinity for thread");
     }
 }
+
+std::vector<size_t> uhd::get_thread_affinity()
+{
+    // Windows can only return the affinity of a thread when changing it
+    return {};
+}
 #endif /* HAVE_WIN_SETTHREADAFFINITYMASK */
 
 /***********************************************************************
@@ -174,6 +203,11 @@ void uhd::set_thread_affinity(const std::vector<size_t>& cpu_affinity_list)
 {
     UHD_LOG_DEBUG("UHD", "Setting thread affinity is not implemented");
 }
+
+std::vector<size_t> uhd::get_thread_affinity()
+{
+    return {};
+}
 #endif /* HAVE_THREAD_SETAFFINITY_DUMMY */
 
 void uhd::set_thread_name(boost::thread* thrd, const std::string& name)
@@ -201,3 +235,171 @@ void uhd::set_thread_name(std::thread* thrd, const std::string& name)
     // thread names.
 #endif /* HAVE_THREAD_SETNAME_DUMMY */
 }
+
+/***********************************************************************
+ * CPU lists and NUMA nodes
+ **********************************************************************/
+std::vector<size_t> uhd::parse_cpu_list(const std::string& cpu_list)
+{
+    std::vector<size_t> cpus;
+    std::vector<std::string> items;
+    boost::split(items, cpu_list, boost::is_any_of(","));
+    for (auto& item : items) {
+        boost::trim(item);
+        if (item.empty()) {
+            continue;
+        }
+        const size_t dash = item.find('-');
+        try {
+            size_t pos         = 0;
+            const size_t first = std::stoul(item.substr(0, dash), &pos);
+            if (pos != item.substr(0, dash).size()) {
+                throw std::invalid_argument(item);
+            }
+            size_t last = first;
+            if (dash != std::string::npos) {
+                last = std::stoul(item.substr(dash + 1), &pos);
+                if (pos != item.size() - dash - 1 or last < first) {
+                    throw std::invalid_argument(item);
+                }
+            }
+            for (size_t cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw uhd::value_error("Invalid CPU list: " + cpu_list);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string uhd::format_cpu_list(const std::vector<size_t>& cpu_affinity_list)
+{
+    if (cpu_affinity_list.empty()) {
+        return "none";
+    }
+    std::string cpu_list;
+    auto it = cpu_affinity_list.begin();
+    while (it != cpu_affinity_list.end()) {
+        // Collapse consecutive CPUs into a range
+        auto last = it;
+        while (last + 1 != cpu_affinity_list.end() and *(last + 1) == *last + 1) {
+            last++;
+        }
+        if (not cpu_list.empty()) {
+            cpu_list += ",";
+        }
+        cpu_list += std::to_string(*it);
+        if (last != it) {
+            cpu_list += "-" + std::to_string(*last);
+        }
+        it = last + 1;
+    }
+    return cpu_list;
+}
+
+std::vector<size_t> uhd::get_numa_node_cpus(size_t numa_node)
+{
+    // Only Linux tells, through sysfs
+    std::ifstream cpulist_file(
+        "/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+    std::string cpu_list;
+    if (not std::getline(cpulist_file, cpu_list)) {
+        return {};
+    }
+    try {
+        return parse_cpu_list(cpu_list);
+    } catch (const uhd::value_error&) {
+        return {};
+    }
+}
+
+std::vector<size_t> uhd::read_cpu_placement(const uhd::device_addr_t& args)
+{
+    if (args.has_key("cpu_affinity")) {
+        const auto cpus = parse_cpu_list(args["cpu_affinity"]);
+        if (cpus.empty()) {
+            throw uhd::value_error("cpu_affinity must not be empty");
+        }
+        return cpus;
+    }
+    if (args.has_key("numa_node")) {
+        const size_t numa_node = args.cast<size_t>("numa_node", 0);
+        const auto cpus        = get_numa_node_cpus(numa_node);
+        if (cpus.empty()) {
+            UHD_LOG_WARNING("UHD",
+                "Cannot determine the CPUs of NUMA node "
+                    << numa_node << ", threads will not be pinned");
+        }
+        return cpus;
+    }
+    return {};
+}
+
+/***********************************************************************
+ * Default affinity of threads created by UHD
+ **********************************************************************/
+namespace {
+
+struct default_affinity_t
+{
+    default_affinity_t()
+    {
+        const char* affinity_env = std::getenv("UHD_THREAD_AFFINITY");
+        if (affinity_env != NULL && affinity_env[0] != '\0') {
+            try {
+                cpus = uhd::parse_cpu_list(affinity_env);
+            } catch (const uhd::value_error& ex) {
+                UHD_LOG_WARNING("UHD", "Ignoring UHD_THREAD_AFFINITY: " << ex.what());
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<size_t> cpus;
+};
+
+default_affinity_t& get_default_affinity()
+{
+    static default_affinity_t default_affinity;
+    return default_affinity;
+}
+
+// Innermost thread_affinity_scope of the current thread
+thread_local bool scope_active = false;
+thread_local std::vector<size_t> scope_cpus;
+
+} // namespace
+
+void uhd::set_default_thread_affinity(const std::vector<size_t>& cpu_affinity_list)
+{
+    auto& default_affinity = get_default_affinity();
+    std::lock_guard<std::mutex> l(default_affinity.mutex);
+    default_affinity.cpus = cpu_affinity_list;
+}
+
+std::vector<size_t> uhd::get_default_thread_affinity()
+{
+    if (scope_active) {
+        return scope_cpus;
+    }
+    auto& default_affinity = get_default_affinity();
+    std::lock_guard<std::mutex> l(default_affinity.mutex);
+    return default_affinity.cpus;
+}
+
+uhd::thread_affinity_scope::thread_affinity_scope(
+    const std::vector<size_t>& cpu_affinity_list)
+    : _prev_active(scope_active), _prev_cpus(scope_cpus)
+{
+    scope_active = true;
+    scope_cpus   = cpu_affinity_list;
+}
+
+uhd::thread_affinity_scope::~thread_affinity_scope()
+{
+    scope_active = _prev_active;
+    scope_cpus   = _prev_cpus;
+}
@@ -0,0 +1,477 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/thread.hpp>
+#include <uhd/utils/tx_file_source.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#ifndef UHD_PLATFORM_WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    include <cerrno>
+#endif
+
+using namespace uhd;
+
+namespace {
+
+constexpr char LOG_ID[] = "TX_FILE_SOURCE";
+
+//! Number of bytes per file the prefetch thread reads ahead at once
+constexpr size_t PREFETCH_CHUNK_SIZE = 1024 * 1024;
+
+/***********************************************************************
+ * Input file
+ **********************************************************************/
+#ifdef UHD_PLATFORM_WIN32
+//! Input file, read into memory
+class source_file
+{
+public:
+    source_file(const std::string& path)
+    {
+        std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+        if (!file.is_open()) {
+            throw uhd::io_error("tx_file_source: Unable to open " + path);
+        }
+        _data.resize(size_t(file.tellg()));
+        file.seekg(0);
+        file.read(_data.data(), _data.size());
+        if (!file) {
+            throw uhd::io_error("tx_file_source: Error reading " + path);
+        }
+    }
+
+    const char* data(void) const
+    {
+        return _data.data();
+    }
+
+    size_t size(void) const
+    {
+        return _data.size();
+    }
+
+    //! The whole file is in memory already
+    void prefetch(const size_t, const size_t) {}
+
+    void release(const size_t, const size_t) {}
+
+private:
+    std::vector<char> _data;
+};
+
+#else
+//! Memory-mapped input file
+class source_file
+{
+public:
+    source_file(const std::string& path) : _page_size(size_t(::sysconf(_SC_PAGESIZE)))
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw uhd::io_error(str(boost::format("tx_file_source: Unable to open %s: %s")
+                                    % path % std::strerror(errno)));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw uhd::io_error(str(boost::format("tx_file_source: Unable to stat %s: %s")
+                                    % path % std::strerror(errno)));
+        }
+        _size = size_t(st.st_size);
+        if (_size > 0) {
+            void* data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw uhd::io_error(
+                    str(boost::format("tx_file_source: Unable to map %s: %s") % path
+                        % std::strerror(errno)));
+            }
+            _data = static_cast<const char*>(data);
+            ::madvise(const_cast<char*>(_data), _size, MADV_SEQUENTIAL);
+        }
+        // The mapping stays valid without the file descriptor
+        ::close(fd);
+    }
+
+    ~source_file(void)
+    {
+        if (_data) {
+            ::munmap(const_cast<char*>(_data), _size);
+        }
+    }
+
+    const char* data(void) const
+    {
+        return _data;
+    }
+
+    size_t size(void) const
+    {
+        return _size;
+    }
+
+    //! Fault in the pages of a range of the file. Reading from every page
+    // maps it into the process, so the send thread doesn't even take a minor
+    // fault later on.
+    void prefetch(const size_t offset, const size_t len)
+    {
+        const size_t start = offset / _page_size * _page_size;
+        ::madvise(const_cast<char*>(_data + start), offset + len - start, MADV_WILLNEED);
+        volatile char sink = 0;
+        for (size_t pos = start; pos < offset + len; pos += _page_size) {
+            sink = _data[pos];
+        }
+        (void)sink;
+    }
+
+    //! Drop the pages of a range of the file from the process. They remain
+    // in the page cache as long as the kernel sees fit.
+    void release(const size_t offset, const size_t len)
+    {
+        // Only release whole pages, the ones at the edges may still be needed
+        const size_t start = (offset + _page_size - 1) / _page_size * _page_size;
+        const size_t end   = (offset + len) / _page_size * _page_size;
+        if (start < end) {
+            ::madvise(const_cast<char*>(_data + start), end - start, MADV_DONTNEED);
+        }
+    }
+
+private:
+    const size_t _page_size;
+    const char* _data = nullptr;
+    size_t _size      = 0;
+};
+#endif
+
+} // namespace
+
+/***********************************************************************
+ * Source implementation
+ **********************************************************************/
+class tx_file_source_impl : public tx_file_source
+{
+public:
+    tx_file_source_impl(tx_streamer::sptr tx_stream, const config_t& config)
+        : _tx_stream(tx_stream)
+        , _config(config)
+        , _num_chans(tx_stream->get_num_channels())
+        , _bytes_per_samp(convert::get_bytes_per_item(config.cpu_format))
+        , _samps_per_send(config.samps_per_send ? config.samps_per_send
+                                                : tx_stream->get_max_num_samps())
+    {
+        if (_config.filenames.size() != 1 && _config.filenames.size() != _num_chans) {
+            throw uhd::value_error(
+                str(boost::format("tx_file_source: Expected 1 or %d files, got %d")
+                    % _num_chans % _config.filenames.size()));
+        }
+        if (_samps_per_send == 0) {
+            throw uhd::value_error("tx_file_source: Invalid number of samples per send");
+        }
+
+        for (const auto& filename : _config.filenames) {
+            _files.emplace_back(new source_file(filename));
+            const uint64_t num_samps = _files.back()->size() / _bytes_per_samp;
+            if (_files.size() == 1) {
+                _num_samps = num_samps;
+            } else if (num_samps != _num_samps) {
+                throw uhd::value_error(
+                    "tx_file_source: Files must have the same number of samples");
+            }
+            if (_files.back()->size() % _bytes_per_samp != 0) {
+                UHD_LOG_WARNING(LOG_ID,
+                    "Ignoring the incomplete sample at the end of " << filename);
+            }
+        }
+        if (_num_samps == 0) {
+            throw uhd::value_error("tx_file_source: Files contain no samples");
+        }
+        for (size_t chan = 0; chan < _num_chans; chan++) {
+            _chan_data.push_back(_files.at(_files.size() == 1 ? 0 : chan)->data());
+        }
+
+        // Reading ahead more than the entire file is pointless
+        _prefetch_samps = std::min<uint64_t>(
+            std::max(_config.prefetch_size, PREFETCH_CHUNK_SIZE) / _bytes_per_samp,
+            _num_samps);
+        _chunk_samps = std::max<size_t>(1, PREFETCH_CHUNK_SIZE / _bytes_per_samp);
+        _release     = _num_samps > 2 * _prefetch_samps;
+
+        // Have the beginning ready before play() can be called
+        _prefetch_pos.store(_prefetch_chunk(0, _prefetch_samps));
+        _prefetch_thread = std::thread([this]() { _prefetch_loop(); });
+        set_thread_name(&_prefetch_thread, "tx_file_pf");
+        UHD_LOG_DEBUG(LOG_ID,
+            "Sending " << _num_samps << " samples on " << _num_chans
+                       << " channel(s), reading ahead "
+                       << _prefetch_samps * _bytes_per_samp << " bytes per file");
+    }
+
+    ~tx_file_source_impl(void)
+    {
+        {
+            std::lock_guard<std::mutex> l(_mutex);
+            _exit = true;
+        }
+        _cond.notify_one();
+        _prefetch_thread.join();
+    }
+
+    void set_start_time(const time_spec_t& time)
+    {
+        _start_time     = time;
+        _has_start_time = true;
+    }
+
+    uint64_t play(const uint64_t num_samps, const double timeout)
+    {
+        if (_stop) {
+            return 0;
+        }
+        tx_metadata_t md;
+        md.start_of_burst = true;
+        md.end_of_burst   = false;
+        md.has_time_spec  = _has_start_time;
+        md.time_spec      = _start_time;
+        _has_start_time   = false;
+
+        std::vector<const void*> buffs(_num_chans);
+        uint64_t num_sent = 0;
+        bool eob_sent     = false;
+        while (!_stop && (num_samps == 0 || num_sent < num_samps)) {
+            uint64_t file_pos = _send_pos % _num_samps;
+            if (_send_pos > 0 && file_pos == 0 && !_config.loop) {
+                break;
+            }
+            if (file_pos == 0 && _send_pos > 0 && _last_wrap != _send_pos) {
+                _last_wrap = _send_pos;
+                _num_loops++;
+            }
+
+            uint64_t samps_to_send =
+                std::min<uint64_t>(_samps_per_send, _num_samps - file_pos);
+            if (num_samps != 0) {
+                samps_to_send = std::min(samps_to_send, num_samps - num_sent);
+            }
+            md.end_of_burst =
+                (num_samps != 0 && num_sent + samps_to_send == num_samps)
+                || (!_config.loop && file_pos + samps_to_send == _num_samps);
+            for (size_t chan = 0; chan < _num_chans; chan++) {
+                buffs[chan] = _chan_data[chan] + file_pos * _bytes_per_samp;
+            }
+            if (_send_pos + samps_to_send > _prefetch_pos.load()) {
+                _num_prefetch_misses++;
+            }
+
+            const size_t samps_sent =
+                _tx_stream->send(buffs, size_t(samps_to_send), md, timeout);
+            _advance(samps_sent);
+            num_sent += samps_sent;
+            md.start_of_burst = false;
+            md.has_time_spec  = false;
+            if (samps_sent < samps_to_send) {
+                UHD_LOG_WARNING(LOG_ID,
+                    "Timeout while streaming, sent " << samps_sent << " of "
+                                                     << samps_to_send << " samples");
+                break;
+            }
+            eob_sent = md.end_of_burst;
+        }
+
+        // Stopped, or the last send() timed out: End the burst without samples
+        if (!eob_sent && num_sent > 0) {
+            md.end_of_burst = true;
+            _tx_stream->send(buffs, 0, md, timeout);
+        }
+        return num_sent;
+    }
+
+    void stop(void)
+    {
+        _stop = true;
+    }
+
+    void seek(const uint64_t samp)
+    {
+        if (samp >= _num_samps) {
+            throw uhd::index_error(
+                str(boost::format("tx_file_source: Cannot seek to sample %d of %d")
+                    % samp % _num_samps));
+        }
+        {
+            std::lock_guard<std::mutex> l(_mutex);
+            _send_pos = samp;
+            _prefetch_pos.store(samp);
+            _last_wrap = 0;
+            _seek_count++;
+        }
+        _cond.notify_one();
+    }
+
+    uint64_t get_num_samps(void) const
+    {
+        return _num_samps;
+    }
+
+    stats_t get_stats(void) const
+    {
+        stats_t stats;
+        stats.num_samps           = _num_sent.load(std::memory_order_relaxed);
+        stats.num_loops           = _num_loops.load(std::memory_order_relaxed);
+        stats.bytes_prefetched    = _bytes_prefetched.load(std::memory_order_relaxed);
+        stats.num_prefetch_misses = _num_prefetch_misses.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    //! Move the send cursor, and wake up the prefetch thread whenever a
+    // chunk was consumed
+    void _advance(const size_t samps_sent)
+    {
+        const uint64_t prev_pos = _send_pos;
+        _num_sent.fetch_add(samps_sent, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> l(_mutex);
+        _send_pos += samps_sent;
+        if (_send_pos / _chunk_samps != prev_pos / _chunk_samps) {
+            _cond.notify_one();
+        }
+    }
+
+    //! Run f(file_offset, len) on the byte ranges of the files that hold a
+    // range of samples, which may wrap around the end of the files
+    template <typename fn_type>
+    void _for_each_range(const uint64_t pos, const uint64_t num_samps, fn_type&& f)
+    {
+        uint64_t file_pos  = pos % _num_samps;
+        uint64_t remaining = num_samps;
+        while (remaining > 0) {
+            const uint64_t len = std::min(remaining, _num_samps - file_pos);
+            for (auto& file : _files) {
+                f(*file,
+                    size_t(file_pos * _bytes_per_samp),
+                    size_t(len * _bytes_per_samp));
+            }
+            remaining -= len;
+            file_pos = 0;
+        }
+    }
+
+    //! Read ahead a chunk at prefetch_pos, but not beyond end_pos, and
+    // return the new prefetch position
+    uint64_t _prefetch_chunk(const uint64_t prefetch_pos, const uint64_t end_pos)
+    {
+        const uint64_t len = std::min<uint64_t>(_chunk_samps, end_pos - prefetch_pos);
+        _for_each_range(
+            prefetch_pos, len, [](source_file& file, size_t offset, size_t len) {
+                file.prefetch(offset, len);
+            });
+        _bytes_prefetched += len * _bytes_per_samp * _files.size();
+        return prefetch_pos + len;
+    }
+
+    void _prefetch_loop(void)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        uint64_t release_pos = _send_pos;
+        while (!_exit) {
+            const uint64_t send_pos   = _send_pos;
+            const uint64_t seek_count = _seek_count;
+            // The send thread may have overtaken us, or seek() was called
+            uint64_t prefetch_pos = std::max(_prefetch_pos.load(), send_pos);
+            release_pos           = std::min(release_pos, send_pos);
+            uint64_t end_pos      = send_pos + _prefetch_samps;
+            if (!_config.loop) {
+                end_pos = std::min(end_pos, _num_samps);
+            }
+            const bool release = _release && send_pos >= release_pos + _chunk_samps;
+            if (prefetch_pos >= end_pos && !release) {
+                _cond.wait(lock);
+                continue;
+            }
+
+            lock.unlock();
+            if (prefetch_pos < end_pos) {
+                prefetch_pos = _prefetch_chunk(prefetch_pos, end_pos);
+            }
+            if (release) {
+                _for_each_range(release_pos,
+                    send_pos - release_pos,
+                    [](source_file& file, size_t offset, size_t len) {
+                        file.release(offset, len);
+                    });
+                release_pos = send_pos;
+            }
+            lock.lock();
+            if (_seek_count == seek_count) {
+                _prefetch_pos.store(prefetch_pos);
+            } else {
+                release_pos = _send_pos;
+            }
+        }
+    }
+
+    tx_streamer::sptr _tx_stream;
+    const config_t _config;
+    const size_t _num_chans;
+    const size_t _bytes_per_samp;
+    const size_t _samps_per_send;
+
+    // Files, and where the samples of each channel start
+    std::vector<std::unique_ptr<source_file>> _files;
+    std::vector<const char*> _chan_data;
+    uint64_t _num_samps = 0;
+
+    // Prefetch parameters, in samples
+    uint64_t _prefetch_samps = 0;
+    size_t _chunk_samps      = 0;
+    bool _release            = false;
+
+    // Playback state. Positions count samples since the last seek(), across
+    // loops.
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    uint64_t _send_pos = 0;
+    std::atomic<uint64_t> _prefetch_pos{0};
+    uint64_t _last_wrap  = 0;
+    uint64_t _seek_count = 0;
+    bool _has_start_time = false;
+    time_spec_t _start_time;
+    std::atomic<bool> _stop{false};
+    bool _exit = false;
+    std::thread _prefetch_thread;
+
+    // Statistics
+    std::atomic<uint64_t> _num_sent{0};
+    std::atomic<uint64_t> _num_loops{0};
+    std::atomic<uint64_t> _bytes_prefetched{0};
+    std::atomic<uint64_t> _num_prefetch_misses{0};
+};
+
+/***********************************************************************
+ * Factory
+ **********************************************************************/
+tx_file_source::~tx_file_source(void)
+{
+    /* NOP */
+}
+
+tx_file_source::sptr tx_file_source::make(
+    tx_streamer::sptr tx_stream, const config_t& config)
+{
+    return std::make_shared<tx_file_source_impl>(tx_stream, config);
+}
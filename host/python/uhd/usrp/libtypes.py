@@ -25,5 +25,6 @@ Sampling = lib.usrp.sampling
 FEConnection = lib.usrp.fe_connection
 StreamArgs = lib.usrp.stream_args
 RXStreamer = lib.usrp.rx_streamer
+RXRing = lib.usrp.rx_ring
 TXStreamer = lib.usrp.tx_streamer
 # pylint: enable=invalid-name
@@ -0,0 +1,254 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "ad9361_device.h"
+#include <uhd/exception.hpp>
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+
+using namespace uhd::usrp;
+
+namespace {
+
+class mock_ad9361_params : public ad9361_params
+{
+public:
+    digital_interface_delays_t get_digital_interface_timing()
+    {
+        return digital_interface_delays_t{0, 0xF, 0, 0xF};
+    }
+
+    digital_interface_mode_t get_digital_interface_mode()
+    {
+        return AD9361_DDR_FDD_LVCMOS;
+    }
+
+    clocking_mode_t get_clocking_mode()
+    {
+        return clocking_mode_t::AD9361_XTAL_N_CLK_PATH;
+    }
+
+    double get_band_edge(frequency_band_t band)
+    {
+        switch (band) {
+            case AD9361_RX_BAND0:
+                return 2.2e9;
+            case AD9361_RX_BAND1:
+                return 4.0e9;
+            case AD9361_TX_BAND0:
+                return 2.5e9;
+            default:
+                return 0;
+        }
+    }
+};
+
+/*! A register file that behaves like an AD9361 as far as the driver can tell
+ *
+ * Calibrations complete immediately (unless they are stuck), PLLs always lock,
+ * and the FIR coefficient memories are written through their indirect
+ * registers like on the chip.
+ */
+class mock_ad9361_io : public ad9361_io
+{
+public:
+    static constexpr uint32_t RX_FIR_BASE = 0x0f0;
+    static constexpr uint32_t TX_FIR_BASE = 0x060;
+
+    using fir_memory_t = std::array<uint16_t, 128>;
+
+    mock_ad9361_io()
+    {
+        regs.fill(0);
+        for (auto& fir : fir_memory) {
+            fir.fill(0);
+        }
+    }
+
+    uint8_t peek8(uint32_t reg)
+    {
+        switch (reg) {
+            case 0x037: // Product ID
+                return 0x0a;
+            case 0x016: // Calibration control, bits clear when done
+                std::this_thread::sleep_for(cal_poll_delay);
+                return regs[0x016] & stuck_cal_bits;
+            case 0x017: // ENSM state
+                return ensm_state;
+            case 0x05e: // BBPLL lock
+            case 0x244: // RX charge pump calibration done
+            case 0x284: // TX charge pump calibration done
+                return 0x80;
+            case 0x247: // RX PLL lock
+            case 0x287: // TX PLL lock
+                return 0x02;
+            default:
+                return regs.at(reg);
+        }
+    }
+
+    void poke8(uint32_t reg, uint8_t val)
+    {
+        num_pokes++;
+        regs.at(reg) = val;
+        if (reg == 0x014) {
+            ensm_state = (val & 0x20) ? 0x0A : (val & 0x05) ? 0x05 : 0x00;
+        }
+        for (const uint32_t base : {RX_FIR_BASE, TX_FIR_BASE}) {
+            // Writing to base + 4 with the write bit set stores a coefficient
+            if (reg == base + 4 and (regs[base + 5] & 0x04)) {
+                const size_t dir     = (base == RX_FIR_BASE) ? 0 : 1;
+                const uint8_t chains = (regs[base + 5] >> 3) & 0x03;
+                const uint16_t coeff = regs[base + 1] | (regs[base + 2] << 8);
+                for (size_t chain = 0; chain < 2; chain++) {
+                    if (chains & (1 << chain)) {
+                        fir_memory[dir * 2 + chain].at(regs[base]) = coeff;
+                    }
+                }
+            }
+        }
+    }
+
+    //! Return true if the registers that hold a setting are equal
+    bool same_settings(const mock_ad9361_io& other) const
+    {
+        // Indirect access registers of the FIR and gain tables
+        static const std::set<uint32_t> indirect_regs = {RX_FIR_BASE,
+            RX_FIR_BASE + 1,
+            RX_FIR_BASE + 2,
+            RX_FIR_BASE + 4,
+            TX_FIR_BASE,
+            TX_FIR_BASE + 1,
+            TX_FIR_BASE + 2,
+            TX_FIR_BASE + 4,
+            0x130,
+            0x131,
+            0x132,
+            0x133,
+            0x134};
+        bool same = true;
+        for (uint32_t reg = 0; reg < regs.size(); reg++) {
+            if (indirect_regs.count(reg) == 0 and regs[reg] != other.regs[reg]) {
+                BOOST_TEST_MESSAGE(
+                    "Register " << std::hex << reg << " differs: " << int(regs[reg])
+                                << " != " << int(other.regs[reg]));
+                same = false;
+            }
+        }
+        return same and fir_memory == other.fir_memory;
+    }
+
+    std::array<uint8_t, 0x400> regs;
+    //! RX chain 1, RX chain 2, TX chain 1, TX chain 2
+    std::array<fir_memory_t, 4> fir_memory;
+    uint8_t ensm_state = 0x00;
+    size_t num_pokes   = 0;
+    //! Calibrations that never finish
+    uint8_t stuck_cal_bits = 0x00;
+    //! Time it takes to read the calibration status
+    std::chrono::milliseconds cal_poll_delay{0};
+};
+
+struct ad9361_fixture
+{
+    ad9361_fixture()
+        : io(std::make_shared<mock_ad9361_io>())
+        , device(std::make_shared<mock_ad9361_params>(), io)
+    {
+        device.initialize();
+    }
+
+    std::shared_ptr<mock_ad9361_io> io;
+    ad9361_device_t device;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_ad9361_rate_switch)
+{
+    // Rates below 660 kHz use different FIR taps than all others, so
+    // switching from there must reprogram the FIR tables
+    ad9361_fixture reference;
+    reference.device.set_clock_rate(500e3);
+    const size_t pokes_before_reference = reference.io->num_pokes;
+    reference.device.set_clock_rate(16e6);
+    const size_t full_pokes = reference.io->num_pokes - pokes_before_reference;
+
+    // Switching between rates that use the same taps must leave the chip in
+    // the same state, with fewer writes
+    ad9361_fixture dut;
+    dut.device.set_clock_rate(16e6);
+    dut.device.set_clock_rate(30.72e6);
+    BOOST_CHECK(not dut.io->same_settings(*reference.io));
+    const size_t pokes_before = dut.io->num_pokes;
+    dut.device.set_clock_rate(16e6);
+    const size_t cached_pokes = dut.io->num_pokes - pokes_before;
+    BOOST_CHECK(dut.io->same_settings(*reference.io));
+    BOOST_TEST_MESSAGE("Writes for a rate change: " << full_pokes << " with FIR, "
+                                                    << cached_pokes << " without");
+    BOOST_CHECK_LT(cached_pokes, full_pokes / 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_ad9361_tune)
+{
+    for (const double freq : {915e6, 2.45e9, 5.8e9}) {
+        ad9361_fixture reference;
+        reference.device.tune(ad9361_device_t::RX, freq);
+        reference.device.tune(ad9361_device_t::TX, freq);
+
+        // Retuning from a nearby frequency reuses the synthesizer setup
+        ad9361_fixture dut;
+        dut.device.tune(ad9361_device_t::RX, freq - 1e6);
+        dut.device.tune(ad9361_device_t::TX, freq - 1e6);
+        dut.device.tune(ad9361_device_t::RX, freq);
+        dut.device.tune(ad9361_device_t::TX, freq);
+        BOOST_CHECK(dut.io->same_settings(*reference.io));
+        BOOST_CHECK_CLOSE(dut.device.get_freq(ad9361_device_t::RX),
+            reference.device.get_freq(ad9361_device_t::RX),
+            1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ad9361_custom_fir)
+{
+    ad9361_fixture dut;
+    const mock_ad9361_io::fir_memory_t default_taps = dut.io->fir_memory[0];
+
+    // Custom taps on one chain must not be mistaken for the default ones
+    auto fir = std::dynamic_pointer_cast<uhd::digital_filter_fir<int16_t>>(
+        dut.device.get_filter(ad9361_device_t::RX, ad9361_device_t::CHAIN_1, "FIR_1"));
+    BOOST_REQUIRE(fir);
+    std::vector<int16_t> taps(fir->get_taps().size(), 0);
+    taps[0] = 1000;
+    fir->set_taps(taps);
+    dut.device.set_filter(ad9361_device_t::RX, ad9361_device_t::CHAIN_1, "FIR_1", fir);
+    BOOST_CHECK_EQUAL(dut.io->fir_memory[0][0], 1000);
+    BOOST_CHECK(dut.io->fir_memory[1] == default_taps);
+
+    dut.device.set_clock_rate(500e3);
+    dut.device.set_clock_rate(50e6);
+    BOOST_CHECK(dut.io->fir_memory[0] == default_taps);
+    BOOST_CHECK(dut.io->fir_memory[1] == default_taps);
+}
+
+BOOST_AUTO_TEST_CASE(test_ad9361_calibration_timeout)
+{
+    // The baseband DC offset calibration times out after 500 ms, no matter how
+    // long every poll of its status takes
+    ad9361_fixture dut;
+    dut.io->stuck_cal_bits = 0x01;
+    dut.io->cal_poll_delay = std::chrono::milliseconds(2);
+    const auto start       = std::chrono::steady_clock::now();
+    BOOST_CHECK_THROW(dut.device.set_clock_rate(16e6), uhd::runtime_error);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    BOOST_CHECK(elapsed >= std::chrono::milliseconds(500));
+    BOOST_CHECK(elapsed < std::chrono::milliseconds(1000));
+}
@@ -0,0 +1,131 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhdlib/transport/adaptive_wait.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace uhd::transport;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+//! Wait function for data that becomes available at a given time, or on a
+// given poll. Returns true if the data is there by the end of the timeout.
+class mock_source
+{
+public:
+    void arrive_in(const std::chrono::microseconds delay)
+    {
+        _arrival      = clock_type::now() + delay;
+        _arrival_poll = SIZE_MAX;
+    }
+
+    void arrive_on_poll(const size_t num_polls)
+    {
+        _arrival_poll = this->num_polls + num_polls;
+        _arrival      = clock_type::time_point::max();
+    }
+
+    bool operator()(const int32_t timeout_ms)
+    {
+        if (timeout_ms == 0) {
+            num_polls++;
+            return num_polls >= _arrival_poll || clock_type::now() >= _arrival;
+        }
+        num_blocks++;
+        if (num_polls >= _arrival_poll) {
+            return true;
+        }
+        const auto deadline = clock_type::now() + std::chrono::milliseconds(timeout_ms);
+        if (timeout_ms > 0 && _arrival > deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+        std::this_thread::sleep_until(_arrival);
+        return true;
+    }
+
+    size_t num_polls  = 0;
+    size_t num_blocks = 0;
+
+private:
+    clock_type::time_point _arrival = clock_type::time_point::max();
+    size_t _arrival_poll            = SIZE_MAX;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_adaptive_wait_spin)
+{
+    adaptive_wait wait(1e-3);
+    mock_source source;
+    // Data arrives after a few polls, so it's caught while polling, unless
+    // the thread gets preempted for longer than the spin budget
+    const double initial_budget = wait.get_spin_budget();
+    for (int i = 0; i < 10; i++) {
+        source.arrive_on_poll(3);
+        BOOST_CHECK(wait.wait(100, std::ref(source)));
+    }
+    BOOST_CHECK_GT(source.num_polls, 10);
+
+    const auto stats = wait.get_stats();
+    BOOST_CHECK_EQUAL(stats.num_spin_hits + stats.num_blocks, 10);
+    BOOST_CHECK_GT(stats.num_spin_hits, stats.num_blocks);
+    BOOST_CHECK_GT(stats.spin_time, 0.0);
+    // The budget follows the latency down, but never beyond the maximum
+    BOOST_CHECK_LT(wait.get_spin_budget(), initial_budget);
+    BOOST_CHECK_LE(wait.get_spin_budget(), 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(test_adaptive_wait_back_off)
+{
+    adaptive_wait wait(100e-6);
+    mock_source source;
+    // Data takes longer than the maximum spin time, so polling stops
+    for (int i = 0; i < 20; i++) {
+        source.arrive_in(std::chrono::microseconds(2000));
+        BOOST_CHECK(wait.wait(100, std::ref(source)));
+    }
+    BOOST_CHECK_EQUAL(wait.get_spin_budget(), 0.0);
+    const size_t num_polls = source.num_polls;
+    source.arrive_in(std::chrono::microseconds(2000));
+    BOOST_CHECK(wait.wait(100, std::ref(source)));
+    BOOST_CHECK_EQUAL(source.num_polls, num_polls);
+
+    const auto stats = wait.get_stats();
+    BOOST_CHECK_EQUAL(stats.num_blocks, 21);
+    BOOST_CHECK_GT(stats.block_time, stats.spin_time);
+
+    // Once data arrives faster again, polling resumes
+    for (int i = 0; i < 100 && wait.get_spin_budget() == 0.0; i++) {
+        source.arrive_on_poll(0);
+        BOOST_CHECK(wait.wait(100, std::ref(source)));
+    }
+    BOOST_CHECK_GT(wait.get_spin_budget(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_adaptive_wait_timeout)
+{
+    adaptive_wait wait(1e-3);
+    mock_source source;
+
+    // Nothing arrives: Poll first, then block for the rest of the timeout. The
+    // wait never returns before the timeout.
+    const auto start = clock_type::now();
+    BOOST_CHECK(!wait.wait(20, std::ref(source)));
+    BOOST_CHECK(clock_type::now() >= start + std::chrono::milliseconds(20));
+    BOOST_CHECK_GT(source.num_polls, 0);
+    BOOST_CHECK_EQUAL(source.num_blocks, 1);
+
+    // A zero timeout is passed straight through
+    const size_t num_polls = source.num_polls;
+    BOOST_CHECK(!wait.wait(0, std::ref(source)));
+    BOOST_CHECK_EQUAL(source.num_polls, num_polls + 1);
+    BOOST_CHECK_EQUAL(wait.get_stats().num_blocks, 1);
+}
@@ -0,0 +1,253 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/chdr_types.hpp>
+#include <uhd/utils/chdr/pcap_analyzer.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace uhd::rfnoc::chdr;
+using namespace uhd::utils::chdr;
+
+namespace {
+
+constexpr uint16_t CHDR_PORT = 49153;
+
+//! Builds a pcap capture of Ethernet frames in memory
+class pcap_builder
+{
+public:
+    pcap_builder()
+    {
+        put32(0xa1b2c3d4); // Magic, microsecond timestamps
+        put16(2); // Version
+        put16(4);
+        put32(0); // Time zone
+        put32(0); // Accuracy
+        put32(65535); // Snapshot length
+        put32(1); // Ethernet
+    }
+
+    //! Add a UDP datagram with a CHDR packet
+    void add_chdr(const double time,
+        chdr_header header,
+        const std::vector<uint64_t>& body,
+        const uint16_t port = CHDR_PORT)
+    {
+        header.set_length(uint16_t((1 + body.size()) * sizeof(uint64_t)));
+        std::vector<uint8_t> payload(header.get_length());
+        const uint64_t hdr = header.pack();
+        std::memcpy(payload.data(), &hdr, sizeof(hdr));
+        std::memcpy(payload.data() + sizeof(hdr), body.data(), body.size() * 8);
+
+        std::vector<uint8_t> frame(12, 0); // MAC addresses
+        put_be16(frame, 0x0800);
+        // IPv4 header
+        frame.push_back(0x45);
+        frame.push_back(0);
+        put_be16(frame, uint16_t(20 + 8 + payload.size()));
+        frame.insert(frame.end(), {0, 0, 0, 0, 64, 17, 0, 0});
+        frame.insert(frame.end(), {192, 168, 10, 1, 192, 168, 10, 2});
+        // UDP header
+        put_be16(frame, 12345);
+        put_be16(frame, port);
+        put_be16(frame, uint16_t(8 + payload.size()));
+        put_be16(frame, 0);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        add_record(time, frame);
+    }
+
+    void add_record(const double time, const std::vector<uint8_t>& frame)
+    {
+        const double secs = std::floor(time);
+        put32(uint32_t(secs));
+        put32(uint32_t(std::lround((time - secs) * 1e6)));
+        put32(uint32_t(frame.size()));
+        put32(uint32_t(frame.size()));
+        data.insert(data.end(), frame.begin(), frame.end());
+    }
+
+    std::vector<uint8_t> data;
+
+private:
+    void put16(const uint16_t value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    }
+
+    void put32(const uint32_t value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(value));
+    }
+
+    static void put_be16(std::vector<uint8_t>& frame, const uint16_t value)
+    {
+        frame.push_back(uint8_t(value >> 8));
+        frame.push_back(uint8_t(value & 0xff));
+    }
+};
+
+chdr_header make_header(
+    const packet_type_t pkt_type, const uint16_t dst_epid, const uint16_t seq_num)
+{
+    chdr_header header;
+    header.set_pkt_type(pkt_type);
+    header.set_dst_epid(dst_epid);
+    header.set_seq_num(seq_num);
+    return header;
+}
+
+/*! Build a capture with one data stream to EPID 2, stream status responses
+ * to EPID 1, a control packet to EPID 3, and a non-IP frame
+ *
+ * The data stream is missing sequence numbers 500 to 502, and its timestamps
+ * run 10 ppm fast relative to the capture clock at 1 MHz.
+ */
+pcap_builder make_capture()
+{
+    pcap_builder capture;
+    const double start_time = 1000.0;
+    uint16_t strs_seq       = 0;
+    for (uint16_t seq = 0; seq < 1000; seq++) {
+        const double time = start_time + seq * 100e-6;
+        if (seq >= 500 && seq < 503) {
+            continue;
+        }
+        chdr_header header = make_header(PKT_TYPE_DATA_WITH_TS, 2, seq);
+        header.set_eob(seq == 999);
+        std::vector<uint64_t> body(33, 0);
+        body[0] = uint64_t(std::llround(seq * 100.001));
+        capture.add_chdr(time, header, body);
+
+        if (seq % 10 == 9) {
+            strs_payload strs;
+            strs.src_epid = 2;
+            strs.status   = (seq == 499) ? STRS_SEQERR : STRS_OKAY;
+            std::vector<uint64_t> strs_body(4);
+            strs.serialize<uhd::ENDIANNESS_LITTLE>(strs_body.data(), 32);
+            capture.add_chdr(time, make_header(PKT_TYPE_STRS, 1, strs_seq++), strs_body);
+        }
+    }
+    capture.add_chdr(start_time, make_header(PKT_TYPE_CTRL, 3, 0), {0, 0});
+    capture.add_record(start_time, std::vector<uint8_t>(60, 0));
+    return capture;
+}
+
+const pcap_stream_stats_t& find_stream(
+    const pcap_stats_t& stats, const uint16_t dst_epid, const pcap_stream_type_t type)
+{
+    for (const auto& stream : stats.streams) {
+        if (stream.dst_epid == dst_epid && stream.type == type) {
+            return stream;
+        }
+    }
+    throw uhd::key_error("stream not found");
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_pcap_analyzer)
+{
+    const pcap_builder capture = make_capture();
+    pcap_analyzer_config_t config;
+    config.tick_rate   = 1e6;
+    config.num_threads = 1;
+    const pcap_stats_t stats =
+        analyze_pcap(capture.data.data(), capture.data.size(), config);
+
+    BOOST_CHECK_EQUAL(stats.num_bytes, capture.data.size());
+    BOOST_CHECK_EQUAL(stats.num_records, 997 + 100 + 2);
+    BOOST_CHECK_EQUAL(stats.num_chdr_packets, 997 + 100 + 1);
+    BOOST_CHECK_EQUAL(stats.num_ignored, 1);
+    BOOST_CHECK_EQUAL(stats.num_malformed, 0);
+    BOOST_REQUIRE_EQUAL(stats.streams.size(), 3);
+    BOOST_CHECK_EQUAL(stats.streams[0].dst_epid, 1);
+
+    const auto& data = find_stream(stats, 2, PCAP_STREAM_DATA);
+    BOOST_CHECK_EQUAL(data.num_packets, 997);
+    BOOST_CHECK_EQUAL(data.num_bytes, 997 * 34 * 8);
+    BOOST_CHECK_EQUAL(data.num_payload_bytes, 997 * 32 * 8);
+    BOOST_CHECK_EQUAL(data.num_seq_gaps, 1);
+    BOOST_CHECK_EQUAL(data.num_lost_packets, 3);
+    BOOST_CHECK_EQUAL(data.num_eob, 1);
+    BOOST_CHECK_EQUAL(data.num_timestamps, 997);
+    BOOST_CHECK_EQUAL(data.first_timestamp, 0);
+    BOOST_CHECK_EQUAL(data.last_timestamp, 99901);
+    BOOST_CHECK_CLOSE(data.tick_rate, 1e6, 1e-2);
+    BOOST_CHECK_CLOSE(data.drift_ppm, 10.0, 5.0);
+    BOOST_CHECK_CLOSE(data.throughput, 997 * 34 * 8 * 8 / 99.9e-3, 1e-2);
+
+    const auto& strs = find_stream(stats, 1, PCAP_STREAM_STRS);
+    BOOST_CHECK_EQUAL(strs.num_packets, 100);
+    BOOST_CHECK_EQUAL(strs.num_strs_errors, 1);
+    BOOST_CHECK_CLOSE(strs.min_strs_interval, 1e-3, 1e-2);
+    BOOST_CHECK_CLOSE(strs.mean_strs_interval, 1e-3, 1e-2);
+    BOOST_CHECK_CLOSE(strs.max_strs_interval, 1e-3, 1e-2);
+    // Stream status packets have no sequence gaps, even if they are counted
+    BOOST_CHECK_EQUAL(strs.num_seq_gaps, 0);
+
+    BOOST_CHECK_EQUAL(find_stream(stats, 3, PCAP_STREAM_CTRL).num_packets, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_pcap_analyzer_chunks)
+{
+    const pcap_builder capture = make_capture();
+    pcap_analyzer_config_t config;
+    config.tick_rate = 1e6;
+    const pcap_stats_t reference =
+        analyze_pcap(capture.data.data(), capture.data.size(), config);
+
+    // Results must not depend on where the chunks are split
+    config.num_threads = 4;
+    for (size_t chunk_size : {1, 1000, 4096, 100000}) {
+        config.chunk_size = chunk_size;
+        const pcap_stats_t stats =
+            analyze_pcap(capture.data.data(), capture.data.size(), config);
+        BOOST_CHECK_EQUAL(stats.num_chdr_packets, reference.num_chdr_packets);
+        BOOST_REQUIRE_EQUAL(stats.streams.size(), reference.streams.size());
+        for (size_t i = 0; i < stats.streams.size(); i++) {
+            const auto& stream   = stats.streams[i];
+            const auto& expected = reference.streams[i];
+            BOOST_CHECK_EQUAL(stream.num_packets, expected.num_packets);
+            BOOST_CHECK_EQUAL(stream.num_seq_gaps, expected.num_seq_gaps);
+            BOOST_CHECK_EQUAL(stream.num_lost_packets, expected.num_lost_packets);
+            BOOST_CHECK_EQUAL(stream.last_timestamp, expected.last_timestamp);
+            BOOST_CHECK_EQUAL(stream.num_strs_errors, expected.num_strs_errors);
+            BOOST_CHECK_CLOSE(
+                stream.mean_strs_interval + 1.0, expected.mean_strs_interval + 1.0, 1e-6);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_pcap_analyzer_filter)
+{
+    pcap_builder capture = make_capture();
+    // Truncate the last record
+    capture.data.resize(capture.data.size() - 10);
+
+    pcap_analyzer_config_t config;
+    config.udp_port = 1234;
+    const pcap_stats_t stats =
+        analyze_pcap(capture.data.data(), capture.data.size(), config);
+    BOOST_CHECK_EQUAL(stats.num_chdr_packets, 0);
+    BOOST_CHECK_EQUAL(stats.num_ignored, stats.num_records);
+    BOOST_CHECK_EQUAL(stats.num_malformed, 1);
+    BOOST_CHECK(stats.streams.empty());
+
+    const uint32_t bad_magic = 0x0a0d0d0a; // pcapng
+    BOOST_CHECK_THROW(analyze_pcap(&bad_magic, sizeof(bad_magic), config),
+        uhd::value_error);
+    std::vector<uint8_t> pcapng(capture.data.begin(), capture.data.begin() + 24);
+    std::memcpy(pcapng.data(), &bad_magic, sizeof(bad_magic));
+    BOOST_CHECK_THROW(analyze_pcap(pcapng.data(), pcapng.size(), config),
+        uhd::value_error);
+    BOOST_CHECK_THROW(analyze_pcap_file("/nonexistent.pcap", config), uhd::io_error);
+}
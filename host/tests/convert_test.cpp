@@ -11,6 +11,7 @@
 #include <complex>
 #include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
 using namespace uhd;
@@ -304,6 +305,312 @@ BOOST_AUTO_TEST_CASE(test_convert_types_be_sc16_and_sc12)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_convert_types_fc64_and_sc12)
+{
+    convert::id_type id;
+    id.input_format = "fc64";
+    id.num_inputs   = 1;
+    id.num_outputs  = 1;
+
+    // try various lengths to test edge cases
+    id.output_format = "sc12_item32_le";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc64_t>(nsamps, id, 1. / 16);
+    }
+
+    // try various lengths to test edge cases
+    id.output_format = "sc12_item32_be";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc64_t>(nsamps, id, 1. / 16);
+    }
+}
+
+#ifdef UHD_TEST_AVX2_CONVERTERS
+/***********************************************************************
+ * Cross-check the AVX2 sc12 converters against the generic ones
+ **********************************************************************/
+// Must match PRIORITY_AVX2 in lib/convert/convert_common.hpp
+static const int PRIORITY_AVX2 = 4;
+
+static bool cpu_has_avx2(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return true;
+#endif
+}
+
+/*
+ * The SIMD converters round to the nearest integer where the generic ones
+ * truncate, so the float samples are picked to be exact 12-bit values once
+ * scaled by 2048. Together with power-of-two scalars, this keeps the results
+ * bit exact.
+ */
+static int random_sc12(void)
+{
+    return (std::rand() % 4096) - 2048;
+}
+
+static void random_fill(fc32_t& samp)
+{
+    samp = fc32_t(random_sc12() / 2048.f, random_sc12() / 2048.f);
+}
+
+static void random_fill(fc64_t& samp)
+{
+    samp = fc64_t(random_sc12() / 2048., random_sc12() / 2048.);
+}
+
+static void random_fill(sc16_t& samp)
+{
+    samp = sc16_t(short(std::rand()), short(std::rand()));
+}
+
+template <typename data_type>
+static void test_avx2_pack_sc12(const std::string& host_format, const double scalar)
+{
+    convert::id_type id;
+    id.input_format = host_format;
+    id.num_inputs   = 1;
+    id.num_outputs  = 1;
+
+    const size_t max_samps = 50;
+    std::vector<data_type> input(max_samps + 3);
+    for (data_type& in : input) {
+        random_fill(in);
+    }
+
+    for (const std::string wire_format : {"sc12_item32_le", "sc12_item32_be"}) {
+        id.output_format              = wire_format;
+        convert::converter::sptr avx2 = convert::get_converter(id, PRIORITY_AVX2)();
+        convert::converter::sptr gen  = convert::get_converter(id, 0)();
+        avx2->set_scalar(scalar);
+        gen->set_scalar(scalar);
+
+        // Odd lengths, odd host offsets and every wire offset within a line.
+        // The guard bytes around the packed samples must come out the same too.
+        for (size_t nsamps = 1; nsamps <= max_samps; nsamps++) {
+            for (size_t in_off = 0; in_off < 3; in_off++) {
+                for (size_t wire_off = 0; wire_off < 4; wire_off++) {
+                    std::vector<uint32_t> wire_avx2(max_samps + 8, 0xdeadbeef);
+                    std::vector<uint32_t> wire_gen(max_samps + 8, 0xdeadbeef);
+                    std::vector<const void*> in(1, &input[in_off]);
+                    std::vector<void*> out_avx2(
+                        1, reinterpret_cast<uint8_t*>(&wire_avx2[0]) + wire_off);
+                    std::vector<void*> out_gen(
+                        1, reinterpret_cast<uint8_t*>(&wire_gen[0]) + wire_off);
+                    avx2->conv(in, out_avx2, nsamps);
+                    gen->conv(in, out_gen, nsamps);
+                    BOOST_CHECK_MESSAGE(wire_avx2 == wire_gen,
+                        host_format << " -> " << wire_format << " nsamps=" << nsamps
+                                    << " in_off=" << in_off
+                                    << " wire_off=" << wire_off);
+                }
+            }
+        }
+    }
+}
+
+template <typename data_type>
+static void test_avx2_unpack_sc12(const std::string& host_format, const double scalar)
+{
+    convert::id_type id;
+    id.output_format = host_format;
+    id.num_inputs    = 1;
+    id.num_outputs   = 1;
+
+    const size_t max_samps = 50;
+    std::vector<uint32_t> wire(max_samps + 8);
+    for (uint32_t& word : wire) {
+        word = (uint32_t(std::rand()) << 16) ^ uint32_t(std::rand());
+    }
+
+    for (const std::string wire_format : {"sc12_item32_le", "sc12_item32_be"}) {
+        id.input_format               = wire_format;
+        convert::converter::sptr avx2 = convert::get_converter(id, PRIORITY_AVX2)();
+        convert::converter::sptr gen  = convert::get_converter(id, 0)();
+        avx2->set_scalar(scalar);
+        gen->set_scalar(scalar);
+
+        for (size_t nsamps = 1; nsamps <= max_samps; nsamps++) {
+            for (size_t wire_off = 0; wire_off < 4; wire_off++) {
+                for (size_t out_off = 0; out_off < 3; out_off++) {
+                    std::vector<data_type> out_avx2(max_samps + 4, data_type(7, -7));
+                    std::vector<data_type> out_gen(max_samps + 4, data_type(7, -7));
+                    std::vector<const void*> in(
+                        1, reinterpret_cast<const uint8_t*>(&wire[0]) + wire_off);
+                    std::vector<void*> o_avx2(1, &out_avx2[out_off]);
+                    std::vector<void*> o_gen(1, &out_gen[out_off]);
+                    avx2->conv(in, o_avx2, nsamps);
+                    gen->conv(in, o_gen, nsamps);
+                    BOOST_CHECK_MESSAGE(out_avx2 == out_gen,
+                        wire_format << " -> " << host_format << " nsamps=" << nsamps
+                                    << " wire_off=" << wire_off
+                                    << " out_off=" << out_off);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_avx2_sc12_matches_generic)
+{
+    if (not cpu_has_avx2()) {
+        std::cout << "CPU does not support AVX2, skipping AVX2 cross-check" << std::endl;
+        return;
+    }
+
+    test_avx2_pack_sc12<fc32_t>("fc32", 2048.);
+    test_avx2_pack_sc12<fc64_t>("fc64", 2048.);
+    test_avx2_pack_sc12<sc16_t>("sc16", 1.);
+    test_avx2_unpack_sc12<fc32_t>("fc32", 1. / 32768);
+    test_avx2_unpack_sc12<fc64_t>("fc64", 1. / 32768);
+    test_avx2_unpack_sc12<sc16_t>("sc16", 1.);
+}
+#endif // UHD_TEST_AVX2_CONVERTERS
+
+/***********************************************************************
+ * Test sc4 conversions
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_fc64_and_sc4)
+{
+    convert::id_type id;
+    id.input_format = "fc64";
+    id.num_inputs   = 1;
+    id.num_outputs  = 1;
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_le";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc64_t>(nsamps, id, 1. / 4096);
+    }
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_be";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc64_t>(nsamps, id, 1. / 4096);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_fc32_and_sc4)
+{
+    convert::id_type id;
+    id.input_format = "fc32";
+    id.num_inputs   = 1;
+    id.num_outputs  = 1;
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_le";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc32_t>(nsamps, id, 1. / 4096);
+    }
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_be";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_for_floats<fc32_t>(nsamps, id, 1. / 4096);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_and_sc4)
+{
+    convert::id_type id;
+    id.input_format = "sc16";
+    id.num_inputs   = 1;
+    id.num_outputs  = 1;
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_le";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_sc16(nsamps, id, 1, 0xf000);
+    }
+
+    // try various lengths to test edge cases
+    id.output_format = "sc4_item32_be";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++) {
+        test_convert_types_sc16(nsamps, id, 1, 0xf000);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_sc4_unaligned)
+{
+    convert::id_type id;
+    id.input_format  = "sc16";
+    id.num_inputs    = 1;
+    id.output_format = "sc4_item32_be";
+    id.num_outputs   = 1;
+
+    const size_t nsamps = 11;
+    std::vector<sc16_t> input(nsamps), output(nsamps);
+    for (size_t i = 0; i < nsamps; i++) {
+        input[i] = sc16_t(short((i << 12) & 0xf000), short(((15 - i) << 12) & 0xf000));
+    }
+
+    // Pack and unpack in two calls each, where the second call starts in the
+    // middle of a line. Previously packed samples must not be overwritten.
+    std::vector<uint32_t> interm(nsamps);
+    uint8_t* wire = reinterpret_cast<uint8_t*>(&interm[0]);
+
+    convert::id_type out_id = id;
+    std::swap(out_id.input_format, out_id.output_format);
+    convert::converter::sptr c0 = convert::get_converter(id)();
+    convert::converter::sptr c1 = convert::get_converter(out_id)();
+
+    for (const size_t split : {1, 2, 3, 5, 6, 7}) {
+        std::vector<const void*> input0(1, &input[0]), input1(1, &input[split]);
+        std::vector<void*> interm0(1, wire), interm1(1, wire + split);
+        c0->conv(input0, interm0, split);
+        c0->conv(input1, interm1, nsamps - split);
+
+        std::vector<const void*> wire0(1, wire), wire1(1, wire + split);
+        std::vector<void*> output0(1, &output[0]), output1(1, &output[split]);
+        c1->conv(wire0, output0, split);
+        c1->conv(wire1, output1, nsamps - split);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            input.begin(), input.end(), output.begin(), output.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_fc32_to_sc4_saturate)
+{
+    convert::id_type id;
+    id.input_format  = "fc32";
+    id.num_inputs    = 1;
+    id.output_format = "sc4_item32_le";
+    id.num_outputs   = 1;
+
+    // Values outside of [-8, 7] after scaling saturate instead of wrapping
+    const std::vector<fc32_t> input = {fc32_t(1.0f, -1.0f),
+        fc32_t(0.5f, -0.5f),
+        fc32_t(2.0f, -2.0f),
+        fc32_t(1e9f, -1e9f),
+        fc32_t(0.875f, -1.125f)};
+    const std::vector<fc32_t> expected = {fc32_t(0.875f, -1.0f),
+        fc32_t(0.5f, -0.5f),
+        fc32_t(0.875f, -1.0f),
+        fc32_t(0.875f, -1.0f),
+        fc32_t(0.875f, -1.0f)};
+
+    convert::id_type out_id = id;
+    std::swap(out_id.input_format, out_id.output_format);
+    convert::converter::sptr c0 = convert::get_converter(id)();
+    convert::converter::sptr c1 = convert::get_converter(out_id)();
+    c0->set_scalar(8.0);
+    c1->set_scalar(1.0 / 8);
+
+    std::vector<uint32_t> interm(input.size());
+    std::vector<fc32_t> output(input.size());
+    std::vector<const void*> input0(1, &input[0]), interm1(1, &interm[0]);
+    std::vector<void*> interm0(1, &interm[0]), output1(1, &output[0]);
+    c0->conv(input0, interm0, input.size());
+    c1->conv(interm1, output1, input.size());
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        expected.begin(), expected.end(), output.begin(), output.end());
+}
+
 /***********************************************************************
  * Test float to/from fc32 conversion loopback
  **********************************************************************/
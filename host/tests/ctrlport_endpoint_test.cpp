@@ -0,0 +1,119 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/rfnoc/chdr_types.hpp>
+#include <uhdlib/rfnoc/clock_iface.hpp>
+#include <uhdlib/rfnoc/ctrlport_endpoint.hpp>
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+using namespace uhd::rfnoc;
+
+namespace {
+
+constexpr double TIMEBASE_FREQ = 100e6;
+constexpr size_t BUFF_CAPACITY = 64;
+
+struct ctrlport_fixture
+{
+    ctrlport_fixture()
+        : client_clk("client", 100e6, false)
+        , timebase_clk("timebase", TIMEBASE_FREQ, false)
+    {
+        client_clk.set_running(true);
+        timebase_clk.set_running(true);
+        ctrlport = ctrlport_endpoint::make(
+            [this](const chdr::ctrl_payload& request, double) {
+                requests.push_back(request);
+            },
+            0,
+            0,
+            BUFF_CAPACITY,
+            1,
+            client_clk,
+            timebase_clk);
+    }
+
+    //! Acknowledge the request with the given index
+    void ack(const size_t idx)
+    {
+        chdr::ctrl_payload response(requests.at(idx));
+        response.is_ack = true;
+        ctrlport->handle_recv(response);
+    }
+
+    clock_iface client_clk;
+    clock_iface timebase_clk;
+    std::vector<chdr::ctrl_payload> requests;
+    ctrlport_endpoint::sptr ctrlport;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(test_coalesce_same_timestamp, ctrlport_fixture)
+{
+    const uhd::time_spec_t cmd_time(1.0);
+    for (uint32_t i = 0; i < 8; i++) {
+        ctrlport->poke32(0x100 + 4 * i, i, cmd_time);
+    }
+    BOOST_REQUIRE_EQUAL(requests.size(), 8);
+    BOOST_REQUIRE(requests[0].has_timestamp());
+    BOOST_CHECK_EQUAL(requests[0].timestamp.get(), cmd_time.to_ticks(TIMEBASE_FREQ));
+    for (size_t i = 1; i < requests.size(); i++) {
+        BOOST_CHECK(!requests[i].has_timestamp());
+        BOOST_CHECK_EQUAL(requests[i].address, 0x100 + 4 * i);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_coalesce_different_timestamp, ctrlport_fixture)
+{
+    ctrlport->poke32(0x100, 0, uhd::time_spec_t(1.0));
+    ctrlport->poke32(0x104, 0, uhd::time_spec_t(2.0));
+    // Going back to an earlier time must not be coalesced with the later one
+    ctrlport->poke32(0x108, 0, uhd::time_spec_t(1.0));
+    ctrlport->poke32(0x10C, 0);
+    BOOST_REQUIRE_EQUAL(requests.size(), 4);
+    BOOST_CHECK(requests[0].has_timestamp());
+    BOOST_CHECK(requests[1].has_timestamp());
+    BOOST_CHECK(requests[2].has_timestamp());
+    BOOST_CHECK(!requests[3].has_timestamp());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_coalesce_after_ack, ctrlport_fixture)
+{
+    const uhd::time_spec_t cmd_time(1.0);
+    ctrlport->poke32(0x100, 0, cmd_time);
+    ctrlport->poke32(0x104, 0, cmd_time);
+    BOOST_CHECK(!requests[1].has_timestamp());
+    // Once the timed command has executed, the next one must carry its own
+    // timestamp again
+    ack(0);
+    ctrlport->poke32(0x108, 0, cmd_time);
+    BOOST_REQUIRE_EQUAL(requests.size(), 3);
+    BOOST_CHECK(requests[2].has_timestamp());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_coalesce_saves_buffer_space, ctrlport_fixture)
+{
+    // Timed pokes take 5 words, coalesced ones only 3. Without coalescing, the
+    // buffer would fill up after 11 pokes and the 12th would time out.
+    ctrlport->set_policy("default", uhd::device_addr_t("timeout=0.01"));
+    const uhd::time_spec_t cmd_time(1.0);
+    for (uint32_t i = 0; i < 16; i++) {
+        BOOST_REQUIRE_NO_THROW(ctrlport->poke32(0x100 + 4 * i, i, cmd_time));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_coalesce_disabled, ctrlport_fixture)
+{
+    ctrlport->set_policy("default", uhd::device_addr_t("coalesce_timed=0"));
+    const uhd::time_spec_t cmd_time(1.0);
+    ctrlport->poke32(0x100, 0, cmd_time);
+    ctrlport->poke32(0x104, 0, cmd_time);
+    BOOST_REQUIRE_EQUAL(requests.size(), 2);
+    BOOST_CHECK(requests[0].has_timestamp());
+    BOOST_CHECK(requests[1].has_timestamp());
+}
@@ -4,7 +4,23 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 /**
- * Benchmark program to check performance of 2 simultaneous links
+ * Benchmark program to check performance of DPDK links
+ *
+ * In polling mode, this checks the performance of 2 simultaneous links
+ * between two NIC ports that are connected to each other.
+ *
+ * In throughput mode, this streams over many links on NIC port 0, which may
+ * be a virtual device. Each link sends to the port's own address, so it will
+ * receive its own packets if the port loops them back (e.g., net_ring). If
+ * the port drops all TX traffic (e.g., net_null), use --tx-only to measure the
+ * send path without flow control. Example:
+ *
+ *     dpdk_test --throughput --num-links 8 --args \
+ *         "dpdk_vdev=net_ring0,dpdk_corelist=0-4,dpdk_mac=02:70:63:61:70:00,\
+ *          dpdk_ipv4=192.168.10.1/24,dpdk_lcore=1"
+ *
+ * Multiple lcores (and hence DMA queues) per port are configured as a comma-
+ * separated dpdk_lcore list in the UHD configuration file.
  */
 
 
@@ -20,6 +36,7 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <cstdbool>
 #include <cstdio>
 #include <cstring>
@@ -308,19 +325,146 @@ void prepare_and_bench_polling(void)
     bench(tx_strm, rx_strm, NUM_PORTS, 0.0);
 }
 
+void prepare_and_bench_throughput(
+    const size_t num_links, const double duration, const bool tx_only)
+{
+    using namespace uhd::transport;
+    auto ctx = dpdk::dpdk_ctx::get();
+
+    link_params_t buff_args;
+    buff_args.recv_frame_size = 8000;
+    buff_args.send_frame_size = 8000;
+    buff_args.num_send_frames = 32;
+    buff_args.num_recv_frames = 32;
+    const std::string dst_ip  = get_ipv4_addr(0);
+
+    std::vector<udp_dpdk_link::sptr> links;
+    std::vector<dpdk_io_service::sptr> io_srvs;
+    std::vector<mock_send_transport::sptr> tx_strm;
+    std::vector<mock_recv_transport::sptr> rx_strm;
+    std::vector<send_io_if::sptr> raw_tx;
+    for (size_t i = 0; i < num_links; i++) {
+        // Each link sends to its own UDP port on the local address
+        const std::string udp_port = std::to_string(48888 + i);
+        auto link = udp_dpdk_link::make(0, dst_ip, udp_port, udp_port, buff_args);
+        auto io_srv = ctx->get_least_loaded_io_service(0);
+        io_srv->attach_send_link(link);
+        io_srv->attach_recv_link(link);
+        std::cout << "Link " << i << ": UDP port " << udp_port << " on DMA queue "
+                  << link->get_queue_id() << std::endl;
+        if (tx_only) {
+            raw_tx.push_back(io_srv->make_send_client(link,
+                buff_args.num_send_frames,
+                [](frame_buff::uptr buff, send_link_if* send_link) {
+                    send_link->release_send_buff(std::move(buff));
+                },
+                nullptr,
+                0,
+                nullptr,
+                nullptr));
+        } else {
+            tx_strm.push_back(std::make_shared<mock_send_transport>(
+                io_srv, link, link, i, i, TX_CREDITS));
+            rx_strm.push_back(std::make_shared<mock_recv_transport>(
+                io_srv, link, link, i, i, TX_CREDITS));
+        }
+        links.push_back(link);
+        io_srvs.push_back(io_srv);
+    }
+
+    const size_t payload_size = 8 * BENCH_SPP;
+    std::vector<uint64_t> tx_pkts(num_links, 0);
+    std::vector<uint64_t> rx_pkts(num_links, 0);
+    std::vector<uint64_t> rx_bytes(num_links, 0);
+    const auto start    = std::chrono::steady_clock::now();
+    const auto end_time = start + std::chrono::duration<double>(duration);
+    while (std::chrono::steady_clock::now() < end_time) {
+        for (size_t i = 0; i < num_links; i++) {
+            if (tx_only) {
+                for (unsigned int pktno = 0; pktno < BURST_SIZE; pktno++) {
+                    auto buff = raw_tx[i]->get_send_buff(0);
+                    if (!buff) {
+                        break;
+                    }
+                    buff->set_packet_size(payload_size);
+                    raw_tx[i]->release_send_buff(std::move(buff));
+                    tx_pkts[i]++;
+                }
+                continue;
+            }
+            for (unsigned int pktno = 0; pktno < BURST_SIZE; pktno++) {
+                auto buff = tx_strm[i]->get_data_buff(0);
+                if (!buff) {
+                    break;
+                }
+                tx_strm[i]->release_data_buff(buff, payload_size / 4);
+                tx_pkts[i]++;
+            }
+            for (unsigned int pktno = 0; pktno < BURST_SIZE; pktno++) {
+                auto buff = rx_strm[i]->get_data_buff(0);
+                if (!buff) {
+                    break;
+                }
+                rx_bytes[i] += buff->packet_size();
+                rx_pkts[i]++;
+                rx_strm[i]->release_data_buff(std::move(buff));
+            }
+        }
+    }
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Benchmark complete\n\n");
+    uint64_t total_tx = 0, total_rx = 0, total_rx_bytes = 0;
+    for (size_t i = 0; i < num_links; i++) {
+        printf("Link %zu: TX %lu packets (%e Gbps), RX %lu packets (%e Gbps)\n",
+            i,
+            tx_pkts[i],
+            tx_pkts[i] * payload_size * 8.0 / 1.0e9 / elapsed,
+            rx_pkts[i],
+            rx_bytes[i] * 8.0 / 1.0e9 / elapsed);
+        total_tx += tx_pkts[i];
+        total_rx += rx_pkts[i];
+        total_rx_bytes += rx_bytes[i];
+    }
+    printf("\nTotal TX Performance = %e packets/s, %e Gbps\n",
+        total_tx / elapsed,
+        total_tx * payload_size * 8.0 / 1.0e9 / elapsed);
+    printf("Total RX Performance = %e packets/s, %e Gbps\n",
+        total_rx / elapsed,
+        total_rx_bytes * 8.0 / 1.0e9 / elapsed);
+
+    // Tear down in reverse order of creation
+    raw_tx.clear();
+    rx_strm.clear();
+    tx_strm.clear();
+    for (size_t i = 0; i < num_links; i++) {
+        io_srvs[i]->detach_recv_link(links[i]);
+        io_srvs[i]->detach_send_link(links[i]);
+    }
+}
+
 int main(int argc, char** argv)
 {
     int retval, user0_cpu = 0, user1_cpu = 2;
     int status = 0;
     std::string args;
     std::string cpusets;
+    size_t num_links;
+    double duration;
     po::options_description desc("Allowed options");
     desc.add_options()("help", "help message")(
         "args", po::value<std::string>(&args)->default_value(""), "UHD-DPDK args")(
         "polling-mode", "Use polling mode (single thread on own core)")("cpusets",
         po::value<std::string>(&cpusets)->default_value(""),
         "which core(s) to use for a given thread in blocking mode (specify something "
-        "like \"user0=0,user1=2\")");
+        "like \"user0=0,user1=2\")")("throughput",
+        "Stream over multiple links on port 0 (may be a virtual device)")("num-links",
+        po::value<size_t>(&num_links)->default_value(4),
+        "number of links for the throughput benchmark")("duration",
+        po::value<double>(&duration)->default_value(10.0),
+        "duration of the throughput benchmark in seconds")(
+        "tx-only", "Only measure TX in the throughput benchmark (e.g., for net_null)");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -344,7 +488,9 @@ int main(int argc, char** argv)
     auto ctx = uhd::transport::dpdk::dpdk_ctx::get();
     ctx->init(args);
 
-    if (vm.count("polling-mode")) {
+    if (vm.count("throughput")) {
+        prepare_and_bench_throughput(num_links, duration, vm.count("tx-only") > 0);
+    } else if (vm.count("polling-mode")) {
         prepare_and_bench_polling();
     } /*else {
         pthread_cond_t cond;
@@ -10,8 +10,11 @@
 #include <uhdlib/experts/expert_factory.hpp>
 #include <boost/format.hpp>
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
 
 using namespace uhd::experts;
 
@@ -265,3 +268,206 @@ BOOST_AUTO_TEST_CASE(test_experts)
     container->resolve_to("Consume_G");
     VALIDATE_ALL_DEPENDENCIES
 }
+
+//=============================================================================
+
+// out = in1 * scale + in2, and count how often the worker ran
+class scale_worker_t : public worker_node_t
+{
+public:
+    scale_worker_t(const node_retriever_t& db,
+        const std::string& in1,
+        const std::string& in2,
+        const std::string& out,
+        const int scale,
+        std::shared_ptr<std::atomic<int>> count)
+        : worker_node_t(out + "=" + in1 + "*" + std::to_string(scale) + "+" + in2)
+        , _in1(db, in1)
+        , _in2(db, in2)
+        , _out(db, out)
+        , _scale(scale)
+        , _count(count)
+    {
+        bind_accessor(_in1);
+        bind_accessor(_in2);
+        bind_accessor(_out);
+    }
+
+private:
+    void resolve()
+    {
+        if (_in1.get() < 0) {
+            throw std::runtime_error("negative input");
+        }
+        _out = _in1.get() * _scale + _in2.get();
+        (*_count)++;
+    }
+
+    data_reader_t<int> _in1;
+    data_reader_t<int> _in2;
+    data_writer_t<int> _out;
+    const int _scale;
+    std::shared_ptr<std::atomic<int>> _count;
+};
+
+/*! Build a graph with a similar shape as the TwinRX one: Per channel, two
+ * inputs feed three independent workers, two of which feed a fourth one. The
+ * outputs of all channels are combined by a final worker.
+ */
+static expert_container::sptr make_channel_graph(const size_t num_channels,
+    const size_t num_threads,
+    std::shared_ptr<std::atomic<int>> count)
+{
+    expert_container::sptr container =
+        expert_factory::create_container("channels", num_threads);
+    for (size_t i = 0; i < num_channels; i++) {
+        const std::string ch = "ch" + std::to_string(i) + "/";
+        for (const char* name : {"freq", "gain", "lo1", "lo2", "atten", "tune"}) {
+            expert_factory::add_data_node<int>(container, ch + name, 0);
+        }
+        const node_retriever_t& db = container->node_retriever();
+        expert_factory::add_worker_node<scale_worker_t>(
+            container, db, ch + "freq", ch + "gain", ch + "lo1", 2, count);
+        expert_factory::add_worker_node<scale_worker_t>(
+            container, db, ch + "freq", ch + "gain", ch + "lo2", 3, count);
+        expert_factory::add_worker_node<scale_worker_t>(
+            container, db, ch + "gain", ch + "freq", ch + "atten", 5, count);
+        expert_factory::add_worker_node<scale_worker_t>(
+            container, db, ch + "lo1", ch + "lo2", ch + "tune", 7, count);
+    }
+    expert_factory::add_data_node<int>(container, "sum", 0);
+    for (size_t i = 1; i < num_channels; i++) {
+        const std::string in  = (i == 1) ? "ch0/tune" : "sum" + std::to_string(i - 1);
+        const std::string out =
+            (i == num_channels - 1) ? "sum" : "sum" + std::to_string(i);
+        if (out != "sum") {
+            expert_factory::add_data_node<int>(container, out, 0);
+        }
+        expert_factory::add_worker_node<scale_worker_t>(container,
+            container->node_retriever(),
+            "ch" + std::to_string(i) + "/tune",
+            in,
+            out,
+            1,
+            count);
+    }
+    return container;
+}
+
+static data_node_t<int>& get_node(
+    expert_container::sptr container, const std::string& name)
+{
+    return *(const_cast<data_node_t<int>*>(dynamic_cast<const data_node_t<int>*>(
+        &container->node_retriever().lookup(name))));
+}
+
+static int expected_tune(const int freq, const int gain)
+{
+    return (freq * 2 + gain) * 7 + (freq * 3 + gain);
+}
+
+BOOST_AUTO_TEST_CASE(test_experts_incremental)
+{
+    auto count = std::make_shared<std::atomic<int>>(0);
+    expert_container::sptr container = make_channel_graph(2, 0, count);
+    container->resolve_all();
+    BOOST_CHECK_EQUAL(*count, 9);
+
+    // Nothing is dirty, so nothing must be resolved
+    *count = 0;
+    container->resolve_all();
+    BOOST_CHECK_EQUAL(*count, 0);
+
+    // Only the workers downstream of ch1/freq must run
+    get_node(container, "ch1/freq").set(10);
+    container->resolve_from("ch1/freq");
+    BOOST_CHECK_EQUAL(*count, 5);
+    BOOST_CHECK_EQUAL(get_node(container, "ch1/tune").get(), expected_tune(10, 0));
+    BOOST_CHECK_EQUAL(get_node(container, "ch1/atten").get(), 10);
+    BOOST_CHECK_EQUAL(get_node(container, "sum").get(), expected_tune(10, 0));
+    BOOST_CHECK(not get_node(container, "ch1/freq").is_dirty());
+
+    // Writing a value that doesn't change anything must not propagate
+    *count = 0;
+    get_node(container, "ch0/gain").set(0);
+    container->resolve_to("sum");
+    BOOST_CHECK_EQUAL(*count, 0);
+
+    // A forced resolve runs every worker
+    container->resolve_all(true);
+    BOOST_CHECK_EQUAL(*count, 9);
+
+    // Adding nodes after a resolve must update the resolve order
+    expert_factory::add_data_node<int>(container, "total", 0);
+    expert_factory::add_worker_node<scale_worker_t>(
+        container, container->node_retriever(), "sum", "ch0/atten", "total", 2, count);
+    get_node(container, "ch0/gain").set(1);
+    *count = 0;
+    container->resolve_all();
+    BOOST_CHECK_EQUAL(*count, 6);
+    BOOST_CHECK_EQUAL(get_node(container, "total").get(),
+        (expected_tune(0, 1) + expected_tune(10, 0)) * 2 + 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_experts_parallel)
+{
+    constexpr size_t NUM_CHANNELS = 8;
+    auto serial_count             = std::make_shared<std::atomic<int>>(0);
+    auto parallel_count           = std::make_shared<std::atomic<int>>(0);
+    expert_container::sptr serial   = make_channel_graph(NUM_CHANNELS, 1, serial_count);
+    expert_container::sptr parallel = make_channel_graph(NUM_CHANNELS, 4, parallel_count);
+
+    serial->resolve_all();
+    parallel->resolve_all();
+    for (int iter = 1; iter < 20; iter++) {
+        for (size_t i = 0; i < NUM_CHANNELS; i += (iter % 3) + 1) {
+            const std::string ch = "ch" + std::to_string(i) + "/";
+            for (auto container : {serial, parallel}) {
+                get_node(container, ch + "freq").set(iter * 100 + int(i));
+                get_node(container, ch + "gain").set(iter + int(i));
+            }
+        }
+        serial->resolve_all();
+        parallel->resolve_all();
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            const std::string ch = "ch" + std::to_string(i) + "/";
+            for (const char* name : {"lo1", "lo2", "atten", "tune"}) {
+                BOOST_CHECK_EQUAL(get_node(serial, ch + name).get(),
+                    get_node(parallel, ch + name).get());
+            }
+        }
+        BOOST_CHECK_EQUAL(get_node(serial, "sum").get(), get_node(parallel, "sum").get());
+    }
+    BOOST_CHECK_EQUAL(*serial_count, *parallel_count);
+
+    // Exceptions from workers must reach the caller
+    get_node(parallel, "ch3/freq").set(-1);
+    BOOST_CHECK_THROW(parallel->resolve_all(), std::runtime_error);
+    get_node(parallel, "ch3/freq").set(1);
+    get_node(parallel, "ch3/gain").set(2);
+    parallel->resolve_all();
+    BOOST_CHECK_EQUAL(get_node(parallel, "ch3/tune").get(), expected_tune(1, 2));
+}
+
+BOOST_AUTO_TEST_CASE(test_experts_resolve_latency)
+{
+    // This is not a pass/fail test, it only reports the time it takes to
+    // resolve a graph of the size of a TwinRX one after a single change
+    auto count = std::make_shared<std::atomic<int>>(0);
+    for (size_t num_threads : {1, 2}) {
+        expert_container::sptr container = make_channel_graph(2, num_threads, count);
+        container->resolve_all();
+        constexpr int NUM_ITERS = 10000;
+        const auto start        = std::chrono::steady_clock::now();
+        for (int i = 1; i <= NUM_ITERS; i++) {
+            get_node(container, "ch0/freq").set(i);
+            container->resolve_from("ch0/freq");
+        }
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        BOOST_TEST_MESSAGE(str(boost::format("%d thread(s): %.2f us per resolve")
+                               % num_threads % (elapsed.count() / NUM_ITERS * 1e6)));
+        BOOST_CHECK_EQUAL(
+            get_node(container, "ch0/tune").get(), expected_tune(NUM_ITERS, 0));
+    }
+}
@@ -0,0 +1,170 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/usrp/gps_ctrl.hpp>
+#include <boost/format.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace uhd;
+
+namespace {
+
+//! UART of a GPSDO that identifies itself, and then sends what it's told to
+class mock_gpsdo_uart : public uart_iface
+{
+public:
+    void write_uart(const std::string& buf)
+    {
+        if (buf == "*IDN?\r\n") {
+            push("FireFly-IIA,Mock GPSDO\r\n");
+        }
+    }
+
+    std::string read_uart(double timeout)
+    {
+        num_reads++;
+        const auto exit_time =
+            std::chrono::steady_clock::now()
+            + std::chrono::microseconds(int64_t(timeout * 1e6));
+        do {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (not _lines.empty()) {
+                    const std::string line = _lines.front();
+                    _lines.pop_front();
+                    return line;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } while (std::chrono::steady_clock::now() < exit_time);
+        return "";
+    }
+
+    void push(const std::string& line)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lines.push_back(line);
+    }
+
+    //! Send an NMEA sentence, with checksum
+    void push_nmea(const std::string& body)
+    {
+        uint8_t checksum = 0;
+        for (const char ch : body) {
+            checksum ^= uint8_t(ch);
+        }
+        push(str(boost::format("$%s*%02X\r\n") % body % int(checksum)));
+    }
+
+    //! Send the sentences that follow the PPS edge at 12:34:<sec> on 2020-05-17
+    void push_pps(const int sec, const bool locked = true)
+    {
+        const std::string time = str(boost::format("1234%02d.00") % sec);
+        push_nmea("GPGGA," + time + ",3000.0000,N,09700.0000,W," + (locked ? "1" : "0")
+                  + ",08,1.0,200.0,M,-20.0,M,,");
+        push_nmea("GPRMC," + time + ",A,3000.0000,N,09700.0000,W,0.0,0.0,170520,,");
+    }
+
+    std::atomic<size_t> num_reads{0};
+
+private:
+    std::mutex _mutex;
+    std::deque<std::string> _lines;
+};
+
+constexpr int64_t EPOCH_12_34_00 = 1589718840; // 2020-05-17 12:34:00 UTC
+
+//! Read the GPS time while the next PPS sentences arrive
+int64_t get_gps_time(gps_ctrl::sptr gps, mock_gpsdo_uart& uart, const int sec)
+{
+    std::thread pps_thread([&uart, sec]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        uart.push_pps(sec);
+    });
+    const int64_t gps_time = gps->get_sensor("gps_time").to_int();
+    pps_thread.join();
+    return gps_time;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_gps_ctrl_sensors)
+{
+    auto uart = std::make_shared<mock_gpsdo_uart>();
+    auto gps  = gps_ctrl::make(uart);
+    BOOST_REQUIRE(gps->gps_detected());
+
+    uart->push("garbage\r\n");
+    uart->push("$GPGGA,bad,checksum*00\r\n");
+    uart->push_nmea("GPGSV,3,1,12");
+    uart->push("20-05-17 12:34:05 -5.0E-12 1 2 3\r\n");
+    uart->push_pps(5);
+
+    // The first read waits for the reader to pick up the sentences, all
+    // others come from the cache
+    BOOST_CHECK(gps->get_sensor("gps_locked").to_bool());
+    BOOST_CHECK(gps->get_sensor("gps_gpgga").value.find("$GPGGA,123405.00") == 0);
+    BOOST_CHECK(gps->get_sensor("gps_gprmc").value.find("$GPRMC,123405.00") == 0);
+    BOOST_CHECK_EQUAL(
+        gps->get_sensor("gps_servo").value, "20-05-17 12:34:05 -5.0E-12 1 2 3");
+    BOOST_CHECK_THROW(gps->get_sensor("gps_foo"), uhd::value_error);
+
+    // The reader picks up new sentences within a second, even if nobody waits
+    // for them
+    uart->push_pps(6, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    BOOST_CHECK(not gps->get_sensor("gps_locked").to_bool());
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_ctrl_time)
+{
+    auto uart = std::make_shared<mock_gpsdo_uart>();
+    auto gps  = gps_ctrl::make(uart);
+    BOOST_REQUIRE(gps->gps_detected());
+
+    // No time yet, so the query times out
+    BOOST_CHECK_THROW(gps->get_sensor("gps_time"), uhd::value_error);
+
+    // The query waits for the next sentence, and doesn't use the one that
+    // was sent before, even if it is recent
+    BOOST_CHECK_EQUAL(get_gps_time(gps, *uart, 10), EPOCH_12_34_00 + 10);
+    BOOST_CHECK_EQUAL(get_gps_time(gps, *uart, 11), EPOCH_12_34_00 + 11);
+    uart->push_pps(12);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK_EQUAL(get_gps_time(gps, *uart, 13), EPOCH_12_34_00 + 13);
+
+    // Without lock, there's no valid time
+    std::thread pps_thread([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        uart->push_nmea("GPRMC,,V,,,,,,,,,");
+    });
+    BOOST_CHECK_THROW(gps->get_sensor("gps_time"), uhd::value_error);
+    pps_thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_ctrl_idle)
+{
+    auto uart = std::make_shared<mock_gpsdo_uart>();
+    auto gps  = gps_ctrl::make(uart);
+    BOOST_REQUIRE(gps->gps_detected());
+
+    // While nobody reads a sensor, the UART is polled much less often than
+    // while a read waits for a sentence
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    size_t num_reads = uart->num_reads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const size_t num_idle_reads = uart->num_reads - num_reads;
+
+    num_reads = uart->num_reads;
+    BOOST_CHECK_EQUAL(get_gps_time(gps, *uart, 20), EPOCH_12_34_00 + 20);
+    BOOST_CHECK_GT(uart->num_reads - num_reads, num_idle_reads);
+}
@@ -0,0 +1,157 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/image_loader.hpp>
+#include <uhdlib/usrp/common/image_loader_console.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::string FAKE_TYPE = "image_loader_test";
+
+std::atomic<size_t> num_active{0};
+std::atomic<size_t> max_active{0};
+
+/*! Loader for devices of type FAKE_TYPE
+ *
+ * It takes "sleep_ms" milliseconds to load an image. Devices with "fail" set
+ * are not applicable, devices with "throw" set make it throw.
+ */
+bool fake_loader(const uhd::image_loader::image_loader_args_t& args)
+{
+    const size_t active = ++num_active;
+    size_t prev_max     = max_active;
+    while (active > prev_max && !max_active.compare_exchange_weak(prev_max, active)) {
+    }
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(args.args.cast<int>("sleep_ms", 0)));
+    --num_active;
+
+    if (args.args.has_key("throw")) {
+        throw uhd::runtime_error("Failed to load " + args.args["name"]);
+    }
+    return !args.args.has_key("fail");
+}
+
+std::vector<uhd::image_loader::image_loader_args_t> make_args(
+    const std::vector<std::string>& device_args)
+{
+    static bool registered = false;
+    if (!registered) {
+        uhd::image_loader::register_image_loader(FAKE_TYPE, &fake_loader, "");
+        registered = true;
+    }
+    num_active = 0;
+    max_active = 0;
+
+    std::vector<uhd::image_loader::image_loader_args_t> all_args;
+    for (const auto& args : device_args) {
+        uhd::image_loader::image_loader_args_t image_loader_args;
+        image_loader_args.args          = uhd::device_addr_t(args);
+        image_loader_args.args["type"]  = FAKE_TYPE;
+        image_loader_args.load_firmware = false;
+        image_loader_args.load_fpga     = true;
+        image_loader_args.download      = false;
+        all_args.push_back(image_loader_args);
+    }
+    return all_args;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_image_loader_max_concurrent)
+{
+    const auto all_args = make_args(std::vector<std::string>(6, "sleep_ms=50"));
+
+    auto results = uhd::image_loader::load(all_args, 2);
+    BOOST_REQUIRE_EQUAL(results.size(), all_args.size());
+    for (const auto& result : results) {
+        BOOST_CHECK(result.success);
+        BOOST_CHECK(result.error.empty());
+    }
+    BOOST_CHECK_EQUAL(max_active.load(), 2);
+
+    max_active = 0;
+    results    = uhd::image_loader::load(all_args, 1);
+    BOOST_CHECK_EQUAL(max_active.load(), 1);
+
+    // A limit of 0, or one above the number of devices, loads them all at once
+    max_active = 0;
+    results    = uhd::image_loader::load(all_args, 0);
+    BOOST_CHECK_EQUAL(max_active.load(), all_args.size());
+    max_active = 0;
+    results    = uhd::image_loader::load(all_args, 10);
+    BOOST_CHECK_EQUAL(max_active.load(), all_args.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_image_loader_result_order)
+{
+    // The later devices finish first, but the results follow the arguments
+    const auto all_args = make_args({"name=dev0,sleep_ms=60",
+        "name=dev1,sleep_ms=40,fail=1",
+        "name=dev2,sleep_ms=20,throw=1",
+        "name=dev3"});
+
+    const auto results = uhd::image_loader::load(all_args, 0);
+    BOOST_REQUIRE_EQUAL(results.size(), 4);
+    BOOST_CHECK(results[0].success);
+    BOOST_CHECK(results[0].error.empty());
+    BOOST_CHECK(!results[1].success);
+    BOOST_CHECK(results[1].error.empty());
+    BOOST_CHECK(!results[2].success);
+    BOOST_CHECK(results[2].error.find("Failed to load dev2") != std::string::npos);
+    BOOST_CHECK(results[3].success);
+    BOOST_CHECK(results[3].error.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_image_loader_errors)
+{
+    // An exception only fails its own device, and the others still get loaded
+    // when they share a thread with it
+    const auto all_args = make_args({"name=dev0,throw=1", "name=dev1", "name=dev2"});
+    const auto results  = uhd::image_loader::load(all_args, 1);
+    BOOST_REQUIRE_EQUAL(results.size(), 3);
+    BOOST_CHECK(!results[0].success);
+    BOOST_CHECK(results[0].error.find("Failed to load dev0") != std::string::npos);
+    BOOST_CHECK(results[1].success);
+    BOOST_CHECK(results[2].success);
+
+    // Unknown device types are reported like any other error
+    auto unknown_args            = all_args;
+    unknown_args[1].args["type"] = "no_such_type";
+    const auto unknown_results   = uhd::image_loader::load(unknown_args, 0);
+    BOOST_CHECK(!unknown_results[1].success);
+    BOOST_CHECK(unknown_results[1].error.find("no_such_type") != std::string::npos);
+
+    BOOST_CHECK(uhd::image_loader::load({}, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_image_loader_console)
+{
+    // Output is passed on line by line, and only the last state of a line
+    // that is overwritten with "\r" is kept
+    std::vector<std::string> lines;
+    {
+        uhd::usrp::image_loader_console console(
+            [&lines](const std::string& line) { lines.push_back(line); });
+        console << "-- Initializing..." << std::flush;
+        BOOST_CHECK(lines.empty());
+        console << "successful." << std::endl;
+        console << "\r-- Loading: 10%" << std::flush << "\r-- Loading: 100%" << std::endl;
+        console << "-- Finalizing..." << std::flush;
+    }
+    // An incomplete line is passed on when the console goes away
+    const std::vector<std::string> expected = {
+        "-- Initializing...successful.", "-- Loading: 100%", "-- Finalizing..."};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        lines.begin(), lines.end(), expected.begin(), expected.end());
+}
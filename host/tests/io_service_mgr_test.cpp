@@ -0,0 +1,156 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "common/mock_link.hpp"
+#include <uhdlib/usrp/common/io_service_mgr.hpp>
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+using namespace uhd::transport;
+using namespace uhd::usrp;
+
+namespace {
+
+constexpr size_t FRAME_SIZE = 1000;
+constexpr size_t NUM_FRAMES = 4;
+
+struct links_t
+{
+    mock_recv_link::sptr recv_link;
+    mock_send_link::sptr send_link;
+};
+
+links_t make_links()
+{
+    return {std::make_shared<mock_recv_link>(
+                mock_recv_link::link_params{FRAME_SIZE, NUM_FRAMES}),
+        std::make_shared<mock_send_link>(
+            mock_send_link::link_params{FRAME_SIZE, NUM_FRAMES})};
+}
+
+//! Connects RX data links to polling offload threads with a given load
+class poll_mgr_fixture
+{
+public:
+    poll_mgr_fixture(const size_t num_threads = 2)
+        : mgr(io_service_mgr::make(uhd::device_addr_t()))
+    {
+        default_args.recv_offload             = true;
+        default_args.recv_offload_wait_mode   = io_service_args_t::POLL;
+        default_args.num_poll_offload_threads = num_threads;
+    }
+
+    io_service::sptr connect(const links_t& links, const double load)
+    {
+        uhd::device_addr_t stream_args;
+        stream_args["stream_load"] = std::to_string(load);
+        return mgr->connect_links(links.recv_link,
+            links.send_link,
+            link_type_t::RX_DATA,
+            default_args,
+            stream_args,
+            "streamer");
+    }
+
+    void disconnect(const links_t& links)
+    {
+        mgr->disconnect_links(links.recv_link, links.send_link);
+    }
+
+    io_service_mgr::sptr mgr;
+    io_service_args_t default_args;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(test_polling_placement_by_load, poll_mgr_fixture)
+{
+    const auto a = make_links(), b = make_links(), c = make_links(), d = make_links(),
+               e = make_links();
+
+    // The first connections each get a thread of their own
+    auto io_srv0 = connect(a, 100e6);
+    auto io_srv1 = connect(b, 90e6);
+    BOOST_CHECK(io_srv0 != io_srv1);
+
+    // Then, the thread with the lowest load is picked
+    BOOST_CHECK(connect(c, 30e6) == io_srv1);
+    BOOST_CHECK(connect(d, 1e6) == io_srv0);
+
+    // Disconnecting removes the load of the stream from its thread:
+    // io_srv1 is down to 30 MB/s, io_srv0 is at 101 MB/s
+    disconnect(b);
+    BOOST_CHECK(connect(e, 1e6) == io_srv1);
+
+    for (const auto& links : {a, c, d, e}) {
+        disconnect(links);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_polling_placement_by_count, poll_mgr_fixture)
+{
+    const auto a = make_links(), b = make_links(), c = make_links(), d = make_links(),
+               e = make_links();
+
+    // Without a known load, the connection count decides
+    auto io_srv0 = connect(a, 0.0);
+    auto io_srv1 = connect(b, 0.0);
+    BOOST_CHECK(io_srv0 != io_srv1);
+    auto io_srv_c = connect(c, 0.0);
+    auto io_srv_d = connect(d, 0.0);
+    BOOST_CHECK(io_srv_c != io_srv_d);
+    BOOST_CHECK(io_srv_c == io_srv0 || io_srv_c == io_srv1);
+    BOOST_CHECK(io_srv_d == io_srv0 || io_srv_d == io_srv1);
+
+    // Disconnecting removes the connection from the count
+    disconnect(c);
+    BOOST_CHECK(connect(e, 0.0) == io_srv_c);
+
+    for (const auto& links : {a, b, d, e}) {
+        disconnect(links);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_polling_muxed_links, poll_mgr_fixture)
+{
+    const auto a = make_links(), muxed = make_links(), b = make_links(),
+               c = make_links();
+
+    auto io_srv0 = connect(a, 50e6);
+    auto io_srv1 = connect(muxed, 40e6);
+    // Muxed links stay on their thread, and add their load to it
+    BOOST_CHECK(connect(muxed, 40e6) == io_srv1);
+    BOOST_CHECK(connect(b, 1e6) == io_srv0);
+
+    // Every disconnect of a muxed link removes an equal share of its load,
+    // so io_srv1 is down to 40 MB/s, io_srv0 is at 51 MB/s
+    disconnect(muxed);
+    BOOST_CHECK(connect(c, 1e6) == io_srv1);
+
+    for (const auto& links : {a, muxed, b, c}) {
+        disconnect(links);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_polling_thread_release, poll_mgr_fixture)
+{
+    const auto a = make_links(), b = make_links(), c = make_links(), d = make_links();
+
+    auto io_srv0 = connect(a, 10e6);
+    auto io_srv1 = connect(b, 20e6);
+    BOOST_CHECK(io_srv0 != io_srv1);
+
+    // Once its last connection is gone, a thread is released, and the next
+    // connection starts a new one even though io_srv1 has capacity
+    disconnect(a);
+    auto io_srv2 = connect(c, 30e6);
+    BOOST_CHECK(io_srv2 != io_srv1);
+    BOOST_CHECK(connect(d, 1e6) == io_srv1);
+
+    for (const auto& links : {b, c, d}) {
+        disconnect(links);
+    }
+}
@@ -0,0 +1,333 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include "rfnoc_graph_mock_nodes.hpp"
+#include <uhd/device.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhdlib/rfnoc/graph.hpp>
+#include <uhdlib/usrp/multi_usrp_utils.hpp>
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::rfnoc;
+using namespace uhd::usrp;
+
+namespace {
+
+const std::string DEVICE_TYPE = "multi_usrp_test";
+
+using spec_t = subdev_spec_t;
+
+/*! Legacy (non-RFNoC) device that consists of nothing but a property tree
+ *
+ * Daughterboard A has two RX and two TX frontends, and motherboard 0 has two RX
+ * and two TX DSPs. The codecs have a fixed gain. The properties of frontend N
+ * have values that identify it, e.g., the antenna of RX frontend 1 is "RX1".
+ */
+class fake_device : public uhd::device
+{
+public:
+    fake_device()
+    {
+        _type = USRP;
+        _tree = property_tree::make();
+
+        const fs_path mb_path = "/mboards/0";
+        _tree->create<std::string>(mb_path / "name").set("Fake Device");
+        _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec").set(spec_t("A:0"));
+        _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec").set(spec_t("A:0"));
+        _tree->create<std::vector<size_t>>(mb_path / "rx_chan_dsp_mapping")
+            .set(std::vector<size_t>{0, 1});
+        _tree->create<std::vector<size_t>>(mb_path / "tx_chan_dsp_mapping")
+            .set(std::vector<size_t>{0, 1});
+        for (const std::string dir : {"rx", "tx"}) {
+            const fs_path codec_gain_path = mb_path / (dir + "_codecs/A/gains/digital");
+            _tree->create<meta_range_t>(codec_gain_path / "range")
+                .set(meta_range_t(0.0, 0.0));
+            _tree->create<double>(codec_gain_path / "value").set(0.0);
+            for (size_t i = 0; i < 2; i++) {
+                _add_frontend(mb_path / "dboards/A" / (dir + "_frontends") / i, dir, i);
+                _add_dsp(mb_path / (dir + "_dsps") / i, dir == "rx", i);
+            }
+        }
+    }
+
+    rx_streamer::sptr get_rx_stream(const stream_args_t&)
+    {
+        throw uhd::not_implemented_error("get_rx_stream()");
+    }
+
+    tx_streamer::sptr get_tx_stream(const stream_args_t&)
+    {
+        throw uhd::not_implemented_error("get_tx_stream()");
+    }
+
+    bool recv_async_msg(async_metadata_t&, double)
+    {
+        return false;
+    }
+
+private:
+    void _add_frontend(const fs_path& root, const std::string& dir, const size_t index)
+    {
+        _tree->create<std::string>(root / "name").set(dir + " frontend");
+        _tree->create<std::string>(root / "antenna/value")
+            .set((dir == "rx" ? "RX" : "TX") + std::to_string(index));
+        _tree->create<std::vector<std::string>>(root / "antenna/options")
+            .set({"RX0", "RX1", "TX0", "TX1"});
+        _tree->create<double>(root / "bandwidth/value").set(10e6 * (index + 1));
+        _tree->create<meta_range_t>(root / "freq/range").set(meta_range_t(0.0, 6e9));
+        _tree->create<double>(root / "freq/value").set(1e9 * (index + 1));
+        _tree->create<meta_range_t>(root / "gains/PGA/range")
+            .set(meta_range_t(0.0, 60.0, 1.0));
+        _tree->create<double>(root / "gains/PGA/value").set(10.0 * (index + 1));
+    }
+
+    void _add_dsp(const fs_path& root, const bool is_rx, const size_t index)
+    {
+        _tree->create<meta_range_t>(root / "rate/range").set(meta_range_t(1e6, 100e6));
+        _tree->create<double>(root / "rate/value").set(1e6 * (index + 1));
+        _tree->create<meta_range_t>(root / "freq/range").set(meta_range_t(-50e6, 50e6));
+        _tree->create<double>(root / "freq/value").set(0.0);
+        if (is_rx) {
+            _tree->create<stream_cmd_t>(root / "stream_cmd");
+        }
+    }
+};
+
+device_addrs_t find_fake_device(const device_addr_t& hint)
+{
+    if (hint.get("type", "") != DEVICE_TYPE) {
+        return {};
+    }
+    return {hint};
+}
+
+device::sptr make_fake_device(const device_addr_t&)
+{
+    return std::make_shared<fake_device>();
+}
+
+struct fake_usrp_fixture
+{
+    fake_usrp_fixture()
+    {
+        static bool registered = false;
+        if (!registered) {
+            device::register_device(&find_fake_device, &make_fake_device, device::USRP);
+            registered = true;
+        }
+        usrp = multi_usrp::make(device_addr_t("type=" + DEVICE_TYPE));
+        tree = usrp->get_tree();
+    }
+
+    multi_usrp::sptr usrp;
+    property_tree::sptr tree;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(test_chan_props_follow_subdev_spec, fake_usrp_fixture)
+{
+    BOOST_REQUIRE_EQUAL(usrp->get_rx_num_channels(), 1);
+    BOOST_CHECK_EQUAL(usrp->get_rx_antenna(0), "RX0");
+    BOOST_CHECK_EQUAL(usrp->get_rx_bandwidth(0), 10e6);
+    BOOST_CHECK_EQUAL(usrp->get_rx_gain(0), 10.0);
+
+    // Changes made through multi_usrp are picked up
+    usrp->set_rx_subdev_spec(spec_t("A:1"), 0);
+    BOOST_CHECK_EQUAL(usrp->get_rx_antenna(0), "RX1");
+    BOOST_CHECK_EQUAL(usrp->get_rx_bandwidth(0), 20e6);
+    BOOST_CHECK_EQUAL(usrp->get_rx_gain(0), 20.0);
+    usrp->set_rx_antenna("RX0", 0);
+    BOOST_CHECK_EQUAL(
+        tree->access<std::string>("/mboards/0/dboards/A/rx_frontends/1/antenna/value")
+            .get(),
+        "RX0");
+
+    // So are changes made straight to the tree
+    tree->access<subdev_spec_t>("/mboards/0/tx_subdev_spec").set(spec_t("A:1 A:0"));
+    BOOST_REQUIRE_EQUAL(usrp->get_tx_num_channels(), 2);
+    BOOST_CHECK_EQUAL(usrp->get_tx_antenna(0), "TX1");
+    BOOST_CHECK_EQUAL(usrp->get_tx_antenna(1), "TX0");
+    usrp->set_tx_gain(42.0, 1);
+    BOOST_CHECK_EQUAL(
+        tree->access<double>("/mboards/0/dboards/A/tx_frontends/0/gains/PGA/value").get(),
+        42.0);
+
+    // The channel to DSP mappings are followed as well
+    BOOST_CHECK_EQUAL(usrp->get_tx_rate(0), 1e6);
+    tree->access<std::vector<size_t>>("/mboards/0/tx_chan_dsp_mapping")
+        .set(std::vector<size_t>{1, 0});
+    BOOST_CHECK_EQUAL(usrp->get_tx_rate(0), 2e6);
+    usrp->set_tx_rate(4e6, 1);
+    BOOST_CHECK_EQUAL(tree->access<double>("/mboards/0/tx_dsps/0/rate/value").get(), 4e6);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_chan_props_missing, fake_usrp_fixture)
+{
+    const fs_path fe_path = "/mboards/0/dboards/A/rx_frontends/0";
+    tree->remove(fe_path / "bandwidth/value");
+    tree->remove(fe_path / "antenna/value");
+    // Drop the cached properties
+    usrp->set_rx_subdev_spec(spec_t("A:0"), 0);
+
+    // Properties that don't exist throw like they did without a cache
+    BOOST_CHECK_THROW(usrp->get_rx_bandwidth(0), uhd::lookup_error);
+    BOOST_CHECK_THROW(usrp->set_rx_bandwidth(1e6, 0), uhd::lookup_error);
+    BOOST_CHECK_THROW(usrp->get_rx_antenna(0), uhd::lookup_error);
+    // The others still work
+    BOOST_CHECK_EQUAL(usrp->get_rx_rate(0), 1e6);
+
+    // Properties that are created later are found in the tree
+    tree->create<double>(fe_path / "bandwidth/value").set(5e6);
+    BOOST_CHECK_EQUAL(usrp->get_rx_bandwidth(0), 5e6);
+
+    // Invalid channels and frontends that don't exist throw as well
+    BOOST_CHECK_THROW(usrp->get_rx_antenna(1), uhd::index_error);
+    BOOST_CHECK_THROW(usrp->get_rx_rate(1), uhd::index_error);
+    usrp->set_rx_subdev_spec(spec_t("A:2"), 0);
+    BOOST_CHECK_THROW(usrp->get_rx_bandwidth(0), uhd::lookup_error);
+
+    // A channel without a frontend doesn't affect the others
+    usrp->set_rx_subdev_spec(spec_t("A:1 A:2"), 0);
+    BOOST_CHECK_EQUAL(usrp->get_rx_antenna(0), "RX1");
+    BOOST_CHECK_THROW(usrp->get_rx_antenna(1), uhd::lookup_error);
+    BOOST_CHECK_EQUAL(usrp->get_rx_gain(0), 20.0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_multi_chan_setters_default, fake_usrp_fixture)
+{
+    usrp->set_rx_subdev_spec(spec_t("A:0 A:1"), 0);
+    usrp->set_tx_subdev_spec(spec_t("A:0 A:1"), 0);
+    const std::vector<size_t> chans{1, 0};
+    const fs_path rx_fe_path = "/mboards/0/dboards/A/rx_frontends";
+    const fs_path tx_fe_path = "/mboards/0/dboards/A/tx_frontends";
+
+    usrp->set_rx_rate(5e6, chans);
+    usrp->set_rx_gain(15.0, "PGA", chans);
+    usrp->set_rx_bandwidth(30e6, chans);
+    const auto rx_results =
+        usrp->set_rx_freq(tune_request_t(2.4e9), std::vector<size_t>{1});
+    BOOST_REQUIRE_EQUAL(rx_results.size(), 1);
+    BOOST_CHECK_EQUAL(rx_results[0].actual_rf_freq, 2.4e9);
+    for (size_t chan = 0; chan < 2; chan++) {
+        BOOST_CHECK_EQUAL(usrp->get_rx_rate(chan), 5e6);
+        BOOST_CHECK_EQUAL(
+            tree->access<double>(rx_fe_path / chan / "gains/PGA/value").get(), 15.0);
+        BOOST_CHECK_EQUAL(usrp->get_rx_bandwidth(chan), 30e6);
+    }
+    BOOST_CHECK_EQUAL(tree->access<double>(rx_fe_path / 0 / "freq/value").get(), 1e9);
+    BOOST_CHECK_EQUAL(tree->access<double>(rx_fe_path / 1 / "freq/value").get(), 2.4e9);
+
+    usrp->set_tx_rate(6e6, chans);
+    usrp->set_tx_gain(25.0, "PGA", chans);
+    usrp->set_tx_bandwidth(40e6, chans);
+    // The results follow the order of the channels
+    const auto tx_results = usrp->set_tx_freq(tune_request_t(900e6, 1e6), chans);
+    BOOST_REQUIRE_EQUAL(tx_results.size(), 2);
+    for (size_t chan = 0; chan < 2; chan++) {
+        BOOST_CHECK_EQUAL(usrp->get_tx_rate(chan), 6e6);
+        BOOST_CHECK_EQUAL(
+            tree->access<double>(tx_fe_path / chan / "gains/PGA/value").get(), 25.0);
+        BOOST_CHECK_EQUAL(usrp->get_tx_bandwidth(chan), 40e6);
+        BOOST_CHECK_EQUAL(tx_results[chan].actual_rf_freq, 901e6);
+    }
+
+    // An invalid channel is caught before any of the channels is changed
+    BOOST_CHECK_THROW(usrp->set_rx_rate(7e6, {0, 2}), uhd::index_error);
+    BOOST_CHECK_THROW(usrp->set_rx_gain(5.0, "PGA", {0, 2}), uhd::index_error);
+    BOOST_CHECK_THROW(usrp->set_tx_freq(tune_request_t(1e9), {0, 2}), uhd::index_error);
+    BOOST_CHECK_THROW(usrp->set_tx_bandwidth(1e6, {0, 2}), uhd::index_error);
+    BOOST_CHECK_EQUAL(usrp->get_rx_rate(0), 5e6);
+    BOOST_CHECK_EQUAL(usrp->get_rx_gain("PGA", 0), 15.0);
+    BOOST_CHECK_EQUAL(usrp->get_tx_freq(0), 900e6);
+    BOOST_CHECK_EQUAL(usrp->get_tx_bandwidth(0), 40e6);
+}
+
+BOOST_AUTO_TEST_CASE(test_for_each_chan_by_radio)
+{
+    std::vector<size_t> visited;
+    auto chan_fn = [&visited](const size_t chan) { visited.push_back(chan); };
+
+    // The channels are grouped by radio, in their order within a radio
+    for_each_chan_by_radio(
+        {{"0/Radio#1", 0}, {"0/Radio#0", 1}, {"0/Radio#1", 2}, {"0/Radio#0", 3}},
+        chan_fn);
+    const std::vector<size_t> expected{1, 3, 0, 2};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        visited.begin(), visited.end(), expected.begin(), expected.end());
+
+    visited.clear();
+    for_each_chan_by_radio({}, chan_fn);
+    BOOST_CHECK(visited.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_for_each_chan_by_radio_exception)
+{
+    std::vector<size_t> visited;
+    auto chan_fn = [&visited](const size_t chan) {
+        visited.push_back(chan);
+        if (chan == 3) {
+            throw uhd::value_error("Invalid setting for channel 3");
+        }
+    };
+
+    BOOST_CHECK_THROW(
+        for_each_chan_by_radio(
+            {{"0/Radio#0", 1}, {"0/Radio#0", 3}, {"0/Radio#1", 0}}, chan_fn),
+        uhd::value_error);
+    // The channels after the failing one are skipped
+    const std::vector<size_t> expected{1, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        visited.begin(), visited.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_for_each_chan_by_radio_readback)
+{
+    // Two channels, each a DDC between two radios
+    node_accessor_t node_accessor{};
+    detail::graph_t graph{};
+    std::vector<std::unique_ptr<mock_radio_node_t>> rx_radios, tx_radios;
+    std::vector<std::unique_ptr<mock_ddc_node_t>> ddcs;
+    detail::graph_t::graph_edge_t edge_info;
+    edge_info.src_port                    = 0;
+    edge_info.dst_port                    = 0;
+    edge_info.property_propagation_active = true;
+    edge_info.edge                        = detail::graph_t::graph_edge_t::DYNAMIC;
+    for (size_t chan = 0; chan < 2; chan++) {
+        rx_radios.emplace_back(new mock_radio_node_t(2 * chan));
+        tx_radios.emplace_back(new mock_radio_node_t(2 * chan + 1));
+        ddcs.emplace_back(new mock_ddc_node_t());
+        node_accessor.init_props(rx_radios.back().get());
+        node_accessor.init_props(tx_radios.back().get());
+        node_accessor.init_props(ddcs.back().get());
+        graph.connect(rx_radios.back().get(), ddcs.back().get(), edge_info);
+        graph.connect(ddcs.back().get(), tx_radios.back().get(), edge_info);
+    }
+    graph.commit();
+    BOOST_REQUIRE_EQUAL(ddcs[0]->_decim.get(), 1);
+    BOOST_REQUIRE_EQUAL(ddcs[1]->_decim.get(), 1);
+
+    // Values read back while the channels are configured are already resolved
+    // through the graph
+    std::vector<int> decims;
+    for_each_chan_by_radio({{"0/Radio#1", 1}, {"0/Radio#0", 0}}, [&](const size_t chan) {
+        tx_radios[chan]->set_property<double>("master_clock_rate", 100e6, 0);
+        decims.push_back(ddcs[chan]->_decim.get());
+    });
+    const std::vector<int> expected{2, 2};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        decims.begin(), decims.end(), expected.begin(), expected.end());
+}
@@ -114,7 +114,8 @@ public:
         recv_link_if::sptr /*recv_link*/,
         size_t /*num_recv_frames*/,
         recv_callback_t /*recv_cb*/,
-        send_io_if::fc_callback_t /*fc_cb*/)
+        send_io_if::fc_callback_t /*fc_cb*/,
+        const recv_route_t& /*recv_route*/ = recv_route_t())
     {
         return std::make_shared<mock_send_io>(send_link);
     }
@@ -124,7 +125,8 @@ public:
         recv_callback_t /*cb*/,
         send_link_if::sptr /*fc_link*/,
         size_t /*num_send_frames*/,
-        recv_io_if::fc_callback_t /*fc_cb*/)
+        recv_io_if::fc_callback_t /*fc_cb*/,
+        const recv_route_t& /*recv_route*/ = recv_route_t())
     {
         auto io = std::make_shared<mock_recv_io>(recv_link);
         _recv_io.push_back(io);
@@ -0,0 +1,596 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/defaults.hpp>
+#include <uhd/rfnoc/mock_block.hpp>
+#include <uhd/rfnoc/replay_block_control.hpp>
+#include <uhd/utils/replay_utils.hpp>
+#include <uhdlib/rfnoc/node_accessor.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace uhd::rfnoc;
+
+// Redeclare this here, since it's only defined outside of UHD_API
+noc_block_base::make_args_t::~make_args_t() = default;
+
+namespace {
+
+constexpr size_t NUM_PORTS     = 4;
+constexpr size_t MEM_ADDR_SIZE = 20;
+constexpr size_t WORD_SIZE     = 8; // bytes
+constexpr size_t MEM_SIZE      = 1 << MEM_ADDR_SIZE;
+constexpr size_t DEFAULT_MTU   = 8000;
+constexpr uint8_t FILL_BYTE    = 0xAA;
+
+/*! Register interface and memory of a Replay block
+ *
+ * Record fullness is reset by a record restart (except on \p stale_port), and
+ * advanced by the mock TX streamers. The upload/download helpers access the
+ * block from several threads, so all register accesses are serialized.
+ */
+class replay_mem_reg_iface_t : public mock_reg_iface_t
+{
+public:
+    replay_mem_reg_iface_t() : memory(MEM_SIZE, FILL_BYTE)
+    {
+        for (size_t port = 0; port < NUM_PORTS; port++) {
+            read_memory[get_addr(replay_block_control::REG_COMPAT_ADDR, port)] =
+                replay_block_control::MINOR_COMPAT
+                | (replay_block_control::MAJOR_COMPAT << 16);
+            read_memory[get_addr(replay_block_control::REG_MEM_SIZE_ADDR, port)] =
+                MEM_ADDR_SIZE | ((WORD_SIZE * 8) << 16);
+            _set_fullness(port, 0);
+        }
+    }
+
+    void poke32(uint32_t addr, uint32_t data, uhd::time_spec_t time, bool ack)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        mock_reg_iface_t::poke32(addr, data, time, ack);
+    }
+
+    uint32_t peek32(uint32_t addr, uhd::time_spec_t time)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        return mock_reg_iface_t::peek32(addr, time);
+    }
+
+    //! Return the record fullness of a port and advance it by \p num_bytes
+    uint64_t add_fullness(const size_t port, const size_t num_bytes)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        const uint32_t addr =
+            get_addr(replay_block_control::REG_REC_FULLNESS_LO_ADDR, port);
+        const uint64_t fullness =
+            read_memory.at(addr) | (uint64_t(read_memory.at(addr + 4)) << 32);
+        _set_fullness(port, fullness + num_bytes);
+        return fullness;
+    }
+
+    static uint32_t get_addr(const uint32_t offset, const size_t port)
+    {
+        return offset + port * replay_block_control::REPLAY_BLOCK_OFFSET;
+    }
+
+    std::vector<uint8_t> memory;
+    //! Port that keeps receiving data after a record restart
+    size_t stale_port = NUM_PORTS;
+
+protected:
+    void _poke_cb(uint32_t addr, uint32_t, uhd::time_spec_t, bool)
+    {
+        for (size_t port = 0; port < NUM_PORTS; port++) {
+            if (addr == get_addr(replay_block_control::REG_REC_RESTART_ADDR, port)) {
+                _set_fullness(port, port == stale_port ? WORD_SIZE : 0);
+            }
+        }
+    }
+
+private:
+    void _set_fullness(const size_t port, const uint64_t fullness)
+    {
+        const uint32_t addr =
+            get_addr(replay_block_control::REG_REC_FULLNESS_LO_ADDR, port);
+        read_memory[addr]     = uint32_t(fullness);
+        read_memory[addr + 4] = uint32_t(fullness >> 32);
+    }
+
+    std::mutex _mutex;
+};
+
+using reg_iface_sptr = std::shared_ptr<replay_mem_reg_iface_t>;
+
+//! TX streamer that records into the Replay memory of the port it's connected to
+class mock_replay_tx_streamer : public uhd::tx_streamer
+{
+public:
+    mock_replay_tx_streamer(
+        replay_block_control::sptr replay, reg_iface_sptr reg_iface, const size_t spp)
+        : _replay(replay), _reg_iface(reg_iface), _spp(spp)
+    {
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return 1;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return _spp;
+    }
+
+    size_t send(const buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t&,
+        const double)
+    {
+        // Called from the worker threads, so no Boost.Test assertions here
+        if (_port < 0) {
+            throw uhd::runtime_error("Streamer is not connected");
+        }
+        const size_t num_bytes  = nsamps_per_buff * 4;
+        const uint64_t fullness = _reg_iface->add_fullness(_port, num_bytes);
+        if (fullness + num_bytes > _replay->get_record_size(_port)) {
+            throw uhd::runtime_error("Record buffer overflow");
+        }
+        std::memcpy(_reg_iface->memory.data() + _replay->get_record_offset(_port)
+                        + fullness,
+            buffs[0],
+            num_bytes);
+        return nsamps_per_buff;
+    }
+
+    bool recv_async_msg(uhd::async_metadata_t&, double)
+    {
+        return false;
+    }
+
+    int _port = -1;
+
+private:
+    replay_block_control::sptr _replay;
+    reg_iface_sptr _reg_iface;
+    const size_t _spp;
+};
+
+//! RX streamer that plays back from the Replay memory of the port it's connected to
+class mock_replay_rx_streamer : public uhd::rx_streamer
+{
+public:
+    mock_replay_rx_streamer(replay_block_control::sptr replay, reg_iface_sptr reg_iface)
+        : _replay(replay), _reg_iface(reg_iface)
+    {
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return 1;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return 1000;
+    }
+
+    size_t recv(const buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t& metadata,
+        const double,
+        const bool)
+    {
+        if (_port < 0) {
+            throw uhd::runtime_error("Streamer is not connected");
+        }
+        const uint64_t play_size = _replay->get_play_size(_port);
+        const size_t num_bytes =
+            std::min<uint64_t>(nsamps_per_buff * 4, play_size - _bytes_played);
+        if (num_bytes == 0) {
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        std::memcpy(buffs[0],
+            _reg_iface->memory.data() + _replay->get_play_offset(_port) + _bytes_played,
+            num_bytes);
+        _bytes_played += num_bytes;
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+        return num_bytes / 4;
+    }
+
+    void issue_stream_cmd(const uhd::stream_cmd_t&) {}
+
+    int _port = -1;
+
+private:
+    replay_block_control::sptr _replay;
+    reg_iface_sptr _reg_iface;
+    uint64_t _bytes_played = 0;
+};
+
+/*! Graph that only knows how to stream to and from a single Replay block
+ *
+ * Everything the helpers don't use throws.
+ */
+class mock_replay_graph : public rfnoc_graph
+{
+public:
+    mock_replay_graph(replay_block_control::sptr replay, reg_iface_sptr reg_iface)
+        : _replay(replay), _reg_iface(reg_iface)
+    {
+    }
+
+    std::vector<block_id_t> find_blocks(const std::string&) const
+    {
+        return {_replay->get_block_id()};
+    }
+
+    bool has_block(const block_id_t& block_id) const
+    {
+        return block_id == _replay->get_block_id();
+    }
+
+    noc_block_base::sptr get_block(const block_id_t& block_id) const
+    {
+        if (!has_block(block_id)) {
+            throw uhd::lookup_error("No such block: " + block_id.to_string());
+        }
+        return _replay;
+    }
+
+    bool is_connectable(const block_id_t&, size_t, const block_id_t&, size_t)
+    {
+        return false;
+    }
+
+    void connect(const block_id_t&, size_t, const block_id_t&, size_t, bool)
+    {
+        throw uhd::not_implemented_error("connect()");
+    }
+
+    void connect(uhd::tx_streamer::sptr streamer,
+        size_t,
+        const block_id_t& dst_blk,
+        size_t dst_port,
+        uhd::transport::adapter_id_t)
+    {
+        BOOST_REQUIRE(has_block(dst_blk));
+        auto tx_stream = std::dynamic_pointer_cast<mock_replay_tx_streamer>(streamer);
+        BOOST_REQUIRE(tx_stream);
+        tx_stream->_port = int(dst_port);
+        tx_ports.push_back(dst_port);
+    }
+
+    void connect(const block_id_t& src_blk,
+        size_t src_port,
+        uhd::rx_streamer::sptr streamer,
+        size_t,
+        uhd::transport::adapter_id_t)
+    {
+        BOOST_REQUIRE(has_block(src_blk));
+        auto rx_stream = std::dynamic_pointer_cast<mock_replay_rx_streamer>(streamer);
+        BOOST_REQUIRE(rx_stream);
+        rx_stream->_port = int(src_port);
+        rx_ports.push_back(src_port);
+    }
+
+    void disconnect(const block_id_t&, size_t, const block_id_t&, size_t)
+    {
+        throw uhd::not_implemented_error("disconnect()");
+    }
+
+    void disconnect(const std::string&) {}
+
+    void disconnect(const std::string&, size_t) {}
+
+    std::vector<uhd::transport::adapter_id_t> enumerate_adapters_from_src(
+        const block_id_t&, size_t)
+    {
+        return {};
+    }
+
+    std::vector<uhd::transport::adapter_id_t> enumerate_adapters_to_dst(
+        const block_id_t&, size_t)
+    {
+        return {};
+    }
+
+    std::vector<stream_placement_t> get_stream_placements() const
+    {
+        return {};
+    }
+
+    std::vector<graph_edge_t> enumerate_static_connections() const
+    {
+        return {};
+    }
+
+    std::vector<graph_edge_t> enumerate_active_connections()
+    {
+        return {};
+    }
+
+    void commit()
+    {
+        num_commits++;
+    }
+
+    void release() {}
+
+    uhd::rx_streamer::sptr create_rx_streamer(
+        const size_t num_ports, const uhd::stream_args_t&)
+    {
+        BOOST_REQUIRE_EQUAL(num_ports, 1);
+        return std::make_shared<mock_replay_rx_streamer>(_replay, _reg_iface);
+    }
+
+    uhd::tx_streamer::sptr create_tx_streamer(
+        const size_t num_ports, const uhd::stream_args_t& args)
+    {
+        BOOST_REQUIRE_EQUAL(num_ports, 1);
+        const size_t spp = args.args.cast<size_t>("spp", default_spp);
+        tx_spps.push_back(spp);
+        return std::make_shared<mock_replay_tx_streamer>(_replay, _reg_iface, spp);
+    }
+
+    size_t get_num_mboards() const
+    {
+        return 1;
+    }
+
+    std::shared_ptr<mb_controller> get_mb_controller(const size_t)
+    {
+        throw uhd::not_implemented_error("get_mb_controller()");
+    }
+
+    bool synchronize_devices(const uhd::time_spec_t&, const bool)
+    {
+        return true;
+    }
+
+    uhd::property_tree::sptr get_tree(void) const
+    {
+        throw uhd::not_implemented_error("get_tree()");
+    }
+
+    //! Samples per packet of streamers created without an "spp" argument
+    size_t default_spp = 1000;
+    std::vector<size_t> tx_spps;
+    std::vector<size_t> tx_ports;
+    std::vector<size_t> rx_ports;
+    size_t num_commits = 0;
+
+private:
+    replay_block_control::sptr _replay;
+    reg_iface_sptr _reg_iface;
+};
+
+struct replay_utils_fixture
+{
+    replay_utils_fixture()
+        : reg_iface(std::make_shared<replay_mem_reg_iface_t>())
+        , block_container(get_mock_block(REPLAY_BLOCK,
+              NUM_PORTS,
+              NUM_PORTS,
+              uhd::device_addr_t(),
+              DEFAULT_MTU,
+              ANY_DEVICE,
+              reg_iface))
+        , replay(block_container.get_block<replay_block_control>())
+    {
+        node_accessor.init_props(replay.get());
+        graph = std::make_shared<mock_replay_graph>(replay, reg_iface);
+    }
+
+    std::vector<uint8_t> make_data(const size_t num_bytes)
+    {
+        std::vector<uint8_t> data(num_bytes);
+        std::mt19937 rng(num_bytes);
+        std::generate(data.begin(), data.end(), [&rng]() { return uint8_t(rng()); });
+        return data;
+    }
+
+    reg_iface_sptr reg_iface;
+    mock_block_container block_container;
+    replay_block_control::sptr replay;
+    std::shared_ptr<mock_replay_graph> graph;
+    node_accessor_t node_accessor{};
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_replay_checksum_empty)
+{
+    // FNV-1a offset basis
+    BOOST_CHECK_EQUAL(replay_checksum(nullptr, 0), 0xcbf29ce484222325ULL);
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_checksum_detects_changes)
+{
+    std::vector<uint8_t> data(4099);
+    std::iota(data.begin(), data.end(), 0);
+    const uint64_t checksum = replay_checksum(data.data(), data.size());
+    BOOST_CHECK_EQUAL(checksum, replay_checksum(data.data(), data.size()));
+
+    // Flip a bit in a full word, and in the trailing bytes
+    for (const size_t idx : {size_t(17), data.size() - 1}) {
+        data[idx] ^= 0x01;
+        BOOST_CHECK_NE(checksum, replay_checksum(data.data(), data.size()));
+        data[idx] ^= 0x01;
+    }
+    // Trailing bytes count towards the checksum
+    BOOST_CHECK_NE(checksum, replay_checksum(data.data(), data.size() - 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_checksum_unaligned)
+{
+    std::vector<uint8_t> data(1027);
+    std::iota(data.begin(), data.end(), 3);
+    std::vector<uint8_t> shifted(data.size() + 1);
+    std::memcpy(shifted.data() + 1, data.data(), data.size());
+    BOOST_CHECK_EQUAL(replay_checksum(data.data(), data.size()),
+        replay_checksum(shifted.data() + 1, data.size()));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_upload, replay_utils_fixture)
+{
+    // 1005 words plus a partial one, so the sections aren't all the same size
+    const size_t num_bytes    = 1005 * WORD_SIZE + 5;
+    const uint64_t mem_offset = 16 * WORD_SIZE;
+    const auto data           = make_data(num_bytes);
+
+    BOOST_CHECK_EQUAL(replay_upload(graph, replay, data.data(), num_bytes, mem_offset),
+        1006 * WORD_SIZE);
+    BOOST_CHECK_EQUAL(graph->num_commits, 1);
+
+    // One section per port, contiguous and word aligned, in port order
+    BOOST_REQUIRE_EQUAL(graph->tx_ports.size(), NUM_PORTS);
+    uint64_t offset = mem_offset;
+    for (size_t port = 0; port < NUM_PORTS; port++) {
+        BOOST_CHECK_EQUAL(graph->tx_ports[port], port);
+        BOOST_CHECK_EQUAL(replay->get_record_offset(port), offset);
+        BOOST_CHECK_EQUAL(replay->get_record_size(port) % WORD_SIZE, 0);
+        BOOST_CHECK_EQUAL(
+            replay->get_record_fullness(port), replay->get_record_size(port));
+        offset += replay->get_record_size(port);
+    }
+    BOOST_CHECK_EQUAL(offset, mem_offset + 1006 * WORD_SIZE);
+    // The first sections get the extra words
+    BOOST_CHECK_EQUAL(replay->get_record_size(0), 252 * WORD_SIZE);
+    BOOST_CHECK_EQUAL(replay->get_record_size(1), 252 * WORD_SIZE);
+    BOOST_CHECK_EQUAL(replay->get_record_size(3), 251 * WORD_SIZE);
+
+    const auto& memory = reg_iface->memory;
+    BOOST_CHECK(std::equal(data.begin(), data.end(), memory.begin() + mem_offset));
+    // The last word is padded with zeros, the memory around it is untouched
+    for (size_t i = num_bytes; i < 1006 * WORD_SIZE; i++) {
+        BOOST_CHECK_EQUAL(memory[mem_offset + i], 0);
+    }
+    BOOST_CHECK_EQUAL(memory[mem_offset - 1], FILL_BYTE);
+    BOOST_CHECK_EQUAL(memory[mem_offset + 1006 * WORD_SIZE], FILL_BYTE);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_upload_ports, replay_utils_fixture)
+{
+    // Fewer words than ports: only as many sections as there are words
+    const auto data = make_data(2 * WORD_SIZE);
+    replay_upload(graph, replay, data.data(), data.size(), 0, {3, 1, 2});
+    BOOST_CHECK_EQUAL(graph->tx_ports.size(), 2);
+    BOOST_CHECK_EQUAL(graph->tx_ports[0], 3);
+    BOOST_CHECK_EQUAL(graph->tx_ports[1], 1);
+    BOOST_CHECK_EQUAL(replay->get_record_offset(1), WORD_SIZE);
+    BOOST_CHECK(std::equal(data.begin(), data.end(), reg_iface->memory.begin()));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_upload_spp, replay_utils_fixture)
+{
+    // Streamers get recreated with a packet size that is a multiple of the
+    // word size, which must not be rounded down to zero
+    const size_t items_per_word = WORD_SIZE / 4;
+    graph->default_spp          = items_per_word - 1;
+    const auto data             = make_data(10 * WORD_SIZE);
+    replay_upload(graph, replay, data.data(), data.size(), 0, {0});
+    BOOST_REQUIRE_EQUAL(graph->tx_spps.size(), 2);
+    BOOST_CHECK_EQUAL(graph->tx_spps[0], items_per_word - 1);
+    BOOST_CHECK_EQUAL(graph->tx_spps[1], items_per_word);
+
+    graph->tx_spps.clear();
+    graph->default_spp = 5 * items_per_word + 1;
+    replay_upload(graph, replay, data.data(), data.size(), 0, {0});
+    BOOST_REQUIRE_EQUAL(graph->tx_spps.size(), 2);
+    BOOST_CHECK_EQUAL(graph->tx_spps[1], 5 * items_per_word);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_upload_stale_data, replay_utils_fixture)
+{
+    // The record buffer never drains, so flushing it must give up
+    reg_iface->stale_port = 1;
+    const auto data       = make_data(4 * WORD_SIZE);
+    BOOST_CHECK_THROW(
+        replay_upload(graph, replay, data.data(), data.size(), 0, {1}), uhd::io_error);
+    BOOST_CHECK_EQUAL(reg_iface->memory[0], FILL_BYTE);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_download_verify, replay_utils_fixture)
+{
+    const size_t num_bytes    = 777 * WORD_SIZE + 3;
+    const uint64_t mem_offset = 3 * WORD_SIZE;
+    const auto data           = make_data(num_bytes);
+    std::copy(data.begin(), data.end(), reg_iface->memory.begin() + mem_offset);
+
+    // The destination must not be written past its end
+    std::vector<uint8_t> readback(num_bytes + 1, 0x55);
+    replay_download(graph, replay, readback.data(), num_bytes, mem_offset, {2, 0, 1});
+    BOOST_CHECK_EQUAL(graph->rx_ports.size(), 3);
+    BOOST_CHECK_EQUAL(graph->rx_ports[0], 2);
+    BOOST_CHECK_EQUAL(replay->get_play_offset(2), mem_offset);
+    BOOST_CHECK(std::equal(data.begin(), data.end(), readback.begin()));
+    BOOST_CHECK_EQUAL(readback[num_bytes], 0x55);
+
+    BOOST_CHECK(
+        replay_verify_readback(graph, replay, data.data(), num_bytes, mem_offset));
+    reg_iface->memory[mem_offset + num_bytes / 2] ^= 0x80;
+    BOOST_CHECK(
+        !replay_verify_readback(graph, replay, data.data(), num_bytes, mem_offset));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_file_round_trip, replay_utils_fixture)
+{
+    namespace fs        = boost::filesystem;
+    const fs::path dir  = fs::temp_directory_path() / fs::unique_path();
+    const auto in_file  = (dir / "in.dat").string();
+    const auto out_file = (dir / "out.dat").string();
+    fs::create_directories(dir);
+
+    const auto data = make_data(4321);
+    {
+        std::ofstream file(in_file, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    BOOST_CHECK_EQUAL(replay_upload_file(graph, replay, in_file, WORD_SIZE),
+        (4321 + WORD_SIZE - 1) / WORD_SIZE * WORD_SIZE);
+    replay_download_file(graph, replay, out_file, data.size(), WORD_SIZE);
+
+    BOOST_REQUIRE_EQUAL(fs::file_size(out_file), data.size());
+    std::vector<uint8_t> readback(data.size());
+    {
+        std::ifstream file(out_file, std::ios::binary);
+        file.read(reinterpret_cast<char*>(readback.data()), readback.size());
+    }
+    BOOST_CHECK(data == readback);
+    BOOST_CHECK_THROW(
+        replay_upload_file(graph, replay, (dir / "missing.dat").string()), uhd::io_error);
+    fs::remove_all(dir);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_replay_invalid_args, replay_utils_fixture)
+{
+    const auto data = make_data(64);
+    // Unaligned offset
+    BOOST_CHECK_THROW(replay_upload(graph, replay, data.data(), data.size(), 1),
+        uhd::value_error);
+    // Doesn't fit into memory
+    BOOST_CHECK_THROW(
+        replay_upload(graph, replay, data.data(), data.size(), MEM_SIZE - WORD_SIZE),
+        uhd::value_error);
+    // Invalid port
+    BOOST_CHECK_THROW(
+        replay_upload(graph, replay, data.data(), data.size(), 0, {NUM_PORTS}),
+        uhd::value_error);
+    BOOST_CHECK(graph->tx_spps.empty());
+
+    // Nothing to do
+    BOOST_CHECK_EQUAL(replay_upload(graph, replay, data.data(), 0), 0);
+    BOOST_CHECK(graph->tx_spps.empty());
+}
@@ -0,0 +1,100 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhdlib/rfnoc/rx_flow_ctrl_state.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace uhd::rfnoc;
+
+namespace {
+
+constexpr size_t PKT_SIZE = 1000;
+
+//! Receive and release packets one by one, return the number of responses sent
+size_t stream(rx_flow_ctrl_state& state, const size_t num_pkts)
+{
+    size_t num_resps = 0;
+    for (size_t i = 0; i < num_pkts; i++) {
+        state.data_received(PKT_SIZE);
+        state.xfer_done(PKT_SIZE);
+        if (state.fc_resp_due()) {
+            state.fc_resp_sent();
+            num_resps++;
+        }
+    }
+    return num_resps;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_rx_flow_ctrl_no_capacity)
+{
+    // Without a capacity, there's a response every fc_freq
+    rx_flow_ctrl_state state({1, 2}, {4 * PKT_SIZE, 1000});
+    BOOST_CHECK_EQUAL(stream(state, 400), 100);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().bytes, 4 * PKT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_flow_ctrl_coalesce)
+{
+    // Data is consumed right away, so responses back off up to an eighth of
+    // the capacity
+    rx_flow_ctrl_state state({1, 2}, {4 * PKT_SIZE, 1000}, {256 * PKT_SIZE, 1000});
+    const size_t num_resps = stream(state, 4000);
+    BOOST_CHECK_LT(num_resps, 4000 / 16);
+    BOOST_CHECK_GE(num_resps, 4000 / 32);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().bytes, 32 * PKT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_flow_ctrl_watermark)
+{
+    rx_flow_ctrl_state state({1, 2}, {4 * PKT_SIZE, 1000}, {256 * PKT_SIZE, 1000});
+    stream(state, 4000);
+    BOOST_REQUIRE_EQUAL(state.get_coalesce_limit().bytes, 32 * PKT_SIZE);
+
+    // A burst fills up the buffer before the application gets to it
+    for (size_t i = 0; i < 200; i++) {
+        state.data_received(PKT_SIZE);
+    }
+    // Above half the capacity, responses go out at fc_freq, and the limit
+    // backs off
+    size_t num_resps = 0;
+    auto last_resp   = state.get_xfer_counts();
+    for (size_t i = 0; i < 64; i++) {
+        state.xfer_done(PKT_SIZE);
+        if (state.fc_resp_due()) {
+            const auto xfer_counts = state.get_xfer_counts();
+            if (num_resps > 0) {
+                BOOST_CHECK_EQUAL(xfer_counts.bytes - last_resp.bytes, 4 * PKT_SIZE);
+            }
+            state.fc_resp_sent();
+            last_resp = xfer_counts;
+            num_resps++;
+        }
+    }
+    BOOST_CHECK_GE(num_resps, 64 / 4 - 1);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().bytes, 4 * PKT_SIZE);
+
+    // Once the application caught up, coalescing resumes
+    for (size_t i = 64; i < 200; i++) {
+        state.xfer_done(PKT_SIZE);
+        if (state.fc_resp_due()) {
+            state.fc_resp_sent();
+        }
+    }
+    stream(state, 4000);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().bytes, 32 * PKT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_flow_ctrl_packets)
+{
+    // Packet based flow control coalesces the same way
+    rx_flow_ctrl_state state({1, 2}, {uint64_t(-1), 2}, {uint64_t(1) << 40, 64});
+    BOOST_CHECK_EQUAL(stream(state, 8), 2);
+    stream(state, 1000);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().packets, 8);
+    BOOST_CHECK_EQUAL(state.get_coalesce_limit().bytes, uint64_t(-1));
+}
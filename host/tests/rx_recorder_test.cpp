@@ -0,0 +1,264 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/utils/rx_recorder.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+using namespace uhd;
+namespace fs = boost::filesystem;
+
+namespace {
+
+constexpr double TICK_RATE = 1e6;
+
+/*! RX streamer that returns a counter per channel
+ *
+ * Sample n of channel c has the value (c << 24) | n. Every recv() call returns
+ * at most one packet worth of samples. Overflows can be injected before a
+ * given sample; the samples after that are still counted, so the overflow
+ * creates a gap.
+ */
+class mock_rx_streamer : public rx_streamer
+{
+public:
+    mock_rx_streamer(const size_t num_chans, const size_t spp)
+        : _num_chans(num_chans), _spp(spp)
+    {
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return _num_chans;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return _spp;
+    }
+
+    size_t recv(const buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t& metadata,
+        const double,
+        const bool)
+    {
+        metadata.reset();
+        if (_overflow_at == _next_samp) {
+            metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+            _overflow_at        = ~uint32_t(0);
+            // The samples that would have been received are lost
+            _next_samp += uint32_t(_spp);
+            return 0;
+        }
+        const size_t num_samps = std::min(nsamps_per_buff, _spp);
+        for (size_t chan = 0; chan < _num_chans; chan++) {
+            uint32_t* buff = reinterpret_cast<uint32_t*>(buffs[chan]);
+            for (size_t i = 0; i < num_samps; i++) {
+                buff[i] = uint32_t(chan << 24) | (_next_samp + uint32_t(i));
+            }
+        }
+        metadata.has_time_spec = true;
+        metadata.time_spec     = time_spec_t::from_ticks(_next_samp, TICK_RATE);
+        _next_samp += uint32_t(num_samps);
+        return num_samps;
+    }
+
+    void issue_stream_cmd(const stream_cmd_t&) {}
+
+    void inject_overflow(const uint32_t samp)
+    {
+        _overflow_at = samp;
+    }
+
+private:
+    const size_t _num_chans;
+    const size_t _spp;
+    uint32_t _next_samp   = 0;
+    uint32_t _overflow_at = ~uint32_t(0);
+};
+
+struct tmp_dir
+{
+    tmp_dir(void) : path(fs::temp_directory_path() / fs::unique_path())
+    {
+        fs::create_directories(path);
+    }
+
+    ~tmp_dir(void)
+    {
+        fs::remove_all(path);
+    }
+
+    const fs::path path;
+};
+
+std::vector<uint32_t> read_file(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<char> bytes(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<uint32_t> data(bytes.size() / sizeof(uint32_t));
+    std::memcpy(data.data(), bytes.data(), data.size() * sizeof(uint32_t));
+    return data;
+}
+
+std::vector<std::string> read_index(const std::string& filename)
+{
+    std::ifstream file(filename);
+    std::vector<std::string> entries;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#') {
+            entries.push_back(line);
+        }
+    }
+    return entries;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_rx_recorder_single_channel)
+{
+    tmp_dir dir;
+    auto rx_stream = std::make_shared<mock_rx_streamer>(1, 1000);
+
+    rx_recorder::config_t config;
+    config.filename    = (dir.path / "rx.dat").string();
+    config.num_buffers = 2;
+    config.buffer_size = 1; // Rounded up to 4096 samples
+    auto recorder      = rx_recorder::make(rx_stream, config);
+
+    // Not a multiple of the buffer size, to exercise the final partial write
+    const size_t num_samps = 10000;
+    BOOST_CHECK_EQUAL(recorder->record(num_samps), num_samps);
+    recorder->close();
+
+    BOOST_REQUIRE_EQUAL(recorder->get_filenames(0).size(), 1);
+    BOOST_CHECK_EQUAL(recorder->get_filenames(0).at(0), config.filename);
+    const auto data = read_file(config.filename);
+    BOOST_REQUIRE_EQUAL(data.size(), num_samps);
+    for (size_t i = 0; i < num_samps; i++) {
+        BOOST_REQUIRE_EQUAL(data[i], i);
+    }
+
+    const auto stats = recorder->get_stats();
+    BOOST_CHECK_EQUAL(stats.num_samps, num_samps);
+    BOOST_CHECK_EQUAL(stats.bytes_written, num_samps * sizeof(uint32_t));
+    BOOST_CHECK_EQUAL(stats.num_overflows, 0);
+    BOOST_CHECK_EQUAL(stats.num_queued, 0);
+
+    // One entry for the start, and one for each of the two later buffers
+    const auto index = read_index(config.filename + ".idx");
+    BOOST_REQUIRE_EQUAL(index.size(), 3);
+    BOOST_CHECK_EQUAL(index[0], "0,0,0.000000000000,start");
+    BOOST_CHECK_EQUAL(index[1], "4096,0,0.004096000000,buffer");
+    BOOST_CHECK_EQUAL(index[2], "8192,0,0.008192000000,buffer");
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_recorder_striped)
+{
+    tmp_dir dir;
+    const std::vector<std::string> stripe_dirs{
+        (dir.path / "a").string(), (dir.path / "b").string()};
+    for (const auto& stripe_dir : stripe_dirs) {
+        fs::create_directories(stripe_dir);
+    }
+    auto rx_stream = std::make_shared<mock_rx_streamer>(2, 700);
+
+    rx_recorder::config_t config;
+    config.filename    = (dir.path / "rx.dat").string();
+    config.stripe_dirs = stripe_dirs;
+    config.num_buffers = 3;
+    config.buffer_size = 1;
+    config.direct_io   = false;
+    auto recorder      = rx_recorder::make(rx_stream, config);
+
+    const size_t num_samps = 3 * 4096 + 100;
+    BOOST_CHECK_EQUAL(recorder->record(num_samps), num_samps);
+    recorder->close();
+
+    for (size_t chan = 0; chan < 2; chan++) {
+        const auto filenames = recorder->get_filenames(chan);
+        BOOST_REQUIRE_EQUAL(filenames.size(), 2);
+        BOOST_CHECK_EQUAL(filenames[0],
+            (fs::path(stripe_dirs[0]) / ("rx_ch" + std::to_string(chan) + "_s0.dat"))
+                .string());
+
+        // Reassemble the stripes, one buffer at a time
+        std::vector<std::vector<uint32_t>> stripes{
+            read_file(filenames[0]), read_file(filenames[1])};
+        BOOST_CHECK_EQUAL(stripes[0].size(), 2 * 4096);
+        BOOST_CHECK_EQUAL(stripes[1].size(), 4096 + 100);
+        std::vector<uint32_t> data;
+        for (size_t offset = 0; data.size() < num_samps; offset += 4096) {
+            for (const auto& stripe : stripes) {
+                const size_t end = std::min(offset + 4096, stripe.size());
+                if (offset < end) {
+                    data.insert(
+                        data.end(), stripe.begin() + offset, stripe.begin() + end);
+                }
+            }
+        }
+        BOOST_REQUIRE_EQUAL(data.size(), num_samps);
+        for (size_t i = 0; i < num_samps; i++) {
+            BOOST_REQUIRE_EQUAL(data[i], uint32_t(chan << 24) | i);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_recorder_overflow)
+{
+    tmp_dir dir;
+    auto rx_stream = std::make_shared<mock_rx_streamer>(1, 1000);
+    rx_stream->inject_overflow(2000);
+
+    rx_recorder::config_t config;
+    config.filename = (dir.path / "rx.dat").string();
+    auto recorder   = rx_recorder::make(rx_stream, config);
+    BOOST_CHECK_EQUAL(recorder->record(5000), 5000);
+    recorder->close();
+
+    BOOST_CHECK_EQUAL(recorder->get_stats().num_overflows, 1);
+    const auto data = read_file(config.filename);
+    BOOST_REQUIRE_EQUAL(data.size(), 5000);
+    BOOST_CHECK_EQUAL(data[1999], 1999);
+    BOOST_CHECK_EQUAL(data[2000], 3000);
+
+    // The gap shows up in the index: sample 2000 in the file was received at
+    // t = 3 ms
+    const auto index = read_index(config.filename + ".idx");
+    BOOST_REQUIRE_EQUAL(index.size(), 2);
+    BOOST_CHECK_EQUAL(index[1], "2000,0,0.003000000000,overflow");
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_recorder_null)
+{
+    auto rx_stream = std::make_shared<mock_rx_streamer>(1, 1000);
+
+    rx_recorder::config_t config;
+    config.num_buffers = 2;
+    config.buffer_size = 1;
+    config.one_packet  = true;
+    auto recorder      = rx_recorder::make(rx_stream, config);
+    BOOST_CHECK_EQUAL(recorder->record(20000), 20000);
+
+    const auto stats = recorder->get_stats();
+    BOOST_CHECK_EQUAL(stats.num_samps, 20000);
+    BOOST_CHECK_EQUAL(stats.bytes_written, 0);
+    BOOST_CHECK_EQUAL(stats.num_stalls, 0);
+    BOOST_CHECK(!stats.recv_sizes.empty());
+    BOOST_CHECK(recorder->get_filenames(0).empty());
+
+    // Stopping is sticky
+    recorder->stop();
+    BOOST_CHECK_EQUAL(recorder->record(1000), 0);
+}
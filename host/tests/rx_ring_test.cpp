@@ -0,0 +1,256 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhdlib/transport/rx_ring.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace uhd;
+using uhd::transport::rx_ring;
+
+namespace {
+
+constexpr size_t CHAN_OFFSET = 1000000;
+
+/*! Streamer that plays back a list of chunks
+ *
+ * Sample N of channel C has the value N + C * CHAN_OFFSET, and its timestamp
+ * is N seconds. Once all chunks are played back, recv() times out.
+ */
+class mock_rx_streamer : public rx_streamer
+{
+public:
+    struct chunk_t
+    {
+        size_t num_samps;
+        rx_metadata_t::error_code_t error_code;
+    };
+
+    mock_rx_streamer(const size_t num_chans) : _num_chans(num_chans) {}
+
+    size_t get_num_channels(void) const
+    {
+        return _num_chans;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return 100;
+    }
+
+    size_t recv(const buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t& metadata,
+        const double timeout,
+        const bool)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        metadata.reset();
+        if (_chunks.empty()) {
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                std::min<int>(10, static_cast<int>(timeout * 1000))));
+            metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        chunk_t& chunk      = _chunks.front();
+        metadata.error_code = chunk.error_code;
+        const size_t num_samps = std::min(nsamps_per_buff, chunk.num_samps);
+        metadata.has_time_spec = true;
+        metadata.time_spec     = time_spec_t(double(_next_samp));
+        for (size_t chan = 0; chan < _num_chans; chan++) {
+            uint32_t* buff = static_cast<uint32_t*>(buffs[chan]);
+            for (size_t i = 0; i < num_samps; i++) {
+                buff[i] = uint32_t(_next_samp + i + chan * CHAN_OFFSET);
+            }
+        }
+        _next_samp += num_samps;
+        chunk.num_samps -= num_samps;
+        if (chunk.num_samps == 0) {
+            _chunks.pop_front();
+        }
+        return num_samps;
+    }
+
+    void issue_stream_cmd(const stream_cmd_t&) {}
+
+    void push_chunk(const size_t num_samps,
+        const rx_metadata_t::error_code_t error_code = rx_metadata_t::ERROR_CODE_NONE)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _chunks.push_back({num_samps, error_code});
+    }
+
+private:
+    const size_t _num_chans;
+    std::mutex _mutex;
+    std::deque<chunk_t> _chunks;
+    size_t _next_samp = 0;
+};
+
+//! Check that a block holds \p num_samps samples, starting with sample \p first
+void check_block(
+    rx_ring& ring, const size_t index, const size_t first, const size_t num_samps)
+{
+    const auto& blk = ring.get_block(index);
+    BOOST_CHECK_EQUAL(blk.num_samps, num_samps);
+    BOOST_CHECK(blk.metadata.has_time_spec);
+    BOOST_CHECK_EQUAL(blk.metadata.time_spec.get_full_secs(), first);
+    for (size_t chan = 0; chan < ring.get_num_chans(); chan++) {
+        const uint32_t* samps =
+            reinterpret_cast<const uint32_t*>(ring.get_block_ptr(index, chan));
+        for (size_t i = 0; i < num_samps; i++) {
+            if (samps[i] != first + i + chan * CHAN_OFFSET) {
+                BOOST_ERROR("Wrong sample " << i << " on channel " << chan);
+                return;
+            }
+        }
+    }
+}
+
+//! Wait for \p condition to become true, for up to a second
+bool wait_for(std::function<bool()> condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_rx_ring_handoff)
+{
+    auto streamer = std::make_shared<mock_rx_streamer>(2);
+    // Chunks that don't line up with the blocks, and a partial block at the end
+    streamer->push_chunk(60);
+    streamer->push_chunk(60);
+    streamer->push_chunk(130);
+    rx_ring ring(streamer, sizeof(uint32_t), 4, 100);
+    ring.start();
+
+    size_t index;
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 0, 100);
+    ring.release(index);
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 100, 100);
+    ring.release(index);
+    // The stream times out, which completes the block
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 200, 50);
+    ring.release(index);
+
+    BOOST_CHECK(!ring.get(index, 0.05));
+    BOOST_CHECK_EQUAL(ring.get_num_overflows(), 0);
+    BOOST_CHECK_EQUAL(ring.get_num_stalls(), 0);
+    ring.stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_ring_overflow)
+{
+    auto streamer = std::make_shared<mock_rx_streamer>(1);
+    streamer->push_chunk(30);
+    streamer->push_chunk(0, rx_metadata_t::ERROR_CODE_OVERFLOW);
+    streamer->push_chunk(50);
+    rx_ring ring(streamer, sizeof(uint32_t), 4, 100);
+    ring.start();
+
+    // The samples after the overflow start a new block
+    size_t index;
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 0, 30);
+    ring.release(index);
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 30, 50);
+    ring.release(index);
+    BOOST_CHECK_EQUAL(ring.get_num_overflows(), 1);
+    ring.stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_ring_stall)
+{
+    auto streamer = std::make_shared<mock_rx_streamer>(1);
+    streamer->push_chunk(50);
+    rx_ring ring(streamer, sizeof(uint32_t), 2, 10);
+    ring.start();
+
+    // Nobody takes the blocks, so the receive thread runs out of them
+    BOOST_REQUIRE(wait_for([&ring]() { return ring.get_num_stalls() > 0; }));
+    size_t first, second, third;
+    BOOST_REQUIRE(ring.get(first, 1.0));
+    BOOST_REQUIRE(ring.get(second, 1.0));
+    BOOST_CHECK(!ring.get(third, 0.05));
+
+    // No samples are lost while the thread waits for a block
+    ring.release(first);
+    BOOST_REQUIRE(ring.get(third, 1.0));
+    check_block(ring, second, 10, 10);
+    check_block(ring, third, 20, 10);
+    BOOST_CHECK_EQUAL(ring.get_num_overflows(), 0);
+    ring.stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_ring_stop)
+{
+    auto streamer = std::make_shared<mock_rx_streamer>(1);
+    streamer->push_chunk(20);
+    rx_ring ring(streamer, sizeof(uint32_t), 2, 10);
+    ring.start();
+
+    size_t first, second;
+    BOOST_REQUIRE(ring.get(first, 1.0));
+    BOOST_REQUIRE(ring.get(second, 1.0));
+    // stop() returns while the thread waits for a block, and the blocks that
+    // were handed out stay valid
+    ring.stop();
+    check_block(ring, first, 0, 10);
+    check_block(ring, second, 10, 10);
+    ring.release(first);
+    ring.release(second);
+
+    // Nothing is received while stopped, and streaming continues on start()
+    streamer->push_chunk(10);
+    size_t index;
+    BOOST_CHECK(!ring.get(index, 0.05));
+    ring.start();
+    BOOST_REQUIRE(ring.get(index, 1.0));
+    check_block(ring, index, 20, 10);
+    ring.release(index);
+    ring.stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_rx_ring_error)
+{
+    auto streamer = std::make_shared<mock_rx_streamer>(1);
+    streamer->push_chunk(0, rx_metadata_t::ERROR_CODE_BAD_PACKET);
+    rx_ring ring(streamer, sizeof(uint32_t), 2, 10);
+    ring.start();
+
+    size_t index;
+    BOOST_REQUIRE(wait_for([&ring, &index]() {
+        try {
+            ring.get(index, 0.01);
+        } catch (const uhd::runtime_error&) {
+            return true;
+        }
+        return false;
+    }));
+    ring.stop();
+
+    BOOST_CHECK_THROW(rx_ring(streamer, sizeof(uint32_t), 0, 10), uhd::value_error);
+    BOOST_CHECK_THROW(rx_ring(streamer, sizeof(uint32_t), 2, 0), uhd::value_error);
+}
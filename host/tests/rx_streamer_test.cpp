@@ -416,6 +416,8 @@ BOOST_AUTO_TEST_CASE(test_recv_one_channel_packet_fragment)
             const size_t ticks_per_sample = static_cast<size_t>(TICK_RATE / SAMP_RATE);
             const size_t expected_ticks   = ticks_per_sample * total_samps_read;
             BOOST_CHECK_EQUAL(metadata.time_spec.to_ticks(TICK_RATE), expected_ticks);
+            BOOST_CHECK_EQUAL(metadata.time_ticks.get_ticks(), expected_ticks);
+            BOOST_CHECK_EQUAL(metadata.time_ticks.get_tick_rate(), TICK_RATE);
 
             for (size_t samp = 0; samp < num_samps; samp++) {
                 const size_t pkt_idx = samp + total_samps_read;
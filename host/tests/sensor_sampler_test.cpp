@@ -0,0 +1,134 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/usrp/sensor_sampler.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+namespace {
+
+//! Wait until a condition holds, or give up after a few seconds
+template <typename cond_type>
+bool wait_for(cond_type cond)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (not cond()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+sensor_sampler::sensor_t make_counter(
+    const std::string& key, const double period, std::atomic<int>& count)
+{
+    sensor_sampler::sensor_t sensor;
+    sensor.key    = key;
+    sensor.period = period;
+    sensor.read   = [key, &count]() { return sensor_value_t(key, ++count, ""); };
+    return sensor;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_sensor_sampler_rates)
+{
+    std::atomic<int> fast_count(0), slow_count(0);
+    auto sampler = sensor_sampler::make({make_counter("fast", 0.01, fast_count),
+        make_counter("slow", 0.2, slow_count)});
+    BOOST_CHECK_EQUAL(sampler->get_keys().size(), 2);
+    BOOST_CHECK_EQUAL(sampler->get_keys()[1], "slow");
+
+    BOOST_REQUIRE(wait_for([&]() { return fast_count > 20; }));
+    sampler->stop();
+    BOOST_CHECK_GE(slow_count, 1);
+    BOOST_CHECK_LT(slow_count * 5, fast_count);
+
+    // The cache holds the last value read, even after stopping
+    const auto fast = sampler->get("fast");
+    BOOST_CHECK(fast.valid);
+    BOOST_CHECK(fast.error.empty());
+    BOOST_CHECK_EQUAL(fast.value.name, "fast");
+    BOOST_CHECK_EQUAL(fast.value.to_int(), fast_count);
+    BOOST_CHECK_GE(fast.age, 0.0);
+    BOOST_CHECK_THROW(sampler->get("medium"), uhd::key_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_sensor_sampler_errors)
+{
+    std::atomic<int> count(0);
+    sensor_sampler::sensor_t flaky;
+    flaky.key    = "flaky";
+    flaky.period = 0.005;
+    flaky.read   = [&count]() {
+        if (++count > 1) {
+            throw uhd::runtime_error("sensor is gone");
+        }
+        return sensor_value_t("flaky", true, "locked", "unlocked");
+    };
+    sensor_sampler::sensor_t broken;
+    broken.key    = "broken";
+    broken.period = 0.005;
+    broken.read   = []() -> sensor_value_t { throw uhd::io_error("no reply"); };
+
+    auto sampler = sensor_sampler::make({flaky, broken});
+    BOOST_REQUIRE(wait_for([&]() { return count > 3; }));
+    sampler->stop();
+
+    // A failed read keeps the last good value, which then ages
+    const auto flaky_value = sampler->get("flaky");
+    BOOST_CHECK(flaky_value.valid);
+    BOOST_CHECK(flaky_value.value.to_bool());
+    BOOST_CHECK(flaky_value.error.find("sensor is gone") != std::string::npos);
+    const auto broken_value = sampler->get("broken");
+    BOOST_CHECK(not broken_value.valid);
+    BOOST_CHECK(broken_value.error.find("no reply") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_sensor_sampler_non_blocking)
+{
+    std::atomic<bool> reading(false), release(false);
+    sensor_sampler::sensor_t slow;
+    slow.key    = "slow";
+    slow.period = 0.001;
+    slow.read   = [&]() {
+        reading = true;
+        while (not release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return sensor_value_t("slow", 1.0, "V");
+    };
+
+    auto sampler = sensor_sampler::make({slow});
+    BOOST_REQUIRE(wait_for([&]() { return reading.load(); }));
+    // The read is stuck, but the cache is still accessible
+    BOOST_CHECK(not sampler->get("slow").valid);
+    release = true;
+    BOOST_CHECK(wait_for([&]() { return sampler->get("slow").valid; }));
+    BOOST_CHECK_EQUAL(sampler->get("slow").value.to_real(), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_sensor_sampler_config)
+{
+    std::atomic<int> count(0);
+    BOOST_CHECK_THROW(sensor_sampler::make(
+                          {make_counter("a", 0.1, count), make_counter("a", 0.2, count)}),
+        uhd::value_error);
+    BOOST_CHECK_THROW(
+        sensor_sampler::make({make_counter("a", 0.0, count)}), uhd::value_error);
+    BOOST_CHECK_THROW(sensor_sampler::make({sensor_sampler::sensor_t()}),
+        uhd::value_error);
+    // Without sensors, there's nothing to do
+    BOOST_CHECK(sensor_sampler::make({})->get_keys().empty());
+}
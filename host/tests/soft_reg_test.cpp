@@ -6,6 +6,9 @@
 
 #include <uhd/utils/soft_register.hpp>
 #include <boost/test/unit_test.hpp>
+#include <map>
+#include <utility>
+#include <vector>
 
 using namespace uhd;
 
@@ -32,3 +35,210 @@ BOOST_AUTO_TEST_CASE(test_soft_reg_field)
     BOOST_CHECK_EQUAL(soft_reg_field::shift(test_reg4), 0);
     BOOST_CHECK_EQUAL(soft_reg_field::mask<size_t>(test_reg4), ~size_t(0) & 0x1FFFFFFFF);
 }
+
+namespace {
+
+//! Bus that records every access
+class counting_wb_iface : public wb_iface
+{
+public:
+    void poke32(const wb_addr_type addr, const uint32_t data)
+    {
+        pokes.push_back({addr, data});
+        regs[addr] = data;
+    }
+
+    uint32_t peek32(const wb_addr_type addr)
+    {
+        num_peeks++;
+        return regs[addr];
+    }
+
+    std::vector<std::pair<wb_addr_type, uint32_t>> pokes;
+    std::map<wb_addr_type, uint32_t> regs;
+    size_t num_peeks = 0;
+};
+
+class test_regmap_t : public soft_regmap_t
+{
+public:
+    class ctrl_reg_t : public soft_reg32_wo_t
+    {
+    public:
+        UHD_DEFINE_SOFT_REG_FIELD(ENABLE, /*width*/ 1, /*shift*/ 0);
+        UHD_DEFINE_SOFT_REG_FIELD(GAIN, /*width*/ 8, /*shift*/ 8);
+
+        ctrl_reg_t(const wb_iface::wb_addr_type addr) : soft_reg32_wo_t(addr) {}
+    } ctrl0, ctrl1;
+
+    soft_reg32_rw_t config;
+    soft_reg32_ro_t status;
+
+    test_regmap_t(const soft_regmap_mode_t mode)
+        : soft_regmap_t("test", mode)
+        , ctrl0(0x10)
+        , ctrl1(0x14)
+        , config(0x18)
+        , status(0x1C)
+    {
+        add_to_map(ctrl0, "ctrl0");
+        add_to_map(ctrl1, "ctrl1");
+        add_cacheable_to_map(config, "config");
+        add_to_map(status, "status");
+    }
+
+    void flush_writable()
+    {
+        // The status register can't be flushed, so flush the others one by one
+        ctrl0.flush();
+        ctrl1.flush();
+        config.flush();
+    }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_soft_regmap_direct)
+{
+    counting_wb_iface iface;
+    test_regmap_t regmap(DIRECT_REGMAP);
+    regmap.initialize(iface);
+
+    regmap.flush_writable();
+    regmap.flush_writable();
+    // ALWAYS_FLUSH registers write every time
+    BOOST_CHECK_EQUAL(iface.pokes.size(), 6);
+    BOOST_CHECK_EQUAL(regmap.get_stats().writes_issued, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_soft_regmap_shadowed)
+{
+    counting_wb_iface iface;
+    test_regmap_t regmap(SHADOWED_REGMAP);
+    regmap.initialize(iface);
+
+    // The first flush writes everything
+    regmap.flush_writable();
+    BOOST_CHECK_EQUAL(iface.pokes.size(), 3);
+
+    // Unchanged values are not written again
+    regmap.flush_writable();
+    BOOST_CHECK_EQUAL(iface.pokes.size(), 3);
+
+    // Only the changed word is written
+    regmap.ctrl1.set(test_regmap_t::ctrl_reg_t::GAIN, 42);
+    regmap.ctrl1.set(test_regmap_t::ctrl_reg_t::ENABLE, 1);
+    regmap.flush_writable();
+    BOOST_REQUIRE_EQUAL(iface.pokes.size(), 4);
+    BOOST_CHECK_EQUAL(iface.pokes.back().first, 0x14);
+    BOOST_CHECK_EQUAL(iface.pokes.back().second, (42 << 8) | 1);
+
+    // Changing a value and back is not a change
+    regmap.ctrl0.set(test_regmap_t::ctrl_reg_t::GAIN, 1);
+    regmap.ctrl0.set(test_regmap_t::ctrl_reg_t::GAIN, 0);
+    regmap.ctrl0.flush();
+    BOOST_CHECK_EQUAL(iface.pokes.size(), 4);
+
+    const auto stats = regmap.get_stats();
+    BOOST_CHECK_EQUAL(stats.writes_requested, 10);
+    BOOST_CHECK_EQUAL(stats.writes_issued, 4);
+    BOOST_CHECK_EQUAL(stats.writes_skipped, 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_soft_regmap_shadowed_reads)
+{
+    counting_wb_iface iface;
+    iface.regs[0x1C] = 0xABCD;
+    test_regmap_t regmap(SHADOWED_REGMAP);
+    regmap.initialize(iface);
+
+    // Reading an individual register always goes to the bus, even if it is
+    // cacheable
+    regmap.config.write(soft_reg32_rw_t::REGISTER, 0x1234);
+    BOOST_CHECK_EQUAL(regmap.config.read(soft_reg32_rw_t::REGISTER), 0x1234);
+    BOOST_CHECK_EQUAL(regmap.status.read(soft_reg32_ro_t::REGISTER), 0xABCD);
+    BOOST_CHECK_EQUAL(iface.num_peeks, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_soft_regmap_shadowed_flush)
+{
+    class rw_regmap_t : public soft_regmap_t
+    {
+    public:
+        soft_reg32_rw_t reg0, reg1, reg2;
+
+        rw_regmap_t() : soft_regmap_t("rw", SHADOWED_REGMAP), reg0(0), reg1(4), reg2(8)
+        {
+            add_cacheable_to_map(reg0, "reg0");
+            add_cacheable_to_map(reg1, "reg1");
+            add_to_map(reg2, "reg2");
+        }
+    };
+
+    counting_wb_iface iface;
+    rw_regmap_t regmap;
+    regmap.initialize(iface, /*sync*/ true);
+    // Syncing flushes and then reads every register
+    BOOST_CHECK_EQUAL(iface.pokes.size(), 3);
+    BOOST_CHECK_EQUAL(iface.num_peeks, 3);
+
+    regmap.reg0.set(soft_reg32_rw_t::REGISTER, 1);
+    regmap.reg2.set(soft_reg32_rw_t::REGISTER, 2);
+    regmap.flush();
+    BOOST_REQUIRE_EQUAL(iface.pokes.size(), 5);
+    BOOST_CHECK_EQUAL(iface.pokes[3].first, 0);
+    BOOST_CHECK_EQUAL(iface.pokes[4].first, 8);
+
+    // Only the register that isn't cacheable is read back
+    iface.regs[8] = 3;
+    regmap.refresh();
+    BOOST_CHECK_EQUAL(iface.num_peeks, 4);
+    BOOST_CHECK_EQUAL(regmap.reg0.get(soft_reg32_rw_t::REGISTER), 1);
+    BOOST_CHECK_EQUAL(regmap.reg2.get(soft_reg32_rw_t::REGISTER), 3);
+
+    const auto stats = regmap.get_stats();
+    BOOST_CHECK_EQUAL(stats.writes_issued, 5);
+    BOOST_CHECK_EQUAL(stats.writes_skipped, 1);
+    BOOST_CHECK_EQUAL(stats.reads_skipped, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_soft_regmap_shadowed_refresh_dirty)
+{
+    class rw_regmap_t : public soft_regmap_t
+    {
+    public:
+        soft_reg32_rw_t config, status;
+
+        rw_regmap_t() : soft_regmap_t("rw", SHADOWED_REGMAP), config(0), status(4)
+        {
+            add_cacheable_to_map(config, "config");
+            add_to_map(status, "status");
+        }
+    };
+
+    counting_wb_iface iface;
+    rw_regmap_t regmap;
+    regmap.initialize(iface);
+
+    regmap.config.write(soft_reg32_rw_t::REGISTER, 0x1234);
+    regmap.refresh();
+    BOOST_CHECK_EQUAL(iface.num_peeks, 2);
+    // Only the status register is read, the config register is in sync
+    regmap.refresh();
+    BOOST_CHECK_EQUAL(iface.num_peeks, 3);
+    BOOST_CHECK(!regmap.config.is_dirty());
+
+    // A value that was set but not flushed must not be mistaken for the
+    // hardware value, so the register is read back like in direct mode
+    regmap.config.set(soft_reg32_rw_t::REGISTER, 0x5678);
+    BOOST_CHECK(regmap.config.is_dirty());
+    regmap.refresh();
+    BOOST_CHECK_EQUAL(iface.num_peeks, 5);
+    BOOST_CHECK_EQUAL(regmap.config.get(soft_reg32_rw_t::REGISTER), 0x1234);
+    BOOST_CHECK(!regmap.config.is_dirty());
+
+    // Now it is in sync again
+    regmap.refresh();
+    BOOST_CHECK_EQUAL(iface.num_peeks, 6);
+    BOOST_CHECK_EQUAL(regmap.get_stats().reads_skipped, 2);
+}
@@ -0,0 +1,82 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/thread.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE(test_parse_cpu_list)
+{
+    BOOST_CHECK(uhd::parse_cpu_list("").empty());
+    BOOST_CHECK(uhd::parse_cpu_list("3") == std::vector<size_t>({3}));
+    BOOST_CHECK(uhd::parse_cpu_list("8, 0-3,2,10-11")
+                == std::vector<size_t>({0, 1, 2, 3, 8, 10, 11}));
+    BOOST_CHECK_THROW(uhd::parse_cpu_list("a"), uhd::value_error);
+    BOOST_CHECK_THROW(uhd::parse_cpu_list("1-"), uhd::value_error);
+    BOOST_CHECK_THROW(uhd::parse_cpu_list("3-1"), uhd::value_error);
+    BOOST_CHECK_THROW(uhd::parse_cpu_list("1x"), uhd::value_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_default_thread_affinity)
+{
+    const auto process_default = uhd::get_default_thread_affinity();
+    {
+        uhd::thread_affinity_scope outer({1, 2});
+        BOOST_CHECK(uhd::get_default_thread_affinity() == std::vector<size_t>({1, 2}));
+        {
+            uhd::thread_affinity_scope inner({});
+            BOOST_CHECK(uhd::get_default_thread_affinity().empty());
+        }
+        BOOST_CHECK(uhd::get_default_thread_affinity() == std::vector<size_t>({1, 2}));
+
+        // Scopes only apply to the thread they were created in
+        std::vector<size_t> other_thread;
+        std::thread([&other_thread]() {
+            other_thread = uhd::get_default_thread_affinity();
+        }).join();
+        BOOST_CHECK(other_thread == process_default);
+    }
+    BOOST_CHECK(uhd::get_default_thread_affinity() == process_default);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_affinity)
+{
+    const auto cpus = uhd::get_thread_affinity();
+    if (cpus.empty()) {
+        BOOST_TEST_MESSAGE("Thread affinity not supported, skipping");
+        return;
+    }
+
+    // A task runs on the CPUs that were the default when it was made
+    std::mutex mutex;
+    std::vector<size_t> task_cpus;
+    std::atomic<bool> done(false);
+    uhd::task::sptr task;
+    {
+        uhd::thread_affinity_scope scope({cpus.back()});
+        task = uhd::task::make([&]() {
+            if (not done) {
+                std::lock_guard<std::mutex> lock(mutex);
+                task_cpus = uhd::get_thread_affinity();
+                done      = true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (not done and std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    task.reset();
+    std::lock_guard<std::mutex> lock(mutex);
+    BOOST_CHECK(task_cpus == std::vector<size_t>({cpus.back()}));
+    BOOST_CHECK(uhd::get_thread_affinity() == cpus);
+}
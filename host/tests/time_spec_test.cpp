@@ -6,6 +6,7 @@
 //
 
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/time_ticks.hpp>
 #include <stdint.h>
 #include <boost/test/unit_test.hpp>
 #include <boost/thread.hpp> //sleep
@@ -105,3 +106,46 @@ BOOST_AUTO_TEST_CASE(test_time_error_irrational_rate)
 
     BOOST_CHECK_EQUAL(err, (long long)(0));
 }
+
+BOOST_AUTO_TEST_CASE(test_time_ticks)
+{
+    BOOST_CHECK(!uhd::time_ticks_t().is_valid());
+
+    // Full seconds are exact, even where a double can't hold the tick count
+    const double rate    = 245.76e6;
+    const uint64_t ticks = (uint64_t(1) << 60) + 1;
+    const uhd::time_ticks_t tt(ticks, rate);
+    BOOST_CHECK(tt.is_valid());
+    BOOST_CHECK_EQUAL(tt.to_ticks(rate), ticks);
+    const uhd::time_spec_t ts = tt.to_time_spec();
+    BOOST_CHECK_EQUAL(ts.get_full_secs(), int64_t(ticks / uint64_t(rate)));
+    BOOST_CHECK_EQUAL(ts.get_tick_count(rate), long(ticks % uint64_t(rate)));
+
+    // Non-integer tick rates fall back to time_spec_t::from_ticks()
+    const double odd_rate = 1625e3 / 6.0;
+    const uhd::time_ticks_t odd(23423436291667ull, odd_rate);
+    BOOST_CHECK(
+        odd.to_time_spec() == uhd::time_spec_t::from_ticks(23423436291667ll, odd_rate));
+    BOOST_CHECK_EQUAL(
+        uhd::time_ticks_t::from_time_spec(odd.to_time_spec(), odd_rate).get_ticks(),
+        23423436291667ull);
+
+    // Converting to another clock domain goes through seconds
+    const uhd::time_ticks_t one_sec(100000000, 100e6);
+    BOOST_CHECK_EQUAL(one_sec.to_ticks(200e6), 200000000u);
+}
+
+BOOST_AUTO_TEST_CASE(test_time_ticks_advance)
+{
+    // Integer number of ticks per sample: exact
+    uhd::time_ticks_t tt(10, 200e6);
+    tt.advance(1000, 50e6);
+    BOOST_CHECK_EQUAL(tt.get_ticks(), 4010u);
+
+    // Otherwise rounded to the nearest tick
+    uhd::time_ticks_t odd(0, 100e6);
+    odd.advance(7, 30e6);
+    BOOST_CHECK_EQUAL(odd.get_ticks(), 23u);
+    BOOST_CHECK(odd == uhd::time_ticks_t(23, 100e6));
+    BOOST_CHECK(odd != uhd::time_ticks_t(23, 200e6));
+}
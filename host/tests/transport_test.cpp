@@ -8,6 +8,9 @@
 #include "common/mock_transport.hpp"
 #include <uhdlib/transport/inline_io_service.hpp>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <vector>
 
 using namespace uhd::transport;
 
@@ -116,6 +119,71 @@ BOOST_AUTO_TEST_CASE(test_io)
     recv_xport->release_data_buff(std::move(recv_buff));
 }
 
+BOOST_AUTO_TEST_CASE(test_adaptive_wait_io)
+{
+    auto io_srv     = inline_io_service::make();
+    auto send_link0 = make_send_link(40);
+    io_srv->attach_send_link(send_link0);
+    auto recv_link0 = make_recv_link(40);
+    io_srv->attach_recv_link(recv_link0);
+    auto send_xport = make_send_xport(io_srv, send_link0, recv_link0, 1, 2, 32);
+
+    // Only the clients of this link poll before they block
+    auto send_link1 = make_send_link(40);
+    io_srv->attach_send_link(send_link1);
+    auto recv_link1 = make_recv_link(40);
+    io_srv->attach_recv_link(recv_link1);
+    io_srv->set_adaptive_wait(recv_link1, 1e-3);
+    auto recv_xport = make_recv_xport(io_srv, recv_link1, send_link1, 1, 2, 32);
+
+    // A packet that is already there is picked up while polling
+    auto send_buff = send_xport->get_data_buff(0);
+    UHD_ASSERT_THROW(send_buff);
+    send_xport->release_data_buff(send_buff, 16);
+    auto packet = send_link0->pop_send_packet();
+    recv_link1->push_back_recv_packet(packet.first, packet.second);
+    auto recv_buff = recv_xport->get_data_buff(100);
+    BOOST_REQUIRE(recv_buff);
+    recv_xport->release_data_buff(std::move(recv_buff));
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link1).num_spin_hits, 1);
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link1).num_blocks, 0);
+
+    // Without a packet, the wait ends up blocking
+    BOOST_CHECK(!recv_xport->get_data_buff(10));
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link1).num_blocks, 1);
+
+    // The send client has no adaptive wait
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link0).num_spin_hits, 0);
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link0).num_blocks, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_adaptive_wait_muxed_io)
+{
+    auto io_srv    = inline_io_service::make();
+    auto send_link = make_send_link(80);
+    io_srv->attach_send_link(send_link);
+    auto recv_link = make_recv_link(80);
+    io_srv->attach_recv_link(recv_link);
+
+    // Each client gets its own wait, the mode is decided when it connects
+    io_srv->set_adaptive_wait(recv_link, 1e-3);
+    auto recv_xport0 = make_recv_xport(io_srv, recv_link, send_link, 1, 2, 32);
+    io_srv->set_adaptive_wait(recv_link, 0.0);
+    auto recv_xport1 = make_recv_xport(io_srv, recv_link, send_link, 3, 4, 32);
+    io_srv->set_adaptive_wait(recv_link, 1e-3);
+    auto recv_xport2 = make_recv_xport(io_srv, recv_link, send_link, 5, 6, 32);
+
+    BOOST_CHECK(!recv_xport0->get_data_buff(10));
+    BOOST_CHECK(!recv_xport1->get_data_buff(10));
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link).num_blocks, 1);
+    BOOST_CHECK(!recv_xport2->get_data_buff(10));
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link).num_blocks, 2);
+
+    // The statistics of a client go away with it
+    recv_xport0.reset();
+    BOOST_CHECK_EQUAL(io_srv->get_adaptive_wait_stats(recv_link).num_blocks, 1);
+}
+
 BOOST_AUTO_TEST_CASE(test_muxed_io)
 {
     auto io_srv    = inline_io_service::make();
@@ -166,6 +234,154 @@ BOOST_AUTO_TEST_CASE(test_muxed_io)
     UHD_ASSERT_THROW(msg == 0xa5d3b33f);
 }
 
+/*
+ * Receivers for routing tests. Packets carry their destination EPID in their
+ * first two bytes.
+ */
+static uint16_t get_test_epid(const void* frame)
+{
+    uint16_t epid;
+    std::memcpy(&epid, frame, sizeof(epid));
+    return epid;
+}
+
+struct test_receiver
+{
+    test_receiver(io_service::sptr io_srv,
+        recv_link_if::sptr recv_link,
+        const uint16_t epid,
+        const bool routed)
+        : epid(epid)
+    {
+        auto cb = [this](frame_buff::uptr& buff, recv_link_if*, send_link_if*) {
+            num_callbacks++;
+            return get_test_epid(buff->data()) == this->epid;
+        };
+        auto release_cb = [](frame_buff::uptr buff, recv_link_if* link, send_link_if*) {
+            link->release_recv_buff(std::move(buff));
+        };
+        const recv_route_t route = {routed ? &get_test_epid : nullptr, epid};
+        recv_io = io_srv->make_recv_client(
+            recv_link, 1, cb, send_link_if::sptr(), 0, release_cb, route);
+    }
+
+    //! Receive a packet, and return its EPID (or -1 on timeout)
+    int recv()
+    {
+        auto buff = recv_io->get_recv_buff(0);
+        if (!buff) {
+            return -1;
+        }
+        const int result = get_test_epid(buff->data());
+        recv_io->release_recv_buff(std::move(buff));
+        return result;
+    }
+
+    const uint16_t epid;
+    size_t num_callbacks = 0;
+    recv_io_if::sptr recv_io;
+};
+
+static void push_epid_packet(mock_recv_link::sptr recv_link, const uint16_t epid)
+{
+    boost::shared_array<uint8_t> data(new uint8_t[16]());
+    std::memcpy(data.get(), &epid, sizeof(epid));
+    recv_link->push_back_recv_packet(data, 16);
+}
+
+BOOST_AUTO_TEST_CASE(test_routed_mux)
+{
+    auto io_srv    = inline_io_service::make();
+    auto recv_link = make_recv_link(16);
+    io_srv->attach_recv_link(recv_link);
+
+    // Routed receivers for EPIDs 10 to 13, and a catch-all receiver
+    std::vector<std::unique_ptr<test_receiver>> rcvrs;
+    for (uint16_t epid = 10; epid < 14; epid++) {
+        rcvrs.emplace_back(new test_receiver(io_srv, recv_link, epid, true));
+    }
+    auto cb = [](frame_buff::uptr&, recv_link_if*, send_link_if*) { return true; };
+    auto release_cb = [](frame_buff::uptr buff, recv_link_if* link, send_link_if*) {
+        link->release_recv_buff(std::move(buff));
+    };
+    auto catch_all = io_srv->make_recv_client(
+        recv_link, 1, cb, send_link_if::sptr(), 0, release_cb);
+
+    // Packets for other receivers are queued, and only offered to the receiver
+    // of their EPID
+    for (const uint16_t epid : {13, 11, 12, 10}) {
+        push_epid_packet(recv_link, epid);
+    }
+    BOOST_CHECK_EQUAL(rcvrs[0]->recv(), 10);
+    for (const auto& rcvr : rcvrs) {
+        BOOST_CHECK_EQUAL(rcvr->num_callbacks, 1);
+    }
+    BOOST_CHECK_EQUAL(rcvrs[3]->recv(), 13);
+    BOOST_CHECK_EQUAL(rcvrs[1]->recv(), 11);
+    BOOST_CHECK_EQUAL(rcvrs[2]->recv(), 12);
+    BOOST_CHECK_EQUAL(rcvrs[2]->recv(), -1);
+
+    // Packets no routed receiver takes fall back to the others
+    push_epid_packet(recv_link, 20);
+    push_epid_packet(recv_link, 12);
+    auto buff = catch_all->get_recv_buff(0);
+    BOOST_REQUIRE(buff);
+    BOOST_CHECK_EQUAL(get_test_epid(buff->data()), 20);
+    catch_all->release_recv_buff(std::move(buff));
+    BOOST_CHECK_EQUAL(rcvrs[2]->recv(), 12);
+
+    // A disconnected receiver is no longer offered packets
+    rcvrs[1].reset();
+    push_epid_packet(recv_link, 11);
+    buff = catch_all->get_recv_buff(0);
+    BOOST_REQUIRE(buff);
+    BOOST_CHECK_EQUAL(get_test_epid(buff->data()), 11);
+    catch_all->release_recv_buff(std::move(buff));
+}
+
+BOOST_AUTO_TEST_CASE(test_routed_mux_benchmark)
+{
+    constexpr size_t num_packets = 100000;
+    for (const size_t num_rcvrs : {1, 4, 16, 64}) {
+        for (const bool routed : {false, true}) {
+            auto io_srv    = inline_io_service::make();
+            auto recv_link = make_recv_link(num_rcvrs);
+            io_srv->attach_recv_link(recv_link);
+            std::vector<std::unique_ptr<test_receiver>> rcvrs;
+            for (size_t i = 0; i < num_rcvrs; i++) {
+                rcvrs.emplace_back(
+                    new test_receiver(io_srv, recv_link, uint16_t(i), routed));
+            }
+
+            const size_t num_rounds = num_packets / num_rcvrs;
+            std::chrono::nanoseconds elapsed(0);
+            for (size_t round = 0; round < num_rounds; round++) {
+                for (size_t i = 0; i < num_rcvrs; i++) {
+                    push_epid_packet(recv_link, uint16_t(i));
+                }
+                const auto start = std::chrono::steady_clock::now();
+                for (const auto& rcvr : rcvrs) {
+                    rcvr->recv();
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+            }
+
+            size_t num_callbacks = 0;
+            for (const auto& rcvr : rcvrs) {
+                num_callbacks += rcvr->num_callbacks;
+            }
+            const double packets = double(num_rounds * num_rcvrs);
+            BOOST_TEST_MESSAGE(num_rcvrs
+                               << " receivers, " << (routed ? "routed" : "unrouted")
+                               << ": " << (elapsed.count() / packets) << " ns and "
+                               << (num_callbacks / packets) << " callbacks per packet");
+            if (routed) {
+                BOOST_CHECK_EQUAL(num_callbacks, num_rounds * num_rcvrs);
+            }
+        }
+    }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(test_oversubscribed)
 {
@@ -0,0 +1,244 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/utils/tx_file_source.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace uhd;
+namespace fs = boost::filesystem;
+
+namespace {
+
+/*! TX streamer that stores the samples and metadata it was sent
+ *
+ * A timeout can be injected after a given number of samples.
+ */
+class mock_tx_streamer : public tx_streamer
+{
+public:
+    struct burst_t
+    {
+        std::vector<std::vector<uint32_t>> samps;
+        bool has_time_spec = false;
+        time_spec_t time_spec;
+        bool end_of_burst = false;
+    };
+
+    mock_tx_streamer(const size_t num_chans, const size_t spp)
+        : _num_chans(num_chans), _spp(spp)
+    {
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return _num_chans;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return _spp;
+    }
+
+    size_t send(const buffs_type& buffs,
+        const size_t nsamps_per_buff,
+        const tx_metadata_t& metadata,
+        const double)
+    {
+        if (metadata.start_of_burst || bursts.empty() || bursts.back().end_of_burst) {
+            BOOST_REQUIRE(metadata.start_of_burst);
+            bursts.push_back(burst_t());
+            bursts.back().samps.resize(_num_chans);
+            bursts.back().has_time_spec = metadata.has_time_spec;
+            bursts.back().time_spec     = metadata.time_spec;
+        }
+        const size_t num_samps = std::min(nsamps_per_buff, _timeout_after);
+        _timeout_after -= num_samps;
+        auto& burst = bursts.back();
+        for (size_t chan = 0; chan < _num_chans; chan++) {
+            const uint32_t* buff = reinterpret_cast<const uint32_t*>(buffs[chan]);
+            burst.samps[chan].insert(burst.samps[chan].end(), buff, buff + num_samps);
+        }
+        burst.end_of_burst = metadata.end_of_burst && num_samps == nsamps_per_buff;
+        return num_samps;
+    }
+
+    bool recv_async_msg(async_metadata_t&, double)
+    {
+        return false;
+    }
+
+    void inject_timeout(const size_t after)
+    {
+        _timeout_after = after;
+    }
+
+    std::vector<burst_t> bursts;
+
+private:
+    const size_t _num_chans;
+    const size_t _spp;
+    size_t _timeout_after = ~size_t(0);
+};
+
+struct tmp_dir
+{
+    tmp_dir(void) : path(fs::temp_directory_path() / fs::unique_path())
+    {
+        fs::create_directories(path);
+    }
+
+    ~tmp_dir(void)
+    {
+        fs::remove_all(path);
+    }
+
+    const fs::path path;
+};
+
+//! Write a file where sample n has the value (tag << 24) | n
+std::string write_file(const fs::path& path, const uint32_t tag, const size_t num_samps)
+{
+    std::vector<uint32_t> data(num_samps);
+    for (size_t i = 0; i < num_samps; i++) {
+        data[i] = (tag << 24) | uint32_t(i);
+    }
+    std::ofstream file(path.string(), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), num_samps * sizeof(uint32_t));
+    return path.string();
+}
+
+void check_counter(const std::vector<uint32_t>& samps,
+    const uint32_t tag,
+    const size_t first,
+    const size_t num_file_samps)
+{
+    for (size_t i = 0; i < samps.size(); i++) {
+        BOOST_REQUIRE_EQUAL(
+            samps[i], (tag << 24) | uint32_t((first + i) % num_file_samps));
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_tx_file_source_single_burst)
+{
+    tmp_dir dir;
+    auto tx_stream = std::make_shared<mock_tx_streamer>(2, 1000);
+
+    tx_file_source::config_t config;
+    config.filenames = {write_file(dir.path / "a.dat", 1, 10500),
+        write_file(dir.path / "b.dat", 2, 10500)};
+    auto source = tx_file_source::make(tx_stream, config);
+    BOOST_CHECK_EQUAL(source->get_num_samps(), 10500);
+
+    source->set_start_time(time_spec_t(1.5));
+    BOOST_CHECK_EQUAL(source->play(), 10500);
+    BOOST_REQUIRE_EQUAL(tx_stream->bursts.size(), 1);
+    const auto& burst = tx_stream->bursts[0];
+    BOOST_CHECK(burst.has_time_spec);
+    BOOST_CHECK_EQUAL(burst.time_spec.get_real_secs(), 1.5);
+    BOOST_CHECK(burst.end_of_burst);
+    BOOST_REQUIRE_EQUAL(burst.samps[0].size(), 10500);
+    check_counter(burst.samps[0], 1, 0, 10500);
+    check_counter(burst.samps[1], 2, 0, 10500);
+
+    // At the end of the file, there's nothing left to send
+    BOOST_CHECK_EQUAL(source->play(), 0);
+    BOOST_CHECK_EQUAL(tx_stream->bursts.size(), 1);
+
+    // Bursts of a given length, without a start time
+    source->seek(10000);
+    BOOST_CHECK_EQUAL(source->play(300), 300);
+    BOOST_CHECK_EQUAL(source->play(300), 200);
+    BOOST_REQUIRE_EQUAL(tx_stream->bursts.size(), 3);
+    BOOST_CHECK(!tx_stream->bursts[1].has_time_spec);
+    BOOST_CHECK(tx_stream->bursts[1].end_of_burst);
+    check_counter(tx_stream->bursts[1].samps[1], 2, 10000, 10500);
+    check_counter(tx_stream->bursts[2].samps[0], 1, 10300, 10500);
+    BOOST_CHECK_THROW(source->seek(10500), uhd::index_error);
+
+    const auto stats = source->get_stats();
+    BOOST_CHECK_EQUAL(stats.num_samps, 11000);
+    BOOST_CHECK_EQUAL(stats.num_loops, 0);
+    BOOST_CHECK_GE(stats.bytes_prefetched, 2 * 10500 * sizeof(uint32_t));
+}
+
+BOOST_AUTO_TEST_CASE(test_tx_file_source_loop)
+{
+    tmp_dir dir;
+    auto tx_stream = std::make_shared<mock_tx_streamer>(2, 700);
+
+    // One file for both channels, much larger than the prefetch size, so
+    // pages are released behind the cursor
+    const size_t num_file_samps = 3 * 1024 * 1024 / sizeof(uint32_t) + 123;
+    tx_file_source::config_t config;
+    config.filenames      = {write_file(dir.path / "a.dat", 3, num_file_samps)};
+    config.samps_per_send = 5000;
+    config.prefetch_size  = 1;
+    config.loop           = true;
+    auto source           = tx_file_source::make(tx_stream, config);
+
+    // Seamless: one burst across the end of the file
+    const size_t num_samps = 2 * num_file_samps + 4321;
+    BOOST_CHECK_EQUAL(source->play(num_samps), num_samps);
+    BOOST_REQUIRE_EQUAL(tx_stream->bursts.size(), 1);
+    BOOST_CHECK(tx_stream->bursts[0].end_of_burst);
+    for (size_t chan = 0; chan < 2; chan++) {
+        BOOST_REQUIRE_EQUAL(tx_stream->bursts[0].samps[chan].size(), num_samps);
+        check_counter(tx_stream->bursts[0].samps[chan], 3, 0, num_file_samps);
+    }
+    BOOST_CHECK_EQUAL(source->get_stats().num_loops, 2);
+
+    // The next burst picks up where the last one ended
+    BOOST_CHECK_EQUAL(source->play(100), 100);
+    check_counter(tx_stream->bursts[1].samps[0], 3, 4321, num_file_samps);
+}
+
+BOOST_AUTO_TEST_CASE(test_tx_file_source_stop)
+{
+    tmp_dir dir;
+    auto tx_stream = std::make_shared<mock_tx_streamer>(1, 1000);
+
+    tx_file_source::config_t config;
+    config.filenames = {write_file(dir.path / "a.dat", 0, 5000)};
+    config.loop      = true;
+    auto source      = tx_file_source::make(tx_stream, config);
+
+    // A timeout ends the burst
+    tx_stream->inject_timeout(12345);
+    BOOST_CHECK_EQUAL(source->play(), 12345);
+    BOOST_REQUIRE_EQUAL(tx_stream->bursts.size(), 1);
+    BOOST_CHECK(tx_stream->bursts[0].end_of_burst);
+
+    // Stopping is sticky
+    source->stop();
+    BOOST_CHECK_EQUAL(source->play(), 0);
+    BOOST_CHECK_EQUAL(tx_stream->bursts.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_tx_file_source_config)
+{
+    tmp_dir dir;
+    auto tx_stream = std::make_shared<mock_tx_streamer>(2, 1000);
+    const auto a   = write_file(dir.path / "a.dat", 0, 100);
+    const auto b   = write_file(dir.path / "b.dat", 0, 200);
+    const auto c   = write_file(dir.path / "c.dat", 0, 0);
+
+    tx_file_source::config_t config;
+    config.filenames = {a, b};
+    BOOST_CHECK_THROW(tx_file_source::make(tx_stream, config), uhd::value_error);
+    config.filenames = {a, a, a};
+    BOOST_CHECK_THROW(tx_file_source::make(tx_stream, config), uhd::value_error);
+    config.filenames = {c};
+    BOOST_CHECK_THROW(tx_file_source::make(tx_stream, config), uhd::value_error);
+    config.filenames = {(dir.path / "missing.dat").string()};
+    BOOST_CHECK_THROW(tx_file_source::make(tx_stream, config), uhd::io_error);
+}
@@ -7,6 +7,7 @@
 #include "../common/mock_link.hpp"
 #include <uhdlib/transport/tx_streamer_impl.hpp>
 #include <boost/test/unit_test.hpp>
+#include <cmath>
 #include <iostream>
 #include <memory>
 
@@ -556,6 +557,125 @@ BOOST_AUTO_TEST_CASE(test_send_one_channel_multi_packet)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_send_one_channel_multi_packet_ticks)
+{
+    const std::string format("fc32");
+
+    auto send_links = make_links(1);
+    auto streamer   = make_tx_streamer(send_links, format);
+
+    // A tick count that can't be represented exactly by a double, to make sure
+    // it is passed through without a detour via time_spec_t. The time_spec is
+    // left at zero, as time_ticks takes precedence.
+    const uint64_t start_ticks = (uint64_t(1) << 60) + 1;
+    uhd::tx_metadata_t metadata;
+    metadata.has_time_spec  = true;
+    metadata.time_ticks     = uhd::time_ticks_t(start_ticks, TICK_RATE);
+    metadata.has_time_ticks = true;
+    metadata.end_of_burst   = true;
+
+    const size_t spp       = streamer->get_max_num_samps();
+    const size_t num_samps = spp * 3;
+    std::vector<std::complex<float>> buff(num_samps);
+    BOOST_CHECK_EQUAL(streamer->send(&buff.front(), num_samps, metadata, 1.0), num_samps);
+
+    const uint64_t ticks_per_samp = uint64_t(TICK_RATE / SAMP_RATE);
+    size_t samps_checked          = 0;
+    while (samps_checked < num_samps) {
+        mock_tx_data_xport::packet_info_t info;
+        std::complex<uint16_t>* data;
+        size_t packet_samps;
+        boost::shared_array<uint8_t> frame_buff;
+
+        std::tie(info, data, packet_samps, frame_buff) = pop_send_packet(send_links[0]);
+        BOOST_CHECK(info.has_tsf);
+        BOOST_CHECK_EQUAL(info.tsf, start_ticks + samps_checked * ticks_per_samp);
+        samps_checked += packet_samps;
+    }
+    BOOST_CHECK_EQUAL(samps_checked, num_samps);
+}
+
+BOOST_AUTO_TEST_CASE(test_send_one_channel_multi_packet_ticks_fractional)
+{
+    const std::string format("fc32");
+
+    auto send_links = make_links(1);
+    auto streamer   = make_tx_streamer(send_links, format);
+    // 33 1/3 ticks per sample: every fragment falls between two ticks, and its
+    // rounding error must not carry over to the next one
+    const double samp_rate = 3e6;
+    streamer->set_samp_rate(samp_rate);
+
+    const uint64_t start_ticks = 1000;
+    uhd::tx_metadata_t metadata;
+    metadata.has_time_spec  = true;
+    metadata.time_ticks     = uhd::time_ticks_t(start_ticks, TICK_RATE);
+    metadata.has_time_ticks = true;
+    metadata.end_of_burst   = true;
+
+    const size_t spp       = streamer->get_max_num_samps();
+    const size_t num_samps = spp * 10;
+    BOOST_REQUIRE(spp % 3 != 0);
+    std::vector<std::complex<float>> buff(num_samps);
+    BOOST_CHECK_EQUAL(streamer->send(&buff.front(), num_samps, metadata, 1.0), num_samps);
+
+    size_t samps_checked = 0;
+    while (samps_checked < num_samps) {
+        mock_tx_data_xport::packet_info_t info;
+        std::complex<uint16_t>* data;
+        size_t packet_samps;
+        boost::shared_array<uint8_t> frame_buff;
+
+        std::tie(info, data, packet_samps, frame_buff) = pop_send_packet(send_links[0]);
+        BOOST_CHECK(info.has_tsf);
+        BOOST_CHECK_EQUAL(info.tsf,
+            start_ticks + uint64_t(std::llround(samps_checked * TICK_RATE / samp_rate)));
+        samps_checked += packet_samps;
+    }
+    BOOST_CHECK_EQUAL(samps_checked, num_samps);
+}
+
+BOOST_AUTO_TEST_CASE(test_send_one_channel_stale_ticks)
+{
+    const std::string format("fc32");
+
+    auto send_links = make_links(1);
+    auto streamer   = make_tx_streamer(send_links, format);
+
+    // Metadata that is reused with a new time_spec keeps its old time_ticks,
+    // which must not be used unless it is asked for
+    uhd::tx_metadata_t metadata;
+    metadata.has_time_spec  = true;
+    metadata.time_ticks     = uhd::time_ticks_t(1000, TICK_RATE);
+    metadata.has_time_ticks = true;
+    metadata.end_of_burst   = true;
+
+    std::vector<std::complex<float>> buff(20);
+    mock_tx_data_xport::packet_info_t info;
+    std::complex<uint16_t>* data;
+    size_t packet_samps;
+    boost::shared_array<uint8_t> frame_buff;
+
+    BOOST_CHECK_EQUAL(streamer->send(&buff.front(), buff.size(), metadata, 1.0), 20);
+    std::tie(info, data, packet_samps, frame_buff) = pop_send_packet(send_links[0]);
+    BOOST_CHECK(info.has_tsf);
+    BOOST_CHECK_EQUAL(info.tsf, 1000);
+
+    metadata.has_time_ticks = false;
+    metadata.time_spec      = uhd::time_spec_t::from_ticks(5000, TICK_RATE);
+    BOOST_CHECK_EQUAL(streamer->send(&buff.front(), buff.size(), metadata, 1.0), 20);
+    std::tie(info, data, packet_samps, frame_buff) = pop_send_packet(send_links[0]);
+    BOOST_CHECK(info.has_tsf);
+    BOOST_CHECK_EQUAL(info.tsf, 5000);
+
+    // Without has_time_spec, neither of them is used
+    metadata.has_time_spec  = false;
+    metadata.has_time_ticks = true;
+    BOOST_CHECK_EQUAL(streamer->send(&buff.front(), buff.size(), metadata, 1.0), 20);
+    std::tie(info, data, packet_samps, frame_buff) = pop_send_packet(send_links[0]);
+    BOOST_CHECK(!info.has_tsf);
+}
+
 BOOST_AUTO_TEST_CASE(test_send_two_channel_one_packet)
 {
     const size_t NUM_PKTS_TO_TEST = 30;
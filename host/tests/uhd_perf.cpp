@@ -0,0 +1,690 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// Description:
+//
+// Headless performance suite. Runs micro-benchmarks of the converters, the
+// streamers, the I/O services, the control port endpoint and the property
+// tree against mock links and transports, so no hardware is required.
+//
+// Results are printed as a table, and can optionally be written to a JSON
+// file. A previously written JSON file can be passed in as a baseline; any
+// benchmark that got slower than the baseline by more than the tolerance is
+// flagged, and the program exits with a non-zero status.
+//
+// The results depend on the host, so no baseline is shipped with UHD. To gate
+// an upgrade, record a baseline with the current version on the machine that
+// will run the new one, with nothing else running on it:
+//     uhd_perf --json baseline.json
+// After the upgrade, compare against that file:
+//     uhd_perf --baseline baseline.json --tolerance 0.1
+// Keep --suites, --filter, --duration and --repeat the same for both runs.
+// Benchmarks that are missing from the baseline are reported, but not compared.
+//
+
+#include "common/mock_link.hpp"
+#include <uhd/convert.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/rfnoc/chdr_types.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/version.hpp>
+#include <uhdlib/rfnoc/chdr_rx_data_xport.hpp>
+#include <uhdlib/rfnoc/chdr_tx_data_xport.hpp>
+#include <uhdlib/rfnoc/clock_iface.hpp>
+#include <uhdlib/rfnoc/ctrlport_endpoint.hpp>
+#include <uhdlib/transport/inline_io_service.hpp>
+#include <uhdlib/transport/offload_io_service.hpp>
+#include <uhdlib/transport/rx_streamer_impl.hpp>
+#include <uhdlib/transport/tx_streamer_impl.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace uhd;
+using namespace uhd::rfnoc;
+using namespace uhd::transport;
+
+static const double TICK_RATE  = 100e6;
+static const double SAMP_RATE  = 10e6;
+static const size_t SPP        = 1000;
+static const size_t NUM_FRAMES = 32;
+
+/***********************************************************************
+ * Benchmark registry and timing
+ **********************************************************************/
+//! The result of a single benchmark. Lower values are always better.
+struct perf_result_t
+{
+    std::string suite;
+    std::string name;
+    std::string unit;
+    double value;
+
+    std::string key() const
+    {
+        return suite + "/" + name;
+    }
+};
+
+//! A benchmark returns the time per unit of work (in ns), given the minimum
+// duration to run for.
+using perf_fn_t = std::function<double(double)>;
+
+struct perf_case_t
+{
+    std::string suite;
+    std::string name;
+    std::string unit;
+    perf_fn_t fn;
+};
+
+/*! Time an operation
+ *
+ * Runs \p op in batches of growing size until a batch takes at least
+ * \p min_duration seconds, and returns the time per call in ns.
+ */
+static double time_op(const std::function<void()>& op, const double min_duration)
+{
+    op(); // Warm up caches and lazily allocated state
+    size_t iterations = 1;
+    while (true) {
+        const auto start_time = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            op();
+        }
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+        if (elapsed.count() >= min_duration) {
+            return elapsed.count() * 1e9 / iterations;
+        }
+        iterations *= (elapsed.count() < min_duration / 10) ? 10 : 2;
+    }
+}
+
+/***********************************************************************
+ * Converters
+ **********************************************************************/
+static perf_fn_t make_converter_bench(
+    const std::string& in_format, const std::string& out_format)
+{
+    return [in_format, out_format](const double min_duration) {
+        convert::id_type id;
+        id.input_format  = in_format;
+        id.num_inputs    = 1;
+        id.output_format = out_format;
+        id.num_outputs   = 1;
+        auto conv        = convert::get_converter(id)();
+        conv->set_scalar(32767.);
+
+        // Allocate for the largest item size (fc64) on both sides
+        std::vector<uint8_t> in_buff(SPP * 16), out_buff(SPP * 16);
+        const convert::converter::input_type inputs{in_buff.data()};
+        const convert::converter::output_type outputs{out_buff.data()};
+        return time_op([&]() { conv->conv(inputs, outputs, SPP); }, min_duration)
+               / SPP;
+    };
+}
+
+static void add_converter_benches(std::vector<perf_case_t>& cases)
+{
+    const std::vector<std::pair<std::string, std::string>> conversions{
+        {"fc32", "sc16_item32_le"},
+        {"sc16_item32_le", "fc32"},
+        {"fc32", "sc16_item32_be"},
+        {"sc16_item32_be", "fc32"},
+        {"fc32", "sc16_chdr"},
+        {"sc16_chdr", "fc32"},
+        {"sc16", "sc16_chdr"},
+        {"sc16_chdr", "sc16"},
+        {"fc32", "sc8_item32_le"},
+        {"sc8_item32_le", "fc32"},
+        {"fc32", "sc12_item32_le"},
+        {"sc12_item32_le", "fc32"},
+    };
+    for (const auto& conversion : conversions) {
+        cases.push_back({"converters",
+            conversion.first + "->" + conversion.second,
+            "ns/sample",
+            make_converter_bench(conversion.first, conversion.second)});
+    }
+}
+
+/***********************************************************************
+ * Streamers over mock links
+ **********************************************************************/
+class mock_rx_streamer : public rx_streamer_impl<chdr_rx_data_xport, true>
+{
+public:
+    using base_t = rx_streamer_impl<chdr_rx_data_xport, true>;
+
+    mock_rx_streamer(const uhd::stream_args_t& stream_args) : base_t(1, stream_args)
+    {
+        base_t::set_tick_rate(TICK_RATE);
+        base_t::set_samp_rate(SAMP_RATE);
+        base_t::set_scale_factor(0, 1.0 / 32767.);
+    }
+
+    void issue_stream_cmd(const stream_cmd_t& /*stream_cmd*/) {}
+};
+
+class mock_tx_streamer : public tx_streamer_impl<chdr_tx_data_xport>
+{
+public:
+    using base_t = tx_streamer_impl<chdr_tx_data_xport>;
+
+    mock_tx_streamer(const uhd::stream_args_t& stream_args) : base_t(1, stream_args)
+    {
+        base_t::set_tick_rate(TICK_RATE);
+        base_t::set_samp_rate(SAMP_RATE);
+        base_t::set_scale_factor(0, 32767.);
+    }
+
+    bool recv_async_msg(uhd::async_metadata_t& /*async_metadata*/, double /*timeout*/)
+    {
+        return false;
+    }
+};
+
+static perf_fn_t make_rx_streamer_bench(const std::string& format)
+{
+    return [format](const double min_duration) {
+        auto streamer = std::make_shared<mock_rx_streamer>(stream_args_t(format, "sc16"));
+
+        const chdr::chdr_packet_factory pkt_factory(CHDR_W_64, ENDIANNESS_BIG);
+        const sep_id_pair_t epids                = {0, 1};
+        const stream_buff_params_t buff_capacity = {UINT64_MAX, UINT32_MAX};
+        const stream_buff_params_t fc_freq       = {UINT64_MAX, UINT32_MAX};
+        const chdr_rx_data_xport::fc_params_t fc_params{buff_capacity, fc_freq};
+        const size_t frame_size = SPP * 4 + 16;
+
+        // The recv link hands out the same data packet over and over
+        auto recv_link = std::make_shared<mock_recv_link>(
+            mock_recv_link::link_params{frame_size, NUM_FRAMES}, true);
+        auto send_link = std::make_shared<mock_send_link>(
+            mock_send_link::link_params{frame_size, NUM_FRAMES}, true);
+        boost::shared_array<uint8_t> recv_frame(new uint8_t[frame_size]);
+        auto pkt = pkt_factory.make_generic();
+        chdr::chdr_header header;
+        header.set_pkt_type(chdr::PKT_TYPE_DATA_WITH_TS);
+        header.set_length(frame_size);
+        header.set_dst_epid(epids.second);
+        pkt->refresh(recv_frame.get(), header, 1000 /*tsf*/);
+        recv_link->push_back_recv_packet(recv_frame, frame_size);
+
+        auto io_srv = inline_io_service::make();
+        io_srv->attach_recv_link(recv_link);
+        io_srv->attach_send_link(send_link);
+        streamer->connect_channel(0,
+            std::make_unique<chdr_rx_data_xport>(io_srv,
+                recv_link,
+                send_link,
+                pkt_factory,
+                epids,
+                send_link->get_num_send_frames(),
+                fc_params,
+                [io_srv, recv_link, send_link]() {
+                    io_srv->detach_recv_link(recv_link);
+                    io_srv->detach_send_link(send_link);
+                }));
+
+        std::vector<uint8_t> buff(SPP * convert::get_bytes_per_item(format));
+        uhd::rx_metadata_t md;
+        return time_op([&]() { streamer->recv(buff.data(), SPP, md, 1.0, true); },
+                   min_duration)
+               / SPP;
+    };
+}
+
+static perf_fn_t make_tx_streamer_bench(const std::string& format)
+{
+    return [format](const double min_duration) {
+        auto streamer = std::make_shared<mock_tx_streamer>(stream_args_t(format, "sc16"));
+
+        const chdr::chdr_packet_factory pkt_factory(CHDR_W_64, ENDIANNESS_BIG);
+        const sep_id_pair_t epids                = {0, 1};
+        const stream_buff_params_t buff_capacity = {UINT64_MAX, UINT32_MAX};
+        const chdr_tx_data_xport::fc_params_t fc_params{buff_capacity};
+        const size_t frame_size = SPP * 4 + 16;
+
+        auto recv_link = std::make_shared<mock_recv_link>(
+            mock_recv_link::link_params{frame_size, NUM_FRAMES}, true);
+        auto send_link = std::make_shared<mock_send_link>(
+            mock_send_link::link_params{frame_size, NUM_FRAMES}, true);
+
+        auto io_srv = inline_io_service::make();
+        io_srv->attach_recv_link(recv_link);
+        io_srv->attach_send_link(send_link);
+        streamer->connect_channel(0,
+            std::make_unique<chdr_tx_data_xport>(io_srv,
+                recv_link,
+                send_link,
+                pkt_factory,
+                epids,
+                send_link->get_num_send_frames(),
+                fc_params,
+                [io_srv, recv_link, send_link]() {
+                    io_srv->detach_recv_link(recv_link);
+                    io_srv->detach_send_link(send_link);
+                }));
+
+        std::vector<uint8_t> buff(SPP * convert::get_bytes_per_item(format));
+        uhd::tx_metadata_t md;
+        md.has_time_spec = true;
+        md.time_spec     = uhd::time_spec_t(0.0);
+        return time_op([&]() { streamer->send(buff.data(), SPP, md, 1.0); },
+                   min_duration)
+               / SPP;
+    };
+}
+
+static void add_streamer_benches(std::vector<perf_case_t>& cases)
+{
+    for (const std::string format : {"sc16", "fc32"}) {
+        cases.push_back({"streamers",
+            "rx_" + format,
+            "ns/sample",
+            make_rx_streamer_bench(format)});
+        cases.push_back({"streamers",
+            "tx_" + format,
+            "ns/sample",
+            make_tx_streamer_bench(format)});
+    }
+}
+
+/***********************************************************************
+ * I/O services
+ **********************************************************************/
+static double bench_send_client(io_service::sptr io_srv, const double min_duration)
+{
+    auto send_link = std::make_shared<mock_send_link>(
+        mock_send_link::link_params{SPP * 4, NUM_FRAMES}, true);
+    io_srv->attach_send_link(send_link);
+    auto send_io = io_srv->make_send_client(
+        send_link,
+        NUM_FRAMES,
+        [](frame_buff::uptr buff, send_link_if* link) {
+            link->release_send_buff(std::move(buff));
+        },
+        recv_link_if::sptr(),
+        0,
+        nullptr,
+        nullptr);
+
+    const double result = time_op(
+        [&]() {
+            auto buff = send_io->get_send_buff(1000);
+            buff->set_packet_size(SPP * 4);
+            send_io->release_send_buff(std::move(buff));
+        },
+        min_duration);
+    send_io.reset();
+    io_srv->detach_send_link(send_link);
+    return result;
+}
+
+static double bench_recv_client(io_service::sptr io_srv, const double min_duration)
+{
+    auto recv_link = std::make_shared<mock_recv_link>(
+        mock_recv_link::link_params{SPP * 4, NUM_FRAMES}, true);
+    boost::shared_array<uint8_t> recv_frame(new uint8_t[SPP * 4]);
+    recv_link->push_back_recv_packet(recv_frame, SPP * 4);
+    io_srv->attach_recv_link(recv_link);
+    auto recv_io = io_srv->make_recv_client(
+        recv_link,
+        NUM_FRAMES,
+        [](frame_buff::uptr&, recv_link_if*, send_link_if*) { return true; },
+        send_link_if::sptr(),
+        0,
+        [](frame_buff::uptr buff, recv_link_if* link, send_link_if*) {
+            link->release_recv_buff(std::move(buff));
+        });
+
+    const double result = time_op(
+        [&]() {
+            auto buff = recv_io->get_recv_buff(1000);
+            recv_io->release_recv_buff(std::move(buff));
+        },
+        min_duration);
+    recv_io.reset();
+    io_srv->detach_recv_link(recv_link);
+    return result;
+}
+
+static io_service::sptr make_offload_io_service(
+    const offload_io_service::client_type_t client_type)
+{
+    offload_io_service::params_t params;
+    params.client_type = client_type;
+    return offload_io_service::make(inline_io_service::make(), params);
+}
+
+static double bench_inline_send(const double min_duration)
+{
+    return bench_send_client(inline_io_service::make(), min_duration);
+}
+
+static double bench_inline_recv(const double min_duration)
+{
+    return bench_recv_client(inline_io_service::make(), min_duration);
+}
+
+static double bench_offload_send(const double min_duration)
+{
+    return bench_send_client(
+        make_offload_io_service(offload_io_service::SEND_ONLY), min_duration);
+}
+
+static double bench_offload_recv(const double min_duration)
+{
+    return bench_recv_client(
+        make_offload_io_service(offload_io_service::RECV_ONLY), min_duration);
+}
+
+static void add_io_service_benches(std::vector<perf_case_t>& cases)
+{
+    cases.push_back({"io_service", "inline_send", "ns/packet", bench_inline_send});
+    cases.push_back({"io_service", "inline_recv", "ns/packet", bench_inline_recv});
+    cases.push_back({"io_service", "offload_send", "ns/packet", bench_offload_send});
+    cases.push_back({"io_service", "offload_recv", "ns/packet", bench_offload_recv});
+}
+
+/***********************************************************************
+ * Control port endpoint
+ **********************************************************************/
+static chdr::ctrl_payload make_ack(const chdr::ctrl_payload& request)
+{
+    chdr::ctrl_payload response(request);
+    response.is_ack = true;
+    response.status = chdr::CMD_OKAY;
+    return response;
+}
+
+//! Posted writes: The ACK is handed back on the calling thread after every poke
+static double bench_ctrlport_poke(const double min_duration)
+{
+    clock_iface client_clk("client", 100e6, false);
+    clock_iface timebase_clk("timebase", TICK_RATE, false);
+    client_clk.set_running(true);
+    timebase_clk.set_running(true);
+
+    chdr::ctrl_payload last_request;
+    auto ctrlport = ctrlport_endpoint::make(
+        [&](const chdr::ctrl_payload& request, double) { last_request = request; },
+        0,
+        0,
+        64,
+        1,
+        client_clk,
+        timebase_clk);
+
+    return time_op(
+        [&]() {
+            ctrlport->poke32(0x1000, 0xdeadbeef);
+            ctrlport->handle_recv(make_ack(last_request));
+        },
+        min_duration);
+}
+
+//! Register reads: The ACK comes from a responder thread, as it would from the
+// I/O thread of a real transport
+static double bench_ctrlport_peek(const double min_duration)
+{
+    clock_iface client_clk("client", 100e6, false);
+    clock_iface timebase_clk("timebase", TICK_RATE, false);
+    client_clk.set_running(true);
+    timebase_clk.set_running(true);
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<chdr::ctrl_payload> requests;
+    bool running = true;
+
+    auto ctrlport = ctrlport_endpoint::make(
+        [&](const chdr::ctrl_payload& request, double) {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(request);
+            cond.notify_one();
+        },
+        0,
+        0,
+        64,
+        1,
+        client_clk,
+        timebase_clk);
+
+    std::thread responder([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cond.wait(lock, [&]() { return !running || !requests.empty(); });
+            if (!running) {
+                return;
+            }
+            const auto request = requests.front();
+            requests.pop_front();
+            lock.unlock();
+            ctrlport->handle_recv(make_ack(request));
+            lock.lock();
+        }
+    });
+
+    const double result =
+        time_op([&]() { ctrlport->peek32(0x1000); }, min_duration);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        cond.notify_one();
+    }
+    responder.join();
+    return result;
+}
+
+static void add_ctrlport_benches(std::vector<perf_case_t>& cases)
+{
+    cases.push_back({"ctrlport", "poke32", "ns/op", bench_ctrlport_poke});
+    cases.push_back({"ctrlport", "peek32", "ns/op", bench_ctrlport_peek});
+}
+
+/***********************************************************************
+ * Property tree
+ **********************************************************************/
+static const fs_path FREQ_PATH = "/mboards/0/dboards/A/rx_frontends/0/freq";
+
+static double bench_prop_set(const double min_duration)
+{
+    auto tree    = property_tree::make();
+    auto& prop   = tree->create<double>(FREQ_PATH);
+    double value = 0.0;
+    return time_op([&]() { prop.set(value += 1.0); }, min_duration);
+}
+
+static double bench_prop_set_coerced(const double min_duration)
+{
+    auto tree  = property_tree::make();
+    auto& prop = tree->create<double>(FREQ_PATH)
+                     .set_coercer([](const double value) { return value * 2; })
+                     .add_coerced_subscriber([](const double) {});
+    double value = 0.0;
+    return time_op([&]() { prop.set(value += 1.0); }, min_duration);
+}
+
+static double bench_prop_access_get(const double min_duration)
+{
+    auto tree = property_tree::make();
+    tree->create<double>(FREQ_PATH).set(1e9);
+    return time_op([&]() { tree->access<double>(FREQ_PATH).get(); }, min_duration);
+}
+
+static void add_property_tree_benches(std::vector<perf_case_t>& cases)
+{
+    cases.push_back({"property_tree", "set", "ns/op", bench_prop_set});
+    cases.push_back({"property_tree", "set_coerced", "ns/op", bench_prop_set_coerced});
+    cases.push_back({"property_tree", "access_get", "ns/op", bench_prop_access_get});
+}
+
+/***********************************************************************
+ * Reporting
+ **********************************************************************/
+static void write_json(const std::string& filename,
+    const std::vector<perf_result_t>& results,
+    const double duration)
+{
+    std::ofstream out(filename);
+    if (!out) {
+        throw uhd::io_error("Could not open " + filename + " for writing");
+    }
+    out << "{\n"
+        << "  \"uhd_version\": \"" << uhd::get_version_string() << "\",\n"
+        << "  \"duration\": " << duration << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        out << "    {\"suite\": \"" << result.suite << "\", \"name\": \"" << result.name
+            << "\", \"unit\": \"" << result.unit << "\", \"value\": "
+            << std::setprecision(6) << result.value << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}\n";
+}
+
+static std::map<std::string, double> read_baseline(const std::string& filename)
+{
+    boost::property_tree::ptree root;
+    boost::property_tree::read_json(filename, root);
+    std::map<std::string, double> baseline;
+    for (const auto& entry : root.get_child("results")) {
+        const auto& result = entry.second;
+        baseline[result.get<std::string>("suite") + "/"
+                 + result.get<std::string>("name")] = result.get<double>("value");
+    }
+    return baseline;
+}
+
+int UHD_SAFE_MAIN(int argc, char* argv[])
+{
+    std::string suites, filter, json_file, baseline_file;
+    double duration, tolerance;
+    size_t repeat;
+
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help", "help message")
+        ("suites", po::value<std::string>(&suites)->default_value("converters,streamers,io_service,ctrlport,property_tree"), "comma-separated list of suites to run")
+        ("filter", po::value<std::string>(&filter)->default_value(""), "only run benchmarks whose suite/name contains this string")
+        ("duration", po::value<double>(&duration)->default_value(0.2), "minimum duration of a single measurement, in seconds")
+        ("repeat", po::value<size_t>(&repeat)->default_value(3), "number of measurements per benchmark, the best one is reported")
+        ("json", po::value<std::string>(&json_file), "write results to this JSON file")
+        ("baseline", po::value<std::string>(&baseline_file), "compare results against this JSON file")
+        ("tolerance", po::value<double>(&tolerance)->default_value(0.1), "relative slowdown vs. the baseline that counts as a regression")
+        ("list", "list available benchmarks and exit")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "UHD Performance Suite " << desc << std::endl;
+        std::cout << "Runs micro-benchmarks against mock transports, no hardware "
+                     "required. Lower values are better."
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<perf_case_t> cases;
+    add_converter_benches(cases);
+    add_streamer_benches(cases);
+    add_io_service_benches(cases);
+    add_ctrlport_benches(cases);
+    add_property_tree_benches(cases);
+
+    std::vector<std::string> suite_list;
+    boost::split(suite_list, suites, boost::is_any_of(","));
+    cases.erase(std::remove_if(cases.begin(),
+                    cases.end(),
+                    [&](const perf_case_t& perf_case) {
+                        return std::find(
+                                   suite_list.begin(), suite_list.end(), perf_case.suite)
+                                   == suite_list.end()
+                               || (perf_case.suite + "/" + perf_case.name).find(filter)
+                                      == std::string::npos;
+                    }),
+        cases.end());
+
+    if (vm.count("list")) {
+        for (const auto& perf_case : cases) {
+            std::cout << perf_case.suite << "/" << perf_case.name << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    std::map<std::string, double> baseline;
+    if (vm.count("baseline")) {
+        baseline = read_baseline(baseline_file);
+    }
+
+    std::vector<perf_result_t> results;
+    size_t num_regressions = 0;
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+              << std::setw(14) << "Result" << std::setw(12) << "Unit"
+              << std::setw(14) << "Baseline" << std::setw(10) << "Change"
+              << std::endl;
+    for (const auto& perf_case : cases) {
+        perf_result_t result{perf_case.suite, perf_case.name, perf_case.unit, 0.0};
+        try {
+            result.value = perf_case.fn(duration);
+            for (size_t i = 1; i < repeat; i++) {
+                result.value = std::min(result.value, perf_case.fn(duration));
+            }
+        } catch (const std::exception& ex) {
+            std::cerr << result.key() << ": skipped (" << ex.what() << ")" << std::endl;
+            continue;
+        }
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(44) << result.key() << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(14)
+                  << result.value << std::setw(12) << result.unit;
+        if (baseline.count(result.key())) {
+            const double reference = baseline.at(result.key());
+            const double change    = (result.value - reference) / reference;
+            std::cout << std::setw(14) << reference << std::setw(9)
+                      << std::setprecision(1) << std::showpos << change * 100 << "%"
+                      << std::noshowpos;
+            if (change > tolerance) {
+                std::cout << "  REGRESSION";
+                num_regressions++;
+            }
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    if (vm.count("json")) {
+        write_json(json_file, results, duration);
+        std::cout << "Wrote results to " << json_file << std::endl;
+    }
+    if (num_regressions) {
+        std::cout << num_regressions << " benchmark(s) regressed by more than "
+                  << tolerance * 100 << "%" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+//
+// Copyright 2020 Ettus Research, a National Instruments Brand
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+
+#include <uhd/exception.hpp>
+#include <uhd/rfnoc/chdr_types.hpp>
+#include <uhd/utils/chdr/pcap_analyzer.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace uhd::rfnoc::chdr;
+using namespace uhd::utils::chdr;
+
+namespace {
+
+std::string type_to_string(const pcap_stream_type_t type)
+{
+    switch (type) {
+        case PCAP_STREAM_DATA:
+            return "DATA";
+        case PCAP_STREAM_CTRL:
+            return "CTRL";
+        case PCAP_STREAM_STRS:
+            return "STRS";
+        case PCAP_STREAM_STRC:
+            return "STRC";
+        case PCAP_STREAM_MGMT:
+            return "MGMT";
+    }
+    return "UNKNOWN";
+}
+
+void print_stats(const pcap_stats_t& stats)
+{
+    std::cout << boost::format("Capture:   %u records, %u CHDR packets, %u ignored, "
+                               "%u malformed, %.6f s")
+                     % stats.num_records % stats.num_chdr_packets % stats.num_ignored
+                     % stats.num_malformed % (stats.last_time - stats.first_time)
+              << std::endl;
+    std::cout << boost::format("Decoded:   %.1f MiB in %.3f s (%.2f Gbps)")
+                     % (stats.num_bytes / 1048576.0) % stats.decode_time
+                     % (stats.get_decode_rate() / 1e9)
+              << std::endl
+              << std::endl;
+
+    std::cout << boost::format("%-6s %-5s %10s %12s %10s %8s %8s %5s\n") % "EPID"
+                     % "Type" % "Packets" % "Bytes" % "Mbps" % "Gaps" % "Lost" % "EOB";
+    for (const auto& stream : stats.streams) {
+        std::cout << boost::format("%-6u %-5s %10u %12u %10.2f %8u %8u %5u\n")
+                         % stream.dst_epid % type_to_string(stream.type)
+                         % stream.num_packets % stream.num_bytes
+                         % (stream.throughput / 1e6) % stream.num_seq_gaps
+                         % stream.num_lost_packets % stream.num_eob;
+    }
+
+    bool header_printed = false;
+    for (const auto& stream : stats.streams) {
+        if (stream.num_timestamps < 2) {
+            continue;
+        }
+        if (not header_printed) {
+            std::cout << boost::format("\n%-6s %16s %16s %14s %10s\n") % "EPID"
+                             % "First TS" % "Last TS" % "Tick rate" % "Drift ppm";
+            header_printed = true;
+        }
+        std::cout << boost::format("%-6u %16u %16u %14.1f %10.3f\n") % stream.dst_epid
+                         % stream.first_timestamp % stream.last_timestamp
+                         % stream.tick_rate % stream.drift_ppm;
+    }
+
+    header_printed = false;
+    for (const auto& stream : stats.streams) {
+        if (stream.type != PCAP_STREAM_STRS) {
+            continue;
+        }
+        if (not header_printed) {
+            std::cout << boost::format("\n%-6s %8s %12s %12s %12s\n") % "EPID"
+                             % "Errors" % "Min int. us" % "Mean int. us"
+                             % "Max int. us";
+            header_printed = true;
+        }
+        std::cout << boost::format("%-6u %8u %12.1f %12.1f %12.1f\n") % stream.dst_epid
+                         % stream.num_strs_errors % (stream.min_strs_interval * 1e6)
+                         % (stream.mean_strs_interval * 1e6)
+                         % (stream.max_strs_interval * 1e6);
+    }
+}
+
+//! Append a little-endian value to a buffer
+template <typename T>
+void put(std::vector<uint8_t>& buff, const T value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buff.insert(buff.end(), bytes, bytes + sizeof(value));
+}
+
+void put_be16(std::vector<uint8_t>& buff, const uint16_t value)
+{
+    buff.push_back(uint8_t(value >> 8));
+    buff.push_back(uint8_t(value & 0xff));
+}
+
+//! Append a pcap record with a UDP datagram that contains the given CHDR words
+void put_chdr_record(
+    std::vector<uint8_t>& buff, const double time, const std::vector<uint64_t>& chdr)
+{
+    const size_t chdr_len  = chdr.size() * sizeof(uint64_t);
+    const size_t frame_len = 14 + 20 + 8 + chdr_len;
+    put(buff, uint32_t(time));
+    put(buff, uint32_t((time - std::floor(time)) * 1e6));
+    put(buff, uint32_t(frame_len));
+    put(buff, uint32_t(frame_len));
+    buff.insert(buff.end(), 12, 0);
+    put_be16(buff, 0x0800);
+    buff.insert(buff.end(), {0x45, 0});
+    put_be16(buff, uint16_t(20 + 8 + chdr_len));
+    buff.insert(buff.end(), {0, 0, 0, 0, 64, 17, 0, 0, 192, 168, 10, 2, 192, 168, 10, 1});
+    put_be16(buff, 49153);
+    put_be16(buff, 49153);
+    put_be16(buff, uint16_t(8 + chdr_len));
+    put_be16(buff, 0);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(chdr.data());
+    buff.insert(buff.end(), bytes, bytes + chdr_len);
+}
+
+/*! Build a capture of several streams of timestamped data packets, with a
+ * stream status packet for every 16 data packets
+ */
+std::vector<uint8_t> make_benchmark_capture(
+    const size_t num_bytes, const size_t pkt_size, const size_t num_streams)
+{
+    std::vector<uint8_t> buff;
+    buff.reserve(num_bytes + pkt_size + 1024);
+    put(buff, uint32_t(0xa1b2c3d4));
+    put(buff, uint16_t(2));
+    put(buff, uint16_t(4));
+    put(buff, uint64_t(0));
+    put(buff, uint32_t(65535));
+    put(buff, uint32_t(1));
+
+    const size_t num_words = std::max<size_t>(pkt_size / sizeof(uint64_t), 2);
+    std::vector<uint64_t> data(num_words, 0);
+    std::vector<uint64_t> strs_pkt(5, 0);
+    strs_payload strs;
+    chdr_header header;
+    header.set_length(uint16_t(num_words * sizeof(uint64_t)));
+    for (uint64_t pkt = 0; buff.size() < num_bytes; pkt++) {
+        const uint16_t epid = uint16_t(2 + pkt % num_streams);
+        const uint64_t seq  = pkt / num_streams;
+        const double time   = 1.0 + pkt * 1e-6;
+        header.set_pkt_type(PKT_TYPE_DATA_WITH_TS);
+        header.set_dst_epid(epid);
+        header.set_seq_num(uint16_t(seq));
+        data[0] = header.pack();
+        data[1] = seq * (num_words - 2);
+        put_chdr_record(buff, time, data);
+
+        if (seq % 16 == 15) {
+            chdr_header strs_header;
+            strs_header.set_pkt_type(PKT_TYPE_STRS);
+            strs_header.set_dst_epid(1);
+            strs_header.set_length(uint16_t(strs_pkt.size() * sizeof(uint64_t)));
+            strs.src_epid        = epid;
+            strs.xfer_count_pkts = seq + 1;
+            strs_pkt[0]          = strs_header.pack();
+            strs.serialize<uhd::ENDIANNESS_LITTLE>(&strs_pkt[1], 32);
+            put_chdr_record(buff, time, strs_pkt);
+        }
+    }
+    return buff;
+}
+
+} // namespace
+
+int UHD_SAFE_MAIN(int argc, char* argv[])
+{
+    std::string file;
+    size_t chdr_w_bits, chunk_size, bench_size, bench_pkt_size, iterations;
+    pcap_analyzer_config_t config;
+
+    // clang-format off
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("file", po::value<std::string>(&file), "pcap capture to analyze")
+        ("chdr-w", po::value<size_t>(&chdr_w_bits)->default_value(64), "CHDR width of the captured link, in bits")
+        ("big-endian", "The captured link is big endian")
+        ("port", po::value<uint16_t>(&config.udp_port)->default_value(0), "Only decode UDP datagrams from or to this port (0 for all)")
+        ("tick-rate", po::value<double>(&config.tick_rate)->default_value(0.0), "Nominal tick rate of the device, to compute the timestamp drift")
+        ("threads", po::value<size_t>(&config.num_threads)->default_value(0), "Number of decoder threads (0 for one per CPU)")
+        ("chunk-size", po::value<size_t>(&chunk_size)->default_value(16), "Amount of capture decoded as one unit of work, in MiB")
+        ("benchmark", "Decode a synthetic capture held in memory, and report the decode rate")
+        ("bench-size", po::value<size_t>(&bench_size)->default_value(1024), "Size of the synthetic capture, in MiB")
+        ("bench-pkt-size", po::value<size_t>(&bench_pkt_size)->default_value(8000), "Size of the synthetic CHDR packets, in bytes")
+        ("iterations", po::value<size_t>(&iterations)->default_value(5), "Number of benchmark iterations")
+    ;
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help") or (vm.count("file") == 0 and vm.count("benchmark") == 0)) {
+        std::cout << boost::format("UHD CHDR pcap Analyzer %s") % desc << std::endl;
+        std::cout
+            << "  Decodes the CHDR packets in a pcap capture of an RFNoC link, and\n"
+               "  reports sequence gaps, flow control timing, timestamp drift, and\n"
+               "  throughput for every destination endpoint.\n"
+               "  With --benchmark, no file is read; instead, the decode rate is\n"
+               "  measured on a synthetic capture.\n"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    switch (chdr_w_bits) {
+        case 64:
+            config.chdr_w = uhd::rfnoc::CHDR_W_64;
+            break;
+        case 128:
+            config.chdr_w = uhd::rfnoc::CHDR_W_128;
+            break;
+        case 256:
+            config.chdr_w = uhd::rfnoc::CHDR_W_256;
+            break;
+        case 512:
+            config.chdr_w = uhd::rfnoc::CHDR_W_512;
+            break;
+        default:
+            std::cerr << "Invalid CHDR width: " << chdr_w_bits << std::endl;
+            return EXIT_FAILURE;
+    }
+    if (vm.count("big-endian")) {
+        config.endianness = uhd::ENDIANNESS_BIG;
+    }
+    config.chunk_size = chunk_size * 1024 * 1024;
+
+    if (vm.count("benchmark")) {
+        std::cout << "Building a synthetic capture of " << bench_size << " MiB..."
+                  << std::endl;
+        const std::vector<uint8_t> capture =
+            make_benchmark_capture(bench_size * 1024 * 1024, bench_pkt_size, 4);
+        double best_rate = 0.0;
+        for (size_t i = 0; i < iterations; i++) {
+            const pcap_stats_t stats =
+                analyze_pcap(capture.data(), capture.size(), config);
+            std::cout << boost::format("Iteration %u: %.2f Gbps (%.1f Mpps)") % i
+                             % (stats.get_decode_rate() / 1e9)
+                             % (stats.num_records / stats.decode_time / 1e6)
+                      << std::endl;
+            best_rate = std::max(best_rate, stats.get_decode_rate());
+        }
+        std::cout << boost::format("Best decode rate: %.2f Gbps") % (best_rate / 1e9)
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    print_stats(analyze_pcap_file(file, config));
+    return EXIT_SUCCESS;
+}
@@ -16,6 +16,9 @@
 #include <csignal>
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -46,13 +49,59 @@ void sigint_handler(int)
     }
 }
 
+/*
+ * When several devices are loaded at once, the loaders pass their output to
+ * this console line by line, from their own threads. Every line is printed
+ * whole, prefixed with the device it belongs to, and the combined progress
+ * line is kept below the other output.
+ */
+class multi_device_console
+{
+public:
+    ~multi_device_console()
+    {
+        if (not _progress.empty()) {
+            std::cout << std::endl;
+        }
+    }
+
+    //! Print a line of output of a device
+    void print(const std::string& device, const std::string& line)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        const std::string text = "[" + device + "] " + line;
+        if (_progress.empty()) {
+            std::cout << text << std::endl;
+        } else {
+            // Overwrite the progress line, then print it again below
+            const size_t padding =
+                (_progress.size() > text.size()) ? _progress.size() - text.size() : 0;
+            std::cout << "\r" << text << std::string(padding, ' ') << "\n"
+                      << _progress << std::flush;
+        }
+    }
+
+    //! Replace the progress line
+    void show_progress(const std::string& progress)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        _progress = progress;
+        std::cout << "\r" << _progress << std::flush;
+    }
+
+private:
+    std::mutex _mutex;
+    std::string _progress;
+};
+
 int UHD_SAFE_MAIN(int argc, char* argv[])
 {
     po::options_description desc("Allowed options");
     // clang-format off
     desc.add_options()
         ("help", "help message")
-        ("args", po::value<std::string>()->default_value(""), "Device args, optional loader args")
+        ("args", po::value<std::vector<std::string>>()->composing(), "Device args, optional loader args. Give several times to load several devices at once.")
+        ("max-concurrent", po::value<size_t>()->default_value(0), "Maximum number of devices loaded at the same time (0 for all)")
         ("fw-path", po::value<std::string>()->default_value(""), "Firmware path (uses default if none specified)")
         ("fpga-path", po::value<std::string>()->default_value(""), "FPGA path (uses default if none specified)")
         ("out-path", po::value<std::string>()->default_value(""), "Output path/filename of the downloaded FPGA .bit file")
@@ -81,7 +130,10 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
 
     // Convert user options
     uhd::image_loader::image_loader_args_t image_loader_args;
-    image_loader_args.args          = vm["args"].as<std::string>();
+    const std::vector<std::string> device_args =
+        vm.count("args") ? vm["args"].as<std::vector<std::string>>()
+                         : std::vector<std::string>{""};
+    image_loader_args.args          = device_args.front();
     image_loader_args.load_firmware = (vm.count("no-fw") == 0);
     image_loader_args.load_fpga     = (vm.count("no-fpga") == 0);
     image_loader_args.download      = (vm.count("download") != 0);
@@ -125,8 +177,67 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     device_type = image_loader_args.args.get("type", "");
 
     std::signal(SIGINT, &sigint_handler);
-    if (not uhd::image_loader::load(image_loader_args)) {
-        std::cerr << "No applicable UHD devices found" << std::endl;
+    if (device_args.size() == 1) {
+        if (not uhd::image_loader::load(image_loader_args)) {
+            std::cerr << "No applicable UHD devices found" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Several devices: load them all at once, and print the combined progress
+    // rather than the per-device one
+    std::vector<uhd::image_loader::load_result_t> results;
+    {
+        multi_device_console console;
+        std::vector<uhd::image_loader::image_loader_args_t> all_args;
+        std::vector<double> progress(device_args.size(), 0.0);
+        std::mutex progress_mutex;
+        int last_percent = -1;
+        for (size_t i = 0; i < device_args.size(); i++) {
+            image_loader_args.args = device_args[i];
+            if (image_loader_args.args.get("type", "") != device_type) {
+                throw uhd::runtime_error("All devices must be of the same type.");
+            }
+            image_loader_args.message = [&console, &device_args, i](
+                                            const std::string& line) {
+                console.print(device_args[i], line);
+            };
+            image_loader_args.progress = [&, i](const double fraction) {
+                std::lock_guard<std::mutex> l(progress_mutex);
+                progress[i]  = fraction;
+                double total = 0.0;
+                for (const double p : progress) {
+                    total += p;
+                }
+                const int percent = int(total / progress.size() * 100.0);
+                if (percent != last_percent) {
+                    last_percent = percent;
+                    console.show_progress(str(boost::format("-- Loading %d devices: %d%%")
+                                              % progress.size() % percent));
+                }
+            };
+            all_args.push_back(image_loader_args);
+        }
+
+        results = uhd::image_loader::load(all_args, vm["max-concurrent"].as<size_t>());
+    }
+    size_t num_failed = 0;
+    std::cout << std::endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        std::string outcome = "successful";
+        if (not results[i].error.empty()) {
+            outcome = "failed: " + results[i].error;
+        } else if (not results[i].success) {
+            outcome = "failed: no applicable UHD device found";
+        }
+        num_failed += results[i].success ? 0 : 1;
+        std::cout << boost::format("%s: %s") % device_args[i] % outcome << std::endl;
+    }
+    if (num_failed > 0) {
+        std::cerr << boost::format("Loading failed on %d of %d devices") % num_failed
+                         % results.size()
+                  << std::endl;
         return EXIT_FAILURE;
     }
 
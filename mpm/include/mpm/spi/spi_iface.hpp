@@ -10,6 +10,7 @@
 #include <boost/noncopyable.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace mpm { namespace spi {
 
@@ -36,6 +37,22 @@ public:
      */
     virtual uint32_t transfer24_16(const uint32_t data) = 0;
 
+    /*! Write-only batch of 24-bit SPI xfers
+     *
+     * Every element of \p data is one xfer, in order, with chip select being
+     * toggled between them. Nothing is read back. Implementations may submit
+     * the whole batch at once, which is much faster than calling
+     * transfer24_8() for every xfer.
+     *
+     * \param data The write data for each xfer
+     */
+    virtual void transfer24_batch(const std::vector<uint32_t>& data)
+    {
+        for (const uint32_t xfer : data) {
+            transfer24_8(xfer);
+        }
+    }
+
     /*!
      * \param device The path to the spidev used (e.g. "/dev/spidev0.0")
      * \param speed_hz Transaction speed in Hz
@@ -5,11 +5,19 @@
 //
 #pragma once
 
-#include <unordered_map>
+#include <mpm/spi/spi_iface.hpp>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace mpm {
-class tests_spi_iface : public virtual spi_iface
+
+/*! Mock SPI bus with a register file behind it
+ *
+ * Transactions are decoded like on the AD937x: bit 23 flags a read, bits 22
+ * to 8 hold the address, and bits 7 to 0 the write data.
+ */
+class tests_spi_iface : public mpm::spi::spi_iface
 {
 public:
     /**************************************************************************
@@ -22,24 +30,35 @@ public:
         return std::make_shared<tests_spi_iface>();
     };
 
-    void write_byte(const uint16_t addr, const uint8_t data);
+    uint32_t transfer24_8(const uint32_t data);
 
-    void write_bytes(const uint16_t* addr, const uint8_t* data, const uint32_t count);
+    uint32_t transfer24_16(const uint32_t data);
 
-    uint8_t read_byte(const uint16_t addr);
+    void transfer24_batch(const std::vector<uint32_t>& data);
 
-    void write_field(const uint16_t addr,
-        const uint8_t field_val,
-        const uint8_t mask,
-        const uint8_t start_bit);
+    /**************************************************************************
+     * Test API
+     *************************************************************************/
+    uint8_t get_reg(const uint16_t addr) const;
 
-    uint8_t read_field(const uint16_t addr, const uint8_t mask, const uint8_t start_bit);
-    spi_wire_mode_t get_wire_mode() const;
-    spi_endianness_t get_endianness() const;
-    size_t get_chip_select() const;
+    //! Addresses of all writes so far, in the order they hit the bus
+    const std::vector<uint16_t>& get_write_order() const
+    {
+        return _write_order;
+    }
+
+    //! Number of times the bus was handed a transaction or a batch of them
+    size_t get_num_submissions() const
+    {
+        return _num_submissions;
+    }
 
 private:
+    uint8_t xfer(const uint32_t data);
+
     std::unordered_map<uint16_t, uint8_t> _regs;
-    uint8_t _default_val = 0;
+    std::vector<uint16_t> _write_order;
+    size_t _num_submissions = 0;
+    uint8_t _default_val    = 0;
 };
 } // namespace mpm
@@ -8,6 +8,8 @@
 
 #include <boost/noncopyable.hpp>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace mpm { namespace types {
 
@@ -26,6 +28,17 @@ public:
      */
     virtual void poke8(const uint32_t addr, const uint8_t data) = 0;
 
+    /*! Write several 8-bit values, in order
+     *
+     * \param writes List of (address, value) pairs
+     */
+    virtual void poke8_batch(const std::vector<std::pair<uint32_t, uint8_t>>& writes)
+    {
+        for (const auto& write : writes) {
+            poke8(write.first, write.second);
+        }
+    }
+
     /*! Return a 16-bit value from a given address
      */
     virtual uint16_t peek16(const uint32_t addr) = 0;
@@ -104,9 +104,14 @@ commonErr_t CMB_SPIWriteBytes(
 
     ad9371_spiSettings_t* spi = ad9371_spiSettings_t::make(spiSettings);
     try {
+        // The API uses this for ARM images and tables, so submit all writes at
+        // once instead of doing one SPI transaction at a time
+        std::vector<std::pair<uint32_t, uint8_t>> writes;
+        writes.reserve(count);
         for (size_t i = 0; i < count; ++i) {
-            spi->spi_iface->poke8(addr[i], data[i]);
+            writes.emplace_back(addr[i], data[i]);
         }
+        spi->spi_iface->poke8_batch(writes);
         return COMMONERR_OK;
     } catch (const std::exception& e) {
         // TODO: spit out a reasonable error here (that will survive the C API transition)
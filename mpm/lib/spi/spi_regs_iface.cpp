@@ -52,6 +52,18 @@ public:
         _spi_iface->transfer24_8(transaction);
     }
 
+    void poke8_batch(const std::vector<std::pair<uint32_t, uint8_t>>& writes)
+    {
+        std::vector<uint32_t> transactions;
+        transactions.reserve(writes.size());
+        for (const auto& write : writes) {
+            transactions.push_back(0 | _write_flags | (write.first << _addr_shift)
+                                   | (write.second << _data_shift));
+        }
+
+        _spi_iface->transfer24_batch(transactions);
+    }
+
     uint16_t peek16(const uint32_t addr)
     {
         uint32_t transaction = 0 | (addr << _addr_shift) | _read_flags;
@@ -13,6 +13,11 @@
 #include <linux/spi/spidev.h>
 #include <stdio.h>
 
+/* Number of transfers per SPI_IOC_MESSAGE. The ioctl size field limits this to
+ * 511; spidev also caps the total length of a message at its buffer size.
+ */
+#define SPIDEV_MAX_BATCH 256
+
 int init_spi(int *fd, const char *device,
     const uint32_t mode,
     const uint32_t speed_hz,
@@ -138,3 +143,43 @@ int transfer(
     return 0;
 }
 
+int transfer_batch(
+        int fd,
+        uint8_t *tx, uint32_t len, uint32_t num_transfers,
+        uint32_t speed_hz, uint8_t bits_per_word, uint16_t delay_us
+) {
+    struct spi_ioc_transfer tr[SPIDEV_MAX_BATCH];
+    uint32_t offset = 0;
+    int err;
+
+    while (offset < num_transfers) {
+        uint32_t num_msgs = num_transfers - offset;
+        if (num_msgs > SPIDEV_MAX_BATCH) {
+            num_msgs = SPIDEV_MAX_BATCH;
+        }
+
+        memset(tr, 0, sizeof(tr[0]) * num_msgs);
+        for (uint32_t i = 0; i < num_msgs; i++) {
+            tr[i].tx_buf = (unsigned long) (tx + (offset + i) * len);
+            tr[i].rx_buf = 0; // Write-only, no need to read back
+            tr[i].len = len;
+            tr[i].speed_hz = speed_hz;
+            tr[i].delay_usecs = delay_us;
+            tr[i].bits_per_word = bits_per_word;
+            // Toggle chip select between transfers, but not after the last one
+            tr[i].cs_change = (i + 1 < num_msgs);
+            tr[i].tx_nbits = 1; // Standard SPI
+            tr[i].rx_nbits = 1; // Standard SPI
+        }
+
+        err = ioctl(fd, SPI_IOC_MESSAGE(num_msgs), tr);
+        if (err < 0) {
+            fprintf(stderr, "%s: Failed ioctl: %d\n", __func__, err);
+            perror("ioctl: \n");
+            return err;
+        }
+        offset += num_msgs;
+    }
+
+    return 0;
+}
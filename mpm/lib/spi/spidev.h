@@ -43,3 +43,26 @@ int transfer(
         uint32_t speed_hz, uint8_t bits_per_word, uint16_t delay_us
 );
 
+
+/*! Do a batch of write-only SPI transactions over spidev
+ *
+ * The transactions are submitted in as few SPI_IOC_MESSAGE ioctls as
+ * possible. Chip select is deasserted between transactions, so every one of
+ * them looks like a separate call to transfer() on the wire.
+ *
+ * \param tx Buffer of data to be written, num_transfers * len bytes long
+ * \param len Number of bytes in each transaction
+ * \param num_transfers Number of transactions in tx
+ * \param speed_hz Speed of this transaction in Hz
+ * \param bits_per_word 8, dude
+ * \param delay_us Delay between transfers
+ *
+ * Assumption: spidev was configured properly beforehand.
+ *
+ * \returns 0 if all is golden
+ */
+int transfer_batch(
+        int fd,
+        uint8_t *tx, uint32_t len, uint32_t num_transfers,
+        uint32_t speed_hz, uint8_t bits_per_word, uint16_t delay_us
+);
@@ -79,6 +79,26 @@ public:
         return uint32_t(rx[1] << 8 | rx[2]);
     }
 
+    void transfer24_batch(const std::vector<uint32_t>& data)
+    {
+        if (data.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> tx;
+        tx.reserve(data.size() * 3);
+        for (const uint32_t xfer : data) {
+            tx.push_back(uint8_t(xfer >> 16));
+            tx.push_back(uint8_t(xfer >> 8));
+            tx.push_back(uint8_t(xfer));
+        }
+
+        if (transfer_batch(_fd, tx.data(), 3, data.size(), _speed, _bits, _delay)
+            != 0) {
+            throw mpm::runtime_error(str(boost::format("SPI Transaction failed!")));
+        }
+    }
+
 private:
     int _fd;
     const uint32_t _mode;
@@ -4,7 +4,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
-#include <mpm/spi_iface.hpp>
+#include <mpm/spi/spi_iface.hpp>
 #include <mpm/tests/tests_spi_iface.hpp>
 #include <memory>
 
@@ -16,7 +16,7 @@ public:
     static sptr make();
 
 private:
-    mpm::spi_iface::sptr _dev1_spi;
-    mpm::spi_iface::sptr _dev2_spi;
+    mpm::spi::spi_iface::sptr _dev1_spi;
+    mpm::spi::spi_iface::sptr _dev2_spi;
 };
 }} // namespace mpm::tests
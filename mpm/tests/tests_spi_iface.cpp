@@ -4,27 +4,36 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 
+#include <mpm/spi/spi_regs_iface.hpp>
 #include <mpm/tests/tests_spi_iface.hpp>
+#include <boost/test/unit_test.hpp>
 
 /**************************************************************************
  * spi_iface API calls
  *************************************************************************/
 namespace mpm {
 
-void tests_spi_iface::write_byte(const uint16_t addr, const uint8_t data)
+uint32_t tests_spi_iface::transfer24_8(const uint32_t data)
 {
-    _regs[addr] = data;
+    _num_submissions++;
+    return xfer(data);
 }
 
-void tests_spi_iface::write_bytes(
-    const uint16_t* addr, const uint8_t* data, const uint32_t count)
+uint32_t tests_spi_iface::transfer24_16(const uint32_t data)
 {
-    for (size_t i = 0; i < count; i++) {
-        _regs[addr[i]] = data[i];
+    _num_submissions++;
+    return xfer(data);
+}
+
+void tests_spi_iface::transfer24_batch(const std::vector<uint32_t>& data)
+{
+    _num_submissions++;
+    for (const uint32_t transaction : data) {
+        xfer(transaction);
     }
 }
 
-uint8_t tests_spi_iface::read_byte(const uint16_t addr)
+uint8_t tests_spi_iface::get_reg(const uint16_t addr) const
 {
     if (_regs.count(addr)) {
         return _regs.at(addr);
@@ -32,33 +41,68 @@ uint8_t tests_spi_iface::read_byte(const uint16_t addr)
     return _default_val;
 }
 
-void tests_spi_iface::write_field(const uint16_t addr,
-    const uint8_t field_val,
-    const uint8_t mask,
-    const uint8_t start_bit)
+uint8_t tests_spi_iface::xfer(const uint32_t data)
 {
-    const uint8_t old_value = read_byte(addr);
-    _regs[addr]             = (old_value & ~mask) | ((field_val << start_bit) & mask);
+    const uint16_t addr = (data >> 8) & 0x7FFF;
+    if (data & (1 << 23)) {
+        return get_reg(addr);
+    }
+    _regs[addr] = data & 0xFF;
+    _write_order.push_back(addr);
+    return 0;
 }
 
-uint8_t tests_spi_iface::read_field(
-    const uint16_t addr, const uint8_t mask, const uint8_t start_bit)
-{
-    return (read_byte(addr) & mask) >> start_bit;
-}
+} // namespace mpm
 
+/**************************************************************************
+ * Tests
+ *************************************************************************/
+namespace {
 
-spi_iface::spi_wire_mode_t tests_spi_iface::get_wire_mode() const
+// Same settings as the AD937x SPI interface
+mpm::types::regs_iface::sptr make_test_regs_iface(mpm::tests_spi_iface::sptr spi)
 {
-    return spi_iface::spi_wire_mode_t::THREE_WIRE_MODE;
+    return mpm::spi::make_spi_regs_iface(spi, 8, 0, 1 << 23, 0);
 }
 
-spi_iface::spi_endianness_t tests_spi_iface::get_endianness() const
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_spi_regs_iface)
 {
-    return spi_iface::spi_endianness_t::LSB_FIRST;
+    auto spi  = mpm::tests_spi_iface::make();
+    auto regs = make_test_regs_iface(spi);
+
+    regs->poke8(0x0123, 0xAB);
+    BOOST_CHECK_EQUAL(spi->get_reg(0x0123), 0xAB);
+    BOOST_CHECK_EQUAL(regs->peek8(0x0123), 0xAB);
+    BOOST_CHECK_EQUAL(spi->get_num_submissions(), 2);
 }
-size_t tests_spi_iface::get_chip_select() const
+
+BOOST_AUTO_TEST_CASE(test_spi_regs_iface_batch)
 {
-    return 0;
+    auto spi  = mpm::tests_spi_iface::make();
+    auto regs = make_test_regs_iface(spi);
+
+    // Like an ARM image load: many writes, some of them to the same address
+    std::vector<std::pair<uint32_t, uint8_t>> writes;
+    for (uint32_t i = 0; i < 1000; i++) {
+        writes.emplace_back(0x0D00 + (i % 300), uint8_t(i * 7));
+    }
+    regs->poke8_batch(writes);
+
+    BOOST_CHECK_EQUAL(spi->get_num_submissions(), 1);
+    BOOST_REQUIRE_EQUAL(spi->get_write_order().size(), writes.size());
+    for (size_t i = 0; i < writes.size(); i++) {
+        BOOST_CHECK_EQUAL(spi->get_write_order()[i], writes[i].first);
+    }
+    // The last write to every address wins
+    for (uint32_t i = 700; i < 1000; i++) {
+        BOOST_CHECK_EQUAL(regs->peek8(0x0D00 + (i % 300)), uint8_t(i * 7));
+    }
+
+    // Reads are still done one by one, and empty batches are harmless
+    const size_t num_submissions = spi->get_num_submissions();
+    regs->poke8_batch({});
+    BOOST_CHECK_EQUAL(spi->get_num_submissions(), num_submissions + 1);
+    BOOST_CHECK_EQUAL(spi->get_write_order().size(), writes.size());
 }
-} // namespace mpm